@@ -7,12 +7,27 @@ VTK_MODULE_INIT(vtkRenderingOpenGL2);
 VTK_MODULE_INIT(vtkInteractionStyle);
 VTK_MODULE_INIT(vtkRenderingFreeType);
 
+#include "contourcache.h"
+#include "terraintin.h"
+#include "syntheticdata.h"
+#include "demmosaic.h"
+#include "demcatalog.h"
+#include "heightfield.h"
+#include "batchrender.h"
+#include "pipelinetrace.h"
+#include "statshud.h"
+#include "objecttracker.h"
+#include "taskgraph.h"
+#include "interactionscheduler.h"
+#include "sharedimage.h"
+
 // VTK includes
 #include <vtkSmartPointer.h>
 #include <vtkDEMReader.h>
-#include <vtkContourFilter.h>
-#include <vtkWarpScalar.h>
-#include <vtkDataSetMapper.h>
+#include <vtkTrivialProducer.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkTransform.h>
+#include <vtkMatrix4x4.h>
 
 #include <vtkActor.h>
 #include <vtkProperty.h>
@@ -30,9 +45,17 @@ VTK_MODULE_INIT(vtkRenderingFreeType);
 #include <vtkRenderer.h>
 #include <vtkCamera.h>
 
+#include <vtkSliderRepresentation2D.h>
+#include <vtkSliderWidget.h>
+#include <vtkCommand.h>
+
 // standard includes
 #include <vector>
 #include <algorithm>
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <cstdlib>
 
 // ----- utility functions -----
 void setGradientBackground(vtkSmartPointer<vtkRenderer> renderer)
@@ -41,8 +64,112 @@ void setGradientBackground(vtkSmartPointer<vtkRenderer> renderer)
 	renderer->SetBackground(0, 0, 0);
 	renderer->SetBackground2(0.2, 0.2, 0.2);
 }
+
+vtkSmartPointer<vtkSliderWidget> createSlider(vtkSmartPointer<vtkRenderWindowInteractor> interactor, const char *title,
+	double minimum, double maximum, double value, const char *labelFormat, double y)
+{
+	// slider representation with a fixed position in display coordinates
+	vtkSmartPointer<vtkSliderRepresentation2D> sliderRep = vtkSmartPointer<vtkSliderRepresentation2D>::New();
+	sliderRep->SetMinimumValue(minimum);
+	sliderRep->SetMaximumValue(maximum);
+	sliderRep->SetValue(value);
+	sliderRep->SetTitleText(title);
+	sliderRep->SetLabelFormat(labelFormat);
+	sliderRep->GetPoint1Coordinate()->SetCoordinateSystemToDisplay();
+	sliderRep->GetPoint1Coordinate()->SetValue(40, y);
+	sliderRep->GetPoint2Coordinate()->SetCoordinateSystemToDisplay();
+	sliderRep->GetPoint2Coordinate()->SetValue(240, y);
+
+	vtkSmartPointer<vtkSliderWidget> sliderWidget = vtkSmartPointer<vtkSliderWidget>::New();
+	sliderWidget->SetInteractor(interactor);
+	sliderWidget->SetRepresentation(sliderRep);
+	sliderWidget->SetAnimationModeToAnimate();
+	sliderWidget->EnabledOn();
+	return sliderWidget;
+}
 // ----- end of utility functions -----
 
+// ----- slider callbacks -----
+class ContourLevelSliderCallback : public vtkCommand {
+private:
+	ContourLevelSliderCallback() {}
+
+public:
+	vtkSmartPointer<CachedContourFilter> contourFilter;
+	vtkSmartPointer<InteractionScheduler> scheduler;
+
+	static ContourLevelSliderCallback *New() { return new ContourLevelSliderCallback; }
+
+	virtual void Execute(vtkObject *caller, unsigned long eventId, void *callData) {
+		vtkSliderWidget *slider = static_cast<vtkSliderWidget*>(caller);
+		double value = static_cast<vtkSliderRepresentation*>(slider->GetRepresentation())->GetValue();
+
+		// only levels that are not cached yet are contoured, at most once per frame for the last slider position.
+		// A count shares its levels with its multiples, e.g. 15 to 30 contours 15 levels and 30 to 15 none
+		CachedContourFilter *filter = contourFilter;
+		int levels = static_cast<int>(value + 0.5);
+		InteractionScheduler::Update update = [filter, levels]() {
+			if (filter->GetNumberOfLevels() == levels)
+				return false;
+			filter->SetNumberOfLevels(levels);
+			filter->Update();
+			return true;
+		};
+		if (scheduler)
+			scheduler->Post(this, update);
+		else
+			update();
+	}
+};
+
+class WarpSliderCallback : public vtkCommand {
+private:
+	WarpSliderCallback() {}
+
+public:
+	vtkSmartPointer<vtkTransform> elevationScale;
+	vtkSmartPointer<InteractionScheduler> scheduler;
+
+	static WarpSliderCallback *New() { return new WarpSliderCallback; }
+
+	virtual void Execute(vtkObject *caller, unsigned long eventId, void *callData) {
+		vtkSliderWidget *slider = static_cast<vtkSliderWidget*>(caller);
+		double value = static_cast<vtkSliderRepresentation*>(slider->GetRepresentation())->GetValue();
+
+		// all actors share the elevation scale as user transform, nothing is recomputed or uploaded
+		vtkTransform *transform = elevationScale;
+		InteractionScheduler::Update update = [transform, value]() {
+			if (transform->GetMatrix()->GetElement(2, 2) == value)
+				return false;
+			transform->Identity();
+			transform->Scale(1, 1, value);
+			return true;
+		};
+		if (scheduler)
+			scheduler->Post(this, update);
+		else
+			update();
+	}
+};
+
+class MosaicStatisticsCallback : public vtkCommand {
+private:
+	MosaicStatisticsCallback() : mosaic(nullptr) {}
+
+public:
+	DemMosaic *mosaic;
+
+	static MosaicStatisticsCallback *New() { return new MosaicStatisticsCallback; }
+
+	virtual void Execute(vtkObject *caller, unsigned long eventId, void *callData) {
+		// print the paging statistics with 'i'
+		vtkRenderWindowInteractor *interactor = static_cast<vtkRenderWindowInteractor*>(caller);
+		if (interactor->GetKeyCode() == 'i')
+			mosaic->PrintStatistics(std::cout);
+	}
+};
+// ----- end of slider callbacks -----
+
 vtkSmartPointer<vtkRenderWindow> createRenderWindowFromMapper(vtkSmartPointer<vtkMapper> mapper)
 {
 	//create renderer, window and actor
@@ -65,7 +192,8 @@ vtkSmartPointer<vtkRenderWindow> createRenderWindowFromMapper(vtkSmartPointer<vt
 	return window;
 }
 
-vtkSmartPointer<vtkRenderWindow> createRenderWindowFromMultipleMappers(std::vector<vtkSmartPointer<vtkMapper>> mappers)
+vtkSmartPointer<vtkRenderWindow> createRenderWindowFromMultipleMappers(std::vector<vtkSmartPointer<vtkMapper>> mappers,
+	vtkSmartPointer<vtkTransform> userTransform = nullptr)
 {
 	// create renderer and window
 	vtkSmartPointer<vtkRenderer> renderer = vtkSmartPointer<vtkRenderer>::New();
@@ -95,6 +223,12 @@ vtkSmartPointer<vtkRenderWindow> createRenderWindowFromMultipleMappers(std::vect
 	actor1->SetMapper(mappers[0]);
 	actor2->SetMapper(mappers[1]);
 
+	// scaling the elevation of both actors on the GPU
+	if (userTransform) {
+		actor1->SetUserTransform(userTransform);
+		actor2->SetUserTransform(userTransform);
+	}
+
 	renderer->AddActor(actor1);
 	renderer->AddActor(actor2);
 
@@ -117,8 +251,9 @@ void doRenderingAndInteraction(vtkSmartPointer<vtkRenderWindow> window)
 	// create interactor and connect a window
 	vtkSmartPointer<vtkRenderWindowInteractor> interactor = vtkSmartPointer<vtkRenderWindowInteractor>::New();
 	interactor->SetRenderWindow(window);
-	// set an interaction style
-	interactor->SetInteractorStyle(vtkInteractorStyleTrackballCamera::New());
+	// set an interaction style, the interactor holds the only reference
+	vtkSmartPointer<vtkInteractorStyleTrackballCamera> style = vtkSmartPointer<vtkInteractorStyleTrackballCamera>::New();
+	interactor->SetInteractorStyle(style);
 
 	// execute render/interaction loop
 	interactor->Initialize();
@@ -128,43 +263,300 @@ void doRenderingAndInteraction(vtkSmartPointer<vtkRenderWindow> window)
 	window->Finalize();
 }
 
+void doRenderingAndInteraction(vtkSmartPointer<vtkRenderWindowInteractor> interactor, vtkSmartPointer<vtkRenderWindow> window)
+{
+	// set an interaction style, the interactor holds the only reference
+	vtkSmartPointer<vtkInteractorStyleTrackballCamera> style = vtkSmartPointer<vtkInteractorStyleTrackballCamera>::New();
+	interactor->SetInteractorStyle(style);
+
+	// execute render/interaction loop, the first frame goes through an attached interaction scheduler
+	interactor->Initialize();
+	interactor->Render();
+	interactor->Start();
+
+	// close the window when finished
+	window->Finalize();
+}
+
+
+int runTinBenchmarks(vtkSmartPointer<vtkDEMReader> source, int numberOfThreads)
+{
+	// error bound vs triangle count vs build time vs frame time, 0 is the dense grid as reference
+	std::vector<double> errorBounds;
+	errorBounds.push_back(0);
+	errorBounds.push_back(1);
+	errorBounds.push_back(2);
+	errorBounds.push_back(5);
+	errorBounds.push_back(10);
+	errorBounds.push_back(20);
+	errorBounds.push_back(50);
+
+	source->Update();
+	runTinBenchmark(source->GetOutput(), "SainteHelens.dem", errorBounds, numberOfThreads, std::cout);
+
+	// larger synthetic terrains with the same sample spacing
+	const int sizes[] = { 1024, 2048, 4096 };
+	for (int i = 0; i < 3; ++i) {
+		vtkSmartPointer<vtkImageData> terrain = createSyntheticTerrain(sizes[i], 1);
+		runTinBenchmark(terrain, "synthetic " + std::to_string(sizes[i]), errorBounds, numberOfThreads, std::cout);
+	}
+	return 0;
+}
+
+int runMosaicViewer(const std::string& directory, size_t budget)
+{
+	// all tiles share the look up table and the elevation scale, so neighbouring tiles match at their edges
+	vtkSmartPointer<vtkLookupTable> lut = vtkSmartPointer<vtkLookupTable>::New();
+	lut->SetHueRange(0, 0.2);
+	lut->SetSaturationRange(1.0, 0.5);
+	lut->SetValueRange(0.5, 1.0);
+
+	vtkSmartPointer<vtkTransform> elevationScale = vtkSmartPointer<vtkTransform>::New();
+	elevationScale->Scale(1, 1, 2);
+
+	DemMosaic mosaic;
+	mosaic.SetLookupTable(lut);
+	mosaic.SetElevationTransform(elevationScale);
+	mosaic.SetMemoryBudget(budget);
+	int numberOfTiles = mosaic.Open(directory);
+	if (numberOfTiles == 0) {
+		std::cerr << "no DEM tiles found in " << directory << std::endl;
+		return 1;
+	}
+	std::cout << "mosaic of " << numberOfTiles << " tiles, press 'i' for paging statistics" << std::endl;
+
+	// renderer and window, the tiles are added by the mosaic before every frame
+	vtkSmartPointer<vtkRenderer> renderer = vtkSmartPointer<vtkRenderer>::New();
+	setGradientBackground(renderer);
+
+	vtkSmartPointer<vtkScalarBarActor> scalarBarActor = vtkSmartPointer<vtkScalarBarActor>::New();
+	scalarBarActor->SetLookupTable(lut);
+	scalarBarActor->SetTitle("Elevation");
+	scalarBarActor->SetNumberOfLabels(5);
+	renderer->AddActor2D(scalarBarActor);
+
+	vtkSmartPointer<vtkRenderWindow> window = vtkSmartPointer<vtkRenderWindow>::New();
+	window->AddRenderer(renderer);
+	window->SetSize(800, 800);
+
+	// looking at the center of the mosaic from the south west
+	double bounds[6];
+	mosaic.GetBounds(bounds);
+	double center[3] = { 0.5 * (bounds[0] + bounds[1]), 0.5 * (bounds[2] + bounds[3]), bounds[5] };
+	renderer->GetActiveCamera()->SetViewUp(0, 0, 1);
+	renderer->GetActiveCamera()->SetFocalPoint(center);
+	renderer->GetActiveCamera()->SetPosition(center[0] - 1, center[1] - 1, center[2] + 1);
+	renderer->ResetCamera(bounds[0], bounds[1], bounds[2], bounds[3], 2 * bounds[4], 2 * bounds[5]);
+
+	vtkSmartPointer<vtkRenderWindowInteractor> interactor = vtkSmartPointer<vtkRenderWindowInteractor>::New();
+	interactor->SetRenderWindow(window);
+
+	// slider and camera events are coalesced to one update and render per display interval
+	vtkSmartPointer<InteractionScheduler> scheduler = vtkSmartPointer<InteractionScheduler>::New();
+	scheduler->Attach(interactor, window);
+
+	// the tiles are read on a worker, the scheduler renders a frame as soon as one is loaded
+	mosaic.Attach(renderer, scheduler);
+
+	vtkSmartPointer<vtkSliderWidget> warpSlider = createSlider(interactor, "Warp Factor", 0, 10, 2, "%0.1f", 40);
+	vtkSmartPointer<WarpSliderCallback> warpCallback = vtkSmartPointer<WarpSliderCallback>::New();
+	warpCallback->elevationScale = elevationScale;
+	warpCallback->scheduler = scheduler;
+	warpSlider->AddObserver(vtkCommand::InteractionEvent, warpCallback);
+
+	vtkSmartPointer<MosaicStatisticsCallback> statisticsCallback = vtkSmartPointer<MosaicStatisticsCallback>::New();
+	statisticsCallback->mosaic = &mosaic;
+	interactor->AddObserver(vtkCommand::KeyPressEvent, statisticsCallback);
+
+	// statistics overlay, shown with 'h'
+	vtkSmartPointer<StatisticsHud> hud = vtkSmartPointer<StatisticsHud>::New();
+	hud->Attach(window, renderer, interactor);
+
+	doRenderingAndInteraction(interactor, window);
+
+	mosaic.PrintStatistics(std::cout);
+	scheduler->PrintStatistics(std::cout);
+	return 0;
+}
+
 
 int main(int argc, char * argv[])
 {
+	// declared first, so it outlives every object of the scene and can report the ones that leak
+	ObjectTracker tracker;
+	// the scalars of an attached terrain live in its mapping, which has to outlive the scene as well
+	SharedImageView sharedTerrain;
+
+	// command line options:
+	//   --tin <error>   render an adaptive TIN with the given vertical error bound instead of the dense grid
+	//   --threads <n>   number of threads for the TIN construction and the scene setup (default: all cores)
+	//   --tin-bench     print the TIN benchmark tables and exit
+	//   --mosaic <dir>  stream a mosaic of all DEM tiles in the directory
+	//   --budget <MB>   memory budget for resident mosaic tiles (default: 256 MB)
+	//   --batch <camera path> <output prefix>
+	//                   render the camera path offscreen to PNG files and exit (see batchrender.h)
+	//   --trace <file>  record a pipeline trace from the start and write it as Chrome trace JSON on exit.
+	//                   Without this option the trace is started and stopped with 'l' and written to
+	//                   assignment4-trace.json.
+	//   --track-objects report the live VTK objects of the scene with 'o' and the leaked ones on exit
+	//   --publish <name> loader mode: read the DEM once and publish its elevation grid as shared memory
+	//   --attach <name> show a published elevation grid instead of reading the DEM, follows its updates
+	double tinError = 0.0;
+	int numberOfThreads = 0;
+	bool tinBenchmark = false;
+	std::string mosaicDirectory;
+	size_t mosaicBudget = 256;
+	std::string cameraPathFile, batchPrefix;
+	std::string traceFile;
+	bool trackObjects = false;
+	std::string publishName, attachName;
+	for (int i = 1; i < argc; ++i) {
+		if (!std::strcmp(argv[i], "--tin") && i + 1 < argc)
+			tinError = std::atof(argv[++i]);
+		else if (!std::strcmp(argv[i], "--threads") && i + 1 < argc)
+			numberOfThreads = std::atoi(argv[++i]);
+		else if (!std::strcmp(argv[i], "--tin-bench"))
+			tinBenchmark = true;
+		else if (!std::strcmp(argv[i], "--mosaic") && i + 1 < argc)
+			mosaicDirectory = argv[++i];
+		else if (!std::strcmp(argv[i], "--budget") && i + 1 < argc)
+			mosaicBudget = static_cast<size_t>(std::atoi(argv[++i]));
+		else if (!std::strcmp(argv[i], "--batch") && i + 2 < argc) {
+			cameraPathFile = argv[++i];
+			batchPrefix = argv[++i];
+		}
+		else if (!std::strcmp(argv[i], "--trace") && i + 1 < argc)
+			traceFile = argv[++i];
+		else if (!std::strcmp(argv[i], "--track-objects"))
+			trackObjects = true;
+		else if (!std::strcmp(argv[i], "--publish") && i + 1 < argc)
+			publishName = argv[++i];
+		else if (!std::strcmp(argv[i], "--attach") && i + 1 < argc)
+			attachName = argv[++i];
+		else
+			std::cerr << "unknown option " << argv[i] << std::endl;
+	}
+
+	tracker.SetEnabled(trackObjects);
+
+	if (!mosaicDirectory.empty())
+		return runMosaicViewer(mosaicDirectory, mosaicBudget << 20);
+
+	std::vector<CameraKeyframe> cameraPath;
+	if (!cameraPathFile.empty() && !readCameraPath(cameraPathFile, cameraPath)) {
+		std::cerr << "could not read the camera path " << cameraPathFile << std::endl;
+		return 1;
+	}
+
 	// -- begin of basic visualization network definition --
 
+	// execution trace of all filters and renders, switched off unless requested
+	PipelineTrace trace;
+	trace.SetEnabled(!traceFile.empty());
+	if (traceFile.empty())
+		traceFile = "assignment4-trace.json";
+
+	// statistics overlay, shown with 'h'
+	vtkSmartPointer<StatisticsHud> hud = vtkSmartPointer<StatisticsHud>::New();
+
 	// 1. creating source
 	vtkSmartPointer<vtkDEMReader> source = vtkSmartPointer<vtkDEMReader>::New();
-	source->SetFileName("../data/SainteHelens.dem");
-	source->Update();
+	const char *demFileName = "../data/SainteHelens.dem";
+	source->SetFileName(demFileName);
+	trace.AddFilter(source);
+	hud->AddFilter(source, "DEM reader");
+
+	if (!publishName.empty())
+		return runImagePublisher(source, publishName, std::cout);
+
+	// the pipeline starts at the DEM reader or at an elevation grid published by a loader process
+	vtkSmartPointer<vtkAlgorithm> terrain = source;
+	std::string terrainName = "DEM reader";
+	double low, high;
+	DemHeader header;
+	if (!attachName.empty()) {
+		if (!sharedTerrain.Attach(attachName)) {
+			std::cerr << "no published elevation grid " << attachName << std::endl;
+			return 1;
+		}
+		sharedTerrain.PrintInformation(std::cout);
+		vtkSmartPointer<vtkTrivialProducer> producer = vtkSmartPointer<vtkTrivialProducer>::New();
+		producer->SetOutput(sharedTerrain.GetImage());
+		terrain = producer;
+		terrainName = "shared terrain";
+		low = sharedTerrain.GetImage()->GetScalarRange()[0];
+		high = sharedTerrain.GetImage()->GetScalarRange()[1];
+	}
+	// the elevation range comes from the DEM header, the elevation profiles are only read by the first render
+	else if (readDemHeader(demFileName, header)) {
+		low = header.elevationRange[0];
+		high = header.elevationRange[1];
+	}
+	else {
+		source->Update();
+		low = source->GetOutput()->GetScalarRange()[0];
+		high = source->GetOutput()->GetScalarRange()[1];
+	}
+
+	if (tinBenchmark)
+		return runTinBenchmarks(source, numberOfThreads);
 
 	// 2. creating filters
-	//a) warp filter
-	vtkSmartPointer<vtkWarpScalar> warpFilter = vtkSmartPointer<vtkWarpScalar>::New();
-
-	// setting a scale factor of 2 to see the elevation better
-	warpFilter->SetScaleFactor(2);
+	//a) height field, triangle strips straight from the elevation grid with the unscaled elevation as z
+	vtkSmartPointer<HeightFieldStrips> heightField = vtkSmartPointer<HeightFieldStrips>::New();
 
 	// using source as filter input
-	warpFilter->SetInputConnection(source->GetOutputPort());
+	heightField->SetInputConnection(terrain->GetOutputPort());
+	trace.AddFilter(heightField);
+	hud->AddFilter(heightField, "height field");
 
-	// warping the surface in the vertical direction
-	warpFilter->UseNormalOn();
-	warpFilter->SetNormal(0, 0, 1);
-	warpFilter->Update();
+	// the elevation is scaled by the actor transform, with a scale factor of 2 to see the elevation better
+	const double warpFactor = 2;
+	vtkSmartPointer<vtkTransform> elevationScale = vtkSmartPointer<vtkTransform>::New();
+	elevationScale->Scale(1, 1, warpFactor);
 
 	// b) contour filter
-	vtkSmartPointer<vtkContourFilter> contourFilter = vtkSmartPointer<vtkContourFilter>::New();
-
-	// using warp model as filter input
-	contourFilter->SetInputConnection(warpFilter->GetOutputPort());
-
-	// getting the scalar values from source
-	double low = source->GetOutput()->GetScalarRange()[0];
-	double high = source->GetOutput()->GetScalarRange()[1];
-
-	// Generating equally spaced contour lines, here number of contours is 15.
-	contourFilter->GenerateValues(15, low, high);
+	vtkSmartPointer<CachedContourFilter> contourFilter = vtkSmartPointer<CachedContourFilter>::New();
+
+	// contouring the unwarped elevation grid, the lines are lifted to the elevation of their level
+	contourFilter->SetInputConnection(terrain->GetOutputPort());
+	trace.AddFilter(contourFilter);
+	hud->AddFilter(contourFilter, "contours");
+
+	// Generating equally spaced contour lines, here number of contours is 15 at start.
+	// The polylines of every level are cached, so the level slider only contours new levels.
+	contourFilter->SetNumberOfLevels(15);
+	contourFilter->SetRange(low, high);
+
+	// c) optional adaptive TIN, replaces the dense height field
+	vtkSmartPointer<ParallelTerrainDecimation> tinFilter = vtkSmartPointer<ParallelTerrainDecimation>::New();
+	tinFilter->SetInputConnection(terrain->GetOutputPort());
+	tinFilter->SetAbsoluteError(tinError);
+	tinFilter->SetNumberOfThreads(numberOfThreads);
+	trace.AddFilter(tinFilter);
+	if (tinError > 0.0)
+		hud->AddFilter(tinFilter, "TIN");
+
+	// d) the terrain is read once, then the surface and the contours are built concurrently.
+	// Every branch gets its own shallow copy of the elevation grid, so only the branch of a changed filter reruns.
+	BranchExecutor setup(terrain, terrainName);
+	setup.AddBranch(contourFilter, "contours");
+	if (tinError > 0.0)
+		setup.AddBranch(tinFilter, "TIN");
+	else
+		setup.AddBranch(heightField, "height field");
+	setup.Update(&trace, numberOfThreads);
+	std::cout << "scene setup:" << std::endl;
+	setup.GetTaskGraph().PrintSummary(std::cout);
+
+	if (tinError <= 0.0)
+		std::cout << "height field: " << heightField->GetLastVertexBytes() / 1024 << " KiB vertices, "
+			<< heightField->GetLastIndexBytes() / 1024 << " KiB strip indices" << std::endl;
+	else {
+		std::cout << "TIN with error bound " << tinError << ": " << tinFilter->GetOutput()->GetNumberOfPolys()
+			<< " triangles from " << tinFilter->GetLastNumberOfTiles() << " tiles in "
+			<< tinFilter->GetLastBuildTime() * 1000.0 << " ms" << std::endl;
+	}
 
 	// creating custom color by look up table
 	vtkSmartPointer<vtkLookupTable> lut = vtkSmartPointer<vtkLookupTable>::New();
@@ -175,19 +567,23 @@ int main(int argc, char * argv[])
 	// 3.  create mappers
 
 	// a) warp mapper, show the gradient magnitudes as 2D image 
-	vtkSmartPointer<vtkDataSetMapper> warpMapper = vtkSmartPointer<vtkDataSetMapper>::New();
-
-	// connecting to the warp filter output (the pipeline is source->warpFilter->warpMapper->...)
-	warpMapper->SetInputConnection(warpFilter->GetOutputPort());
+	vtkSmartPointer<vtkPolyDataMapper> warpMapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+
+	// connecting to the height field (the pipeline is source->heightField->warpMapper->...)
+	// or to the TIN (source->tinFilter->warpMapper->...), both are scaled by the actor transform
+	if (tinError > 0.0)
+		warpMapper->SetInputConnection(tinFilter->GetOutputPort());
+	else
+		warpMapper->SetInputConnection(heightField->GetOutputPort());
 	warpMapper->ScalarVisibilityOn();
 	warpMapper->SetScalarRange(low, high);
 	warpMapper->SetLookupTable(lut);
 
 
 	// b) contour mapper, show the regions where the data has a specific value
-	vtkSmartPointer<vtkDataSetMapper> contourMapper = vtkSmartPointer<vtkDataSetMapper>::New();
+	vtkSmartPointer<vtkPolyDataMapper> contourMapper = vtkSmartPointer<vtkPolyDataMapper>::New();
 
-	// connecting to the contour filter output (the pipeline is source->contourFilter->contourMapper->...)
+	// connecting to the contour lines (the pipeline is source->contourFilter->contourMapper->...)
 	contourMapper->SetInputConnection(contourFilter->GetOutputPort());
 
 	// avoiding z-buffer fighting with small polygon shift
@@ -205,10 +601,71 @@ int main(int argc, char * argv[])
 	mappers.push_back(warpMapper);
 	mappers.push_back(contourMapper);
 
-	vtkSmartPointer<vtkRenderWindow> finalWindow = createRenderWindowFromMultipleMappers(mappers);
-
-	// 5. successively showing each window and allow user interaction (until it is closed)
-	doRenderingAndInteraction(finalWindow);
-
+	vtkSmartPointer<vtkRenderWindow> finalWindow = createRenderWindowFromMultipleMappers(mappers, elevationScale);
+	trace.AddRenderWindow(finalWindow);
+	tracker.TrackScene(finalWindow);
+	tracker.Track(tinFilter, "TIN");
+	tracker.Track(terrain, terrainName);
+
+	// headless batch mode, the warp factor of every keyframe goes into the shared elevation scale
+	if (!cameraPath.empty()) {
+		renderCameraPath(finalWindow, cameraPath, batchPrefix, [&](const CameraKeyframe& keyframe) {
+			elevationScale->Identity();
+			elevationScale->Scale(1, 1, keyframe.warpFactor);
+		}, std::cout);
+		writeTrace(trace, traceFile);
+		return 0;
+	}
+
+	// 5. sliders for the number of contour levels and the warp factor
+	vtkSmartPointer<vtkRenderWindowInteractor> interactor = vtkSmartPointer<vtkRenderWindowInteractor>::New();
+	interactor->SetRenderWindow(finalWindow);
+
+	// slider and camera events are coalesced to one update and render per display interval
+	vtkSmartPointer<InteractionScheduler> scheduler = vtkSmartPointer<InteractionScheduler>::New();
+	scheduler->Attach(interactor, finalWindow);
+
+	vtkSmartPointer<vtkSliderWidget> levelSlider = createSlider(interactor, "Contour Levels", 2, 60, 15, "%0.0f", 100);
+	vtkSmartPointer<ContourLevelSliderCallback> levelCallback = vtkSmartPointer<ContourLevelSliderCallback>::New();
+	levelCallback->contourFilter = contourFilter;
+	levelCallback->scheduler = scheduler;
+	levelSlider->AddObserver(vtkCommand::InteractionEvent, levelCallback);
+
+	vtkSmartPointer<vtkSliderWidget> warpSlider = createSlider(interactor, "Warp Factor", 0, 10, warpFactor, "%0.1f", 40);
+	vtkSmartPointer<WarpSliderCallback> warpCallback = vtkSmartPointer<WarpSliderCallback>::New();
+	warpCallback->elevationScale = elevationScale;
+	warpCallback->scheduler = scheduler;
+	warpSlider->AddObserver(vtkCommand::InteractionEvent, warpCallback);
+
+	// 'l' starts and stops the trace
+	vtkSmartPointer<TraceToggleCallback> traceCallback = vtkSmartPointer<TraceToggleCallback>::New();
+	traceCallback->trace = &trace;
+	interactor->AddObserver(vtkCommand::KeyPressEvent, traceCallback);
+
+	hud->Attach(finalWindow, finalWindow->GetRenderers()->GetFirstRenderer(), interactor);
+
+	// an attached terrain follows its loader, the branches run again on the republished elevation grid
+	vtkSmartPointer<SharedImageWatcher> terrainWatcher = vtkSmartPointer<SharedImageWatcher>::New();
+	if (!attachName.empty()) {
+		terrainWatcher->view = &sharedTerrain;
+		terrainWatcher->update = [&](SharedImageView::Change change) {
+			setup.Update(&trace, numberOfThreads);
+			interactor->Render();
+		};
+		terrainWatcher->Attach(interactor);
+	}
+
+	// 'o' prints the live objects
+	vtkSmartPointer<ObjectReportCallback> objectCallback = vtkSmartPointer<ObjectReportCallback>::New();
+	objectCallback->tracker = &tracker;
+	objectCallback->window = finalWindow;
+	interactor->AddObserver(vtkCommand::KeyPressEvent, objectCallback);
+
+	// 6. showing the window and allow user interaction (until it is closed)
+	doRenderingAndInteraction(interactor, finalWindow);
+	scheduler->PrintStatistics(std::cout);
+
+	tracker.TrackScene(finalWindow);
+	writeTrace(trace, traceFile);
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,101 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+// Micro-benchmarks of the stages of the height field pipeline: DEM read, warp, contour and LUT mapping,
+// on SainteHelens.dem and on synthetic terrains scaled up from its size.
+//
+// usage: bench [--repetitions n] [--warmup n] [--scales 2,4] [--output results.csv]
+//              [--baseline baseline.csv] [--threshold 0.1]
+//
+
+#include "microbench.h"
+#include "heightfield.h"
+#include "contourcache.h"
+#include "syntheticdata.h"
+
+#include <vtkSmartPointer.h>
+#include <vtkDEMReader.h>
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+#include <vtkDataArray.h>
+#include <vtkLookupTable.h>
+#include <vtkUnsignedCharArray.h>
+
+#include <iostream>
+#include <sstream>
+#include <cmath>
+#include <algorithm>
+
+// warp, contour and LUT mapping of one elevation grid
+static void benchmarkTerrain(MicroBenchmark& bench, vtkImageData *terrain, const std::string& input)
+{
+	int dims[3];
+	terrain->GetDimensions(dims);
+	const double samples = static_cast<double>(dims[0]) * dims[1];
+	double range[2];
+	terrain->GetScalarRange(range);
+
+	// the warp factor is an actor transform, the stage that depends on the data is the height field itself
+	vtkSmartPointer<HeightFieldStrips> heightField = vtkSmartPointer<HeightFieldStrips>::New();
+	heightField->SetInputData(terrain);
+	bench.Run("warp (height field)", input, samples,
+		[&]() { heightField->Update(); },
+		[&]() { heightField->Modified(); });
+
+	// without the level cache, every repetition contours all 15 levels
+	vtkSmartPointer<CachedContourFilter> contourFilter = vtkSmartPointer<CachedContourFilter>::New();
+	contourFilter->SetInputData(terrain);
+	contourFilter->SetNumberOfLevels(15);
+	contourFilter->SetRange(range);
+	bench.Run("contour 15 levels", input, samples,
+		[&]() { contourFilter->Update(); },
+		[&]() { contourFilter->ClearCache(); contourFilter->Modified(); });
+
+	vtkSmartPointer<vtkLookupTable> lut = vtkSmartPointer<vtkLookupTable>::New();
+	lut->SetHueRange(0, 0.2);
+	lut->SetSaturationRange(1.0, 0.5);
+	lut->SetValueRange(0.5, 1.0);
+	lut->SetTableRange(range);
+	lut->Build();
+	vtkDataArray *elevation = terrain->GetPointData()->GetScalars();
+	bench.Run("LUT mapping", input, samples, [&]() {
+		vtkUnsignedCharArray *colors = lut->MapScalars(elevation, VTK_COLOR_MODE_MAP_SCALARS, -1);
+		colors->Delete();
+	});
+}
+
+int main(int argc, char * argv[])
+{
+	BenchmarkOptions options;
+	options.scales.push_back(2);
+	options.scales.push_back(4);
+	if (!parseBenchmarkOptions(argc, argv, options))
+		return 1;
+	MicroBenchmark bench(options);
+
+	// the bundled DEM, every repetition parses the file again
+	vtkSmartPointer<vtkDEMReader> reader = vtkSmartPointer<vtkDEMReader>::New();
+	reader->SetFileName("../data/SainteHelens.dem");
+	reader->Update();
+	int dims[3];
+	reader->GetOutput()->GetDimensions(dims);
+	if (dims[0] <= 1 || dims[1] <= 1) {
+		std::cerr << "could not read ../data/SainteHelens.dem" << std::endl;
+		return 1;
+	}
+	bench.Run("DEM read", "SainteHelens.dem", static_cast<double>(dims[0]) * dims[1],
+		[&]() { reader->Update(); },
+		[&]() { reader->Modified(); });
+	benchmarkTerrain(bench, reader->GetOutput(), "SainteHelens.dem");
+
+	// procedural terrains with the scaled number of samples per side, a scale of 4 has 16 times the samples
+	for (size_t s = 0; s < options.scales.size(); ++s) {
+		int size = static_cast<int>(std::lround(options.scales[s] * std::max(dims[0], dims[1])));
+		std::ostringstream input;
+		input << "synthetic " << size << "x" << size;
+		vtkSmartPointer<vtkImageData> terrain = createSyntheticTerrain(size, 1);
+		benchmarkTerrain(bench, terrain, input.str());
+	}
+
+	return bench.Finish(std::cout);
+}
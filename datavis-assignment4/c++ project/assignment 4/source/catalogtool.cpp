@@ -0,0 +1,78 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+// Command line tool to index a directory of DEMs and to query the index.
+//
+// usage: demcatalog <directory> [--rebuild] [--bbox xmin xmax ymin ymax] [--elevation min max]
+//
+
+#include "demcatalog.h"
+
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cstdlib>
+#include <chrono>
+
+int main(int argc, char * argv[])
+{
+	if (argc < 2) {
+		std::cerr << "usage: " << argv[0] << " <directory> [--rebuild] [--bbox xmin xmax ymin ymax] [--elevation min max]" << std::endl;
+		return 1;
+	}
+
+	bool rebuild = false;
+	double box[4] = { -DBL_MAX, DBL_MAX, -DBL_MAX, DBL_MAX };
+	double elevation[2] = { -DBL_MAX, DBL_MAX };
+	for (int i = 2; i < argc; ++i) {
+		if (!std::strcmp(argv[i], "--rebuild"))
+			rebuild = true;
+		else if (!std::strcmp(argv[i], "--bbox") && i + 4 < argc) {
+			for (int k = 0; k < 4; ++k)
+				box[k] = std::atof(argv[++i]);
+		}
+		else if (!std::strcmp(argv[i], "--elevation") && i + 2 < argc) {
+			elevation[0] = std::atof(argv[++i]);
+			elevation[1] = std::atof(argv[++i]);
+		}
+		else {
+			std::cerr << "unknown option " << argv[i] << std::endl;
+			return 1;
+		}
+	}
+
+	// index (or reload the index of) the directory
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	DemCatalog catalog;
+	int count = catalog.Open(argv[1], !rebuild);
+	double openTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	if (!catalog.Save())
+		std::cerr << "could not write the catalog file in " << argv[1] << std::endl;
+
+	std::cout << std::fixed << std::setprecision(3)
+		<< count << " DEMs indexed in " << 1000.0 * openTime << " ms ("
+		<< catalog.GetParsedEntries() << " headers parsed, " << catalog.GetCachedEntries() << " from cache)" << std::endl;
+	if (count == 0)
+		return 0;
+
+	double bounds[4], range[2];
+	catalog.GetBounds(bounds);
+	catalog.GetElevationRange(range);
+	std::cout << std::setprecision(1) << "extent x [" << bounds[0] << ", " << bounds[1] << "], y [" << bounds[2] << ", " << bounds[3]
+		<< "], elevation [" << range[0] << ", " << range[1] << "]" << std::endl;
+
+	// answer the query from the index
+	start = std::chrono::steady_clock::now();
+	std::vector<int> hits = catalog.Query(box[0], box[1], box[2], box[3], elevation[0], elevation[1]);
+	double queryTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::cout << std::setprecision(3) << hits.size() << " DEMs match the query (" << 1e6 * queryTime << " us)" << std::endl;
+
+	std::cout << std::setprecision(1);
+	for (size_t i = 0; i < hits.size(); ++i) {
+		const DemHeader& header = catalog.GetEntries()[hits[i]];
+		std::cout << header.fileName << ": x [" << header.bounds[0] << ", " << header.bounds[1] << "], y ["
+			<< header.bounds[2] << ", " << header.bounds[3] << "], elevation [" << header.elevationRange[0] << ", "
+			<< header.elevationRange[1] << "], spacing " << header.spacing[0] << " x " << header.spacing[1] << std::endl;
+	}
+	return 0;
+}
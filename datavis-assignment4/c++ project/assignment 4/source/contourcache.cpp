@@ -0,0 +1,179 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+
+#include "contourcache.h"
+
+#include <vtkObjectFactory.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkDataSet.h>
+#include <vtkPointData.h>
+#include <vtkDataArray.h>
+#include <vtkPoints.h>
+#include <vtkCellArray.h>
+
+#include <cmath>
+#include <algorithm>
+
+vtkStandardNewMacro(CachedContourFilter);
+
+const int CachedContourFilter::MaximumNumberOfLevels;
+
+CachedContourFilter::CachedContourFilter()
+	: NumberOfLevels(15), MaximumCachedLevels(256), LastCachedLevels(0), LastExtractedLevels(0), cachedInputTime(0)
+{
+	// empty range: use the scalar range of the input
+	this->Range[0] = 1.0;
+	this->Range[1] = 0.0;
+
+	contourFilter = vtkSmartPointer<vtkContourFilter>::New();
+	contourFilter->ComputeScalarsOn();
+	contourFilter->ComputeNormalsOff();
+	appendFilter = vtkSmartPointer<vtkAppendPolyData>::New();
+}
+
+void CachedContourFilter::ClearCache()
+{
+	levels.clear();
+	this->Modified();
+}
+
+int CachedContourFilter::FillInputPortInformation(int, vtkInformation *info)
+{
+	info->Set(vtkAlgorithm::INPUT_REQUIRED_DATA_TYPE(), "vtkDataSet");
+	return 1;
+}
+
+CachedContourFilter::LevelKey CachedContourFilter::levelKey(double value)
+{
+	return static_cast<LevelKey>(std::floor(value * 1000.0 + 0.5));
+}
+
+void CachedContourFilter::extractLevels(vtkDataSet *input, const std::vector<double>& values)
+{
+	// contour all missing levels in a single pass over the input
+	vtkSmartPointer<vtkDataSet> inputCopy;
+	inputCopy.TakeReference(input->NewInstance());
+	inputCopy->ShallowCopy(input);
+	contourFilter->SetInputData(inputCopy);
+	contourFilter->SetNumberOfContours(static_cast<int>(values.size()));
+	for (size_t i = 0; i < values.size(); ++i)
+		contourFilter->SetValue(static_cast<int>(i), values[i]);
+	contourFilter->Update();
+
+	vtkPolyData *contours = contourFilter->GetOutput();
+	vtkDataArray *scalars = contours->GetPointData()->GetScalars();
+	vtkIdType numberOfPoints = contours->GetNumberOfPoints();
+
+	// one polyline set per level
+	std::vector<vtkSmartPointer<vtkPoints>> levelPoints(values.size());
+	std::vector<vtkSmartPointer<vtkCellArray>> levelLines(values.size());
+	for (size_t i = 0; i < values.size(); ++i) {
+		levelPoints[i] = vtkSmartPointer<vtkPoints>::New();
+		levelLines[i] = vtkSmartPointer<vtkCellArray>::New();
+	}
+
+	// assign every point to the level it lies on and lift it to the elevation of that level
+	std::vector<int> pointLevel(numberOfPoints, 0);
+	std::vector<vtkIdType> pointId(numberOfPoints, 0);
+	for (vtkIdType p = 0; p < numberOfPoints; ++p) {
+		double value = scalars ? scalars->GetTuple1(p) : values[0];
+		size_t nearest = 0;
+		for (size_t i = 1; i < values.size(); ++i)
+			if (std::fabs(values[i] - value) < std::fabs(values[nearest] - value))
+				nearest = i;
+
+		double x[3];
+		contours->GetPoint(p, x);
+		pointLevel[p] = static_cast<int>(nearest);
+		pointId[p] = levelPoints[nearest]->InsertNextPoint(x[0], x[1], values[nearest]);
+	}
+
+	// all points of a line belong to the same level
+	vtkCellArray *lines = contours->GetLines();
+	vtkIdType npts;
+	vtkIdType *pts;
+	for (lines->InitTraversal(); lines->GetNextCell(npts, pts);) {
+		if (npts == 0)
+			continue;
+		vtkCellArray *target = levelLines[pointLevel[pts[0]]];
+		target->InsertNextCell(npts);
+		for (vtkIdType i = 0; i < npts; ++i)
+			target->InsertCellPoint(pointId[pts[i]]);
+	}
+
+	for (size_t i = 0; i < values.size(); ++i) {
+		vtkSmartPointer<vtkPolyData> level = vtkSmartPointer<vtkPolyData>::New();
+		level->SetPoints(levelPoints[i]);
+		level->SetLines(levelLines[i]);
+		levels[levelKey(values[i])] = level;
+	}
+
+	// do not keep the contour output of the last pass alive
+	contourFilter->SetInputData(nullptr);
+	contours->Initialize();
+}
+
+void CachedContourFilter::trimCache(const std::vector<LevelKey>& used)
+{
+	std::map<LevelKey, vtkSmartPointer<vtkPolyData>>::iterator it = levels.begin();
+	while (levels.size() > static_cast<size_t>(this->MaximumCachedLevels) && it != levels.end()) {
+		if (std::find(used.begin(), used.end(), it->first) == used.end())
+			it = levels.erase(it);
+		else
+			++it;
+	}
+}
+
+int CachedContourFilter::RequestData(vtkInformation *, vtkInformationVector **inputVector, vtkInformationVector *outputVector)
+{
+	vtkDataSet *input = vtkDataSet::GetData(inputVector[0]);
+	vtkPolyData *output = vtkPolyData::GetData(outputVector);
+	if (!input || !output)
+		return 0;
+
+	// cached lines are only valid for the data they were extracted from
+	if (input->GetMTime() != cachedInputTime) {
+		levels.clear();
+		cachedInputTime = input->GetMTime();
+	}
+
+	double range[2] = { this->Range[0], this->Range[1] };
+	if (range[0] > range[1])
+		input->GetScalarRange(range);
+
+	// equal intervals lifted by half the step of the largest count, so no level lies on the minimum (a level there
+	// only outlines flat ground). The lift does not depend on the count, so the levels still nest when the count is
+	// multiplied and the cache serves all levels of a divisor of the count
+	std::vector<double> values(this->NumberOfLevels);
+	std::vector<LevelKey> keys(this->NumberOfLevels);
+	const double step = (range[1] - range[0]) / this->NumberOfLevels;
+	const double lift = (range[1] - range[0]) / (2.0 * MaximumNumberOfLevels);
+	for (int i = 0; i < this->NumberOfLevels; ++i) {
+		values[i] = range[0] + lift + i * step;
+		keys[i] = levelKey(values[i]);
+	}
+
+	std::vector<double> missing;
+	for (int i = 0; i < this->NumberOfLevels; ++i)
+		if (levels.find(keys[i]) == levels.end())
+			missing.push_back(values[i]);
+
+	LastExtractedLevels = static_cast<int>(missing.size());
+	LastCachedLevels = this->NumberOfLevels - LastExtractedLevels;
+
+	if (!missing.empty())
+		extractLevels(input, missing);
+
+	// put the requested levels together
+	appendFilter->RemoveAllInputs();
+	for (int i = 0; i < this->NumberOfLevels; ++i)
+		appendFilter->AddInputData(levels[keys[i]]);
+	appendFilter->Update();
+	output->ShallowCopy(appendFilter->GetOutput());
+
+	appendFilter->RemoveAllInputs();
+	trimCache(keys);
+	return 1;
+}
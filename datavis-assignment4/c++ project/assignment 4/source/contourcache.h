@@ -0,0 +1,82 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+// Contour filter for height fields that keeps the polylines of every level it has extracted.
+// Changing the number of levels only contours the levels that are not cached yet.
+//
+
+#pragma once
+
+#include <vtkPolyDataAlgorithm.h>
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+#include <vtkContourFilter.h>
+#include <vtkAppendPolyData.h>
+
+#include <map>
+
+/* Generates equally spaced contour lines of a 2D height field. The n levels are n equal intervals of the range,
+   lifted by half the step of the largest count so that no level lies on the minimum. The lift is the same for
+   every count, so the levels of a count are also levels of all its multiples: going from 15 to 30 levels only
+   contours the 15 new ones, and 30 back to 15 or 10 contours none. The z coordinate of every output point is
+   the elevation of its level, i.e. the lines are "warped" with a scale factor of 1. A different warp factor is
+   a pure z scale of the output and never needs re-contouring, see vtkTransformPolyDataFilter. */
+class CachedContourFilter : public vtkPolyDataAlgorithm {
+public:
+	static CachedContourFilter *New();
+	vtkTypeMacro(CachedContourFilter, vtkPolyDataAlgorithm);
+
+	/* Number of equally spaced levels in the range, with a spacing of range / n. */
+	static const int MaximumNumberOfLevels = 1000;
+	vtkSetClampMacro(NumberOfLevels, int, 1, MaximumNumberOfLevels);
+	vtkGetMacro(NumberOfLevels, int);
+
+	/* Scalar range of the levels. If the range is empty (min > max), the scalar range of the input is used. */
+	vtkSetVector2Macro(Range, double);
+	vtkGetVector2Macro(Range, double);
+
+	/* Upper bound for the number of cached levels. Levels not used by the last execution are dropped first. */
+	vtkSetClampMacro(MaximumCachedLevels, int, 1, 100000);
+	vtkGetMacro(MaximumCachedLevels, int);
+
+	/* Statistics of the last execution: number of levels taken from the cache and number of levels extracted. */
+	vtkGetMacro(LastCachedLevels, int);
+	vtkGetMacro(LastExtractedLevels, int);
+
+	/* Drops all cached polylines. */
+	void ClearCache();
+
+protected:
+	CachedContourFilter();
+	~CachedContourFilter() override {}
+
+	int FillInputPortInformation(int port, vtkInformation *info) override;
+	int RequestData(vtkInformation *request, vtkInformationVector **inputVector, vtkInformationVector *outputVector) override;
+
+private:
+	CachedContourFilter(const CachedContourFilter&) = delete;
+	void operator=(const CachedContourFilter&) = delete;
+
+	// levels are identified by their value rounded to millimeters, so that e.g. the levels of a
+	// 15 level set are found again in the 30 level set over the same range
+	typedef long long LevelKey;
+	static LevelKey levelKey(double value);
+
+	// contours the given levels in one pass and stores every level as separate polyline set
+	void extractLevels(vtkDataSet *input, const std::vector<double>& values);
+
+	// drops unused levels until the cache fits into MaximumCachedLevels
+	void trimCache(const std::vector<LevelKey>& used);
+
+	int NumberOfLevels;
+	double Range[2];
+	int MaximumCachedLevels;
+	int LastCachedLevels;
+	int LastExtractedLevels;
+
+	std::map<LevelKey, vtkSmartPointer<vtkPolyData>> levels;
+	vtkMTimeType cachedInputTime;
+
+	vtkSmartPointer<vtkContourFilter> contourFilter;
+	vtkSmartPointer<vtkAppendPolyData> appendFilter;
+};
@@ -0,0 +1,326 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+
+#include "demcatalog.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <cctype>
+
+static const char *catalogFileName = "dem.catalog";
+static const char *catalogVersion = "# DEM catalog 1";
+
+// ----- A-record parsing -----
+
+// the A-record is a fixed-width Fortran record, reals are written with D exponents (0.682D+03)
+static double realField(const char *record, int offset, int width)
+{
+	std::string field(record + offset, width);
+	std::replace(field.begin(), field.end(), 'D', 'E');
+	std::replace(field.begin(), field.end(), 'd', 'e');
+	return std::strtod(field.c_str(), nullptr);
+}
+
+static int integerField(const char *record, int offset, int width)
+{
+	std::string field(record + offset, width);
+	return std::atoi(field.c_str());
+}
+
+static bool fileStatus(const std::string& fileName, long long& size, long long& modificationTime)
+{
+	struct stat status;
+	if (stat(fileName.c_str(), &status) != 0)
+		return false;
+	size = static_cast<long long>(status.st_size);
+	modificationTime = static_cast<long long>(status.st_mtime);
+	return true;
+}
+
+bool readDemHeader(const std::string& fileName, DemHeader& header)
+{
+	std::ifstream file(fileName.c_str(), std::ios::binary);
+	char record[1024];
+	if (!file.read(record, sizeof(record)))
+		return false;
+
+	header.fileName = fileName;
+	if (!fileStatus(fileName, header.fileSize, header.modificationTime))
+		return false;
+
+	std::string label(record, 144);
+	size_t end = label.find_last_not_of(' ');
+	header.label = end == std::string::npos ? std::string() : label.substr(0, end + 1);
+
+	header.groundSystem = integerField(record, 156, 6);
+	header.groundZone = integerField(record, 162, 6);
+	header.planeUnits = integerField(record, 528, 6);
+	header.elevationUnits = integerField(record, 534, 6);
+
+	// four corners (SW, NW, NE, SE), the quadrangle is not axis aligned in UTM
+	header.bounds[0] = header.bounds[2] = DBL_MAX;
+	header.bounds[1] = header.bounds[3] = -DBL_MAX;
+	for (int corner = 0; corner < 4; ++corner) {
+		double x = realField(record, 546 + 48 * corner, 24);
+		double y = realField(record, 570 + 48 * corner, 24);
+		header.bounds[0] = std::min(header.bounds[0], x);
+		header.bounds[1] = std::max(header.bounds[1], x);
+		header.bounds[2] = std::min(header.bounds[2], y);
+		header.bounds[3] = std::max(header.bounds[3], y);
+	}
+
+	header.elevationRange[0] = realField(record, 738, 24);
+	header.elevationRange[1] = realField(record, 762, 24);
+	header.spacing[0] = realField(record, 816, 12);
+	header.spacing[1] = realField(record, 828, 12);
+	header.spacing[2] = realField(record, 840, 12);
+	header.columns = integerField(record, 858, 6);
+
+	// a DEM always has a positive resolution and a four sided polygon
+	return integerField(record, 540, 6) == 4 && header.spacing[0] > 0 && header.spacing[1] > 0
+		&& header.elevationRange[0] <= header.elevationRange[1];
+}
+
+// ----- directory listing -----
+
+static bool hasDemExtension(const std::string& fileName)
+{
+	if (fileName.size() < 4)
+		return false;
+	std::string extension = fileName.substr(fileName.size() - 4);
+	std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+	return extension == ".dem";
+}
+
+static std::vector<std::string> listDemFiles(const std::string& directory)
+{
+	std::vector<std::string> names;
+#ifdef _WIN32
+	WIN32_FIND_DATAA data;
+	HANDLE handle = FindFirstFileA((directory + "\\*").c_str(), &data);
+	if (handle != INVALID_HANDLE_VALUE) {
+		do {
+			if (!(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) && hasDemExtension(data.cFileName))
+				names.push_back(data.cFileName);
+		} while (FindNextFileA(handle, &data));
+		FindClose(handle);
+	}
+#else
+	DIR *dir = opendir(directory.c_str());
+	if (dir) {
+		for (struct dirent *entry = readdir(dir); entry; entry = readdir(dir))
+			if (hasDemExtension(entry->d_name))
+				names.push_back(entry->d_name);
+		closedir(dir);
+	}
+#endif
+	// directory order is arbitrary, keep the catalog stable
+	std::sort(names.begin(), names.end());
+	return names;
+}
+
+// ----- catalog -----
+
+DemCatalog::DemCatalog()
+	: indexCellSize(1.0), cachedEntries(0), parsedEntries(0)
+{
+	bounds[0] = bounds[2] = 0.0;
+	bounds[1] = bounds[3] = -1.0;
+	elevationRange[0] = 0.0;
+	elevationRange[1] = -1.0;
+	indexOrigin[0] = indexOrigin[1] = 0.0;
+	indexDimensions[0] = indexDimensions[1] = 0;
+}
+
+bool DemCatalog::loadCache(std::vector<DemHeader>& cached) const
+{
+	std::ifstream file((directory + "/" + catalogFileName).c_str());
+	std::string line;
+	if (!std::getline(file, line) || line != catalogVersion)
+		return false;
+
+	while (std::getline(file, line)) {
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		// numbers first, then the tab separated file name and map label
+		size_t tab = line.find('\t');
+		if (tab == std::string::npos)
+			continue;
+		std::istringstream numbers(line.substr(0, tab));
+		DemHeader header;
+		numbers >> header.fileSize >> header.modificationTime
+			>> header.bounds[0] >> header.bounds[1] >> header.bounds[2] >> header.bounds[3]
+			>> header.elevationRange[0] >> header.elevationRange[1]
+			>> header.spacing[0] >> header.spacing[1] >> header.spacing[2]
+			>> header.columns >> header.groundSystem >> header.groundZone >> header.planeUnits >> header.elevationUnits;
+		if (!numbers)
+			continue;
+
+		std::string names = line.substr(tab + 1);
+		size_t labelTab = names.find('\t');
+		header.fileName = directory + "/" + names.substr(0, labelTab);
+		header.label = labelTab == std::string::npos ? std::string() : names.substr(labelTab + 1);
+		cached.push_back(header);
+	}
+	return true;
+}
+
+int DemCatalog::Open(const std::string& path, bool useCache)
+{
+	directory = path;
+	entries.clear();
+	cachedEntries = parsedEntries = 0;
+
+	std::vector<DemHeader> cached;
+	if (useCache)
+		loadCache(cached);
+
+	std::vector<std::string> names = listDemFiles(directory);
+	for (size_t i = 0; i < names.size(); ++i) {
+		std::string fileName = directory + "/" + names[i];
+
+		// reuse the cached header if the file did not change
+		long long size = 0, modificationTime = 0;
+		fileStatus(fileName, size, modificationTime);
+		bool found = false;
+		for (size_t c = 0; c < cached.size() && !found; ++c) {
+			if (cached[c].fileName == fileName && cached[c].fileSize == size && cached[c].modificationTime == modificationTime) {
+				entries.push_back(cached[c]);
+				++cachedEntries;
+				found = true;
+			}
+		}
+		if (found)
+			continue;
+
+		DemHeader header;
+		if (readDemHeader(fileName, header)) {
+			entries.push_back(header);
+			++parsedEntries;
+		}
+	}
+
+	buildIndex();
+	return static_cast<int>(entries.size());
+}
+
+bool DemCatalog::Save() const
+{
+	std::ofstream file((directory + "/" + catalogFileName).c_str());
+	if (!file)
+		return false;
+
+	file << catalogVersion << std::endl;
+	file << "# size mtime xmin xmax ymin ymax zmin zmax dx dy dz columns system zone planeUnits elevationUnits\tfile\tlabel" << std::endl;
+	file << std::setprecision(17);
+	for (size_t i = 0; i < entries.size(); ++i) {
+		const DemHeader& header = entries[i];
+		std::string name = header.fileName.substr(directory.size() + 1);
+		file << header.fileSize << " " << header.modificationTime << " "
+			<< header.bounds[0] << " " << header.bounds[1] << " " << header.bounds[2] << " " << header.bounds[3] << " "
+			<< header.elevationRange[0] << " " << header.elevationRange[1] << " "
+			<< header.spacing[0] << " " << header.spacing[1] << " " << header.spacing[2] << " "
+			<< header.columns << " " << header.groundSystem << " " << header.groundZone << " "
+			<< header.planeUnits << " " << header.elevationUnits << "\t" << name << "\t" << header.label << std::endl;
+	}
+	return static_cast<bool>(file);
+}
+
+void DemCatalog::buildIndex()
+{
+	indexCells.clear();
+	indexDimensions[0] = indexDimensions[1] = 0;
+	if (entries.empty())
+		return;
+
+	bounds[0] = bounds[2] = elevationRange[0] = DBL_MAX;
+	bounds[1] = bounds[3] = elevationRange[1] = -DBL_MAX;
+	double entrySize = 0.0;
+	for (size_t i = 0; i < entries.size(); ++i) {
+		const DemHeader& header = entries[i];
+		bounds[0] = std::min(bounds[0], header.bounds[0]);
+		bounds[1] = std::max(bounds[1], header.bounds[1]);
+		bounds[2] = std::min(bounds[2], header.bounds[2]);
+		bounds[3] = std::max(bounds[3], header.bounds[3]);
+		elevationRange[0] = std::min(elevationRange[0], header.elevationRange[0]);
+		elevationRange[1] = std::max(elevationRange[1], header.elevationRange[1]);
+		entrySize = std::max(entrySize, std::max(header.bounds[1] - header.bounds[0], header.bounds[3] - header.bounds[2]));
+	}
+
+	// cells of the size of the largest DEM, so every DEM overlaps at most 4 cells
+	indexCellSize = std::max(entrySize, 1.0);
+	indexOrigin[0] = bounds[0];
+	indexOrigin[1] = bounds[2];
+	indexDimensions[0] = static_cast<int>((bounds[1] - bounds[0]) / indexCellSize) + 1;
+	indexDimensions[1] = static_cast<int>((bounds[3] - bounds[2]) / indexCellSize) + 1;
+	indexCells.assign(static_cast<size_t>(indexDimensions[0]) * indexDimensions[1], std::vector<int>());
+	for (size_t i = 0; i < entries.size(); ++i) {
+		int i0 = static_cast<int>((entries[i].bounds[0] - indexOrigin[0]) / indexCellSize);
+		int i1 = static_cast<int>((entries[i].bounds[1] - indexOrigin[0]) / indexCellSize);
+		int j0 = static_cast<int>((entries[i].bounds[2] - indexOrigin[1]) / indexCellSize);
+		int j1 = static_cast<int>((entries[i].bounds[3] - indexOrigin[1]) / indexCellSize);
+		for (int j = j0; j <= j1; ++j)
+			for (int k = i0; k <= i1; ++k)
+				indexCells[static_cast<size_t>(j) * indexDimensions[0] + k].push_back(static_cast<int>(i));
+	}
+}
+
+void DemCatalog::GetBounds(double result[4]) const
+{
+	for (int i = 0; i < 4; ++i)
+		result[i] = bounds[i];
+}
+
+void DemCatalog::GetElevationRange(double range[2]) const
+{
+	range[0] = elevationRange[0];
+	range[1] = elevationRange[1];
+}
+
+int DemCatalog::indexCell(double coordinate, int axis) const
+{
+	double cell = std::floor((coordinate - indexOrigin[axis]) / indexCellSize);
+	return static_cast<int>(std::min(std::max(cell, 0.0), static_cast<double>(indexDimensions[axis] - 1)));
+}
+
+std::vector<int> DemCatalog::Query(double xmin, double xmax, double ymin, double ymax,
+	double minimumElevation, double maximumElevation) const
+{
+	std::vector<int> result;
+	if (indexCells.empty())
+		return result;
+
+	// clamping before the conversion, the box may be unbounded (+-DBL_MAX)
+	int i0 = indexCell(xmin, 0), i1 = indexCell(xmax, 0);
+	int j0 = indexCell(ymin, 1), j1 = indexCell(ymax, 1);
+	for (int j = j0; j <= j1; ++j)
+		for (int i = i0; i <= i1; ++i) {
+			const std::vector<int>& cell = indexCells[static_cast<size_t>(j) * indexDimensions[0] + i];
+			for (size_t k = 0; k < cell.size(); ++k) {
+				const DemHeader& header = entries[cell[k]];
+				if (header.bounds[1] >= xmin && header.bounds[0] <= xmax && header.bounds[3] >= ymin && header.bounds[2] <= ymax
+					&& header.elevationRange[1] >= minimumElevation && header.elevationRange[0] <= maximumElevation)
+					result.push_back(cell[k]);
+			}
+		}
+
+	// a DEM may be listed in several cells
+	std::sort(result.begin(), result.end());
+	result.erase(std::unique(result.begin(), result.end()), result.end());
+	return result;
+}
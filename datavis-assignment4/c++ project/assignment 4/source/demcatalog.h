@@ -0,0 +1,81 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+// Header-only index of USGS DEM files. Everything needed for scene setup (extent, spacing, elevation range)
+// is stored in the 1024 byte A-record at the start of a DEM, so no elevation profile is ever read.
+//
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cfloat>
+
+/* Contents of the A-record of a DEM that matter for indexing and scene setup. */
+struct DemHeader {
+	std::string fileName;
+	std::string label;            // map name, first line of the A-record
+	long long fileSize;
+	long long modificationTime;
+
+	double bounds[4];             // xmin, xmax, ymin, ymax of the corner coordinates, in ground units
+	double elevationRange[2];     // minimum and maximum elevation, in elevation units
+	double spacing[3];            // spatial resolution in x, y and z
+	int columns;                  // number of profiles
+	int groundSystem;             // 0 geographic, 1 UTM, 2 state plane
+	int groundZone;
+	int planeUnits;               // 0 radians, 1 feet, 2 meters, 3 arc-seconds
+	int elevationUnits;           // 1 feet, 2 meters
+};
+
+/* Parses the A-record of a DEM file. Returns false if the file cannot be read or is not a DEM. */
+bool readDemHeader(const std::string& fileName, DemHeader& header);
+
+/* Index of all DEMs in a directory, answering extent and elevation queries from the headers.
+   The index is cached in the file "dem.catalog" in the indexed directory. A cached entry is reused as long as
+   size and modification time of its DEM are unchanged, so reopening a catalog does not touch the DEMs at all. */
+class DemCatalog {
+public:
+	DemCatalog();
+
+	/* Indexes all *.dem files in the directory. Returns the number of indexed DEMs. */
+	int Open(const std::string& directory, bool useCache = true);
+
+	/* Writes the index to "dem.catalog" in the indexed directory. */
+	bool Save() const;
+
+	const std::vector<DemHeader>& GetEntries() const { return entries; }
+	const std::string& GetDirectory() const { return directory; }
+
+	/* Union of the extents and of the elevation ranges of all entries. */
+	void GetBounds(double bounds[4]) const;
+	void GetElevationRange(double range[2]) const;
+
+	/* Indices of the entries whose extent intersects the box and whose elevation range intersects
+	   [minimumElevation, maximumElevation]. */
+	std::vector<int> Query(double xmin, double xmax, double ymin, double ymax,
+		double minimumElevation = -DBL_MAX, double maximumElevation = DBL_MAX) const;
+
+	/* Number of entries taken from the cache and number of headers parsed by the last Open(). */
+	int GetCachedEntries() const { return cachedEntries; }
+	int GetParsedEntries() const { return parsedEntries; }
+
+private:
+	void buildIndex();
+	int indexCell(double coordinate, int axis) const;
+	bool loadCache(std::vector<DemHeader>& cached) const;
+
+	std::string directory;
+	std::vector<DemHeader> entries;
+	double bounds[4];
+	double elevationRange[2];
+
+	// uniform grid over the catalog extent, every cell lists the entries overlapping it
+	double indexOrigin[2];
+	double indexCellSize;
+	int indexDimensions[2];
+	std::vector<std::vector<int>> indexCells;
+
+	int cachedEntries;
+	int parsedEntries;
+};
@@ -0,0 +1,384 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+
+#include "demmosaic.h"
+
+#include <vtkPolyDataMapper.h>
+#include <vtkPointSet.h>
+#include <vtkImageData.h>
+#include <vtkCamera.h>
+#include <vtkCommand.h>
+#include <vtkTimerLog.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+// ----- render observer -----
+class MosaicRenderCallback : public vtkCommand {
+private:
+	MosaicRenderCallback() : mosaic(nullptr) {}
+
+public:
+	DemMosaic *mosaic;
+
+	static MosaicRenderCallback *New() { return new MosaicRenderCallback; }
+
+	virtual void Execute(vtkObject *caller, unsigned long eventId, void *callData) {
+		// the renderer collects its props after StartEvent, so tiles added here are drawn in this frame
+		mosaic->UpdateResidentTiles(static_cast<vtkRenderer*>(caller));
+	}
+};
+
+DemMosaic::DemMosaic()
+	: budget(256u << 20), residentBytes(0), loadingBytes(0), loadingTiles(0), frame(0), observerTag(0), stopping(false),
+	requests(0), hits(0), loads(0), evictions(0), budgetSkips(0), totalLoadTime(0.0), maximumLoadTime(0.0), peakResidentBytes(0)
+{
+	bounds[0] = bounds[2] = 0.0;
+	bounds[1] = bounds[3] = -1.0;
+	elevationRange[0] = 0.0;
+	elevationRange[1] = -1.0;
+}
+
+DemMosaic::~DemMosaic()
+{
+	stopWorker();
+	if (renderer)
+		renderer->RemoveObserver(observerTag);
+	for (size_t i = 0; i < tiles.size(); ++i)
+		if (tiles[i].actor)
+			evictTile(tiles[i]);
+}
+
+int DemMosaic::Open(const std::string& directory)
+{
+	// the catalog comes from the cache of the directory if the demcatalog tool wrote one, from the DEM headers
+	// otherwise. Opening a mosaic never writes into the data directory
+	stopWorker();
+	tiles.clear();
+	if (catalog.Open(directory) == 0)
+		return 0;
+
+	const std::vector<DemHeader>& headers = catalog.GetEntries();
+	for (size_t i = 0; i < headers.size(); ++i) {
+		Tile tile;
+		tile.header = &headers[i];
+
+		// float elevation plus the float points of the height field
+		size_t columns = static_cast<size_t>((tile.header->bounds[1] - tile.header->bounds[0]) / tile.header->spacing[0]) + 1;
+		size_t rows = static_cast<size_t>((tile.header->bounds[3] - tile.header->bounds[2]) / tile.header->spacing[1]) + 1;
+		tile.estimatedBytes = columns * rows * (sizeof(float) + 3 * sizeof(float));
+		tile.residentBytes = 0;
+		tile.lastUsed = 0;
+		tile.loading = false;
+		tiles.push_back(tile);
+	}
+
+	catalog.GetBounds(bounds);
+	catalog.GetElevationRange(elevationRange);
+	if (lookupTable)
+		lookupTable->SetRange(elevationRange);
+	return static_cast<int>(tiles.size());
+}
+
+void DemMosaic::GetBounds(double result[6]) const
+{
+	result[0] = bounds[0];
+	result[1] = bounds[1];
+	result[2] = bounds[2];
+	result[3] = bounds[3];
+	result[4] = elevationRange[0];
+	result[5] = elevationRange[1];
+}
+
+void DemMosaic::Attach(vtkRenderer *target, InteractionScheduler *frameScheduler)
+{
+	renderer = target;
+	scheduler = frameScheduler;
+	vtkSmartPointer<MosaicRenderCallback> callback = vtkSmartPointer<MosaicRenderCallback>::New();
+	callback->mosaic = this;
+	observerTag = renderer->AddObserver(vtkCommand::StartEvent, callback);
+	startWorker();
+}
+
+void DemMosaic::startWorker()
+{
+	if (worker.joinable())
+		return;
+	stopping = false;
+	worker = std::thread(&DemMosaic::runWorker, this);
+}
+
+void DemMosaic::stopWorker()
+{
+	if (!worker.joinable())
+		return;
+	{
+		std::lock_guard<std::mutex> lock(loadMutex);
+		stopping = true;
+		requestedTiles.clear();
+	}
+	loadRequested.notify_one();
+	worker.join();
+
+	// tiles that were loaded but never shown
+	loadedTiles.clear();
+	for (size_t i = 0; i < tiles.size(); ++i)
+		tiles[i].loading = false;
+	loadingBytes = 0;
+	loadingTiles = 0;
+}
+
+void DemMosaic::runWorker()
+{
+	std::unique_lock<std::mutex> lock(loadMutex);
+	for (;;) {
+		loadRequested.wait(lock, [this]() { return stopping || !requestedTiles.empty(); });
+		if (stopping)
+			return;
+
+		// the requests are sorted nearest first. The tiles are not changed while the worker runs
+		LoadedTile loaded;
+		loaded.tile = requestedTiles.front();
+		requestedTiles.erase(requestedTiles.begin());
+		std::string fileName = tiles[loaded.tile].header->fileName;
+		lock.unlock();
+
+		vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+		timer->StartTimer();
+
+		// the pipeline of the tile is only seen by this thread until the tile is shown.
+		// Unscaled elevation as z, the elevation scale is applied by the shared transform of the actor.
+		// Tiles with the same number of samples share one strip cell array.
+		loaded.reader = vtkSmartPointer<vtkDEMReader>::New();
+		loaded.reader->SetFileName(fileName.c_str());
+		loaded.heightField = vtkSmartPointer<HeightFieldStrips>::New();
+		loaded.heightField->SetInputConnection(loaded.reader->GetOutputPort());
+		loaded.heightField->Update();
+
+		timer->StopTimer();
+		loaded.seconds = timer->GetElapsedTime();
+
+		lock.lock();
+		loadedTiles.push_back(loaded);
+	}
+}
+
+void DemMosaic::postLoadCheck()
+{
+	// checks once per display interval whether the worker finished a tile, and renders a frame when it did
+	if (!scheduler)
+		return;
+	scheduler->Post(this, [this]() {
+		bool arrived;
+		{
+			std::lock_guard<std::mutex> lock(loadMutex);
+			arrived = !loadedTiles.empty();
+		}
+		if (!arrived)
+			postLoadCheck();
+		return arrived;
+	});
+}
+
+bool DemMosaic::isVisible(const Tile& tile, const double planes[24]) const
+{
+	// world space box of the tile after the elevation transform
+	double box[6] = { VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX, VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX, VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX };
+	for (int c = 0; c < 8; ++c) {
+		double point[3] = { tile.header->bounds[c & 1], tile.header->bounds[2 + ((c >> 1) & 1)], tile.header->elevationRange[(c >> 2) & 1] };
+		double corner[3] = { point[0], point[1], point[2] };
+		if (elevationTransform)
+			elevationTransform->TransformPoint(point, corner);
+		for (int k = 0; k < 3; ++k) {
+			box[2 * k] = std::min(box[2 * k], corner[k]);
+			box[2 * k + 1] = std::max(box[2 * k + 1], corner[k]);
+		}
+	}
+
+	// the box is outside if its corner furthest along a plane normal is behind the plane
+	for (int p = 0; p < 6; ++p) {
+		const double *plane = planes + 4 * p;
+		double x = plane[0] > 0 ? box[1] : box[0];
+		double y = plane[1] > 0 ? box[3] : box[2];
+		double z = plane[2] > 0 ? box[5] : box[4];
+		if (plane[0] * x + plane[1] * y + plane[2] * z + plane[3] < 0)
+			return false;
+	}
+	return true;
+}
+
+void DemMosaic::addLoadedTiles()
+{
+	std::vector<LoadedTile> loaded;
+	{
+		std::lock_guard<std::mutex> lock(loadMutex);
+		loaded.swap(loadedTiles);
+	}
+	for (size_t i = 0; i < loaded.size(); ++i) {
+		Tile& tile = tiles[loaded[i].tile];
+		tile.loading = false;
+		loadingBytes -= tile.estimatedBytes;
+		--loadingTiles;
+		showTile(tile, loaded[i]);
+		tile.lastUsed = frame;
+	}
+}
+
+void DemMosaic::showTile(Tile& tile, const LoadedTile& loaded)
+{
+	tile.reader = loaded.reader;
+	tile.heightField = loaded.heightField;
+
+	vtkSmartPointer<vtkPolyDataMapper> mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+	mapper->SetInputConnection(tile.heightField->GetOutputPort());
+	mapper->ScalarVisibilityOn();
+	mapper->SetScalarRange(elevationRange);
+	if (lookupTable)
+		mapper->SetLookupTable(lookupTable);
+
+	tile.actor = vtkSmartPointer<vtkActor>::New();
+	tile.actor->SetMapper(mapper);
+	if (elevationTransform)
+		tile.actor->SetUserTransform(elevationTransform);
+	renderer->AddActor(tile.actor);
+
+	// GetActualMemorySize reports kibibytes, the elevation scalars are shared with the reader output
+	tile.residentBytes = static_cast<size_t>(tile.reader->GetOutput()->GetActualMemorySize()) * 1024 +
+		static_cast<size_t>(tile.heightField->GetLastVertexBytes() + tile.heightField->GetLastIndexBytes());
+	residentBytes += tile.residentBytes;
+	peakResidentBytes = std::max(peakResidentBytes, residentBytes);
+
+	++loads;
+	totalLoadTime += loaded.seconds;
+	maximumLoadTime = std::max(maximumLoadTime, loaded.seconds);
+}
+
+void DemMosaic::evictTile(Tile& tile)
+{
+	if (renderer)
+		renderer->RemoveActor(tile.actor);
+	tile.actor = nullptr;
+	tile.heightField = nullptr;
+	tile.reader = nullptr;
+	residentBytes -= tile.residentBytes;
+	tile.residentBytes = 0;
+	++evictions;
+}
+
+bool DemMosaic::makeRoom(size_t bytes, const std::vector<int>& needed)
+{
+	while (residentBytes + loadingBytes + bytes > budget) {
+		// least recently used tile that is not needed for the current frame
+		int victim = -1;
+		for (size_t i = 0; i < tiles.size(); ++i) {
+			if (!tiles[i].actor || tiles[i].lastUsed == frame)
+				continue;
+			if (std::find(needed.begin(), needed.end(), static_cast<int>(i)) != needed.end())
+				continue;
+			if (victim < 0 || tiles[i].lastUsed < tiles[victim].lastUsed)
+				victim = static_cast<int>(i);
+		}
+		if (victim < 0)
+			return false;
+		evictTile(tiles[victim]);
+	}
+	return true;
+}
+
+void DemMosaic::UpdateResidentTiles(vtkRenderer *target)
+{
+	if (tiles.empty())
+		return;
+	++frame;
+	addLoadedTiles();
+
+	vtkCamera *camera = target->GetActiveCamera();
+	double planes[24];
+	camera->GetFrustumPlanes(target->GetTiledAspectRatio(), planes);
+
+	// tiles around the focal point, the radius grows with the viewing distance
+	double focalPoint[3], position[3];
+	camera->GetFocalPoint(focalPoint);
+	camera->GetPosition(position);
+	double radius = 2.5 * camera->GetDistance();
+
+	std::vector<int> candidates = catalog.Query(focalPoint[0] - radius, focalPoint[0] + radius, focalPoint[1] - radius, focalPoint[1] + radius);
+
+	std::vector<std::pair<double, int>> byDistance;
+	for (size_t i = 0; i < candidates.size(); ++i) {
+		const Tile& tile = tiles[candidates[i]];
+		if (!isVisible(tile, planes))
+			continue;
+		double dx = std::max(0.0, std::max(tile.header->bounds[0] - focalPoint[0], focalPoint[0] - tile.header->bounds[1]));
+		double dy = std::max(0.0, std::max(tile.header->bounds[2] - focalPoint[1], focalPoint[1] - tile.header->bounds[3]));
+		byDistance.push_back(std::make_pair(dx * dx + dy * dy, candidates[i]));
+	}
+	std::sort(byDistance.begin(), byDistance.end());
+
+	std::vector<int> needed;
+	for (size_t i = 0; i < byDistance.size(); ++i)
+		needed.push_back(byDistance[i].second);
+
+	// requests of the last frame that the worker has not started yet are replaced by the requests of this frame
+	std::vector<int> stale;
+	{
+		std::lock_guard<std::mutex> lock(loadMutex);
+		stale.swap(requestedTiles);
+	}
+	for (size_t i = 0; i < stale.size(); ++i) {
+		tiles[stale[i]].loading = false;
+		loadingBytes -= tiles[stale[i]].estimatedBytes;
+		--loadingTiles;
+	}
+
+	// nearest tiles first, farther tiles are skipped once the budget is exhausted
+	std::vector<int> requested;
+	for (size_t i = 0; i < needed.size(); ++i) {
+		Tile& tile = tiles[needed[i]];
+		++requests;
+		if (tile.actor) {
+			++hits;
+			tile.lastUsed = frame;
+			continue;
+		}
+		if (tile.loading)
+			continue;
+		if (!makeRoom(tile.estimatedBytes, needed)) {
+			++budgetSkips;
+			break;
+		}
+		tile.loading = true;
+		loadingBytes += tile.estimatedBytes;
+		++loadingTiles;
+		requested.push_back(needed[i]);
+	}
+
+	if (!requested.empty()) {
+		{
+			std::lock_guard<std::mutex> lock(loadMutex);
+			requestedTiles.swap(requested);
+		}
+		loadRequested.notify_one();
+	}
+	if (loadingTiles > 0)
+		postLoadCheck();
+}
+
+void DemMosaic::PrintStatistics(std::ostream& os) const
+{
+	size_t resident = 0;
+	for (size_t i = 0; i < tiles.size(); ++i)
+		if (tiles[i].actor)
+			++resident;
+
+	const double megabyte = 1024.0 * 1024.0;
+	os << std::fixed << std::setprecision(1)
+		<< "mosaic: " << resident << "/" << tiles.size() << " tiles resident, "
+		<< residentBytes / megabyte << " MB of " << budget / megabyte << " MB budget (peak " << peakResidentBytes / megabyte << " MB)" << std::endl
+		<< "  tile loads: " << loads << ", mean latency " << (loads ? 1000.0 * totalLoadTime / loads : 0.0)
+		<< " ms, max " << 1000.0 * maximumLoadTime << " ms" << std::endl
+		<< "  cache hit rate: " << (requests ? 100.0 * hits / requests : 0.0) << "% of " << requests << " requests, "
+		<< evictions << " evictions, " << budgetSkips << " frames over budget" << std::endl;
+}
@@ -0,0 +1,139 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+// Out-of-core mosaic of neighbouring DEM tiles. Only the tiles near the camera are kept in memory,
+// under a fixed memory budget.
+//
+
+#pragma once
+
+#include <vtkSmartPointer.h>
+#include <vtkWeakPointer.h>
+#include <vtkRenderer.h>
+#include <vtkActor.h>
+#include <vtkDEMReader.h>
+#include <vtkScalarsToColors.h>
+#include <vtkLinearTransform.h>
+
+#include "demcatalog.h"
+#include "heightfield.h"
+#include "interactionscheduler.h"
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/* A directory of DEM tiles shown as one terrain. Opening the mosaic only reads the DEM catalog of the directory
+   (see DemCatalog), which is the spatial index of the tile extents. Attached to a renderer, the mosaic requests
+   the tiles that intersect the view frustum near the focal point before every frame, nearest first, and evicts
+   the least recently used tiles when the memory budget is exceeded. The tiles are read on a worker thread and
+   added to the renderer at the first frame after they are loaded, so a frame never waits for a tile.
+   All tiles share one lookup table, one scalar range and one elevation transform, so neighbouring tiles
+   with common edge samples meet without seams. */
+class DemMosaic {
+public:
+	DemMosaic();
+	~DemMosaic();
+
+	/* Opens the catalog of all *.dem files in the directory. Returns the number of tiles. The catalog cache of the
+	   directory is read if present but never written, the demcatalog tool writes it. */
+	int Open(const std::string& directory);
+
+	/* Memory budget for resident tiles in bytes. */
+	void SetMemoryBudget(size_t bytes) { budget = bytes; }
+
+	/* Lookup table used for all tiles, its range is set to the elevation range of the mosaic. */
+	void SetLookupTable(vtkScalarsToColors *lut) { lookupTable = lut; }
+
+	/* Transform applied to all tiles, used to scale the elevation (the tiles carry the unscaled elevation as z). */
+	void SetElevationTransform(vtkLinearTransform *transform) { elevationTransform = transform; }
+
+	/* Bounds of the whole mosaic, z is the elevation range. */
+	void GetBounds(double bounds[6]) const;
+	void GetElevationRange(double range[2]) const { range[0] = elevationRange[0]; range[1] = elevationRange[1]; }
+
+	/* Pages tiles in and out before every render of the renderer. With a scheduler, a frame is requested as soon
+	   as a tile has been loaded, otherwise loaded tiles appear with the next frame rendered for other reasons. */
+	void Attach(vtkRenderer *renderer, InteractionScheduler *scheduler = nullptr);
+
+	/* Adds the tiles loaded since the last frame and requests the tiles needed for the current camera of the
+	   renderer. Called by the render observer. */
+	void UpdateResidentTiles(vtkRenderer *renderer);
+
+	/* Prints tile load latency, resident bytes and cache hit rate. */
+	void PrintStatistics(std::ostream& os) const;
+
+private:
+	struct Tile {
+		const DemHeader *header;
+		size_t estimatedBytes;
+
+		// resident state
+		vtkSmartPointer<vtkDEMReader> reader;
+		vtkSmartPointer<HeightFieldStrips> heightField;
+		vtkSmartPointer<vtkActor> actor;
+		size_t residentBytes;
+		unsigned long lastUsed;
+		bool loading;
+	};
+
+	// a tile read by the worker, waiting to be added to the renderer
+	struct LoadedTile {
+		int tile;
+		vtkSmartPointer<vtkDEMReader> reader;
+		vtkSmartPointer<HeightFieldStrips> heightField;
+		double seconds;
+	};
+
+	// worker side: reads the requested tiles nearest first
+	void startWorker();
+	void stopWorker();
+	void runWorker();
+
+	// render thread side
+	void addLoadedTiles();
+	void showTile(Tile& tile, const LoadedTile& loaded);
+	void evictTile(Tile& tile);
+	bool makeRoom(size_t bytes, const std::vector<int>& needed);
+	bool isVisible(const Tile& tile, const double planes[24]) const;
+	void postLoadCheck();
+
+	// tiles in catalog order
+	DemCatalog catalog;
+	std::vector<Tile> tiles;
+
+	double bounds[4];
+	double elevationRange[2];
+	size_t budget;
+	size_t residentBytes;
+	size_t loadingBytes;        // estimated bytes of the tiles requested or being read
+	int loadingTiles;
+	unsigned long frame;
+
+	vtkWeakPointer<vtkRenderer> renderer;
+	vtkWeakPointer<InteractionScheduler> scheduler;
+	unsigned long observerTag;
+
+	// requests and results of the worker, guarded by loadMutex
+	std::thread worker;
+	std::mutex loadMutex;
+	std::condition_variable loadRequested;
+	std::vector<int> requestedTiles;
+	std::vector<LoadedTile> loadedTiles;
+	bool stopping;
+	vtkSmartPointer<vtkScalarsToColors> lookupTable;
+	vtkSmartPointer<vtkLinearTransform> elevationTransform;
+
+	// statistics
+	unsigned long requests;
+	unsigned long hits;
+	unsigned long loads;
+	unsigned long evictions;
+	unsigned long budgetSkips;
+	double totalLoadTime;
+	double maximumLoadTime;
+	size_t peakResidentBytes;
+};
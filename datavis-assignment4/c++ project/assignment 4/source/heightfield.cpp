@@ -0,0 +1,141 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+
+#include "heightfield.h"
+
+#include <vtkObjectFactory.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkImageData.h>
+#include <vtkPolyData.h>
+#include <vtkPointData.h>
+#include <vtkDataArray.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkWeakPointer.h>
+
+#include <map>
+#include <mutex>
+#include <utility>
+
+vtkStandardNewMacro(HeightFieldStrips);
+
+HeightFieldStrips::HeightFieldStrips()
+	: LastVertexBytes(0), LastIndexBytes(0)
+{
+	gridDimensions[0] = gridDimensions[1] = 0;
+	gridOrigin[0] = gridOrigin[1] = 0.0;
+	gridSpacing[0] = gridSpacing[1] = 0.0;
+}
+
+int HeightFieldStrips::FillInputPortInformation(int, vtkInformation *info)
+{
+	info->Set(vtkAlgorithm::INPUT_REQUIRED_DATA_TYPE(), "vtkImageData");
+	return 1;
+}
+
+vtkSmartPointer<vtkCellArray> HeightFieldStrips::GetSharedStrips(int columns, int rows, bool *built)
+{
+	// the strips live as long as one height field of that size uses them. Tiles are built on worker threads
+	// (see DemMosaic), so the map is guarded by a mutex
+	static std::map<std::pair<int, int>, vtkWeakPointer<vtkCellArray>> sharedStrips;
+	static std::mutex sharedStripsMutex;
+	std::lock_guard<std::mutex> lock(sharedStripsMutex);
+
+	// drop the entries of sizes that are no longer used, so the map does not grow with every tile size ever seen
+	for (std::map<std::pair<int, int>, vtkWeakPointer<vtkCellArray>>::iterator entry = sharedStrips.begin(); entry != sharedStrips.end();) {
+		if (entry->second)
+			++entry;
+		else
+			entry = sharedStrips.erase(entry);
+	}
+
+	vtkSmartPointer<vtkCellArray> strips = sharedStrips[std::make_pair(columns, rows)].GetPointer();
+	if (built)
+		*built = !strips;
+	if (strips)
+		return strips;
+
+	// one strip per pair of rows, alternating between the upper and the lower row (counter-clockwise, facing +z)
+	vtkSmartPointer<vtkIdTypeArray> connectivity = vtkSmartPointer<vtkIdTypeArray>::New();
+	connectivity->SetNumberOfValues(static_cast<vtkIdType>(rows - 1) * (2 * columns + 1));
+	vtkIdType *ids = connectivity->GetPointer(0);
+	for (int j = 0; j + 1 < rows; ++j) {
+		*ids++ = 2 * columns;
+		for (int i = 0; i < columns; ++i) {
+			*ids++ = static_cast<vtkIdType>(j + 1) * columns + i;
+			*ids++ = static_cast<vtkIdType>(j) * columns + i;
+		}
+	}
+
+	strips = vtkSmartPointer<vtkCellArray>::New();
+	strips->SetCells(rows - 1, connectivity);
+	sharedStrips[std::make_pair(columns, rows)] = strips;
+	return strips;
+}
+
+int HeightFieldStrips::RequestData(vtkInformation *, vtkInformationVector **inputVector, vtkInformationVector *outputVector)
+{
+	vtkImageData *input = vtkImageData::GetData(inputVector[0]);
+	vtkPolyData *output = vtkPolyData::GetData(outputVector);
+	vtkDataArray *elevation = input ? input->GetPointData()->GetScalars() : nullptr;
+	if (!elevation || !output) {
+		vtkErrorMacro("No elevation grid.");
+		return 0;
+	}
+
+	int dims[3];
+	double origin[3], spacing[3];
+	input->GetDimensions(dims);
+	input->GetOrigin(origin);
+	input->GetSpacing(spacing);
+	const vtkIdType numberOfPoints = static_cast<vtkIdType>(dims[0]) * dims[1];
+
+	// x and y only have to be generated when the grid changed
+	bool sameGrid = points && gridDimensions[0] == dims[0] && gridDimensions[1] == dims[1]
+		&& gridOrigin[0] == origin[0] && gridOrigin[1] == origin[1]
+		&& gridSpacing[0] == spacing[0] && gridSpacing[1] == spacing[1];
+	if (!sameGrid) {
+		points = vtkSmartPointer<vtkPoints>::New();
+		points->SetDataTypeToFloat();
+		points->SetNumberOfPoints(numberOfPoints);
+		float *xyz = static_cast<vtkFloatArray*>(points->GetData())->GetPointer(0);
+		for (int j = 0; j < dims[1]; ++j)
+			for (int i = 0; i < dims[0]; ++i, xyz += 3) {
+				xyz[0] = static_cast<float>(origin[0] + i * spacing[0]);
+				xyz[1] = static_cast<float>(origin[1] + j * spacing[1]);
+			}
+		gridDimensions[0] = dims[0];
+		gridDimensions[1] = dims[1];
+		gridOrigin[0] = origin[0];
+		gridOrigin[1] = origin[1];
+		gridSpacing[0] = spacing[0];
+		gridSpacing[1] = spacing[1];
+	}
+
+	// z is the unscaled elevation
+	float *xyz = static_cast<vtkFloatArray*>(points->GetData())->GetPointer(0);
+	if (elevation->GetDataType() == VTK_FLOAT && elevation->GetNumberOfComponents() == 1) {
+		const float *z = static_cast<vtkFloatArray*>(elevation)->GetPointer(0);
+		for (vtkIdType p = 0; p < numberOfPoints; ++p)
+			xyz[3 * p + 2] = z[p];
+	}
+	else {
+		for (vtkIdType p = 0; p < numberOfPoints; ++p)
+			xyz[3 * p + 2] = static_cast<float>(elevation->GetComponent(p, 0));
+	}
+	points->Modified();
+
+	bool built = false;
+	vtkSmartPointer<vtkCellArray> strips = GetSharedStrips(dims[0], dims[1], &built);
+
+	output->Initialize();
+	output->SetPoints(points);
+	output->SetStrips(strips);
+	output->GetPointData()->SetScalars(elevation);
+
+	LastVertexBytes = numberOfPoints * 3 * static_cast<vtkIdType>(sizeof(float));
+	LastIndexBytes = built ? strips->GetData()->GetNumberOfValues() * static_cast<vtkIdType>(sizeof(vtkIdType)) : 0;
+	return 1;
+}
@@ -0,0 +1,53 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+// Direct height field geometry: triangle strips built straight from a regular elevation grid.
+//
+
+#pragma once
+
+#include <vtkPolyDataAlgorithm.h>
+#include <vtkSmartPointer.h>
+#include <vtkPoints.h>
+#include <vtkCellArray.h>
+
+/* Converts a 2D elevation image into polygonal data for vtkPolyDataMapper, skipping the generic dataset
+   surface extraction that vtkDataSetMapper runs on every pipeline execution.
+   - the connectivity is one triangle strip per grid row. It only depends on the grid dimensions, so all height
+     fields of the same size (e.g. the tiles of a mosaic) share one strip cell array.
+   - the z coordinate is the unscaled elevation. The warp factor belongs into the actor transform
+     (vtkProp3D::SetUserTransform), so changing it uploads nothing.
+   - the input scalars are passed by reference for coloring.
+   - when only the elevation values change, the points array is reused and only z is rewritten. */
+class HeightFieldStrips : public vtkPolyDataAlgorithm {
+public:
+	static HeightFieldStrips *New();
+	vtkTypeMacro(HeightFieldStrips, vtkPolyDataAlgorithm);
+
+	/* Size of the geometry of the last execution in bytes, the shared strips are only counted if they were built. */
+	vtkGetMacro(LastVertexBytes, vtkIdType);
+	vtkGetMacro(LastIndexBytes, vtkIdType);
+
+	/* Returns the strips of a grid with the given number of samples, building them on first use. */
+	static vtkSmartPointer<vtkCellArray> GetSharedStrips(int columns, int rows, bool *built = nullptr);
+
+protected:
+	HeightFieldStrips();
+	~HeightFieldStrips() override {}
+
+	int FillInputPortInformation(int port, vtkInformation *info) override;
+	int RequestData(vtkInformation *request, vtkInformationVector **inputVector, vtkInformationVector *outputVector) override;
+
+private:
+	HeightFieldStrips(const HeightFieldStrips&) = delete;
+	void operator=(const HeightFieldStrips&) = delete;
+
+	// geometry of the last execution, x and y stay valid as long as the grid does not change
+	vtkSmartPointer<vtkPoints> points;
+	int gridDimensions[2];
+	double gridOrigin[2];
+	double gridSpacing[2];
+
+	vtkIdType LastVertexBytes;
+	vtkIdType LastIndexBytes;
+};
@@ -0,0 +1,276 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+
+#include "terraintin.h"
+#include "heightfield.h"
+
+#include <vtkObjectFactory.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkPointData.h>
+#include <vtkDataArray.h>
+#include <vtkFloatArray.h>
+#include <vtkPoints.h>
+#include <vtkCellArray.h>
+#include <vtkPolyData.h>
+#include <vtkGreedyTerrainDecimation.h>
+#include <vtkTimerLog.h>
+
+#include <vtkPolyDataMapper.h>
+#include <vtkLookupTable.h>
+#include <vtkActor.h>
+#include <vtkRenderer.h>
+#include <vtkRenderWindow.h>
+#include <vtkCamera.h>
+
+#include <thread>
+#include <atomic>
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+
+vtkStandardNewMacro(ParallelTerrainDecimation);
+
+ParallelTerrainDecimation::ParallelTerrainDecimation()
+	: AbsoluteError(10.0), NumberOfThreads(0), TileSize(256), LastBuildTime(0.0), LastNumberOfTiles(0)
+{
+}
+
+int ParallelTerrainDecimation::FillInputPortInformation(int, vtkInformation *info)
+{
+	info->Set(vtkAlgorithm::INPUT_REQUIRED_DATA_TYPE(), "vtkImageData");
+	return 1;
+}
+
+int ParallelTerrainDecimation::RequestData(vtkInformation *, vtkInformationVector **inputVector, vtkInformationVector *outputVector)
+{
+	vtkImageData *input = vtkImageData::GetData(inputVector[0]);
+	vtkPolyData *output = vtkPolyData::GetData(outputVector);
+	vtkDataArray *scalars = input ? input->GetPointData()->GetScalars() : nullptr;
+	if (!scalars || !output) {
+		vtkErrorMacro("No height field to decimate.");
+		return 0;
+	}
+
+	vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+	timer->StartTimer();
+
+	int extent[6];
+	double origin[3], spacing[3];
+	input->GetExtent(extent);
+	input->GetOrigin(origin);
+	input->GetSpacing(spacing);
+
+	const int cellsX = extent[1] - extent[0];
+	const int cellsY = extent[3] - extent[2];
+	const int size = this->TileSize;
+	const int tilesX = std::max(1, (cellsX + size - 1) / size);
+	const int tilesY = std::max(1, (cellsY + size - 1) / size);
+	const int numberOfTiles = tilesX * tilesY;
+
+	// row-wise access to the height values, the tiles are copied by the worker threads
+	const int rowLength = cellsX + 1;
+	const int tupleSize = scalars->GetDataTypeSize() * scalars->GetNumberOfComponents();
+	const char *heights = static_cast<const char*>(scalars->GetVoidPointer(0));
+
+	std::vector<vtkSmartPointer<vtkPolyData>> tins(numberOfTiles);
+	std::atomic<int> nextTile(0);
+	const double error = this->AbsoluteError;
+
+	auto worker = [&]() {
+		for (int tile = nextTile++; tile < numberOfTiles; tile = nextTile++) {
+			const int i0 = (tile % tilesX) * size;
+			const int j0 = (tile / tilesX) * size;
+			const int i1 = std::min(i0 + size, cellsX);
+			const int j1 = std::min(j0 + size, cellsY);
+
+			// the tile shares its boundary samples with its neighbours
+			vtkSmartPointer<vtkImageData> tileImage = vtkSmartPointer<vtkImageData>::New();
+			tileImage->SetExtent(0, i1 - i0, 0, j1 - j0, 0, 0);
+			tileImage->SetOrigin(origin[0] + (extent[0] + i0) * spacing[0], origin[1] + (extent[2] + j0) * spacing[1], origin[2]);
+			tileImage->SetSpacing(spacing);
+
+			vtkSmartPointer<vtkDataArray> tileScalars;
+			tileScalars.TakeReference(scalars->NewInstance());
+			tileScalars->SetNumberOfComponents(scalars->GetNumberOfComponents());
+			tileScalars->SetNumberOfTuples(static_cast<vtkIdType>(i1 - i0 + 1) * (j1 - j0 + 1));
+			char *tileHeights = static_cast<char*>(tileScalars->GetVoidPointer(0));
+			for (int j = j0; j <= j1; ++j)
+				std::memcpy(tileHeights + static_cast<size_t>(j - j0) * (i1 - i0 + 1) * tupleSize,
+					heights + (static_cast<size_t>(j) * rowLength + i0) * tupleSize,
+					static_cast<size_t>(i1 - i0 + 1) * tupleSize);
+			tileImage->GetPointData()->SetScalars(tileScalars);
+
+			vtkSmartPointer<vtkGreedyTerrainDecimation> decimation = vtkSmartPointer<vtkGreedyTerrainDecimation>::New();
+			decimation->SetInputData(tileImage);
+			decimation->SetErrorMeasureToAbsoluteError();
+			decimation->SetAbsoluteError(error);
+			decimation->BoundaryVertexDeletionOff();
+			decimation->Update();
+			tins[tile] = decimation->GetOutput();
+		}
+	};
+
+	int numberOfThreads = this->NumberOfThreads > 0 ? this->NumberOfThreads : static_cast<int>(std::thread::hardware_concurrency());
+	numberOfThreads = std::max(1, std::min(numberOfThreads, numberOfTiles));
+	std::vector<std::thread> threads;
+	for (int t = 1; t < numberOfThreads; ++t)
+		threads.push_back(std::thread(worker));
+	worker();
+	for (size_t t = 0; t < threads.size(); ++t)
+		threads[t].join();
+
+	// stitch the tiles in tile order, vertices on tile seams are merged by their grid index
+	vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+	vtkSmartPointer<vtkCellArray> triangles = vtkSmartPointer<vtkCellArray>::New();
+	vtkSmartPointer<vtkFloatArray> elevation = vtkSmartPointer<vtkFloatArray>::New();
+	elevation->SetName(scalars->GetName() ? scalars->GetName() : "Elevation");
+	std::unordered_map<long long, vtkIdType> seamPoints;
+	std::vector<vtkIdType> pointIds;
+
+	for (int tile = 0; tile < numberOfTiles; ++tile) {
+		vtkPolyData *tin = tins[tile];
+		pointIds.resize(tin->GetNumberOfPoints());
+		for (vtkIdType p = 0; p < tin->GetNumberOfPoints(); ++p) {
+			double x[3];
+			tin->GetPoint(p, x);
+			long long i = static_cast<long long>(std::floor((x[0] - origin[0]) / spacing[0] + 0.5)) - extent[0];
+			long long j = static_cast<long long>(std::floor((x[1] - origin[1]) / spacing[1] + 0.5)) - extent[2];
+			bool onSeam = (i % size == 0) || (j % size == 0);
+			if (onSeam) {
+				long long key = j * rowLength + i;
+				std::unordered_map<long long, vtkIdType>::iterator it = seamPoints.find(key);
+				if (it != seamPoints.end()) {
+					pointIds[p] = it->second;
+					continue;
+				}
+				pointIds[p] = points->InsertNextPoint(x);
+				seamPoints[key] = pointIds[p];
+			}
+			else
+				pointIds[p] = points->InsertNextPoint(x);
+			elevation->InsertNextValue(static_cast<float>(x[2]));
+		}
+
+		vtkCellArray *polys = tin->GetPolys();
+		vtkIdType npts;
+		vtkIdType *pts;
+		for (polys->InitTraversal(); polys->GetNextCell(npts, pts);) {
+			triangles->InsertNextCell(npts);
+			for (vtkIdType k = 0; k < npts; ++k)
+				triangles->InsertCellPoint(pointIds[pts[k]]);
+		}
+		tins[tile] = nullptr;
+	}
+
+	output->SetPoints(points);
+	output->SetPolys(triangles);
+	output->GetPointData()->SetScalars(elevation);
+
+	timer->StopTimer();
+	LastBuildTime = timer->GetElapsedTime();
+	LastNumberOfTiles = numberOfTiles;
+	return 1;
+}
+
+// ----- benchmark -----
+
+static double measureFrameTime(vtkSmartPointer<vtkMapper> mapper)
+{
+	vtkSmartPointer<vtkActor> actor = vtkSmartPointer<vtkActor>::New();
+	actor->SetMapper(mapper);
+	actor->SetScale(1, 1, 2);
+
+	vtkSmartPointer<vtkRenderer> renderer = vtkSmartPointer<vtkRenderer>::New();
+	renderer->AddActor(actor);
+	renderer->GetActiveCamera()->SetViewUp(0, 0, 1);
+	renderer->GetActiveCamera()->SetPosition(-1, -1, 1);
+	renderer->GetActiveCamera()->SetFocalPoint(0, 0, 0);
+	renderer->ResetCamera();
+
+	vtkSmartPointer<vtkRenderWindow> window = vtkSmartPointer<vtkRenderWindow>::New();
+	window->OffScreenRenderingOn();
+	window->SetSize(800, 800);
+	window->AddRenderer(renderer);
+
+	// the first frames upload the buffers
+	for (int i = 0; i < 3; ++i)
+		window->Render();
+
+	const int frames = 20;
+	vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+	timer->StartTimer();
+	for (int i = 0; i < frames; ++i) {
+		renderer->GetActiveCamera()->Azimuth(360.0 / frames);
+		window->Render();
+	}
+	timer->StopTimer();
+
+	window->Finalize();
+	return timer->GetElapsedTime() / frames;
+}
+
+void runTinBenchmark(vtkImageData *dem, const std::string& name, const std::vector<double>& errorBounds,
+	int numberOfThreads, std::ostream& os)
+{
+	int dims[3];
+	dem->GetDimensions(dims);
+	double range[2];
+	dem->GetScalarRange(range);
+	const double denseTriangles = 2.0 * (dims[0] - 1) * (dims[1] - 1);
+
+	vtkSmartPointer<vtkLookupTable> lut = vtkSmartPointer<vtkLookupTable>::New();
+	lut->SetHueRange(0, 0.2);
+	lut->SetSaturationRange(1.0, 0.5);
+	lut->SetValueRange(0.5, 1.0);
+
+	os << "# TIN benchmark: " << name << " (" << dims[0] << " x " << dims[1] << " samples)" << std::endl;
+	os << "| error bound | triangles | of dense | build [ms] | frame [ms] |" << std::endl;
+	os << "|------------:|----------:|---------:|-----------:|-----------:|" << std::endl;
+	os << std::fixed;
+
+	for (size_t b = 0; b < errorBounds.size(); ++b) {
+		double triangles = denseTriangles, buildTime = 0.0, frameTime = 0.0;
+
+		if (errorBounds[b] <= 0.0) {
+			// reference: the dense grid as rendered by the default pipeline
+			vtkSmartPointer<HeightFieldStrips> heightField = vtkSmartPointer<HeightFieldStrips>::New();
+			heightField->SetInputData(dem);
+
+			vtkSmartPointer<vtkPolyDataMapper> mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+			mapper->SetInputConnection(heightField->GetOutputPort());
+			mapper->SetScalarRange(range);
+			mapper->SetLookupTable(lut);
+			frameTime = measureFrameTime(mapper);
+		}
+		else {
+			vtkSmartPointer<ParallelTerrainDecimation> tin = vtkSmartPointer<ParallelTerrainDecimation>::New();
+			tin->SetInputData(dem);
+			tin->SetAbsoluteError(errorBounds[b]);
+			tin->SetNumberOfThreads(numberOfThreads);
+			tin->Update();
+			triangles = static_cast<double>(tin->GetOutput()->GetNumberOfPolys());
+			buildTime = tin->GetLastBuildTime();
+
+			vtkSmartPointer<vtkPolyDataMapper> mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+			mapper->SetInputConnection(tin->GetOutputPort());
+			mapper->SetScalarRange(range);
+			mapper->SetLookupTable(lut);
+			frameTime = measureFrameTime(mapper);
+		}
+
+		os << "| " << std::setw(11) << std::setprecision(1);
+		if (errorBounds[b] <= 0.0)
+			os << "dense";
+		else
+			os << errorBounds[b];
+		os << " | " << std::setw(9) << std::setprecision(0) << triangles
+			<< " | " << std::setw(7) << std::setprecision(1) << 100.0 * triangles / denseTriangles << "%"
+			<< " | " << std::setw(10) << std::setprecision(1) << buildTime * 1000.0
+			<< " | " << std::setw(10) << std::setprecision(2) << frameTime * 1000.0 << " |" << std::endl;
+	}
+	os << std::endl;
+}
@@ -0,0 +1,64 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+// Error-bounded terrain decimation: replaces the dense elevation grid by an adaptive TIN
+// (triangulated irregular network) whose height never deviates more than a given bound from the DEM.
+//
+
+#pragma once
+
+#include <vtkPolyDataAlgorithm.h>
+#include <vtkSmartPointer.h>
+#include <vtkImageData.h>
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+/* Multithreaded version of vtkGreedyTerrainDecimation with an absolute error bound.
+   The height field is split into tiles which are decimated independently on worker threads. Every tile keeps
+   its boundary vertices (BoundaryVertexDeletionOff), so neighbouring tiles share their edge vertices and the
+   stitched TIN has no cracks. The output points carry the elevation as z coordinate and as point scalars. */
+class ParallelTerrainDecimation : public vtkPolyDataAlgorithm {
+public:
+	static ParallelTerrainDecimation *New();
+	vtkTypeMacro(ParallelTerrainDecimation, vtkPolyDataAlgorithm);
+
+	/* Maximum vertical distance between the TIN and the height field, in elevation units. */
+	vtkSetClampMacro(AbsoluteError, double, 0.0, VTK_DOUBLE_MAX);
+	vtkGetMacro(AbsoluteError, double);
+
+	/* Number of worker threads, 0 uses all hardware threads. */
+	vtkSetClampMacro(NumberOfThreads, int, 0, 256);
+	vtkGetMacro(NumberOfThreads, int);
+
+	/* Number of grid cells along the edge of a tile. */
+	vtkSetClampMacro(TileSize, int, 16, 4096);
+	vtkGetMacro(TileSize, int);
+
+	/* Statistics of the last execution. */
+	vtkGetMacro(LastBuildTime, double);
+	vtkGetMacro(LastNumberOfTiles, int);
+
+protected:
+	ParallelTerrainDecimation();
+	~ParallelTerrainDecimation() override {}
+
+	int FillInputPortInformation(int port, vtkInformation *info) override;
+	int RequestData(vtkInformation *request, vtkInformationVector **inputVector, vtkInformationVector *outputVector) override;
+
+private:
+	ParallelTerrainDecimation(const ParallelTerrainDecimation&) = delete;
+	void operator=(const ParallelTerrainDecimation&) = delete;
+
+	double AbsoluteError;
+	int NumberOfThreads;
+	int TileSize;
+	double LastBuildTime;
+	int LastNumberOfTiles;
+};
+
+/* Builds the TIN of the DEM for every error bound and prints a table with error bound, triangle count,
+   build time and render frame time. A bound of 0 measures the dense grid as reference. */
+void runTinBenchmark(vtkImageData *dem, const std::string& name, const std::vector<double>& errorBounds,
+	int numberOfThreads, std::ostream& os);
@@ -15,19 +15,38 @@ VTK_MODULE_INIT(vtkRenderingVolumeOpenGL2);
 VTK_MODULE_INIT(vtkRenderingFreeType);
 
 #include "vtkhelper.h"
+#include "batchrender.h"
+#include "pipelinetrace.h"
+#include "statshud.h"
+#include "objecttracker.h"
+#include "comparisonviews.h"
+#include "taskgraph.h"
+#include "interactionscheduler.h"
+#include "sharedimage.h"
+#include "weldedcubes.h"
+#include "cropbox.h"
+#include "viewdependent.h"
+#include "surfacecomponents.h"
+#include "surfacelod.h"
+#include "meshexport.h"
+#include "voxelprobe.h"
+#include "isoatlas.h"
+#include "contourtree.h"
 
 #include <vtkSmartPointer.h>
 #include <vtkImageData.h>
 
 #include <vtkXMLImageDataReader.h>
+#include <vtkTrivialProducer.h>
 #include <vtkPiecewiseFunction.h>
 #include <vtkColorTransferFunction.h>
 #include <vtkVolumeProperty.h>
 #include <vtkSmartVolumeMapper.h>
 
-#include <vtkMarchingCubes.h>
 #include <vtkDataSetMapper.h>
+#include <vtkPolyDataMapper.h>
 #include <vtkLookupTable.h>
+#include <vtkProperty.h>
 
 #include <vtkSliderRepresentation2D.h>
 #include <vtkSliderWidget.h>
@@ -35,16 +54,26 @@ VTK_MODULE_INIT(vtkRenderingFreeType);
 #include <vtkCommand.h>
 #include <vtkInteractorStyleTrackballCamera.h>
 
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <sstream>
+
 class IsoSliderCallback : public vtkCommand {
 private:
-	IsoSliderCallback() {}
+	IsoSliderCallback() : index(0) {}
 
 public:
-	vtkSmartPointer<vtkMarchingCubes> isoSurface;
+	vtkSmartPointer<WeldedMarchingCubes> isoSurface;
+	vtkSmartPointer<InteractionScheduler> scheduler;
+	vtkSmartPointer<ViewDependentSurface> viewDependent;
+	int index;      // iso value of the filter that the slider controls
 
 	static IsoSliderCallback *New() { return new IsoSliderCallback; }
 
-	void SetData( vtkSmartPointer<vtkMarchingCubes> isoSurface ) { this->isoSurface = isoSurface; }
+	void SetData( vtkSmartPointer<WeldedMarchingCubes> isoSurface ) { this->isoSurface = isoSurface; }
 
 	virtual void Execute( vtkObject *caller, unsigned long eventId, void *callData ) {
 		// Get our slider widget back
@@ -53,52 +82,300 @@ public:
 		// Get the value
 		double value = static_cast<vtkSliderRepresentation*>(slider->GetRepresentation())->GetValue();
 
-		// Set new Iso value
-		isoSurface->SetValue( 0, value );
-		isoSurface->Update();
+		// the shown bricks of the view-dependent surface are extracted instead of the whole volume
+		if (viewDependent && viewDependent->GetEnabled() && index == 0) {
+			viewDependent->SetIsoValue(value);
+			return;
+		}
+
+		// Set new Iso value, the surface is extracted at most once per frame for the last slider position
+		WeldedMarchingCubes *surface = isoSurface;
+		const int index = this->index;
+		InteractionScheduler::Update update = [surface, index, value]() {
+			if (surface->GetValue(index) == value)
+				return false;
+			surface->SetValue( index, value );
+			surface->Update();
+			return true;
+		};
+		if (scheduler)
+			scheduler->Post(this, update);
+		else
+			update();
 	}
 };
 
 
-void doRenderingAndInteraction(vtkSmartPointer<vtkRenderWindow> window)
+// doRenderingAndInteraction(window) is provided by vtkhelper
+void doRenderingAndInteraction(vtkSmartPointer<vtkRenderWindowInteractor> interactor, vtkSmartPointer<vtkRenderWindow> window)
 {
-	// create interactor and connect a window
-	vtkSmartPointer<vtkRenderWindowInteractor> interactor = vtkSmartPointer<vtkRenderWindowInteractor>::New();
-	interactor->SetRenderWindow(window);
-	// set an interaction style
-	interactor->SetInteractorStyle(vtkInteractorStyleTrackballCamera::New());
-
-	// execute render/interaction loop
+	// execute render/interaction loop, the first frame goes through an attached interaction scheduler
 	interactor->Initialize();
+	interactor->Render();
 	interactor->Start();
 
 	// close the window when finished
 	window->Finalize();
 }
 
-void doRenderingAndInteraction(vtkSmartPointer<vtkRenderWindowInteractor> interactor, vtkSmartPointer<vtkRenderWindow> window)
+int runComparison(vtkSmartPointer<vtkImageData> volume, SharedImageView *sharedVolume, const std::vector<ComparisonView>& views,
+	const std::vector<CameraKeyframe>& cameraPath, const std::string& batchPrefix,
+	PipelineTrace& trace, vtkSmartPointer<StatisticsHud> hud, ObjectTracker& tracker)
 {
-	// execute render/interaction loop
-	interactor->Initialize();
-	interactor->Start();
+	// one viewport per iso value or transfer function, all on the same volume
+	vtkSmartPointer<vtkRenderWindow> window = vtkSmartPointer<vtkRenderWindow>::New();
+	window->SetSize(1200, 900);
 
-	// close the window when finished
-	window->Finalize();
+	ComparisonLayout layout;
+	layout.Build(window, views);
+	layout.SetVolume(volume);
+	layout.PrintMemory(std::cout);
+
+	trace.AddRenderWindow(window);
+	tracker.TrackScene(window);
+
+	// the views share the camera, so a camera path moves all of them
+	if (!cameraPath.empty()) {
+		renderCameraPath(window, cameraPath, batchPrefix, SceneUpdate(), std::cout);
+		return 0;
+	}
+
+	vtkSmartPointer<vtkRenderWindowInteractor> interactor = vtkSmartPointer<vtkRenderWindowInteractor>::New();
+	interactor->SetRenderWindow(window);
+	vtkSmartPointer<vtkInteractorStyleTrackballCamera> style = vtkSmartPointer<vtkInteractorStyleTrackballCamera>::New();
+	interactor->SetInteractorStyle(style);
+
+	// one render of all viewports per display interval while the camera moves
+	vtkSmartPointer<InteractionScheduler> scheduler = vtkSmartPointer<InteractionScheduler>::New();
+	scheduler->Attach(interactor, window);
+
+	vtkSmartPointer<TraceToggleCallback> traceCallback = vtkSmartPointer<TraceToggleCallback>::New();
+	traceCallback->trace = &trace;
+	interactor->AddObserver(vtkCommand::KeyPressEvent, traceCallback);
+
+	hud->Attach(window, layout.GetRenderer(0), interactor);
+
+	// an attached volume follows its loader, the iso surfaces of all views are updated in parallel on the
+	// republished voxels
+	vtkSmartPointer<SharedImageWatcher> volumeWatcher = vtkSmartPointer<SharedImageWatcher>::New();
+	if (sharedVolume) {
+		volumeWatcher->view = sharedVolume;
+		volumeWatcher->update = [&](SharedImageView::Change change) {
+			layout.SetVolume(sharedVolume->GetImage());
+			scheduler->RequestRender();
+		};
+		volumeWatcher->Attach(interactor);
+	}
+
+	vtkSmartPointer<ObjectReportCallback> objectCallback = vtkSmartPointer<ObjectReportCallback>::New();
+	objectCallback->tracker = &tracker;
+	objectCallback->window = window;
+	interactor->AddObserver(vtkCommand::KeyPressEvent, objectCallback);
+
+	doRenderingAndInteraction(interactor, window);
+	scheduler->PrintStatistics(std::cout);
+	tracker.TrackScene(window);
+	return 0;
 }
 
 
-int main()
+int main(int argc, char * argv[])
 {
+	// declared first, so it outlives every object of the scene and can report the ones that leak
+	ObjectTracker tracker;
+	// the scalars of an attached volume live in its mapping, which has to outlive the scene as well
+	SharedImageView sharedVolume;
+
+	// command line options:
+	//   --batch <camera path> <output prefix>
+	//                   render the camera path offscreen to PNG files and exit (see batchrender.h)
+	//   --trace <file>  record a pipeline trace from the start and write it as Chrome trace JSON on exit.
+	//                   Without this option the trace is started and stopped with 'l' and written to
+	//                   assignment5-trace.json.
+	//   --track-objects report the live VTK objects of the scene with 'o' and the leaked ones on exit
+	//   --compare <views>
+	//                   side by side viewports, a comma separated list of iso values and transfer function
+	//                   presets (skin, bone, muscle), e.g. --compare 500,1150,skin,bone
+	//   --publish <name> loader mode: read the volume once and publish its voxels as shared memory
+	//   --attach <name> show a published volume instead of reading the file, follows its updates
+	//   --threads <n>   number of threads for the iso surface extraction (default: all cores)
+	//   --iso <values>  comma separated iso values, e.g. --iso 500,1150 for skin and bone. All surfaces are extracted
+	//                   in one traversal of the volume, each has its own actor and slider (default: 500)
+	//   --weld-bench <iso value>
+	//                   compare the edge welded extraction on 1 to n threads with vtkMarchingCubes and exit
+	//   --keep-largest <n>
+	//                   keep only the n largest connected components of every iso surface
+	//   --min-component <cells>
+	//                   remove the connected components of the iso surfaces with fewer cells, the noise fragments
+	//   --lod <divisions>
+	//                   smooth the iso surfaces (windowed sinc) and show a vertex clustered copy with the given grid
+	//                   cells along the longest side while the camera moves, e.g. --lod 64
+	//   --export <files>
+	//                   batch export: extract the iso surfaces, write them to the comma separated files (.ply, .stl,
+	//                   .glb, the number of the iso value is appended for further surfaces) and exit. 'x' exports the
+	//                   current surfaces in the viewer.
+	//   --build-atlas   preprocessing: index the active cells of every iso value, write the atlas next to the volume
+	//                   file (headsq-half.isoatlas), report its size and the extraction time against marching cubes
+	//                   on the fly, and exit
+	//   --atlas         extract the iso surfaces of the slider from the atlas written by --build-atlas
+	//   --view-dependent
+	//                   start with the view-dependent surface of the first iso value, toggled with 'v'
+	//   --contour-tree <features>
+	//                   compute the contour tree of the volume and simplify it to the given number of leaves. Its
+	//                   node values are tick marks under the first slider, '[' and ']' move the slider to the previous
+	//                   and next one, 'k' cycles through the single components of the first surface at the value
+	std::vector<CameraKeyframe> cameraPath;
+	std::string batchPrefix;
+	std::string traceFile;
+	bool trackObjects = false;
+	std::vector<ComparisonView> comparisonViews;
+	std::string publishName, attachName;
+	int numberOfThreads = 0;
+	double weldBenchmarkValue = -1.0;
+	std::vector<double> isoValues(1, 500.0);
+	bool viewDependentSurface = false;
+	int largestComponents = 0;
+	vtkIdType minimumComponentCells = 1;
+	int lodDivisions = 0;
+	std::vector<std::string> exportFiles;
+	bool buildAtlas = false, useAtlas = false;
+	int contourFeatures = 0;
+	for (int i = 1; i < argc; ++i) {
+		if (!std::strcmp(argv[i], "--batch") && i + 2 < argc) {
+			if (!readCameraPath(argv[i + 1], cameraPath)) {
+				std::cerr << "could not read the camera path " << argv[i + 1] << std::endl;
+				return 1;
+			}
+			batchPrefix = argv[i + 2];
+			i += 2;
+		}
+		else if (!std::strcmp(argv[i], "--trace") && i + 1 < argc)
+			traceFile = argv[++i];
+		else if (!std::strcmp(argv[i], "--track-objects"))
+			trackObjects = true;
+		else if (!std::strcmp(argv[i], "--compare") && i + 1 < argc) {
+			if (!parseComparisonViews(argv[++i], comparisonViews)) {
+				std::cerr << "invalid view list " << argv[i] << std::endl;
+				return 1;
+			}
+		}
+		else if (!std::strcmp(argv[i], "--publish") && i + 1 < argc)
+			publishName = argv[++i];
+		else if (!std::strcmp(argv[i], "--attach") && i + 1 < argc)
+			attachName = argv[++i];
+		else if (!std::strcmp(argv[i], "--threads") && i + 1 < argc)
+			numberOfThreads = std::atoi(argv[++i]);
+		else if (!std::strcmp(argv[i], "--weld-bench") && i + 1 < argc)
+			weldBenchmarkValue = std::atof(argv[++i]);
+		else if (!std::strcmp(argv[i], "--keep-largest") && i + 1 < argc)
+			largestComponents = std::atoi(argv[++i]);
+		else if (!std::strcmp(argv[i], "--min-component") && i + 1 < argc)
+			minimumComponentCells = std::atol(argv[++i]);
+		else if (!std::strcmp(argv[i], "--lod") && i + 1 < argc)
+			lodDivisions = std::atoi(argv[++i]);
+		else if (!std::strcmp(argv[i], "--export") && i + 1 < argc) {
+			std::istringstream list(argv[++i]);
+			std::string item;
+			while (std::getline(list, item, ','))
+				exportFiles.push_back(item);
+		}
+		else if (!std::strcmp(argv[i], "--build-atlas"))
+			buildAtlas = true;
+		else if (!std::strcmp(argv[i], "--atlas"))
+			useAtlas = true;
+		else if (!std::strcmp(argv[i], "--view-dependent"))
+			viewDependentSurface = true;
+		else if (!std::strcmp(argv[i], "--contour-tree") && i + 1 < argc)
+			contourFeatures = std::atoi(argv[++i]);
+		else if (!std::strcmp(argv[i], "--iso") && i + 1 < argc) {
+			isoValues.clear();
+			std::istringstream list(argv[++i]);
+			std::string item;
+			while (std::getline(list, item, ','))
+				isoValues.push_back(std::atof(item.c_str()));
+			if (isoValues.empty())
+				isoValues.push_back(500.0);
+		}
+		else
+			std::cerr << "unknown option " << argv[i] << std::endl;
+	}
+
+	tracker.SetEnabled(trackObjects);
+
+	// execution trace of all filters and renders, switched off unless requested
+	PipelineTrace trace;
+	trace.SetEnabled(!traceFile.empty());
+	if (traceFile.empty())
+		traceFile = "assignment5-trace.json";
+
+	// statistics overlay, shown with 'h'
+	vtkSmartPointer<StatisticsHud> hud = vtkSmartPointer<StatisticsHud>::New();
+
+	const std::string volumeFileName = "../data/headsq-half.vti";
 	vtkSmartPointer<vtkXMLImageDataReader> source = vtkSmartPointer<vtkXMLImageDataReader>::New();
-	source->SetFileName("../data/headsq-half.vti");
-	source->Update();
+	source->SetFileName(volumeFileName.c_str());
+	trace.AddFilter(source);
+	hud->AddFilter(source, "volume reader");
+
+	if (!publishName.empty())
+		return runImagePublisher(source, publishName, std::cout);
+
+	// the pipeline starts at the reader or at a volume published by a loader process
+	vtkSmartPointer<vtkAlgorithm> volume = source;
+	std::string volumeName = "volume reader";
+	if (!attachName.empty()) {
+		if (!sharedVolume.Attach(attachName)) {
+			std::cerr << "no published volume " << attachName << std::endl;
+			return 1;
+		}
+		sharedVolume.PrintInformation(std::cout);
+		vtkSmartPointer<vtkTrivialProducer> producer = vtkSmartPointer<vtkTrivialProducer>::New();
+		producer->SetOutput(sharedVolume.GetImage());
+		volume = producer;
+		volumeName = "shared volume";
+	}
+
+	if (weldBenchmarkValue >= 0.0) {
+		volume->Update();
+		runWeldingBenchmark(vtkImageData::SafeDownCast(volume->GetOutputDataObject(0)), volumeName, weldBenchmarkValue,
+			numberOfThreads, std::cout);
+		return 0;
+	}
+
+	// the atlas is built once per volume file, its extraction is compared with the iso values of --iso and a sweep
+	// over the value range
+	const std::string atlasFileName = IsoSurfaceAtlas::GetFileName(volumeFileName);
+	vtkSmartPointer<IsoSurfaceAtlas> atlas = vtkSmartPointer<IsoSurfaceAtlas>::New();
+	atlas->SetNumberOfThreads(numberOfThreads);
+	if (buildAtlas) {
+		volume->Update();
+		vtkImageData *image = vtkImageData::SafeDownCast(volume->GetOutputDataObject(0));
+		if (!atlas->Build(image) || !atlas->Write(atlasFileName))
+			return 1;
+		std::cout << "wrote " << atlasFileName << " in " << atlas->GetLastBuildTime() * 1000.0 << " ms" << std::endl;
+		std::vector<double> values(isoValues);
+		double range[2];
+		image->GetScalarRange(range);
+		for (int q = 1; q < 8; ++q)
+			values.push_back(range[0] + q * (range[1] - range[0]) / 8.0);
+		runAtlasBenchmark(image, atlas, volumeName, values, numberOfThreads, std::cout);
+		return 0;
+	}
+
+	if (!comparisonViews.empty()) {
+		volume->Update();
+		vtkImageData *image = vtkImageData::SafeDownCast(volume->GetOutputDataObject(0));
+		int result = runComparison(image, attachName.empty() ? nullptr : &sharedVolume, comparisonViews, cameraPath, batchPrefix, trace, hud, tracker);
+		writeTrace(trace, traceFile);
+		return result;
+	}
 
 	// Task 5.2
 
 	// visualize volume directly:
 	// * create a vtkSmartVolumeMapper that gets its input from the source
 	vtkSmartPointer<vtkSmartVolumeMapper> volMapper = vtkSmartPointer<vtkSmartVolumeMapper>::New();
-	volMapper->SetInputConnection(source->GetOutputPort());
+	volMapper->SetInputConnection(volume->GetOutputPort());
 
 	// * enable GPU rendering and set the appropriate volume blending
 	volMapper->SetRequestedRenderModeToGPU();
@@ -151,19 +428,104 @@ int main()
 	
 	// visualize volume via isosurfaces:
 	// * generate polygon data from the volume dataset by using a vtkMarchingCubes filter
-	vtkSmartPointer<vtkMarchingCubes> skinExtractor = vtkSmartPointer<vtkMarchingCubes>::New();
-	skinExtractor->SetInputConnection(source->GetOutputPort());
+	// The multithreaded variant welds the vertices by lattice edge id instead of a point locator, same surface.
+	vtkSmartPointer<WeldedMarchingCubes> skinExtractor = vtkSmartPointer<WeldedMarchingCubes>::New();
+	skinExtractor->SetInputConnection(volume->GetOutputPort());
+	skinExtractor->SetNumberOfThreads(numberOfThreads);
+	trace.AddFilter(skinExtractor);
+	hud->AddFilter(skinExtractor, "iso surface");
 
 	// * set number of contours to one, set scalar value of that contour to something meaningful
 	// An isosurface, or contour value of 500 is known to correspond to the skin of the patient.
-	skinExtractor->SetValue(0, 500);
+	// Further values of --iso (e.g. 1150 for bone) go to the next output ports of the same filter.
+	for (size_t s = 0; s < isoValues.size(); ++s)
+		skinExtractor->SetValue(static_cast<int>(s), isoValues[s]);
+
+	// the slider streams the active cells of its value from the atlas, while it was built from the same voxels
+	if (useAtlas) {
+		volume->Update();
+		if (atlas->Read(atlasFileName) && atlas->Matches(vtkImageData::SafeDownCast(volume->GetOutputDataObject(0)))) {
+			skinExtractor->SetAtlas(atlas);
+			std::cout << "iso surface atlas " << atlasFileName << ": " << atlas->GetSize() / 1048576.0 << " MB, "
+				<< atlas->GetNumberOfCells() << " cells" << std::endl;
+		}
+		else
+			std::cerr << "no atlas of this volume in " << atlasFileName << ", run with --build-atlas" << std::endl;
+	}
+
+	// batch export, only the iso surfaces are needed
+	if (!exportFiles.empty()) {
+		skinExtractor->Update();
+		bool exported = true;
+		for (size_t s = 0; s < isoValues.size(); ++s)
+			for (const std::string& file : exportFiles) {
+				std::string name = file;
+				const size_t dot = name.rfind('.');
+				if (s > 0 && dot != std::string::npos)
+					name.insert(dot, "-" + std::to_string(s + 1));
+				exported &= exportSurface(skinExtractor->GetOutput(static_cast<int>(s)), name, numberOfThreads, std::cout);
+			}
+		return exported ? 0 : 1;
+	}
 
 	// * manually update the Marching Cubes filter aftwerwards via Update() method to apply the contour value
-	skinExtractor->Update();
+	// The volume is read once, then the iso surface is extracted on its own shallow copy of the volume. The volume
+	// mapper stays connected to the reader, it does no work before the first render (which uploads the volume).
+	BranchExecutor setup(volume, volumeName);
+	setup.AddBranch(skinExtractor, "iso surface");
+	setup.Update(&trace);
+	std::cout << "scene setup:" << std::endl;
+	setup.GetTaskGraph().PrintSummary(std::cout);
+
+	// the contour tree of the volume for the significant iso values and the components of single tree arcs
+	vtkSmartPointer<ContourTree> contourTree;
+	if (contourFeatures > 0) {
+		contourTree = vtkSmartPointer<ContourTree>::New();
+		contourTree->SetNumberOfThreads(numberOfThreads);
+		if (contourTree->Build(vtkImageData::SafeDownCast(volume->GetOutputDataObject(0)))) {
+			contourTree->Simplify(contourFeatures);
+			contourTree->PrintStatistics(std::cout);
+		}
+		else
+			contourTree = nullptr;
+	}
+
+	// optionally every surface without its small fragments and smoothed, the filters run after the extraction of each
+	// slider value. The first surface also gets a component filter for the arcs of the contour tree
+	std::vector<vtkAlgorithmOutput*> surfacePorts;
+	std::vector<vtkSmartPointer<ParallelWindowedSinc>> smoothers;
+	vtkSmartPointer<SurfaceComponentFilter> arcComponents;
+	for (size_t s = 0; s < isoValues.size(); ++s) {
+		surfacePorts.push_back(skinExtractor->GetOutputPort(static_cast<int>(s)));
+		const std::string suffix = isoValues.size() > 1 ? " " + std::to_string(s + 1) : "";
+		if (largestComponents > 0 || minimumComponentCells > 1 || (s == 0 && contourTree)) {
+			vtkSmartPointer<SurfaceComponentFilter> components = vtkSmartPointer<SurfaceComponentFilter>::New();
+			components->SetInputConnection(surfacePorts[s]);
+			components->SetLargestComponents(largestComponents);
+			components->SetMinimumCells(minimumComponentCells);
+			components->SetNumberOfThreads(numberOfThreads);
+			components->Update();
+			components->PrintStatistics(std::cout);
+			trace.AddFilter(components);
+			hud->AddFilter(components, "components" + suffix);
+			surfacePorts[s] = components->GetOutputPort();
+			if (s == 0)
+				arcComponents = components;
+		}
+		if (lodDivisions > 0) {
+			vtkSmartPointer<ParallelWindowedSinc> smoother = vtkSmartPointer<ParallelWindowedSinc>::New();
+			smoother->SetInputConnection(surfacePorts[s]);
+			smoother->SetNumberOfThreads(numberOfThreads);
+			trace.AddFilter(smoother);
+			hud->AddFilter(smoother, "smoothing" + suffix);
+			surfacePorts[s] = smoother->GetOutputPort();
+			smoothers.push_back(smoother);
+		}
+	}
 
 	// * create vtkDataSetMapper and set input connection, don't use scalars for coloring (set scalar visibility to false)
 	vtkSmartPointer<vtkDataSetMapper> skinMapper = vtkSmartPointer<vtkDataSetMapper>::New();
-	skinMapper->SetInputConnection(skinExtractor->GetOutputPort());
+	skinMapper->SetInputConnection(surfacePorts[0]);
 	skinMapper->ScalarVisibilityOff();
 
 	// * create vtkActor and set mapper as input
@@ -173,6 +535,37 @@ int main()
 	// * assign actor to existing renderer
 	renderer->AddActor(skinActor);
 
+	// one actor per further surface, with several surfaces the outer ones are translucent to show the inner ones
+	std::vector<vtkSmartPointer<vtkActor>> surfaceActors(1, skinActor);
+	for (size_t s = 1; s < isoValues.size(); ++s) {
+		vtkSmartPointer<vtkDataSetMapper> mapper = vtkSmartPointer<vtkDataSetMapper>::New();
+		mapper->SetInputConnection(surfacePorts[s]);
+		mapper->ScalarVisibilityOff();
+		vtkSmartPointer<vtkActor> actor = vtkSmartPointer<vtkActor>::New();
+		actor->SetMapper(mapper);
+		renderer->AddActor(actor);
+		surfaceActors.push_back(actor);
+	}
+	if (surfaceActors.size() > 1) {
+		const double surfaceColors[4][3] = { { 0.95, 0.75, 0.65 }, { 0.95, 0.95, 0.85 }, { 0.65, 0.8, 1.0 }, { 0.7, 1.0, 0.7 } };
+		for (size_t s = 0; s < surfaceActors.size(); ++s) {
+			surfaceActors[s]->GetProperty()->SetColor(surfaceColors[s % 4][0], surfaceColors[s % 4][1], surfaceColors[s % 4][2]);
+			surfaceActors[s]->GetProperty()->SetOpacity(s + 1 < surfaceActors.size() ? 0.35 : 1.0);
+		}
+	}
+	trace.AddRenderWindow(window);
+	tracker.TrackScene(window);
+	tracker.Track(volume, volumeName);
+
+	// headless batch mode, the volume is read once and only the iso value of every keyframe is applied
+	if (!cameraPath.empty()) {
+		renderCameraPath(window, cameraPath, batchPrefix, [&](const CameraKeyframe& keyframe) {
+			skinExtractor->SetValue(0, keyframe.isoValue);
+		}, std::cout);
+		writeTrace(trace, traceFile);
+		return 0;
+	}
+
 
 
 
@@ -203,6 +596,10 @@ int main()
 	// * create a vtkRenderWindowInteractor and assign a rendering window 
 	vtkSmartPointer<vtkRenderWindowInteractor> interactor = vtkSmartPointer<vtkRenderWindowInteractor>::New();
 	interactor->SetRenderWindow(window);
+
+	// slider and camera events are coalesced to one extraction and render per display interval
+	vtkSmartPointer<InteractionScheduler> scheduler = vtkSmartPointer<InteractionScheduler>::New();
+	scheduler->Attach(interactor, window);
 	
 	// * create a new vtkSliderWidget and assign the previous interactor and representation to it
 	vtkSmartPointer<vtkSliderWidget> sliderWidget = vtkSmartPointer<vtkSliderWidget>::New();
@@ -222,12 +619,152 @@ int main()
 
 	// * assign the Marching Cubes data
 	callback->isoSurface = skinExtractor;
+	callback->scheduler = scheduler;
 	
+	// 'v' switches the first surface to bricks inside the view frustum, coarser with the distance
+	vtkSmartPointer<ViewDependentSurface> viewDependent = vtkSmartPointer<ViewDependentSurface>::New();
+	viewDependent->NumberOfThreads = numberOfThreads;
+	viewDependent->wholeSurface = skinExtractor;
+	viewDependent->wholeActor = skinActor;
+	viewDependent->scheduler = scheduler;
+	viewDependent->Attach(renderer, interactor, vtkImageData::SafeDownCast(volume->GetOutputDataObject(0)));
+	viewDependent->SetEnabled(viewDependentSurface);
+	callback->viewDependent = viewDependent;
+
 	// * assign the callback object to the slider via AddObserver(vtkCommand::InteracationEvent, ptrToCallback);
 	sliderWidget->AddObserver(vtkCommand::InteractionEvent, callback);
 
+	// '[' and ']' move the slider along the significant iso values, 'k' shows the component of one contour tree arc
+	vtkSmartPointer<ContourTreeNavigator> navigator = vtkSmartPointer<ContourTreeNavigator>::New();
+	// the navigator holds the tree from here on, so that a rebuild frees the tree before
+	const bool navigateContourTree = contourTree != nullptr;
+	if (navigateContourTree) {
+		navigator->tree = contourTree;
+		contourTree = nullptr;
+		navigator->components = arcComponents;
+		navigator->scheduler = scheduler;
+		navigator->NumberOfThreads = numberOfThreads;
+		navigator->Attach(renderer, interactor, sliderWidget);
+	}
+
+	// one more slider above the first one for every further surface
+	std::vector<vtkSmartPointer<vtkSliderWidget>> surfaceSliders;
+	for (size_t s = 1; s < isoValues.size(); ++s) {
+		vtkSmartPointer<vtkSliderRepresentation2D> representation = vtkSmartPointer<vtkSliderRepresentation2D>::New();
+		representation->SetMinimumValue(0.0);
+		representation->SetMaximumValue(4100.0);
+		representation->SetValue(isoValues[s]);
+		representation->GetPoint1Coordinate()->SetCoordinateSystemToDisplay();
+		representation->GetPoint1Coordinate()->SetValue(100, 100 + 60 * static_cast<double>(s));
+		representation->GetPoint2Coordinate()->SetCoordinateSystemToDisplay();
+		representation->GetPoint2Coordinate()->SetValue(300, 100 + 60 * static_cast<double>(s));
+		representation->SetTitleText(("Iso Value " + std::to_string(s + 1)).c_str());
+		representation->SetLabelFormat("%0.1f");
+
+		vtkSmartPointer<vtkSliderWidget> widget = vtkSmartPointer<vtkSliderWidget>::New();
+		widget->SetInteractor(interactor);
+		widget->SetRepresentation(representation);
+		widget->SetAnimationModeToAnimate();
+		widget->EnabledOn();
+
+		vtkSmartPointer<IsoSliderCallback> surfaceCallback = vtkSmartPointer<IsoSliderCallback>::New();
+		surfaceCallback->isoSurface = skinExtractor;
+		surfaceCallback->scheduler = scheduler;
+		surfaceCallback->index = static_cast<int>(s);
+		widget->AddObserver(vtkCommand::InteractionEvent, surfaceCallback);
+		surfaceSliders.push_back(widget);
+	}
+
+	// the smoothed surfaces while still, vertex clustered copies of them while the camera moves
+	vtkSmartPointer<LevelOfDetailSwitch> lodSwitch = vtkSmartPointer<LevelOfDetailSwitch>::New();
+	for (size_t s = 0; s < smoothers.size(); ++s) {
+		vtkSmartPointer<ParallelVertexClustering> decimation = vtkSmartPointer<ParallelVertexClustering>::New();
+		decimation->SetInputConnection(smoothers[s]->GetOutputPort());
+		decimation->SetNumberOfDivisions(lodDivisions);
+		decimation->SetNumberOfThreads(numberOfThreads);
+		decimation->Update();
+		trace.AddFilter(decimation);
+		hud->AddFilter(decimation, isoValues.size() > 1 ? "decimation " + std::to_string(s + 1) : "decimation");
+		std::cout << "surface " << s + 1 << ": smoothing " << smoothers[s]->GetOutput()->GetNumberOfPolys() << " triangles in "
+			<< 1000.0 * (smoothers[s]->GetLastIndexTime() + smoothers[s]->GetLastSmoothTime()) << " ms, level of detail "
+			<< decimation->GetOutput()->GetNumberOfPolys() << " triangles in " << 1000.0 * decimation->GetLastExecuteTime()
+			<< " ms" << std::endl;
+
+		vtkSmartPointer<vtkPolyDataMapper> lodMapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+		lodMapper->SetInputConnection(decimation->GetOutputPort());
+		lodMapper->ScalarVisibilityOff();
+		lodSwitch->AddActor(surfaceActors[s], surfaceActors[s]->GetMapper(), lodMapper);
+	}
+	if (!smoothers.empty())
+		lodSwitch->Attach(window, interactor);
+
+	// 'l' starts and stops the trace
+	vtkSmartPointer<TraceToggleCallback> traceCallback = vtkSmartPointer<TraceToggleCallback>::New();
+	traceCallback->trace = &trace;
+	interactor->AddObserver(vtkCommand::KeyPressEvent, traceCallback);
+
+	hud->Attach(window, renderer, interactor);
+
+	// 'b' shows a crop box, iso surfaces are extracted and the volume is ray cast only inside it
+	vtkSmartPointer<CropBox> cropBox = vtkSmartPointer<CropBox>::New();
+	cropBox->extractor = skinExtractor;
+	cropBox->volumeMapper = volMapper;
+	cropBox->scheduler = scheduler;
+	cropBox->Attach(interactor, vtkImageData::SafeDownCast(volume->GetOutputDataObject(0)));
+
+	// 'm' shows the voxel and the iso surface under the mouse cursor
+	vtkSmartPointer<VoxelProbe> probe = vtkSmartPointer<VoxelProbe>::New();
+	probe->extractor = skinExtractor;
+	probe->viewDependent = viewDependent;
+	probe->cropBox = cropBox;
+	probe->scheduler = scheduler;
+	probe->NumberOfThreads = numberOfThreads;
+	probe->SetVolume(vtkImageData::SafeDownCast(volume->GetOutputDataObject(0)));
+	probe->Attach(renderer, interactor);
+
+	// an attached volume follows its loader, surface and mapper input are updated again on the republished voxels
+	vtkSmartPointer<SharedImageWatcher> volumeWatcher = vtkSmartPointer<SharedImageWatcher>::New();
+	if (!attachName.empty()) {
+		volumeWatcher->view = &sharedVolume;
+		volumeWatcher->update = [&](SharedImageView::Change change) {
+			// the atlas indexes the voxels it was built from, other voxels are extracted by marching cubes again
+			if (skinExtractor->GetAtlas()) {
+				volume->Update();
+				if (!atlas->Matches(vtkImageData::SafeDownCast(volume->GetOutputDataObject(0)))) {
+					skinExtractor->SetAtlas(nullptr);
+					std::cerr << "the attached volume changed, iso surface atlas " << atlasFileName << " no longer used" << std::endl;
+				}
+			}
+			setup.Update(&trace);
+			probe->SetVolume(vtkImageData::SafeDownCast(volume->GetOutputDataObject(0)));
+			viewDependent->SetVolume(vtkImageData::SafeDownCast(volume->GetOutputDataObject(0)));
+			// the tree of the volume before does not fit the new voxels, the new one is built off the render thread
+			// and the navigator stays without a tree if that Build fails
+			if (navigateContourTree)
+				navigator->Rebuild(vtkImageData::SafeDownCast(volume->GetOutputDataObject(0)), contourFeatures);
+			interactor->Render();
+		};
+		volumeWatcher->Attach(interactor);
+	}
+
+	// 'x' writes the current iso surfaces to PLY, STL and glTF
+	vtkSmartPointer<SurfaceExportCallback> exportCallback = vtkSmartPointer<SurfaceExportCallback>::New();
+	exportCallback->extractor = skinExtractor;
+	exportCallback->NumberOfThreads = numberOfThreads;
+	interactor->AddObserver(vtkCommand::KeyPressEvent, exportCallback);
+
+	// 'o' prints the live objects
+	vtkSmartPointer<ObjectReportCallback> objectCallback = vtkSmartPointer<ObjectReportCallback>::New();
+	objectCallback->tracker = &tracker;
+	objectCallback->window = window;
+	interactor->AddObserver(vtkCommand::KeyPressEvent, objectCallback);
+
 	// * finally you can then use the version of doRenderingAndInteraction that accepts an interactor object.
 	doRenderingAndInteraction(interactor, window);
+	scheduler->PrintStatistics(std::cout);
+	probe->PrintStatistics(std::cout);
 
+	tracker.TrackScene(window);
+	writeTrace(trace, traceFile);
 	return 0;
 }
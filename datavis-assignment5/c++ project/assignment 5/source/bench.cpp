@@ -0,0 +1,199 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+// Micro-benchmarks of the stages of the volume pipeline: VTI read and decode, marching cubes per iso value (with
+// point locator, edge welded and from an iso surface atlas), removal of the small surface components, smoothing and decimation of the skin,
+// the contour tree and its simplification, and a volume rendered frame, on headsq-half.vti and on resampled copies scaled up per axis.
+// The contour tree is also measured on the head phantom of datagen with 128 points per side and scale, so a scale
+// of 4 gives a 512^3 volume.
+//
+// usage: bench [--repetitions n] [--warmup n] [--scales 2,3] [--output results.csv]
+//              [--baseline baseline.csv] [--threshold 0.1]
+//
+
+#include <vtkAutoInit.h>
+VTK_MODULE_INIT(vtkRenderingOpenGL2);
+VTK_MODULE_INIT(vtkRenderingVolumeOpenGL2);
+
+#include "microbench.h"
+#include "comparisonviews.h"
+#include "weldedcubes.h"
+#include "surfacecomponents.h"
+#include "surfacelod.h"
+#include "isoatlas.h"
+#include "contourtree.h"
+#include "syntheticdata.h"
+
+#include <vtkSmartPointer.h>
+#include <vtkXMLImageDataReader.h>
+#include <vtkImageData.h>
+#include <vtkImageResize.h>
+#include <vtkMarchingCubes.h>
+#include <vtkSmartVolumeMapper.h>
+#include <vtkVolumeProperty.h>
+#include <vtkVolume.h>
+#include <vtkRenderer.h>
+#include <vtkRenderWindow.h>
+#include <vtkCamera.h>
+
+#include <iostream>
+#include <sstream>
+#include <limits>
+
+// the contour tree of a volume on all hardware threads, its simplification to the features of the iso value slider
+static void benchmarkContourTree(MicroBenchmark& bench, vtkImageData *volume, const std::string& input)
+{
+	const double voxels = static_cast<double>(volume->GetNumberOfPoints());
+	vtkSmartPointer<ContourTree> contourTree = vtkSmartPointer<ContourTree>::New();
+	bench.Run("contour tree", input, voxels,
+		[&]() { contourTree->Build(volume); });
+	contourTree->PrintStatistics(std::cout);
+	bench.Run("contour tree simplify 12", input, voxels,
+		[&]() { contourTree->Simplify(12); },
+		[&]() { contourTree->Simplify(std::numeric_limits<int>::max()); });
+}
+
+// marching cubes per iso value and a volume rendered frame of one volume
+static void benchmarkVolume(MicroBenchmark& bench, vtkImageData *volume, const std::string& input)
+{
+	const double voxels = static_cast<double>(volume->GetNumberOfPoints());
+
+	const double isoValues[] = { 500, 1150 };
+	for (int v = 0; v < 2; ++v) {
+		vtkSmartPointer<vtkMarchingCubes> isoSurface = vtkSmartPointer<vtkMarchingCubes>::New();
+		isoSurface->SetInputData(volume);
+		isoSurface->SetValue(0, isoValues[v]);
+		std::ostringstream stage;
+		stage << "marching cubes " << isoValues[v];
+		bench.Run(stage.str(), input, voxels,
+			[&]() { isoSurface->Update(); },
+			[&]() { isoSurface->Modified(); });
+
+		vtkSmartPointer<WeldedMarchingCubes> weldedSurface = vtkSmartPointer<WeldedMarchingCubes>::New();
+		weldedSurface->SetInputData(volume);
+		weldedSurface->SetValue(0, isoValues[v]);
+		bench.Run("welded " + stage.str(), input, voxels,
+			[&]() { weldedSurface->Update(); },
+			[&]() { weldedSurface->Modified(); });
+	}
+
+	// the skin from the active cells of an atlas, built once outside of the measurement
+	vtkSmartPointer<IsoSurfaceAtlas> atlas = vtkSmartPointer<IsoSurfaceAtlas>::New();
+	atlas->Build(volume);
+	vtkSmartPointer<WeldedMarchingCubes> atlasSurface = vtkSmartPointer<WeldedMarchingCubes>::New();
+	atlasSurface->SetInputData(volume);
+	atlasSurface->SetValue(0, isoValues[0]);
+	atlasSurface->SetAtlas(atlas);
+	bench.Run("atlas marching cubes 500", input, voxels,
+		[&]() { atlasSurface->Update(); },
+		[&]() { atlasSurface->Modified(); });
+
+	// the skin without its noise fragments, the labelling and compaction of the extracted surface
+	vtkSmartPointer<WeldedMarchingCubes> skin = vtkSmartPointer<WeldedMarchingCubes>::New();
+	skin->SetInputData(volume);
+	skin->SetValue(0, isoValues[0]);
+	skin->Update();
+	vtkSmartPointer<SurfaceComponentFilter> largestComponent = vtkSmartPointer<SurfaceComponentFilter>::New();
+	largestComponent->SetInputData(skin->GetOutput());
+	largestComponent->SetLargestComponents(1);
+	bench.Run("surface components 500", input, voxels,
+		[&]() { largestComponent->Update(); },
+		[&]() { largestComponent->Modified(); });
+
+	// the post-processing of the interactive level of detail, smoothing with buffers reused between the repetitions
+	vtkSmartPointer<ParallelWindowedSinc> smoother = vtkSmartPointer<ParallelWindowedSinc>::New();
+	smoother->SetInputData(skin->GetOutput());
+	bench.Run("windowed sinc 500", input, voxels,
+		[&]() { smoother->Update(); },
+		[&]() { smoother->Modified(); });
+	vtkSmartPointer<ParallelVertexClustering> decimation = vtkSmartPointer<ParallelVertexClustering>::New();
+	decimation->SetInputData(skin->GetOutput());
+	bench.Run("vertex clustering 500", input, voxels,
+		[&]() { decimation->Update(); },
+		[&]() { decimation->Modified(); });
+
+	// both surfaces in one traversal, compare with the sum of the two single value stages
+	vtkSmartPointer<WeldedMarchingCubes> bothSurfaces = vtkSmartPointer<WeldedMarchingCubes>::New();
+	bothSurfaces->SetInputData(volume);
+	bothSurfaces->SetValue(0, isoValues[0]);
+	bothSurfaces->SetValue(1, isoValues[1]);
+	bench.Run("welded marching cubes 500+1150", input, voxels,
+		[&]() { bothSurfaces->Update(); },
+		[&]() { bothSurfaces->Modified(); });
+
+	benchmarkContourTree(bench, volume, input);
+
+	// the warm-up frames upload the volume, the timed frames only render from a new camera position
+	vtkSmartPointer<vtkSmartVolumeMapper> mapper = vtkSmartPointer<vtkSmartVolumeMapper>::New();
+	mapper->SetInputData(volume);
+	mapper->SetRequestedRenderModeToGPU();
+	mapper->SetBlendModeToComposite();
+
+	vtkSmartPointer<vtkVolumeProperty> property = vtkSmartPointer<vtkVolumeProperty>::New();
+	applyTransferFunctionPreset("skin", property);
+
+	vtkSmartPointer<vtkVolume> actor = vtkSmartPointer<vtkVolume>::New();
+	actor->SetMapper(mapper);
+	actor->SetProperty(property);
+
+	vtkSmartPointer<vtkRenderer> renderer = vtkSmartPointer<vtkRenderer>::New();
+	renderer->AddVolume(actor);
+	renderer->ResetCamera();
+
+	vtkSmartPointer<vtkRenderWindow> window = vtkSmartPointer<vtkRenderWindow>::New();
+	window->OffScreenRenderingOn();
+	window->SetSize(1000, 600);
+	window->AddRenderer(renderer);
+
+	bench.Run("volume render frame", input, voxels,
+		[&]() { window->Render(); },
+		[&]() { renderer->GetActiveCamera()->Azimuth(10); });
+	window->Finalize();
+}
+
+int main(int argc, char * argv[])
+{
+	BenchmarkOptions options;
+	options.scales.push_back(2);
+	if (!parseBenchmarkOptions(argc, argv, options))
+		return 1;
+	MicroBenchmark bench(options);
+
+	// the bundled volume, every repetition reads and decodes the file again
+	vtkSmartPointer<vtkXMLImageDataReader> reader = vtkSmartPointer<vtkXMLImageDataReader>::New();
+	reader->SetFileName("../data/headsq-half.vti");
+	reader->Update();
+	if (reader->GetOutput()->GetNumberOfPoints() == 0) {
+		std::cerr << "could not read ../data/headsq-half.vti" << std::endl;
+		return 1;
+	}
+	bench.Run("VTI read/decode", "headsq-half.vti", static_cast<double>(reader->GetOutput()->GetNumberOfPoints()),
+		[&]() { reader->Update(); },
+		[&]() { reader->Modified(); });
+	benchmarkVolume(bench, reader->GetOutput(), "headsq-half.vti");
+
+	// trilinear resampling to the scaled resolution, a scale of 2 has 8 times the voxels
+	for (size_t s = 0; s < options.scales.size(); ++s) {
+		vtkSmartPointer<vtkImageResize> resize = vtkSmartPointer<vtkImageResize>::New();
+		resize->SetInputData(reader->GetOutput());
+		resize->SetResizeMethodToMagnificationFactors();
+		resize->SetMagnificationFactors(options.scales[s], options.scales[s], options.scales[s]);
+		resize->InterpolateOn();
+		resize->Update();
+
+		int dims[3];
+		resize->GetOutput()->GetDimensions(dims);
+		std::ostringstream input;
+		input << "headsq x" << options.scales[s] << " (" << dims[0] << "x" << dims[1] << "x" << dims[2] << ")";
+		benchmarkVolume(bench, resize->GetOutput(), input.str());
+
+		// the phantom is generated once per scale, outside of the measurement
+		const int size = static_cast<int>(128 * options.scales[s]);
+		vtkSmartPointer<vtkImageData> phantom = createHeadPhantom(size, size, size, 1);
+		std::ostringstream phantomInput;
+		phantomInput << "phantom (" << size << "x" << size << "x" << size << ")";
+		benchmarkContourTree(bench, phantom, phantomInput.str());
+	}
+
+	return bench.Finish(std::cout);
+}
@@ -0,0 +1,242 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+
+#include "comparisonviews.h"
+
+#include <vtkCommand.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkActor.h>
+#include <vtkVolume.h>
+#include <vtkPiecewiseFunction.h>
+#include <vtkColorTransferFunction.h>
+#include <vtkTextActor.h>
+#include <vtkTextProperty.h>
+#include <vtkTimerLog.h>
+
+#include <sstream>
+#include <iomanip>
+#include <thread>
+#include <cmath>
+#include <cstdlib>
+
+bool applyTransferFunctionPreset(const std::string& preset, vtkVolumeProperty *property)
+{
+	vtkSmartPointer<vtkPiecewiseFunction> opacity = vtkSmartPointer<vtkPiecewiseFunction>::New();
+	vtkSmartPointer<vtkColorTransferFunction> color = vtkSmartPointer<vtkColorTransferFunction>::New();
+
+	if (preset == "skin") {
+		// the transfer function of the single view
+		opacity->AddPoint(-3024, 0, 0.5, 0.0);
+		opacity->AddPoint(-16, 0, .49, .61);
+		opacity->AddPoint(3071, .71, 0.5, 0.0);
+		color->AddRGBPoint(-3024, 0, 0, 0, 0.5, 0.0);
+		color->AddRGBPoint(-16, 0.73, 0.25, 0.30, 0.49, .61);
+		color->AddRGBPoint(641, .90, .82, .56, .5, 0.0);
+		color->AddRGBPoint(3071, 1, 1, 1, .5, 0.0);
+	}
+	else if (preset == "bone") {
+		opacity->AddPoint(0, 0);
+		opacity->AddPoint(1100, 0);
+		opacity->AddPoint(1300, 0.3);
+		opacity->AddPoint(2500, 0.9);
+		color->AddRGBPoint(0, 0, 0, 0);
+		color->AddRGBPoint(1100, 0.55, 0.45, 0.35);
+		color->AddRGBPoint(2500, 1.0, 0.98, 0.9);
+	}
+	else if (preset == "muscle") {
+		opacity->AddPoint(0, 0);
+		opacity->AddPoint(400, 0);
+		opacity->AddPoint(700, 0.15);
+		opacity->AddPoint(1000, 0.05);
+		opacity->AddPoint(1200, 0);
+		color->AddRGBPoint(0, 0, 0, 0);
+		color->AddRGBPoint(500, 0.6, 0.1, 0.1);
+		color->AddRGBPoint(1000, 0.95, 0.5, 0.4);
+	}
+	else
+		return false;
+
+	property->SetScalarOpacity(opacity);
+	property->SetColor(color);
+	property->SetInterpolationType(VTK_LINEAR_INTERPOLATION);
+	property->ShadeOn();
+	return true;
+}
+
+bool parseComparisonViews(const std::string& specification, std::vector<ComparisonView>& views)
+{
+	views.clear();
+	std::istringstream list(specification);
+	std::string item;
+	while (std::getline(list, item, ',')) {
+		if (item.empty())
+			continue;
+
+		ComparisonView view;
+		char *end = nullptr;
+		view.isoValue = std::strtod(item.c_str(), &end);
+		if (end && *end == '\0') {
+			std::ostringstream label;
+			label << "iso " << item;
+			view.label = label.str();
+		}
+		else {
+			vtkSmartPointer<vtkVolumeProperty> probe = vtkSmartPointer<vtkVolumeProperty>::New();
+			if (!applyTransferFunctionPreset(item, probe))
+				return false;
+			view.isoValue = 0.0;
+			view.preset = item;
+			view.label = item;
+		}
+		views.push_back(view);
+	}
+	return !views.empty();
+}
+
+// ----- transfer function switching -----
+// The volume views share one mapper. It rebuilds its transfer function tables when their modification time is newer
+// than the last build, so the tables of a view are marked modified before its renderer draws. Only the small 1D
+// tables are uploaded again, the volume texture stays.
+class TransferFunctionRefresh : public vtkCommand {
+private:
+	TransferFunctionRefresh() {}
+
+public:
+	vtkSmartPointer<vtkVolumeProperty> property;
+
+	static TransferFunctionRefresh *New() { return new TransferFunctionRefresh; }
+
+	virtual void Execute(vtkObject *caller, unsigned long eventId, void *callData) {
+		property->GetRGBTransferFunction()->Modified();
+		property->GetScalarOpacity()->Modified();
+	}
+};
+
+// ----- layout -----
+ComparisonLayout::ComparisonLayout()
+	: lastUpdateTime(0.0)
+{
+}
+
+void ComparisonLayout::Build(vtkRenderWindow *window, const std::vector<ComparisonView>& views)
+{
+	this->views = views;
+	camera = vtkSmartPointer<vtkCamera>::New();
+	volumeMapper = vtkSmartPointer<vtkSmartVolumeMapper>::New();
+	volumeMapper->SetRequestedRenderModeToGPU();
+	volumeMapper->SetBlendModeToComposite();
+
+	size_t volumeViews = 0;
+	for (size_t v = 0; v < views.size(); ++v)
+		if (!views[v].IsIsoSurface())
+			++volumeViews;
+
+	// grid with about as many rows as columns
+	const int columns = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(views.size()))));
+	const int rows = static_cast<int>((views.size() + columns - 1) / columns);
+
+	for (size_t v = 0; v < views.size(); ++v) {
+		const int column = static_cast<int>(v) % columns;
+		const int row = static_cast<int>(v) / columns;
+
+		vtkSmartPointer<vtkRenderer> renderer = vtkSmartPointer<vtkRenderer>::New();
+		renderer->SetViewport(static_cast<double>(column) / columns, 1.0 - static_cast<double>(row + 1) / rows,
+			static_cast<double>(column + 1) / columns, 1.0 - static_cast<double>(row) / rows);
+		renderer->GradientBackgroundOn();
+		renderer->SetBackground(0, 0, 0);
+		renderer->SetBackground2(0.2, 0.2, 0.2);
+		renderer->SetActiveCamera(camera);
+
+		if (views[v].IsIsoSurface()) {
+			IsoSurface surface;
+			surface.input = vtkSmartPointer<vtkImageData>::New();
+			surface.filter = vtkSmartPointer<vtkMarchingCubes>::New();
+			surface.filter->SetInputData(surface.input);
+			surface.filter->SetValue(0, views[v].isoValue);
+			isoSurfaces.push_back(surface);
+
+			vtkSmartPointer<vtkPolyDataMapper> mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+			mapper->SetInputConnection(surface.filter->GetOutputPort());
+			mapper->ScalarVisibilityOff();
+
+			vtkSmartPointer<vtkActor> actor = vtkSmartPointer<vtkActor>::New();
+			actor->SetMapper(mapper);
+			renderer->AddActor(actor);
+		}
+		else {
+			vtkSmartPointer<vtkVolumeProperty> property = vtkSmartPointer<vtkVolumeProperty>::New();
+			applyTransferFunctionPreset(views[v].preset, property);
+			volumeProperties.push_back(property);
+
+			vtkSmartPointer<vtkVolume> volumeActor = vtkSmartPointer<vtkVolume>::New();
+			volumeActor->SetMapper(volumeMapper);
+			volumeActor->SetProperty(property);
+			renderer->AddVolume(volumeActor);
+
+			if (volumeViews > 1) {
+				vtkSmartPointer<TransferFunctionRefresh> refresh = vtkSmartPointer<TransferFunctionRefresh>::New();
+				refresh->property = property;
+				renderer->AddObserver(vtkCommand::StartEvent, refresh);
+			}
+		}
+
+		vtkSmartPointer<vtkTextActor> label = vtkSmartPointer<vtkTextActor>::New();
+		label->SetInput(views[v].label.c_str());
+		label->GetTextProperty()->SetFontSize(16);
+		label->GetPositionCoordinate()->SetCoordinateSystemToNormalizedViewport();
+		label->GetPositionCoordinate()->SetValue(0.03, 0.93);
+		renderer->AddActor2D(label);
+
+		window->AddRenderer(renderer);
+		renderers.push_back(renderer);
+	}
+}
+
+void ComparisonLayout::SetVolume(vtkImageData *volume)
+{
+	bool first = !this->volume;
+	this->volume = volume;
+	volumeMapper->SetInputData(volume);
+
+	// every filter gets its own data object on the same scalar array, so the pipelines do not share any state
+	for (size_t i = 0; i < isoSurfaces.size(); ++i)
+		isoSurfaces[i].input->ShallowCopy(volume);
+
+	vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+	timer->StartTimer();
+	std::vector<std::thread> workers;
+	for (size_t i = 0; i < isoSurfaces.size(); ++i)
+		workers.push_back(std::thread([this, i]() { isoSurfaces[i].filter->Update(); }));
+	for (size_t i = 0; i < workers.size(); ++i)
+		workers[i].join();
+	timer->StopTimer();
+	lastUpdateTime = timer->GetElapsedTime();
+
+	// the camera is shared, fitting it in one renderer fits it in all
+	if (first && !renderers.empty())
+		renderers[0]->ResetCamera(volume->GetBounds());
+}
+
+void ComparisonLayout::PrintMemory(std::ostream& os) const
+{
+	// GetActualMemorySize reports kibibytes, the shallow copies hold the same array and are not counted again
+	os << std::fixed << std::setprecision(2);
+	if (volume)
+		os << "shared volume: " << volume->GetActualMemorySize() / 1024.0 << " MiB" << std::endl;
+
+	double surfaces = 0.0;
+	size_t surface = 0;
+	for (size_t v = 0; v < views.size(); ++v) {
+		if (!views[v].IsIsoSurface()) {
+			os << views[v].label << ": transfer function on the shared volume" << std::endl;
+			continue;
+		}
+		vtkPolyData *output = isoSurfaces[surface++].filter->GetOutput();
+		double memory = output->GetActualMemorySize() / 1024.0;
+		surfaces += memory;
+		os << views[v].label << ": " << output->GetNumberOfPolys() << " triangles, " << memory << " MiB" << std::endl;
+	}
+	os << "all surfaces: " << surfaces << " MiB, parallel update " << 1000.0 * lastUpdateTime << " ms" << std::endl;
+}
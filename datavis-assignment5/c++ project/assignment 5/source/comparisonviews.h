@@ -0,0 +1,76 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+// Side by side comparison of iso values and transfer functions on one volume.
+//
+
+#pragma once
+
+#include <vtkSmartPointer.h>
+#include <vtkImageData.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderer.h>
+#include <vtkCamera.h>
+#include <vtkMarchingCubes.h>
+#include <vtkSmartVolumeMapper.h>
+#include <vtkVolumeProperty.h>
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+/* One viewport of a comparison, either an iso surface or a direct volume rendering with a transfer function preset. */
+struct ComparisonView {
+	std::string label;
+	double isoValue;
+	std::string preset;     // empty for iso surface views
+
+	bool IsIsoSurface() const { return preset.empty(); }
+};
+
+/* Parses a comma separated list of views, numbers are iso values, names are transfer function presets
+   (skin, bone, muscle), e.g. "500,1150,skin,bone". Returns false for an unknown preset. */
+bool parseComparisonViews(const std::string& specification, std::vector<ComparisonView>& views);
+
+/* Sets the opacity and color function of a transfer function preset. Returns false for an unknown name. */
+bool applyTransferFunctionPreset(const std::string& preset, vtkVolumeProperty *property);
+
+/* Grid of viewports in one window, one renderer per view, all looking through the same camera.
+   - all views read the same vtkImageData. The iso surface filters get shallow copies of it, which share the scalar
+     array (no voxel is copied) but give every filter its own pipeline, so they can execute concurrently.
+   - all volume views render through one vtkSmartVolumeMapper, so the volume is uploaded to the GPU once. Every
+     view only has its own vtkVolume and vtkVolumeProperty.
+   So the memory grows by the per-view surfaces only. */
+class ComparisonLayout {
+public:
+	ComparisonLayout();
+
+	/* Creates one renderer per view in the window, arranged in a grid of about equal rows and columns. */
+	void Build(vtkRenderWindow *window, const std::vector<ComparisonView>& views);
+
+	/* Shares the volume with all views and updates the iso surfaces in parallel, one thread per surface. */
+	void SetVolume(vtkImageData *volume);
+
+	/* Wall clock time of the last parallel update in seconds. */
+	double GetLastUpdateTime() const { return lastUpdateTime; }
+
+	/* Prints the memory of the shared volume and of every surface. */
+	void PrintMemory(std::ostream& os) const;
+
+	vtkRenderer *GetRenderer(size_t view) const { return renderers[view]; }
+
+private:
+	struct IsoSurface {
+		vtkSmartPointer<vtkImageData> input;
+		vtkSmartPointer<vtkMarchingCubes> filter;
+	};
+
+	std::vector<ComparisonView> views;
+	std::vector<vtkSmartPointer<vtkRenderer>> renderers;
+	std::vector<IsoSurface> isoSurfaces;
+	std::vector<vtkSmartPointer<vtkVolumeProperty>> volumeProperties;
+	vtkSmartPointer<vtkSmartVolumeMapper> volumeMapper;
+	vtkSmartPointer<vtkCamera> camera;
+	vtkSmartPointer<vtkImageData> volume;
+	double lastUpdateTime;
+};
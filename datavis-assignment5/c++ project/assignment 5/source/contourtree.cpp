@@ -0,0 +1,1668 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+
+#include "contourtree.h"
+#include "volumekernels.h"
+
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkDataArray.h>
+#include <vtkPoints.h>
+#include <vtkCellArray.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataMapper2D.h>
+#include <vtkProperty2D.h>
+#include <vtkCoordinate.h>
+#include <vtkSliderRepresentation2D.h>
+#include <vtkTimerLog.h>
+
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <queue>
+#include <type_traits>
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+	// nodes that left a merge tree for good, with the point of their parent node, -1 at the root. The regular ones,
+	// the pending points and the nodes with one child, stay nodes only if they are nodes of the other tree
+	struct FinalNodes {
+		std::vector<std::pair<uint64_t, int64_t>> nodes;
+		std::vector<std::pair<uint64_t, int64_t>> regular;
+	};
+
+	// a pending point or saddle on the arc below a final node, with its value to sort the points of an arc
+	template <class T> struct ArcPoint {
+		int64_t node;
+		uint64_t point;
+		T value;
+		bool saddle;
+	};
+
+	// a final node with its value and the point of its parent node, later its new index
+	template <class T> struct FinalNode {
+		uint64_t point;
+		int64_t parent;
+		T value;
+	};
+
+	// reduced merge tree of the planes z0 to z1: the nodes in sweep order with the index of their parent node, which
+	// comes later in the sweep, -1 at the root, the children of every node in compressed rows and the number of its
+	// children that are final. The tree also has pending points, to be added as nodes when they are nodes of the
+	// other tree: the nodes of the other tree of a slab that are no nodes of its own, and the nodes dropped by the
+	// merges that the other tree may have. Each has a node before it in the sweep on the path to the root that passes
+	// the point. The saddles spliced out of the tree are kept the same way, the nodes that left it for good are final
+	struct MergeTree {
+		std::vector<uint64_t> vertex;
+		std::vector<int64_t> parent;
+		std::vector<int64_t> childStart;
+		std::vector<int64_t> children;
+		std::vector<int32_t> hidden;
+		std::vector<std::pair<uint64_t, int64_t>> pending;
+		std::vector<std::pair<uint64_t, int64_t>> saddles;
+		std::vector<FinalNodes> final;
+		int z0;
+		int z1;
+	};
+
+	// face neighbours first, then edge neighbours: superlevel sets are connected over the 6 face neighbours,
+	// sublevel sets over all 18. With the same connectivity on both sides the components around an ambiguous face
+	// would form a cycle, with this complementary pair the components on both sides of every value form a tree
+	const int neighbourOffset[18][3] = { { -1, 0, 0 }, { 1, 0, 0 }, { 0, -1, 0 }, { 0, 1, 0 }, { 0, 0, -1 }, { 0, 0, 1 },
+		{ -1, -1, 0 }, { 1, -1, 0 }, { -1, 1, 0 }, { 1, 1, 0 }, { -1, 0, -1 }, { 1, 0, -1 }, { -1, 0, 1 }, { 1, 0, 1 },
+		{ 0, -1, -1 }, { 0, 1, -1 }, { 0, -1, 1 }, { 0, 1, 1 } };
+	const int faceNeighbours = 6;
+	const int edgeNeighbours = 18;
+
+	// the points of a 3x3x3 cube next to each of them, one bit per point, over the face neighbours and over all 18
+	struct CubeAdjacency {
+		uint32_t face[27];
+		uint32_t edge[27];
+
+		CubeAdjacency()
+		{
+			for (int c = 0; c < 27; ++c) {
+				face[c] = edge[c] = 0;
+				for (int e = 0; e < 27; ++e) {
+					int steps = 0, longest = 0;
+					for (int a = 0, f = 1; a < 3; ++a, f *= 3) {
+						const int d = std::abs(c / f % 3 - e / f % 3);
+						steps += d;
+						longest = std::max(longest, d);
+					}
+					face[c] |= uint32_t(longest == 1 && steps == 1) << e;
+					edge[c] |= uint32_t(longest == 1 && steps <= 2) << e;
+				}
+			}
+		}
+	};
+	const CubeAdjacency cubeAdjacency;
+
+	// the points of the volume in the total order of (value, point id)
+	template <class T> struct Field {
+		const T *scalars;
+		int dims[3];
+		uint64_t slice;
+
+		bool Less(uint64_t a, uint64_t b) const
+		{
+			return Less(scalars[a], a, scalars[b], b);
+		}
+
+		// earlier in the sweep, descending for the join tree and ascending for the split tree
+		bool Before(uint64_t a, uint64_t b, bool descending) const
+		{
+			return descending ? Less(b, a) : Less(a, b);
+		}
+
+		// the same with the values at hand, so that sorting needs no lookups into the volume
+		static bool Less(T valueA, uint64_t a, T valueB, uint64_t b)
+		{
+			return valueA < valueB || (!(valueB < valueA) && a < b);
+		}
+
+		static bool Before(T valueA, uint64_t a, T valueB, uint64_t b, bool descending)
+		{
+			return descending ? Less(valueB, b, valueA, a) : Less(valueA, a, valueB, b);
+		}
+
+		// the first numberOfOffsets neighbours of neighbourOffset inside the volume
+		int Neighbours(uint64_t v, int numberOfOffsets, uint64_t neighbours[18]) const
+		{
+			const int ijk[3] = { static_cast<int>(v % dims[0]), static_cast<int>((v / dims[0]) % dims[1]), static_cast<int>(v / slice) };
+			int count = 0;
+			for (int n = 0; n < numberOfOffsets; ++n) {
+				const int *offset = neighbourOffset[n];
+				bool inside = true;
+				for (int a = 0; a < 3; ++a)
+					inside = inside && ijk[a] + offset[a] >= 0 && ijk[a] + offset[a] < dims[a];
+				if (inside)
+					neighbours[count++] = v + offset[0] + static_cast<int64_t>(offset[1]) * dims[0] + offset[2] * static_cast<int64_t>(slice);
+			}
+			return count;
+		}
+
+		// the highest (lowest) of the point and its neighbours, the point itself at a maximum (minimum)
+		uint64_t Steepest(uint64_t v, int numberOfOffsets, bool up) const
+		{
+			uint64_t neighbours[18];
+			const int count = Neighbours(v, numberOfOffsets, neighbours);
+			uint64_t steepest = v;
+			for (int n = 0; n < count; ++n)
+				if (up ? Less(steepest, neighbours[n]) : Less(neighbours[n], steepest))
+					steepest = neighbours[n];
+			return steepest;
+		}
+
+		// whether the point may be a node of the merge tree of the sweep. Its neighbours before it in the sweep are in
+		// one component at its turn if they are connected through the points of its 3x3x3 cube before it, then it is
+		// regular, unless no neighbour comes after it, as at the root
+		bool MayBeNode(uint64_t v, bool descending) const
+		{
+			const int ijk[3] = { static_cast<int>(v % dims[0]), static_cast<int>((v / dims[0]) % dims[1]), static_cast<int>(v / slice) };
+			bool before[27];
+			for (int c = 0; c < 27; ++c) {
+				const int d[3] = { c % 3 - 1, c / 3 % 3 - 1, c / 9 - 1 };
+				bool inside = c != 13;
+				for (int a = 0; a < 3; ++a)
+					inside = inside && ijk[a] + d[a] >= 0 && ijk[a] + d[a] < dims[a];
+				before[c] = inside && Before(v + d[0] + static_cast<int64_t>(d[1]) * dims[0] + d[2] * static_cast<int64_t>(slice), v, descending);
+			}
+			uint32_t remaining = 0;
+			for (int c = 0; c < 27; ++c)
+				remaining |= uint32_t(before[c]) << c;
+
+			// components of the points before it from its neighbours, over the connectivity of the sweep
+			const uint32_t *adjacent = descending ? cubeAdjacency.face : cubeAdjacency.edge;
+			int numberOfComponents = 0;
+			bool after = false;
+			for (int n = 0; n < (descending ? faceNeighbours : edgeNeighbours); ++n) {
+				const int *offset = neighbourOffset[n];
+				const int c = offset[0] + 1 + 3 * (offset[1] + 1) + 9 * (offset[2] + 1);
+				bool inside = true;
+				for (int a = 0; a < 3; ++a)
+					inside = inside && ijk[a] + offset[a] >= 0 && ijk[a] + offset[a] < dims[a];
+				after = after || (inside && !before[c]);
+				if (!((remaining >> c) & 1))
+					continue;
+				uint32_t front = uint32_t(1) << c;
+				remaining &= ~front;
+				while (front) {
+					uint32_t next = 0;
+					for (int e = 0; e < 27; ++e)
+						if ((front >> e) & 1)
+							next |= adjacent[e];
+					front = next & remaining;
+					remaining &= ~front;
+				}
+				++numberOfComponents;
+			}
+			return numberOfComponents != 1 || !after;
+		}
+	};
+
+	// marks of the points that stay nodes, one bit per point, empty for none
+	bool isMarked(const std::vector<uint64_t>& marks, uint64_t id)
+	{
+		return !marks.empty() && ((marks[id >> 6] >> (id & 63)) & 1) != 0;
+	}
+
+	// a point on a plane shared with a neighbouring slab, which stays a node until the slabs are merged
+	bool isInterface(int z, int z0, int z1, int numberOfPlanes)
+	{
+		return (z == z0 && z0 > 0) || (z == z1 && z1 < numberOfPlanes - 1);
+	}
+
+	// ascending order of (value, index), a counting sort for types of at most 16 bits
+	template <class T> void sortPoints(const T *values, uint32_t count, std::vector<uint32_t>& order, std::true_type)
+	{
+		const int64_t low = std::numeric_limits<T>::min();
+		const size_t numberOfBins = size_t(1) << (8 * sizeof(T));
+		std::vector<uint32_t> start(numberOfBins + 1, 0);
+		for (uint32_t i = 0; i < count; ++i)
+			++start[static_cast<int64_t>(values[i]) - low + 1];
+		for (size_t b = 0; b < numberOfBins; ++b)
+			start[b + 1] += start[b];
+		order.resize(count);
+		for (uint32_t i = 0; i < count; ++i)
+			order[start[static_cast<int64_t>(values[i]) - low]++] = i;
+	}
+
+	template <class T> void sortPoints(const T *values, uint32_t count, std::vector<uint32_t>& order, std::false_type)
+	{
+		order.resize(count);
+		for (uint32_t i = 0; i < count; ++i)
+			order[i] = i;
+		std::sort(order.begin(), order.end(), [values](uint32_t a, uint32_t b) {
+			return values[a] < values[b] || (!(values[b] < values[a]) && a < b);
+		});
+	}
+
+	// sweeps the points of a slab in order with a union-find over the point ids of the slab, over the face neighbours
+	// descending and all 18 neighbours ascending. A root link holds -(node + 1) of the last node of its component,
+	// the other links the next point towards the root. The arc of every point is the node at its upper end, or the
+	// node of the point. Only the critical points and the points of the planes shared with the neighbouring slabs
+	// are nodes, so a slab gives a reduced tree
+	template <class T> void sweepSlab(const Field<T>& field, int z0, int z1, const std::vector<uint32_t>& order,
+		bool descending, std::vector<int32_t>& link, std::vector<int32_t>& arc, MergeTree& tree)
+	{
+		const int32_t unvisited = std::numeric_limits<int32_t>::max();
+		const uint32_t count = static_cast<uint32_t>(order.size());
+		const uint64_t base = static_cast<uint64_t>(z0) * field.slice;
+		const int nx = field.dims[0], ny = field.dims[1];
+		const int numberOfOffsets = descending ? faceNeighbours : edgeNeighbours;
+		int32_t step[18];
+		for (int n = 0; n < numberOfOffsets; ++n)
+			step[n] = neighbourOffset[n][0] + neighbourOffset[n][1] * nx + neighbourOffset[n][2] * static_cast<int32_t>(field.slice);
+		const uint32_t slice = static_cast<uint32_t>(field.slice);
+		link.assign(count, unvisited);
+		arc.resize(count);
+		tree.vertex.clear();
+		tree.parent.clear();
+		tree.childStart.assign(1, 0);
+		tree.children.clear();
+		tree.hidden.clear();
+		tree.z0 = z0;
+		tree.z1 = z1;
+		auto find = [&link](int32_t x) {
+			while (link[x] >= 0) {
+				const int32_t p = link[x];
+				if (link[p] >= 0)
+					link[x] = link[p];
+				x = p;
+			}
+			return x;
+		};
+
+		int32_t roots[18];
+		int numberOfRoots = 0;
+		auto visit = [&](uint32_t w) {
+			if (link[w] == unvisited)
+				return;
+			const int32_t root = find(static_cast<int32_t>(w));
+			for (int r = 0; r < numberOfRoots; ++r)
+				if (roots[r] == root)
+					return;
+			roots[numberOfRoots++] = root;
+		};
+		for (uint32_t rank = 0; rank < count; ++rank) {
+			const uint32_t v = order[descending ? count - 1 - rank : rank];
+			const int i = static_cast<int>(v % nx), j = static_cast<int>((v / nx) % ny), k = static_cast<int>(v / slice);
+			const int ijk[3] = { i, j, k }, last[3] = { nx - 1, ny - 1, z1 - z0 };
+			numberOfRoots = 0;
+			for (int n = 0; n < numberOfOffsets; ++n) {
+				const int *offset = neighbourOffset[n];
+				if (ijk[0] + offset[0] >= 0 && ijk[0] + offset[0] <= last[0] && ijk[1] + offset[1] >= 0 && ijk[1] + offset[1] <= last[1] &&
+					ijk[2] + offset[2] >= 0 && ijk[2] + offset[2] <= last[2])
+					visit(static_cast<uint32_t>(static_cast<int32_t>(v) + step[n]));
+			}
+
+			// a maximum, a saddle or a point of a shared plane is a node, the last point the root
+			if (numberOfRoots != 1 || rank == count - 1 || isInterface(z0 + k, z0, z1, field.dims[2])) {
+				const int32_t node = static_cast<int32_t>(tree.vertex.size());
+				tree.vertex.push_back(base + v);
+				tree.parent.push_back(-1);
+				tree.hidden.push_back(0);
+				for (int r = 0; r < numberOfRoots; ++r) {
+					tree.parent[-link[roots[r]] - 1] = node;
+					tree.children.push_back(-link[roots[r]] - 1);
+					link[roots[r]] = static_cast<int32_t>(v);
+				}
+				tree.childStart.push_back(static_cast<int64_t>(tree.children.size()));
+				link[v] = -node - 1;
+				arc[v] = node;
+			}
+			else {
+				link[v] = roots[0];
+				arc[v] = -link[roots[0]] - 1;
+			}
+		}
+	}
+
+	// the points of two lists in sweep order in one list, a point of both lists once, with the index in it of every
+	// point of both lists. Ranges of the first list are interleaved in parallel with the points of the second list
+	// before the next range, with indices into the range, which are then moved by the points of the ranges before
+	template <class T> void interleave(const Field<T>& field, bool descending, const std::vector<uint64_t>& a,
+		const std::vector<uint64_t>& b, int numberOfThreads, std::vector<uint64_t>& vertex, std::vector<int64_t>& mapA,
+		std::vector<int64_t>& mapB)
+	{
+		const int numberOfRanges = static_cast<int>(std::max<size_t>(1, std::min<size_t>(a.size(), numberOfThreads > 1 ? 4 * numberOfThreads : 1)));
+		std::vector<size_t> firstA(numberOfRanges + 1), firstB(numberOfRanges + 1);
+		for (int r = 0; r <= numberOfRanges; ++r) {
+			firstA[r] = a.size() * r / numberOfRanges;
+			firstB[r] = r == 0 ? 0 : r == numberOfRanges ? b.size() : std::lower_bound(b.begin(), b.end(), a[firstA[r]],
+				[&field, descending](uint64_t x, uint64_t y) { return field.Before(x, y, descending); }) - b.begin();
+		}
+		mapA.resize(a.size());
+		mapB.resize(b.size());
+		std::vector<int64_t> rangeStart(numberOfRanges + 1, 0);
+		parallelFor(numberOfRanges, numberOfThreads, [&](int r, int) {
+			size_t p = firstA[r], q = firstB[r];
+			int64_t index = 0;
+			while (p < firstA[r + 1] || q < firstB[r + 1]) {
+				if (q == firstB[r + 1] || (p < firstA[r + 1] && field.Before(a[p], b[q], descending)))
+					mapA[p++] = index++;
+				else if (p == firstA[r + 1] || field.Before(b[q], a[p], descending))
+					mapB[q++] = index++;
+				else {
+					mapA[p++] = index;
+					mapB[q++] = index++;
+				}
+			}
+			rangeStart[r + 1] = index;
+		});
+		for (int r = 0; r < numberOfRanges; ++r)
+			rangeStart[r + 1] += rangeStart[r];
+		vertex.resize(rangeStart[numberOfRanges]);
+		parallelFor(numberOfRanges, numberOfThreads, [&](int r, int) {
+			for (size_t p = firstA[r]; p < firstA[r + 1]; ++p) {
+				mapA[p] += rangeStart[r];
+				vertex[mapA[p]] = a[p];
+			}
+			for (size_t q = firstB[r]; q < firstB[r + 1]; ++q) {
+				mapB[q] += rangeStart[r];
+				vertex[mapB[q]] = b[q];
+			}
+		});
+	}
+
+	// merges the reduced trees of two neighbouring slabs, the second above the first, by a sweep over the nodes of
+	// both with the tree arcs as neighbours. The nodes of the shared plane are in both trees and are merged into one.
+	// The sweep is serial, interleaving the nodes, collecting their children and moving the pending points run on
+	// the threads of the merge. The shared plane is inner after the merge, its regular points are dropped as nodes
+	// and kept as pending points on the arc they lie on if the other tree may have them. A final child is a component
+	// of its own, a node with one stays a node, so that the final parent of the child remains
+	template <class T> void mergeTrees(const Field<T>& field, bool descending, const MergeTree& a, const MergeTree& b,
+		int numberOfThreads, MergeTree& out)
+	{
+		std::vector<uint64_t> vertex;
+		std::vector<int64_t> mapA, mapB;
+		interleave(field, descending, a.vertex, b.vertex, numberOfThreads, vertex, mapA, mapB);
+
+		// the children of every node in compressed rows, those of the first tree before those of the second one
+		const int64_t count = static_cast<int64_t>(vertex.size());
+		std::vector<int64_t> childStart(count + 1, 0);
+		parallelRanges(static_cast<vtkIdType>(a.vertex.size()), numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+			for (vtkIdType i = begin; i < end; ++i)
+				childStart[mapA[i] + 1] = a.childStart[i + 1] - a.childStart[i];
+		});
+		parallelRanges(static_cast<vtkIdType>(b.vertex.size()), numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+			for (vtkIdType i = begin; i < end; ++i)
+				childStart[mapB[i] + 1] += b.childStart[i + 1] - b.childStart[i];
+		});
+		for (int64_t n = 0; n < count; ++n)
+			childStart[n + 1] += childStart[n];
+		std::vector<int64_t> children(childStart[count]);
+		parallelRanges(static_cast<vtkIdType>(a.vertex.size()), numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+			for (vtkIdType i = begin; i < end; ++i)
+				for (int64_t c = a.childStart[i], next = childStart[mapA[i]]; c < a.childStart[i + 1]; ++c)
+					children[next++] = mapA[a.children[c]];
+		});
+		parallelRanges(static_cast<vtkIdType>(b.vertex.size()), numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+			for (vtkIdType i = begin; i < end; ++i)
+				for (int64_t c = b.childStart[i], next = childStart[mapB[i] + 1] - (b.childStart[i + 1] - b.childStart[i]);
+					c < b.childStart[i + 1]; ++c)
+					children[next++] = mapB[b.children[c]];
+		});
+		std::vector<int32_t> hidden(count);
+		parallelRanges(static_cast<vtkIdType>(a.vertex.size()), numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+			for (vtkIdType i = begin; i < end; ++i)
+				hidden[mapA[i]] = a.hidden[i];
+		});
+		parallelRanges(static_cast<vtkIdType>(b.vertex.size()), numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+			for (vtkIdType i = begin; i < end; ++i)
+				hidden[mapB[i]] += b.hidden[i];
+		});
+
+		// the same sweep as in a slab over the merged nodes, with the node of the merged tree at every merged node,
+		// or for a dropped one the node at the upper end of its arc
+		out.vertex.clear();
+		out.parent.clear();
+		out.childStart.assign(1, 0);
+		out.children.clear();
+		out.hidden.clear();
+		out.z0 = a.z0;
+		out.z1 = b.z1;
+		std::vector<int64_t> link(count), outNode(count);
+		std::vector<std::pair<uint64_t, int64_t>> dropped;
+		auto find = [&link](int64_t x) {
+			while (link[x] >= 0) {
+				const int64_t parent = link[x];
+				if (link[parent] >= 0)
+					link[x] = link[parent];
+				x = parent;
+			}
+			return x;
+		};
+		std::vector<int64_t> roots;
+		for (int64_t x = 0; x < count; ++x) {
+			roots.clear();
+			for (int64_t c = childStart[x]; c < childStart[x + 1]; ++c) {
+				const int64_t root = find(children[c]);
+				if (std::find(roots.begin(), roots.end(), root) == roots.end())
+					roots.push_back(root);
+			}
+			const int z = static_cast<int>(vertex[x] / field.slice);
+			if (roots.size() != 1 || hidden[x] > 0 || x == count - 1 || isInterface(z, out.z0, out.z1, field.dims[2])) {
+				const int64_t node = static_cast<int64_t>(out.vertex.size());
+				out.vertex.push_back(vertex[x]);
+				out.parent.push_back(-1);
+				out.hidden.push_back(hidden[x]);
+				for (size_t r = 0; r < roots.size(); ++r) {
+					out.parent[-link[roots[r]] - 1] = node;
+					out.children.push_back(-link[roots[r]] - 1);
+					link[roots[r]] = x;
+				}
+				out.childStart.push_back(static_cast<int64_t>(out.children.size()));
+				link[x] = -node - 1;
+				outNode[x] = node;
+			}
+			else {
+				link[x] = roots[0];
+				outNode[x] = -link[roots[0]] - 1;
+				dropped.push_back(std::make_pair(vertex[x], outNode[x]));
+			}
+		}
+
+		// a dropped node is regular in this tree, so it stays pending only if it may be a node of the other tree
+		std::vector<char> keep(dropped.size());
+		parallelRanges(static_cast<vtkIdType>(dropped.size()), numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+			for (vtkIdType p = begin; p < end; ++p)
+				keep[p] = field.MayBeNode(dropped[p].first, !descending);
+		});
+		size_t numberOfKept = 0;
+		for (size_t p = 0; p < dropped.size(); ++p)
+			if (keep[p])
+				dropped[numberOfKept++] = dropped[p];
+		dropped.resize(numberOfKept);
+
+		// the pending points and saddles of both trees with the merged nodes of their nodes, then the dropped nodes
+		auto movePoints = [&](const std::vector<std::pair<uint64_t, int64_t>>& pointsA, const std::vector<std::pair<uint64_t, int64_t>>& pointsB,
+			std::vector<std::pair<uint64_t, int64_t>>& points, size_t more) {
+			const vtkIdType countA = static_cast<vtkIdType>(pointsA.size()), countB = static_cast<vtkIdType>(pointsB.size());
+			points.resize(countA + countB + more);
+			parallelRanges(countA + countB, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+				for (vtkIdType p = begin; p < end; ++p) {
+					const std::pair<uint64_t, int64_t>& point = p < countA ? pointsA[p] : pointsB[p - countA];
+					points[p] = std::make_pair(point.first, outNode[p < countA ? mapA[point.second] : mapB[point.second]]);
+				}
+			});
+		};
+		movePoints(a.pending, b.pending, out.pending, dropped.size());
+		std::copy(dropped.begin(), dropped.end(), out.pending.end() - dropped.size());
+		movePoints(a.saddles, b.saddles, out.saddles, 0);
+	}
+
+	// keeps only the paths from the points of the shared planes to the root in a tree, as in distributed merge trees:
+	// the components of the other nodes stay inside the planes z0 to z1 until they reach their parent, so their
+	// parents are final. The nodes on the paths with one child on a path are saddles, as their other children are
+	// final, and become pending saddles of the arc they lie on. The pending points and saddles on the arcs below the
+	// final nodes are final as well and go into their arcs in sweep order. The merges then only carry nodes of about
+	// the size of the shared planes
+	template <class T> void reduceTree(const Field<T>& field, bool descending, int numberOfThreads, MergeTree& tree)
+	{
+		const int64_t count = static_cast<int64_t>(tree.vertex.size());
+		auto onPlane = [&field, &tree](int64_t x) {
+			return isInterface(static_cast<int>(tree.vertex[x] / field.slice), tree.z0, tree.z1, field.dims[2]);
+		};
+		// the children come before their parent in the sweep
+		std::vector<char> onPath(count, 0);
+		std::vector<int32_t> pathChildren(count, 0);
+		for (int64_t x = 0; x < count; ++x) {
+			if (onPlane(x))
+				onPath[x] = 1;
+			if (onPath[x] && tree.parent[x] >= 0) {
+				onPath[tree.parent[x]] = 1;
+				++pathChildren[tree.parent[x]];
+			}
+		}
+		std::vector<int64_t> reduced(count, -1);
+		int64_t numberOfReduced = 0;
+		for (int64_t x = 0; x < count; ++x)
+			if (onPath[x] && (pathChildren[x] != 1 || tree.parent[x] < 0 || onPlane(x)))
+				reduced[x] = numberOfReduced++;
+
+		// the saddles on the way down from every remaining node to the next one, each reached from one node
+		std::vector<int64_t> pathNode(count, -1), reducedParent(numberOfReduced, -1);
+		std::vector<std::pair<uint64_t, int64_t>> saddles;
+		for (int64_t x = 0; x < count; ++x)
+			if (reduced[x] >= 0) {
+				pathNode[x] = reduced[x];
+				int64_t y = tree.parent[x];
+				for (; y >= 0 && reduced[y] < 0; y = tree.parent[y]) {
+					pathNode[y] = reduced[x];
+					saddles.push_back(std::make_pair(tree.vertex[y], reduced[x]));
+				}
+				reducedParent[reduced[x]] = y >= 0 ? reduced[y] : -1;
+			}
+
+		// a point on a path stays with the node of the reduced tree at or before its node, a point below a final node
+		// goes down to the arc it lies on
+		const int numberOfRanges = 16 * numberOfThreads;
+		std::vector<ArcPoint<T>> arcPoints;
+		auto reducePoints = [&](std::vector<std::pair<uint64_t, int64_t>>& points, bool saddle) {
+			std::vector<std::vector<std::pair<uint64_t, int64_t>>> rangePoints(numberOfRanges);
+			std::vector<std::vector<ArcPoint<T>>> rangeArcPoints(numberOfRanges);
+			parallelFor(numberOfRanges, numberOfThreads, [&](int r, int) {
+				for (size_t p = points.size() * r / numberOfRanges; p < points.size() * (r + 1) / numberOfRanges; ++p) {
+					const uint64_t point = points[p].first;
+					int64_t node = points[p].second;
+					while (!onPath[node] && tree.parent[node] >= 0 && field.Before(tree.vertex[tree.parent[node]], point, descending))
+						node = tree.parent[node];
+					if (onPath[node])
+						rangePoints[r].push_back(std::make_pair(point, pathNode[node]));
+					else {
+						const ArcPoint<T> arcPoint = { node, point, field.scalars[point], saddle };
+						rangeArcPoints[r].push_back(arcPoint);
+					}
+				}
+			});
+			std::vector<size_t> pointStart(numberOfRanges + 1, 0), arcStart(numberOfRanges + 1, arcPoints.size());
+			for (int r = 0; r < numberOfRanges; ++r) {
+				pointStart[r + 1] = pointStart[r] + rangePoints[r].size();
+				arcStart[r + 1] = arcStart[r] + rangeArcPoints[r].size();
+			}
+			points.resize(pointStart[numberOfRanges]);
+			arcPoints.resize(arcStart[numberOfRanges]);
+			parallelFor(numberOfRanges, numberOfThreads, [&](int r, int) {
+				std::copy(rangePoints[r].begin(), rangePoints[r].end(), points.begin() + pointStart[r]);
+				std::copy(rangeArcPoints[r].begin(), rangeArcPoints[r].end(), arcPoints.begin() + arcStart[r]);
+			});
+		};
+		reducePoints(tree.pending, false);
+		reducePoints(tree.saddles, true);
+		tree.saddles.insert(tree.saddles.end(), saddles.begin(), saddles.end());
+
+		// the points of an arc follow its final node in sweep order, the last one goes to the parent of the node
+		parallelSort(arcPoints, numberOfThreads, [descending](const ArcPoint<T>& a, const ArcPoint<T>& b) {
+			return a.node < b.node || (a.node == b.node && Field<T>::Before(a.value, a.point, b.value, b.point, descending));
+		});
+		const size_t numberOfArcPoints = arcPoints.size();
+		std::vector<size_t> rangeSaddles(numberOfRanges + 1, 0);
+		parallelFor(numberOfRanges, numberOfThreads, [&](int r, int) {
+			for (size_t p = numberOfArcPoints * r / numberOfRanges; p < numberOfArcPoints * (r + 1) / numberOfRanges; ++p)
+				if (arcPoints[p].saddle)
+					++rangeSaddles[r + 1];
+		});
+		for (int r = 0; r < numberOfRanges; ++r)
+			rangeSaddles[r + 1] += rangeSaddles[r];
+		FinalNodes final;
+		final.nodes.resize(rangeSaddles[numberOfRanges]);
+		final.regular.resize(numberOfArcPoints - rangeSaddles[numberOfRanges]);
+		std::vector<int64_t> firstPoint(count, -1);
+		parallelFor(numberOfRanges, numberOfThreads, [&](int r, int) {
+			const size_t begin = numberOfArcPoints * r / numberOfRanges;
+			size_t nextSaddle = rangeSaddles[r], nextRegular = begin - rangeSaddles[r];
+			for (size_t p = begin; p < numberOfArcPoints * (r + 1) / numberOfRanges; ++p) {
+				const int64_t node = arcPoints[p].node, parent = tree.parent[node];
+				const std::pair<uint64_t, int64_t> point(arcPoints[p].point, p + 1 < numberOfArcPoints && arcPoints[p + 1].node == node ?
+					static_cast<int64_t>(arcPoints[p + 1].point) : parent >= 0 ? static_cast<int64_t>(tree.vertex[parent]) : -1);
+				if (arcPoints[p].saddle)
+					final.nodes[nextSaddle++] = point;
+				else
+					final.regular[nextRegular++] = point;
+				if (p == 0 || arcPoints[p - 1].node != node)
+					firstPoint[node] = static_cast<int64_t>(arcPoints[p].point);
+			}
+		});
+		std::vector<ArcPoint<T>>().swap(arcPoints);
+
+		// the final nodes, with the number of final children of the remaining nodes
+		std::vector<int32_t> hidden(numberOfReduced, 0);
+		for (int64_t x = 0; x < count; ++x)
+			if (reduced[x] >= 0)
+				hidden[reduced[x]] += tree.hidden[x];
+			else if (!onPath[x]) {
+				const int64_t y = tree.parent[x];
+				const std::pair<uint64_t, int64_t> node(tree.vertex[x], firstPoint[x] >= 0 ? firstPoint[x] :
+					y >= 0 ? static_cast<int64_t>(tree.vertex[y]) : -1);
+				if (y >= 0 && tree.childStart[x + 1] - tree.childStart[x] + tree.hidden[x] == 1)
+					final.regular.push_back(node);
+				else
+					final.nodes.push_back(node);
+				if (y >= 0 && reduced[y] >= 0)
+					++hidden[reduced[y]];
+			}
+
+		// the remaining nodes with their children in compressed rows
+		std::vector<uint64_t> vertex(numberOfReduced);
+		std::vector<int64_t> childStart(numberOfReduced + 1, 0);
+		for (int64_t x = 0; x < count; ++x)
+			if (reduced[x] >= 0) {
+				vertex[reduced[x]] = tree.vertex[x];
+				if (reducedParent[reduced[x]] >= 0)
+					++childStart[reducedParent[reduced[x]] + 1];
+			}
+		for (int64_t n = 0; n < numberOfReduced; ++n)
+			childStart[n + 1] += childStart[n];
+		std::vector<int64_t> children(childStart[numberOfReduced]), next(childStart.begin(), childStart.end() - 1);
+		for (int64_t n = 0; n < numberOfReduced; ++n)
+			if (reducedParent[n] >= 0)
+				children[next[reducedParent[n]]++] = n;
+		tree.vertex.swap(vertex);
+		tree.parent.swap(reducedParent);
+		tree.childStart.swap(childStart);
+		tree.children.swap(children);
+		tree.hidden.swap(hidden);
+		tree.final.push_back(std::move(final));
+	}
+
+	// join and split tree of a slab, each with the nodes of the other one as pending points
+	template <class T> void slabTrees(const Field<T>& field, int z0, int z1, MergeTree& join, MergeTree& split)
+	{
+		const uint64_t base = static_cast<uint64_t>(z0) * field.slice;
+		std::vector<uint32_t> order;
+		sortPoints(field.scalars + base, static_cast<uint32_t>((z1 - z0 + 1) * field.slice), order,
+			std::integral_constant<bool, std::is_integral<T>::value && sizeof(T) <= 2>());
+		std::vector<int32_t> link, joinArc, splitArc;
+		sweepSlab(field, z0, z1, order, true, link, joinArc, join);
+		sweepSlab(field, z0, z1, order, false, link, splitArc, split);
+		for (size_t n = 0; n < split.vertex.size(); ++n) {
+			const int32_t node = joinArc[split.vertex[n] - base];
+			if (join.vertex[node] != split.vertex[n])
+				join.pending.push_back(std::make_pair(split.vertex[n], static_cast<int64_t>(node)));
+		}
+		for (size_t n = 0; n < join.vertex.size(); ++n) {
+			const int32_t node = splitArc[join.vertex[n] - base];
+			if (split.vertex[node] != join.vertex[n])
+				split.pending.push_back(std::make_pair(join.vertex[n], static_cast<int64_t>(node)));
+		}
+	}
+
+	// the merge tree of the final nodes, the regular nodes that are not marked are spliced out
+	template <class T> void finalTree(const Field<T>& field, bool descending, const std::vector<uint64_t>& marks,
+		int numberOfThreads, MergeTree& tree)
+	{
+		const int numberOfParts = static_cast<int>(tree.final.size());
+		std::vector<size_t> partStart(2 * numberOfParts + 1, 0);
+		for (int f = 0; f < numberOfParts; ++f) {
+			partStart[2 * f + 1] = partStart[2 * f] + tree.final[f].nodes.size();
+			partStart[2 * f + 2] = partStart[2 * f + 1] + tree.final[f].regular.size();
+		}
+		std::vector<FinalNode<T>> nodes(partStart[2 * numberOfParts]);
+		parallelFor(2 * numberOfParts, numberOfThreads, [&](int part, int) {
+			const std::vector<std::pair<uint64_t, int64_t>>& points = part % 2 ? tree.final[part / 2].regular : tree.final[part / 2].nodes;
+			for (size_t p = 0; p < points.size(); ++p) {
+				const FinalNode<T> node = { points[p].first, points[p].second, field.scalars[points[p].first] };
+				nodes[partStart[part] + p] = node;
+			}
+		});
+		tree = MergeTree();
+		parallelSort(nodes, numberOfThreads, [descending](const FinalNode<T>& a, const FinalNode<T>& b) {
+			return Field<T>::Before(a.value, a.point, b.value, b.point, descending);
+		});
+		auto findNode = [&nodes, &field, descending](uint64_t point) {
+			return static_cast<int64_t>(std::lower_bound(nodes.begin(), nodes.end(), point, [&field, descending](const FinalNode<T>& node, uint64_t p) {
+				return Field<T>::Before(node.value, node.point, field.scalars[p], p, descending);
+			}) - nodes.begin());
+		};
+
+		// the parents as node indices. All nodes but the regular ones are marked
+		const int64_t count = static_cast<int64_t>(nodes.size());
+		std::vector<int64_t> parent(count);
+		parallelRanges(count, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+			for (vtkIdType n = begin; n < end; ++n)
+				parent[n] = nodes[n].parent < 0 ? -1 : findNode(static_cast<uint64_t>(nodes[n].parent));
+		});
+		const int numberOfRanges = 16 * numberOfThreads;
+		std::vector<int64_t> rangeStart(numberOfRanges + 1, 0);
+		parallelFor(numberOfRanges, numberOfThreads, [&](int r, int) {
+			for (int64_t n = count * r / numberOfRanges; n < count * (r + 1) / numberOfRanges; ++n)
+				if (isMarked(marks, nodes[n].point))
+					++rangeStart[r + 1];
+		});
+		for (int r = 0; r < numberOfRanges; ++r)
+			rangeStart[r + 1] += rangeStart[r];
+		tree.vertex.resize(rangeStart[numberOfRanges]);
+		tree.parent.resize(rangeStart[numberOfRanges]);
+		parallelFor(numberOfRanges, numberOfThreads, [&](int r, int) {
+			int64_t next = rangeStart[r];
+			for (int64_t n = count * r / numberOfRanges; n < count * (r + 1) / numberOfRanges; ++n)
+				if (isMarked(marks, nodes[n].point)) {
+					int64_t p = parent[n];
+					while (p >= 0 && !isMarked(marks, nodes[p].point))
+						p = parent[p];
+					tree.vertex[next] = nodes[n].point;
+					tree.parent[next++] = p;
+				}
+		});
+		// the new index of every node, in the place of its parent point
+		parallelFor(numberOfRanges, numberOfThreads, [&](int r, int) {
+			int64_t next = rangeStart[r];
+			for (int64_t n = count * r / numberOfRanges; n < count * (r + 1) / numberOfRanges; ++n)
+				if (isMarked(marks, nodes[n].point))
+					nodes[n].parent = next++;
+		});
+		parallelRanges(static_cast<vtkIdType>(tree.parent.size()), numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+			for (vtkIdType n = begin; n < end; ++n)
+				if (tree.parent[n] >= 0)
+					tree.parent[n] = nodes[tree.parent[n]].parent;
+		});
+	}
+
+	// merges the join and split trees of neighbouring slabs pairwise, level by level, the merges of a level in
+	// parallel. Every merged tree is reduced to the paths from its shared planes again, so the trees do not grow
+	// with the levels. The threads left over are shared by the merges, so the last levels run on all threads too
+	template <class T> void mergeSlabTrees(const Field<T>& field, std::vector<MergeTree>& trees, int numberOfThreads,
+		MergeTree& join, MergeTree& split)
+	{
+		for (int count = static_cast<int>(trees.size()) / 2; count > 1; count = (count + 1) / 2) {
+			const int pairs = count / 2;
+			std::vector<MergeTree> merged(2 * ((count + 1) / 2));
+			parallelFor(2 * pairs, std::min(numberOfThreads, 2 * pairs), [&](int unit, int) {
+				const int pair = unit / 2, kind = unit % 2;
+				MergeTree& a = trees[4 * pair + kind];
+				MergeTree& b = trees[4 * pair + 2 + kind];
+				MergeTree& out = merged[2 * pair + kind];
+				const int mergeThreads = std::max(1, numberOfThreads / (2 * pairs));
+				mergeTrees(field, kind == 0, a, b, mergeThreads, out);
+				out.final.swap(a.final);
+				std::move(b.final.begin(), b.final.end(), std::back_inserter(out.final));
+				a = MergeTree();
+				b = MergeTree();
+				reduceTree(field, kind == 0, mergeThreads, out);
+			});
+			if (count % 2) {
+				merged[2 * pairs] = std::move(trees[2 * (count - 1)]);
+				merged[2 * pairs + 1] = std::move(trees[2 * (count - 1) + 1]);
+			}
+			trees.swap(merged);
+		}
+		join = std::move(trees[0]);
+		split = std::move(trees[1]);
+	}
+
+	// join and split tree with the same nodes: the trees of the slabs are merged once, then the critical points of
+	// both trees are added to the other one from its pending points. Every critical point is a node or a pending
+	// point of the slab trees, as a point inside a slab sees all its neighbours there and a point of a shared plane
+	// is a node anyway, and a node that a merge drops stays a pending point unless its neighbours show that it is
+	// regular in the other tree. So the trees get the same nodes, as the merge into the contour tree requires,
+	// without a second sweep over the points or a second merge of the slabs. The times are the sweeps of the slabs
+	// and the merges in seconds
+	template <class T> void buildMergeTrees(const T *scalars, const int dims[3], int numberOfSlabs, int numberOfThreads,
+		MergeTree& join, MergeTree& split, vtkIdType criticalPoints[2], double times[2])
+	{
+		Field<T> field;
+		field.scalars = scalars;
+		for (int a = 0; a < 3; ++a)
+			field.dims[a] = dims[a];
+		field.slice = static_cast<uint64_t>(dims[0]) * dims[1];
+		vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+		timer->StartTimer();
+		const int numberOfPlanes = dims[2] - 1;
+		std::vector<MergeTree> trees(2 * numberOfSlabs);        // join and split tree of every slab
+		parallelFor(numberOfSlabs, numberOfThreads, [&](int s, int) {
+			slabTrees(field, s * numberOfPlanes / numberOfSlabs, (s + 1) * numberOfPlanes / numberOfSlabs, trees[2 * s], trees[2 * s + 1]);
+			reduceTree(field, true, 1, trees[2 * s]);
+			reduceTree(field, false, 1, trees[2 * s + 1]);
+		});
+		timer->StopTimer();
+		times[0] = timer->GetElapsedTime();
+
+		timer->StartTimer();
+		mergeSlabTrees(field, trees, numberOfThreads, join, split);
+		std::vector<uint64_t> marks((field.slice * dims[2] + 63) / 64, 0);
+		for (int kind = 0; kind < 2; ++kind) {
+			const MergeTree& tree = kind == 0 ? join : split;
+			criticalPoints[kind] = 0;
+			for (size_t f = 0; f < tree.final.size(); ++f) {
+				const std::vector<std::pair<uint64_t, int64_t>>& nodes = tree.final[f].nodes;
+				for (size_t n = 0; n < nodes.size(); ++n)
+					marks[nodes[n].first >> 6] |= uint64_t(1) << (nodes[n].first & 63);
+				criticalPoints[kind] += static_cast<vtkIdType>(nodes.size());
+			}
+		}
+		parallelFor(2, std::min(2, numberOfThreads), [&](int kind, int) {
+			finalTree(field, kind == 0, marks, std::max(1, numberOfThreads / 2), kind == 0 ? join : split);
+		});
+		timer->StopTimer();
+		times[1] = timer->GetElapsedTime();
+	}
+
+	// merges a join and a split tree with the same nodes into the contour tree (Carr, Snoeyink and Axen): a maximum
+	// of the join tree that is regular in the split tree is an upper leaf, its arc goes to its join tree parent, and
+	// symmetrically for the minima. Nodes are numbered in ascending order, the arcs are (upper, lower) pairs. The
+	// parents of both trees are returned before the leaves are peeled off. False if the node sets differ.
+	// While there are many leaves they are peeled off in rounds on the threads, all upper leaves at once and then
+	// all lower ones: the upper leaves hang below no other upper leaf in the join tree, their chains in the split
+	// tree are spliced out as a whole, and the children counts and xors of their parents are changed atomically.
+	// The leaves of a round are peeled and listed in their order, so the arcs do not depend on the threads. The
+	// last leaves are peeled off one by one
+	bool mergeContourTree(const MergeTree& join, const MergeTree& split, int numberOfThreads, std::vector<int64_t>& joinParent,
+		std::vector<int64_t>& splitParent, std::vector<std::pair<int64_t, int64_t>>& arcs)
+	{
+		const int64_t count = static_cast<int64_t>(split.vertex.size());
+		if (static_cast<int64_t>(join.vertex.size()) != count)
+			return false;
+		std::atomic<bool> sameNodes(true);
+		parallelRanges(count, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+			for (vtkIdType n = begin; n < end; ++n)
+				if (join.vertex[count - 1 - n] != split.vertex[n])
+					sameNodes = false;
+		});
+		if (!sameNodes)
+			return false;
+
+		// parent, number of children and xor of the children of every node in both trees
+		std::vector<std::atomic<int64_t>> joinXor(count), splitXor(count);
+		std::vector<std::atomic<int32_t>> joinChildren(count), splitChildren(count);
+		joinParent.resize(count);
+		splitParent.assign(split.parent.begin(), split.parent.end());
+		parallelRanges(count, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+			for (vtkIdType node = begin; node < end; ++node) {
+				joinXor[node] = splitXor[node] = 0;
+				joinChildren[node] = splitChildren[node] = 0;
+				joinParent[node] = join.parent[count - 1 - node] < 0 ? -1 : count - 1 - join.parent[count - 1 - node];
+			}
+		});
+		parallelRanges(count, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+			for (vtkIdType node = begin; node < end; ++node) {
+				if (joinParent[node] >= 0) {
+					++joinChildren[joinParent[node]];
+					joinXor[joinParent[node]] ^= node;
+				}
+				if (splitParent[node] >= 0) {
+					++splitChildren[splitParent[node]];
+					splitXor[splitParent[node]] ^= node;
+				}
+			}
+		});
+		std::vector<int64_t> below(joinParent), above(splitParent);
+
+		arcs.clear();
+		arcs.reserve(count > 0 ? count - 1 : 0);
+		auto isUpperLeaf = [&](int64_t x) { return joinChildren[x] == 0 && splitChildren[x] == 1; };
+		auto isLowerLeaf = [&](int64_t x) { return splitChildren[x] == 0 && joinChildren[x] == 1; };
+		std::vector<char> removed(count, 0);
+		const int numberOfRanges = 16 * numberOfThreads;
+		std::vector<std::vector<int64_t>> rangeLeaves[2];
+		for (int kind = 0; kind < 2; ++kind)
+			rangeLeaves[kind].resize(numberOfRanges);
+		parallelFor(numberOfRanges, numberOfThreads, [&](int r, int) {
+			for (int64_t x = count * r / numberOfRanges; x < count * (r + 1) / numberOfRanges; ++x) {
+				if (isUpperLeaf(x))
+					rangeLeaves[0][r].push_back(x);
+				else if (isLowerLeaf(x))
+					rangeLeaves[1][r].push_back(x);
+			}
+		});
+		std::vector<int64_t> leaves[2];                 // upper and lower leaves of the next rounds
+		for (int kind = 0; kind < 2; ++kind)
+			for (int r = 0; r < numberOfRanges; ++r)
+				leaves[kind].insert(leaves[kind].end(), rangeLeaves[kind][r].begin(), rangeLeaves[kind][r].end());
+
+		const size_t roundLeaves = 4096;
+		std::vector<int32_t> listed(count, 0);          // the last round that listed a node as a leaf
+		int32_t numberOfRounds = 0;
+		while (leaves[0].size() + leaves[1].size() >= roundLeaves) {
+			for (int kind = 0; kind < 2; ++kind) {
+				// upper leaves peel off their join tree arcs and leave the split tree, lower leaves the other way round
+				std::vector<std::atomic<int32_t>>& ownChildren = kind == 0 ? joinChildren : splitChildren;
+				std::vector<std::atomic<int32_t>>& otherChildren = kind == 0 ? splitChildren : joinChildren;
+				std::vector<std::atomic<int64_t>>& ownXor = kind == 0 ? joinXor : splitXor;
+				std::vector<std::atomic<int64_t>>& otherXor = kind == 0 ? splitXor : joinXor;
+				std::vector<int64_t>& ownParent = kind == 0 ? below : above;
+				std::vector<int64_t>& otherParent = kind == 0 ? above : below;
+				std::vector<int64_t> round;
+				round.swap(leaves[kind]);
+				round.erase(std::remove_if(round.begin(), round.end(), [&](int64_t x) {
+					return removed[x] || (kind == 0 ? !isUpperLeaf(x) : !isLowerLeaf(x)) || ownParent[x] < 0;
+				}), round.end());
+				const size_t first = arcs.size();
+				arcs.resize(first + round.size());
+				parallelRanges(static_cast<vtkIdType>(round.size()), numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+					for (vtkIdType i = begin; i < end; ++i)
+						removed[round[i]] = 1;
+				});
+				std::vector<std::vector<int64_t>> changed(numberOfRanges);
+				parallelFor(numberOfRanges, numberOfThreads, [&](int r, int) {
+					for (size_t i = round.size() * r / numberOfRanges; i < round.size() * (r + 1) / numberOfRanges; ++i) {
+						const int64_t x = round[i], y = ownParent[x];
+						arcs[first + i] = kind == 0 ? std::make_pair(x, y) : std::make_pair(y, x);
+						ownXor[y] ^= x;
+						--ownChildren[y];
+						changed[r].push_back(y);
+						// the lowest leaf of a chain splices the chain out of the other tree
+						const int64_t child = otherXor[x];
+						if (removed[child])
+							continue;
+						int64_t top = x;
+						while (otherParent[top] >= 0 && removed[otherParent[top]])
+							top = otherParent[top];
+						const int64_t parent = otherParent[top];
+						otherParent[child] = parent;
+						if (parent >= 0)
+							otherXor[parent] ^= top ^ child;
+					}
+				});
+				// the parents that are leaves now, each once at its first leaf
+				++numberOfRounds;
+				for (int r = 0; r < numberOfRanges; ++r)
+					for (size_t c = 0; c < changed[r].size(); ++c) {
+						const int64_t y = changed[r][c];
+						if (listed[y] == numberOfRounds)
+							continue;
+						listed[y] = numberOfRounds;
+						if (ownChildren[y] == 0 && otherChildren[y] == 1)
+							leaves[kind].push_back(y);
+						else if (ownChildren[y] == 1 && otherChildren[y] == 0)
+							leaves[1 - kind].push_back(y);
+					}
+			}
+		}
+
+		std::vector<int64_t> stack(leaves[0]);
+		stack.insert(stack.end(), leaves[1].begin(), leaves[1].end());
+		while (!stack.empty()) {
+			const int64_t x = stack.back();
+			stack.pop_back();
+			if (removed[x] || !(isUpperLeaf(x) || isLowerLeaf(x)))
+				continue;
+			int64_t y;
+			if (joinChildren[x] == 0) {
+				y = below[x];
+				if (y < 0)
+					continue;
+				arcs.push_back(std::make_pair(x, y));
+				--joinChildren[y];
+				joinXor[y] ^= x;
+				const int64_t child = splitXor[x], parent = above[x];
+				above[child] = parent;
+				if (parent >= 0)
+					splitXor[parent] ^= x ^ child;
+			}
+			else {
+				y = above[x];
+				if (y < 0)
+					continue;
+				arcs.push_back(std::make_pair(y, x));
+				--splitChildren[y];
+				splitXor[y] ^= x;
+				const int64_t child = joinXor[x], parent = below[x];
+				below[child] = parent;
+				if (parent >= 0)
+					joinXor[parent] ^= x ^ child;
+			}
+			removed[x] = 1;
+			if (isUpperLeaf(y) || isLowerLeaf(y))
+				stack.push_back(y);
+		}
+		return static_cast<int64_t>(arcs.size()) == std::max<int64_t>(count - 1, 0);
+	}
+
+	// the values of the nodes, read from the scalars on the threads
+	template <class T> void nodeValues(const T *scalars, const std::vector<uint64_t>& vertex, int numberOfThreads,
+		std::vector<double>& values)
+	{
+		parallelRanges(static_cast<vtkIdType>(vertex.size()), numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+			for (vtkIdType n = begin; n < end; ++n)
+				values[n] = static_cast<double>(scalars[vertex[n]]);
+		});
+	}
+
+	// a lattice edge (above, below) where the value separates the two sides of a contour tree arc: the superlevel
+	// component of the upper end and the sublevel component of the lower end at the value. The candidates are where
+	// the steepest descents from the lower face neighbours of the upper end, and the steepest ascents from the higher
+	// face neighbours of the lower end, cross the value. A candidate is on the arc if the maximum above it is in the
+	// superlevel component of the upper end, and the minimum below it in the sublevel component of the lower end.
+	// Superlevel sets are followed over face neighbours, sublevel sets over all 18
+	template <class T> bool crossArc(const T *scalars, const int dims[3], uint64_t upper, uint64_t lower, double value,
+		const std::function<bool(uint64_t, uint64_t)>& connectedAbove, const std::function<bool(uint64_t, uint64_t)>& connectedBelow,
+		uint64_t edge[2])
+	{
+		Field<T> field;
+		field.scalars = scalars;
+		for (int a = 0; a < 3; ++a)
+			field.dims[a] = dims[a];
+		field.slice = static_cast<uint64_t>(dims[0]) * dims[1];
+		auto extremum = [&field](uint64_t v, bool up) {
+			const int numberOfOffsets = up ? faceNeighbours : edgeNeighbours;
+			for (uint64_t next = field.Steepest(v, numberOfOffsets, up); next != v; next = field.Steepest(v, numberOfOffsets, up))
+				v = next;
+			return v;
+		};
+		const uint64_t upperMaximum = extremum(upper, true), lowerMinimum = extremum(lower, false);
+
+		for (int direction = 0; direction < 2; ++direction) {
+			const bool down = direction == 0;
+			const uint64_t end = down ? upper : lower;
+			uint64_t neighbours[18];
+			const int count = field.Neighbours(end, faceNeighbours, neighbours);
+			for (int n = 0; n < count; ++n) {
+				if (field.Less(neighbours[n], end) != down)
+					continue;
+				// follow the path until it crosses the value, or stop at an extremum before
+				uint64_t previous = end, current = neighbours[n];
+				while (current != previous && (static_cast<double>(scalars[current]) >= value) == down) {
+					previous = current;
+					current = field.Steepest(current, faceNeighbours, !down);
+				}
+				if (current == previous)
+					continue;
+				const uint64_t above = down ? previous : current, below = down ? current : previous;
+				if (connectedAbove(extremum(above, true), upperMaximum) && connectedBelow(extremum(below, false), lowerMinimum)) {
+					edge[0] = above;
+					edge[1] = below;
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+}
+
+vtkStandardNewMacro(ContourTree);
+
+ContourTree::ContourTree()
+	: NumberOfThreads(0), joinNodes(0), splitNodes(0), numberOfSlabs(0), lastNumberOfThreads(0), sweepTime(0.0),
+	mergeTime(0.0), contourTime(0.0), LastBuildTime(0.0)
+{
+}
+
+bool ContourTree::Build(vtkImageData *volume)
+{
+	vtkDataArray *scalars = volume ? volume->GetPointData()->GetScalars() : nullptr;
+	if (!scalars || scalars->GetNumberOfComponents() != 1) {
+		vtkErrorMacro("No volume with one scalar component for a contour tree.");
+		return false;
+	}
+	int dims[3];
+	volume->GetDimensions(dims);
+	if (dims[0] < 2 || dims[1] < 2 || dims[2] < 2) {
+		vtkErrorMacro("A contour tree needs a volume of at least 2 x 2 x 2 points.");
+		return false;
+	}
+
+	// the points of a slab are indexed with 31 bits
+	vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+	timer->StartTimer();
+	const int numberOfThreads = threadCount(this->NumberOfThreads);
+	const int numberOfPlanes = dims[2] - 1;
+	const double slice = static_cast<double>(dims[0]) * dims[1];
+	const double limit = static_cast<double>(std::numeric_limits<int32_t>::max());
+	int slabs = std::min(numberOfPlanes, 4 * numberOfThreads);
+	while (slabs < numberOfPlanes && slice * ((numberOfPlanes + slabs - 1) / slabs + 1) >= limit)
+		++slabs;
+	if (slice * ((numberOfPlanes + slabs - 1) / slabs + 1) >= limit) {
+		vtkErrorMacro("The planes of the volume are too large for a contour tree.");
+		return false;
+	}
+
+	MergeTree join, split;
+	vtkIdType criticalPoints[2];
+	double times[2];
+	switch (scalars->GetDataType()) {
+		vtkTemplateMacro(buildMergeTrees(static_cast<const VTK_TT*>(scalars->GetVoidPointer(0)), dims, slabs,
+			numberOfThreads, join, split, criticalPoints, times));
+	default:
+		vtkErrorMacro("Unsupported scalar type " << scalars->GetDataTypeAsString());
+		return false;
+	}
+
+	vtkSmartPointer<vtkTimerLog> contourTimer = vtkSmartPointer<vtkTimerLog>::New();
+	contourTimer->StartTimer();
+	// the tree of the last Build stays as it is until the merge succeeded
+	std::vector<int64_t> joinParent, splitParent;
+	std::vector<std::pair<int64_t, int64_t>> merged;
+	if (!mergeContourTree(join, split, numberOfThreads, joinParent, splitParent, merged)) {
+		vtkErrorMacro("The join and the split tree do not merge into a contour tree.");
+		return false;
+	}
+	this->joinParent.swap(joinParent);
+	this->splitParent.swap(splitParent);
+	const int64_t count = static_cast<int64_t>(split.vertex.size());
+	this->nodeVertex.swap(split.vertex);
+	this->nodeValue.resize(count);
+	this->vertexNode.resize(count);
+	switch (scalars->GetDataType()) {
+		vtkTemplateMacro(nodeValues(static_cast<const VTK_TT*>(scalars->GetVoidPointer(0)), this->nodeVertex,
+			numberOfThreads, this->nodeValue));
+	}
+	parallelRanges(count, numberOfThreads, [this](vtkIdType begin, vtkIdType end) {
+		for (vtkIdType n = begin; n < end; ++n)
+			this->vertexNode[n] = std::make_pair(this->nodeVertex[n], static_cast<int64_t>(n));
+	});
+	parallelSort(this->vertexNode, numberOfThreads, std::less<std::pair<uint64_t, int64_t>>());
+	this->arcs.resize(merged.size());
+	parallelRanges(static_cast<vtkIdType>(merged.size()), numberOfThreads, [this, &merged](vtkIdType begin, vtkIdType end) {
+		for (vtkIdType a = begin; a < end; ++a) {
+			this->arcs[a].upper = merged[a].first;
+			this->arcs[a].lower = merged[a].second;
+		}
+	});
+	contourTimer->StopTimer();
+	timer->StopTimer();
+
+	this->volume = volume;
+	this->joinNodes = criticalPoints[0];
+	this->splitNodes = criticalPoints[1];
+	this->numberOfSlabs = slabs;
+	this->lastNumberOfThreads = numberOfThreads;
+	this->sweepTime = times[0];
+	this->mergeTime = times[1];
+	this->contourTime = contourTimer->GetElapsedTime();
+	this->LastBuildTime = timer->GetElapsedTime();
+	Simplify(std::numeric_limits<int>::max());
+	this->Modified();
+	return true;
+}
+
+void ContourTree::Simplify(int numberOfFeatures)
+{
+	const int64_t numberOfNodes = static_cast<int64_t>(this->nodeVertex.size());
+	const int64_t numberOfArcs = static_cast<int64_t>(this->arcs.size());
+	const int numberOfThreads = threadCount(this->NumberOfThreads);
+	this->chains.resize(numberOfArcs);
+	this->chainAlive.assign(numberOfArcs, 1);
+	this->nextArc.assign(numberOfArcs, -1);
+	parallelRanges(numberOfArcs, numberOfThreads, [this](vtkIdType begin, vtkIdType end) {
+		for (vtkIdType a = begin; a < end; ++a) {
+			Chain chain = { this->arcs[a].upper, this->arcs[a].lower, a, a };
+			this->chains[a] = chain;
+		}
+	});
+
+	// arcs up and down from every node, counted on the threads
+	std::vector<int32_t> up(numberOfNodes), down(numberOfNodes);
+	{
+		std::vector<std::atomic<int32_t>> upCount(numberOfNodes), downCount(numberOfNodes);
+		parallelRanges(numberOfNodes, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+			for (vtkIdType n = begin; n < end; ++n)
+				upCount[n] = downCount[n] = 0;
+		});
+		parallelRanges(numberOfArcs, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+			for (vtkIdType a = begin; a < end; ++a) {
+				++downCount[this->arcs[a].upper];
+				++upCount[this->arcs[a].lower];
+			}
+		});
+		parallelRanges(numberOfNodes, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+			for (vtkIdType n = begin; n < end; ++n) {
+				up[n] = upCount[n];
+				down[n] = downCount[n];
+			}
+		});
+	}
+
+	auto persistence = [this](int64_t c) { return this->nodeValue[this->chains[c].upper] - this->nodeValue[this->chains[c].lower]; };
+	auto isLeaf = [&](int64_t n) { return up[n] + down[n] == 1; };
+	typedef std::pair<double, int64_t> Entry;
+	std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+	auto pushLeafArc = [&](int64_t c) {
+		if (isLeaf(this->chains[c].upper) || isLeaf(this->chains[c].lower))
+			heap.push(Entry(persistence(c), c));
+	};
+	const int numberOfRanges = 16 * numberOfThreads;
+	std::vector<int64_t> rangeLeaves(numberOfRanges + 1, 0);
+	parallelFor(numberOfRanges, numberOfThreads, [&](int r, int) {
+		for (int64_t n = numberOfNodes * r / numberOfRanges; n < numberOfNodes * (r + 1) / numberOfRanges; ++n)
+			if (isLeaf(n))
+				++rangeLeaves[r + 1];
+	});
+	for (int r = 0; r < numberOfRanges; ++r)
+		rangeLeaves[r + 1] += rangeLeaves[r];
+	int64_t leaves = rangeLeaves[numberOfRanges];
+
+	// the chains at every node in compressed rows, only when leaves are pruned. A row is filled on the threads in
+	// any order, which the pruning does not depend on
+	const int64_t target = std::max(2, numberOfFeatures);
+	std::vector<int64_t> incidentStart, incident;
+	std::vector<Entry> leafArcs;
+	if (leaves > target) {
+		incidentStart.resize(numberOfNodes + 1);
+		std::vector<int64_t> rangeIncident(numberOfRanges + 1, 0);
+		parallelFor(numberOfRanges, numberOfThreads, [&](int r, int) {
+			for (int64_t n = numberOfNodes * r / numberOfRanges; n < numberOfNodes * (r + 1) / numberOfRanges; ++n)
+				rangeIncident[r + 1] += up[n] + down[n];
+		});
+		for (int r = 0; r < numberOfRanges; ++r)
+			rangeIncident[r + 1] += rangeIncident[r];
+		std::vector<std::atomic<int64_t>> next(numberOfNodes);
+		parallelFor(numberOfRanges, numberOfThreads, [&](int r, int) {
+			int64_t start = rangeIncident[r];
+			for (int64_t n = numberOfNodes * r / numberOfRanges; n < numberOfNodes * (r + 1) / numberOfRanges; ++n) {
+				incidentStart[n] = next[n] = start;
+				start += up[n] + down[n];
+			}
+		});
+		incidentStart[numberOfNodes] = rangeIncident[numberOfRanges];
+		incident.resize(rangeIncident[numberOfRanges]);
+		parallelRanges(numberOfArcs, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+			for (vtkIdType a = begin; a < end; ++a) {
+				incident[next[this->arcs[a].upper]++] = a;
+				incident[next[this->arcs[a].lower]++] = a;
+			}
+		});
+
+		// the leaf arcs of the tree are sorted once in parallel, only the arcs that become leaf arcs while pruning
+		// go through the heap, and the next arc is the least of both
+		std::vector<std::vector<Entry>> rangeArcs(numberOfRanges);
+		parallelFor(numberOfRanges, numberOfThreads, [&](int r, int) {
+			for (int64_t c = numberOfArcs * r / numberOfRanges; c < numberOfArcs * (r + 1) / numberOfRanges; ++c)
+				if (isLeaf(this->chains[c].upper) || isLeaf(this->chains[c].lower))
+					rangeArcs[r].push_back(Entry(persistence(c), c));
+		});
+		for (int r = 0; r < numberOfRanges; ++r)
+			leafArcs.insert(leafArcs.end(), rangeArcs[r].begin(), rangeArcs[r].end());
+		parallelSort(leafArcs, numberOfThreads, std::less<Entry>());
+	}
+	size_t nextLeafArc = 0;
+
+	// the leaf arcs of least persistence (value difference) are pruned first. A maximum is pruned from a saddle with
+	// another arc up, a minimum from one with another arc down, a saddle that is regular afterwards joins its two
+	// arcs, so the arcs of the simplified tree are chains of arcs of the contour tree
+	while (leaves > target && (nextLeafArc < leafArcs.size() || !heap.empty())) {
+		Entry top;
+		if (heap.empty() || (nextLeafArc < leafArcs.size() && leafArcs[nextLeafArc] < heap.top()))
+			top = leafArcs[nextLeafArc++];
+		else {
+			top = heap.top();
+			heap.pop();
+		}
+		const int64_t c = top.second;
+		if (!this->chainAlive[c] || top.first != persistence(c))
+			continue;
+		const int64_t upper = this->chains[c].upper, lower = this->chains[c].lower;
+		int64_t saddle;
+		if (isLeaf(upper) && up[lower] >= 2)
+			saddle = lower;
+		else if (isLeaf(lower) && down[upper] >= 2)
+			saddle = upper;
+		else
+			continue;
+		this->chainAlive[c] = 0;
+		--down[upper];
+		--up[lower];
+		--leaves;
+		if (isLeaf(saddle)) {
+			++leaves;
+			for (int64_t i = incidentStart[saddle]; i < incidentStart[saddle + 1]; ++i)
+				if (this->chainAlive[incident[i]])
+					pushLeafArc(incident[i]);
+		}
+		else if (up[saddle] == 1 && down[saddle] == 1) {
+			int64_t above = -1, below = -1;
+			for (int64_t i = incidentStart[saddle]; i < incidentStart[saddle + 1]; ++i) {
+				const int64_t d = incident[i];
+				if (!this->chainAlive[d])
+					continue;
+				if (this->chains[d].lower == saddle)
+					above = d;
+				else
+					below = d;
+			}
+			const Chain lowerChain = this->chains[below];
+			Chain& upperChain = this->chains[above];
+			this->nextArc[upperChain.last] = lowerChain.first;
+			upperChain.last = lowerChain.last;
+			upperChain.lower = lowerChain.lower;
+			this->chainAlive[below] = 0;
+			up[saddle] = down[saddle] = 0;
+			for (int64_t i = incidentStart[lowerChain.lower]; i < incidentStart[lowerChain.lower + 1]; ++i)
+				if (incident[i] == below)
+					incident[i] = above;
+			pushLeafArc(above);
+		}
+	}
+
+	this->significantValues.clear();
+	for (int64_t n = 0; n < numberOfNodes; ++n)
+		if (up[n] + down[n] > 0)
+			this->significantValues.push_back(this->nodeValue[n]);
+	if (numberOfNodes == 1)
+		this->significantValues.push_back(this->nodeValue[0]);
+	// the nodes are numbered ascending, so are their values
+	this->significantValues.erase(std::unique(this->significantValues.begin(), this->significantValues.end()),
+		this->significantValues.end());
+}
+
+std::vector<int> ContourTree::GetArcsAt(double value) const
+{
+	std::vector<int> result;
+	for (size_t c = 0; c < this->chains.size(); ++c)
+		if (this->chainAlive[c] && this->nodeValue[this->chains[c].upper] >= value && this->nodeValue[this->chains[c].lower] < value)
+			result.push_back(static_cast<int>(c));
+	std::stable_sort(result.begin(), result.end(), [this](int a, int b) {
+		return this->nodeValue[this->chains[a].upper] - this->nodeValue[this->chains[a].lower] >
+			this->nodeValue[this->chains[b].upper] - this->nodeValue[this->chains[b].lower];
+	});
+	return result;
+}
+
+void ContourTree::GetArcRange(int arc, double range[2]) const
+{
+	range[0] = this->nodeValue[this->chains[arc].lower];
+	range[1] = this->nodeValue[this->chains[arc].upper];
+}
+
+vtkIdType ContourTree::GetNumberOfSimplifiedArcs() const
+{
+	return static_cast<vtkIdType>(std::count(this->chainAlive.begin(), this->chainAlive.end(), 1));
+}
+
+int64_t ContourTree::findNode(uint64_t vertex) const
+{
+	auto it = std::lower_bound(this->vertexNode.begin(), this->vertexNode.end(), std::make_pair(vertex, int64_t(-1)));
+	return it != this->vertexNode.end() && it->first == vertex ? it->second : -1;
+}
+
+bool ContourTree::FindSeed(int arc, double value, double point[3]) const
+{
+	if (!this->volume || arc < 0 || arc >= static_cast<int>(this->chains.size()) || !this->chainAlive[arc])
+		return false;
+
+	// the arc of the chain that contains the value
+	int64_t a = this->chains[arc].first;
+	while (!(this->nodeValue[this->arcs[a].upper] >= value && this->nodeValue[this->arcs[a].lower] < value)) {
+		if (a == this->chains[arc].last)
+			return false;
+		a = this->nextArc[a];
+	}
+
+	// two maxima are connected above the value if their lowest join tree ancestors above it are the same, two
+	// minima below it if their highest split tree ancestors below it are
+	auto connectedAbove = [this, value](uint64_t first, uint64_t second) {
+		int64_t nodes[2] = { findNode(first), findNode(second) };
+		if (nodes[0] < 0 || nodes[1] < 0)
+			return false;
+		for (int n = 0; n < 2; ++n)
+			while (this->joinParent[nodes[n]] >= 0 && this->nodeValue[this->joinParent[nodes[n]]] >= value)
+				nodes[n] = this->joinParent[nodes[n]];
+		return nodes[0] == nodes[1];
+	};
+	auto connectedBelow = [this, value](uint64_t first, uint64_t second) {
+		int64_t nodes[2] = { findNode(first), findNode(second) };
+		if (nodes[0] < 0 || nodes[1] < 0)
+			return false;
+		for (int n = 0; n < 2; ++n)
+			while (this->splitParent[nodes[n]] >= 0 && this->nodeValue[this->splitParent[nodes[n]]] < value)
+				nodes[n] = this->splitParent[nodes[n]];
+		return nodes[0] == nodes[1];
+	};
+	vtkDataArray *scalars = this->volume->GetPointData()->GetScalars();
+	int dims[3];
+	this->volume->GetDimensions(dims);
+	const int64_t upper = this->arcs[a].upper, lower = this->arcs[a].lower;
+	uint64_t edge[2];
+	bool found = false;
+	switch (scalars->GetDataType()) {
+		vtkTemplateMacro(found = crossArc(static_cast<const VTK_TT*>(scalars->GetVoidPointer(0)), dims,
+			this->nodeVertex[upper], this->nodeVertex[lower], value, connectedAbove, connectedBelow, edge));
+	}
+	if (!found)
+		return false;
+
+	// interpolated as marching cubes does
+	double ends[2][3];
+	for (int e = 0; e < 2; ++e)
+		this->volume->GetPoint(static_cast<vtkIdType>(edge[e]), ends[e]);
+	const double above = scalars->GetTuple1(static_cast<vtkIdType>(edge[0]));
+	const double below = scalars->GetTuple1(static_cast<vtkIdType>(edge[1]));
+	const double t = above != below ? (above - value) / (above - below) : 0.0;
+	for (int c = 0; c < 3; ++c)
+		point[c] = ends[0][c] + t * (ends[1][c] - ends[0][c]);
+	return true;
+}
+
+void ContourTree::PrintStatistics(std::ostream& os) const
+{
+	std::vector<int32_t> degree(this->nodeVertex.size(), 0);
+	for (size_t a = 0; a < this->arcs.size(); ++a) {
+		++degree[this->arcs[a].upper];
+		++degree[this->arcs[a].lower];
+	}
+	os << "contour tree: " << GetNumberOfNodes() << " nodes, " << GetNumberOfArcs() << " arcs, "
+		<< std::count(degree.begin(), degree.end(), 1) << " leaves ("
+		<< this->joinNodes << " join tree and " << this->splitNodes << " split tree critical points), "
+		<< GetNumberOfSimplifiedArcs() << " arcs and " << this->significantValues.size()
+		<< " significant values after simplification, " << std::fixed << std::setprecision(3) << this->LastBuildTime
+		<< " s on " << this->lastNumberOfThreads << " threads in " << this->numberOfSlabs << " slabs (sweeps "
+		<< this->sweepTime << " s, merges " << this->mergeTime << " s, contour tree " << this->contourTime << " s)"
+		<< std::endl;
+}
+
+ContourTreeNavigator::ContourTreeNavigator()
+	: PreviousKey('['), NextKey(']'), ArcKey('k'), NumberOfThreads(0), renderer(nullptr), interactor(nullptr),
+	slider(nullptr), arc(-1), numberOfFeatures(0), buildDone(false), buildSucceeded(false)
+{
+}
+
+ContourTreeNavigator::~ContourTreeNavigator()
+{
+	// a Build cannot be interrupted, the last one is waited for
+	if (builder.joinable())
+		builder.join();
+}
+
+void ContourTreeNavigator::Attach(vtkRenderer *renderer, vtkRenderWindowInteractor *interactor, vtkSliderWidget *slider)
+{
+	this->renderer = renderer;
+	this->interactor = interactor;
+	this->slider = slider;
+	if (tree && vtkSliderRepresentation2D::SafeDownCast(slider->GetRepresentation())) {
+		vtkSmartPointer<vtkPolyDataMapper2D> mapper = vtkSmartPointer<vtkPolyDataMapper2D>::New();
+		ticks = vtkSmartPointer<vtkActor2D>::New();
+		ticks->SetMapper(mapper);
+		ticks->GetProperty()->SetColor(1.0, 0.8, 0.2);
+		ticks->GetProperty()->SetLineWidth(2.0);
+		drawTicks();
+		renderer->AddActor2D(ticks);
+	}
+	interactor->AddObserver(vtkCommand::KeyPressEvent, this);
+	slider->AddObserver(vtkCommand::InteractionEvent, this);
+}
+
+void ContourTreeNavigator::TreeChanged()
+{
+	// without a tree the ticks are hidden and the keys do nothing
+	if (ticks) {
+		ticks->SetVisibility(tree ? 1 : 0);
+		if (tree)
+			drawTicks();
+	}
+	arc = -1;
+	if (components)
+		components->UseSeedPointOff();
+}
+
+void ContourTreeNavigator::Rebuild(vtkImageData *volume, int numberOfFeatures)
+{
+	// the arcs and the seeds of the tree before are not those of the new voxels
+	tree = nullptr;
+	TreeChanged();
+	if (!scheduler) {
+		vtkSmartPointer<ContourTree> built = vtkSmartPointer<ContourTree>::New();
+		built->SetNumberOfThreads(NumberOfThreads);
+		if (built->Build(volume)) {
+			built->Simplify(numberOfFeatures);
+			tree = built;
+			TreeChanged();
+		}
+		return;
+	}
+
+	// the worker gets its own copy, the scalars of an attached volume are unmapped after the next refresh
+	nextVolume = vtkSmartPointer<vtkImageData>::New();
+	nextVolume->DeepCopy(volume);
+	this->numberOfFeatures = numberOfFeatures;
+	if (!builder.joinable())
+		startBuild();
+}
+
+void ContourTreeNavigator::startBuild()
+{
+	vtkSmartPointer<ContourTree> building = vtkSmartPointer<ContourTree>::New();
+	building->SetNumberOfThreads(NumberOfThreads);
+	vtkSmartPointer<vtkImageData> volume = nextVolume;
+	const int features = numberOfFeatures;
+	nextVolume = nullptr;
+	buildDone = false;
+	// the tree and its volume are only seen by the worker until it is done
+	builder = std::thread([this, building, volume, features]() {
+		const bool succeeded = building->Build(volume);
+		if (succeeded)
+			building->Simplify(features);
+		std::lock_guard<std::mutex> lock(buildMutex);
+		builtTree = building;
+		buildSucceeded = succeeded;
+		buildDone = true;
+	});
+	postBuildCheck();
+}
+
+void ContourTreeNavigator::postBuildCheck()
+{
+	// checks once per display interval whether the worker is done, then takes its tree and renders a frame. The key
+	// is not the navigator, whose seed updates would replace the check
+	scheduler->Post(&builder, [this]() {
+		vtkSmartPointer<ContourTree> built;
+		{
+			std::lock_guard<std::mutex> lock(buildMutex);
+			if (!buildDone) {
+				postBuildCheck();
+				return false;
+			}
+			if (buildSucceeded)
+				built = builtTree;
+			builtTree = nullptr;
+		}
+		builder.join();
+		// the tree of a volume that was replaced while the worker ran is not shown
+		if (nextVolume) {
+			startBuild();
+			return false;
+		}
+		if (!built)
+			return false;
+		tree = built;
+		TreeChanged();
+		return true;
+	});
+}
+
+void ContourTreeNavigator::drawTicks()
+{
+	vtkSliderRepresentation2D *representation = vtkSliderRepresentation2D::SafeDownCast(slider->GetRepresentation());
+	// the center of the slider moves between the end caps, EndCapLength + SliderLength / 2 of the tube length away
+	// from its ends, where the ticks are placed across the tube
+	double ends[2][2];
+	for (int e = 0; e < 2; ++e) {
+		vtkCoordinate *coordinate = e == 0 ? representation->GetPoint1Coordinate() : representation->GetPoint2Coordinate();
+		const double *display = coordinate->GetComputedDoubleDisplayValue(renderer);
+		ends[e][0] = display[0];
+		ends[e][1] = display[1];
+	}
+	const double along[2] = { ends[1][0] - ends[0][0], ends[1][1] - ends[0][1] };
+	const double length = std::sqrt(along[0] * along[0] + along[1] * along[1]);
+	const double inset = representation->GetEndCapLength() + 0.5 * representation->GetSliderLength();
+	const double minimum = representation->GetMinimumValue(), maximum = representation->GetMaximumValue();
+	vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+	vtkSmartPointer<vtkCellArray> lines = vtkSmartPointer<vtkCellArray>::New();
+	const std::vector<double>& values = tree->GetSignificantValues();
+	for (size_t v = 0; v < values.size() && length > 0.0 && maximum > minimum; ++v) {
+		if (values[v] < minimum || values[v] > maximum)
+			continue;
+		const double t = inset + (1.0 - 2.0 * inset) * (values[v] - minimum) / (maximum - minimum);
+		const double center[2] = { ends[0][0] + t * along[0], ends[0][1] + t * along[1] };
+		const double across[2] = { -8.0 * along[1] / length, 8.0 * along[0] / length };
+		const vtkIdType first = points->InsertNextPoint(center[0] - across[0], center[1] - across[1], 0.0);
+		points->InsertNextPoint(center[0] + across[0], center[1] + across[1], 0.0);
+		lines->InsertNextCell(2);
+		lines->InsertCellPoint(first);
+		lines->InsertCellPoint(first + 1);
+	}
+	vtkSmartPointer<vtkPolyData> tickLines = vtkSmartPointer<vtkPolyData>::New();
+	tickLines->SetPoints(points);
+	tickLines->SetLines(lines);
+	static_cast<vtkPolyDataMapper2D*>(ticks->GetMapper())->SetInputData(tickLines);
+}
+
+void ContourTreeNavigator::setValue(double value)
+{
+	static_cast<vtkSliderRepresentation*>(slider->GetRepresentation())->SetValue(value);
+	// as if the slider was dragged there, for the iso value callback and the seed
+	slider->InvokeEvent(vtkCommand::InteractionEvent, nullptr);
+	if (scheduler)
+		scheduler->RequestRender();
+	else
+		interactor->Render();
+}
+
+void ContourTreeNavigator::updateSeed(double value)
+{
+	if (!components)
+		return;
+	InteractionScheduler::Update update = [this, value]() {
+		double point[3];
+		if (arc >= 0 && tree->FindSeed(arc, value, point)) {
+			components->SetSeedPoint(point);
+			components->UseSeedPointOn();
+			return true;
+		}
+		if (arc >= 0)
+			std::cout << "contour tree: the arc ends before " << value << ", the whole surface is shown" << std::endl;
+		arc = -1;
+		const bool changed = components->GetUseSeedPoint();
+		components->UseSeedPointOff();
+		return changed;
+	};
+	if (scheduler)
+		scheduler->Post(this, update);
+	else if (update())
+		interactor->Render();
+}
+
+void ContourTreeNavigator::Execute(vtkObject *caller, unsigned long eventId, void *callData)
+{
+	if (!tree || !slider)
+		return;
+	vtkSliderRepresentation *representation = static_cast<vtkSliderRepresentation*>(slider->GetRepresentation());
+	const double value = representation->GetValue();
+	if (eventId == vtkCommand::InteractionEvent) {
+		if (arc >= 0)
+			updateSeed(value);
+		return;
+	}
+	if (eventId != vtkCommand::KeyPressEvent)
+		return;
+
+	const char key = interactor->GetKeyCode();
+	if (key == PreviousKey || key == NextKey) {
+		const std::vector<double>& values = tree->GetSignificantValues();
+		const double minimum = representation->GetMinimumValue(), maximum = representation->GetMaximumValue();
+		const double tolerance = 1e-9 * std::max(1.0, maximum - minimum);
+		if (key == NextKey) {
+			auto it = std::upper_bound(values.begin(), values.end(), value + tolerance);
+			if (it != values.end() && *it <= maximum)
+				setValue(*it);
+		}
+		else {
+			auto it = std::lower_bound(values.begin(), values.end(), value - tolerance);
+			if (it != values.begin() && *(it - 1) >= minimum)
+				setValue(*(it - 1));
+		}
+	}
+	else if (key == ArcKey && components) {
+		// the next arc at the value, longest first, after the last one the whole surface again
+		const std::vector<int> arcs = tree->GetArcsAt(value);
+		const std::vector<int>::const_iterator current = std::find(arcs.begin(), arcs.end(), arc);
+		const size_t index = arc < 0 || current == arcs.end() ? 0 : (current - arcs.begin()) + 1;
+		arc = index < arcs.size() ? arcs[index] : -1;
+		if (arc >= 0) {
+			double range[2];
+			tree->GetArcRange(arc, range);
+			std::cout << "contour tree: arc " << index + 1 << " of " << arcs.size() << " at " << value << ", values "
+				<< range[0] << " to " << range[1] << std::endl;
+		}
+		else
+			std::cout << "contour tree: the whole surface at " << value << std::endl;
+		updateSeed(value);
+	}
+}
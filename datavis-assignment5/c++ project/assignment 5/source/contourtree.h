@@ -0,0 +1,171 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+// Contour tree of the volume, for the topologically significant iso values and the surface of a single tree arc.
+//
+
+#pragma once
+
+#include "surfacecomponents.h"
+#include "interactionscheduler.h"
+
+#include <vtkObject.h>
+#include <vtkSmartPointer.h>
+#include <vtkImageData.h>
+#include <vtkRenderer.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkSliderWidget.h>
+#include <vtkActor2D.h>
+#include <vtkCommand.h>
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include <thread>
+#include <mutex>
+
+/* Contour tree of a volume with one scalar component in the total order of (value, point id), superlevel sets
+   connected over the 6 face neighbours and sublevel sets over all 18. Every arc is a family of iso surface
+   components between the values of its ends. The join and the split tree are built on the threads from slabs of
+   planes and merged into the contour tree, Simplify prunes the arcs of least persistence for the significant
+   iso values. */
+class ContourTree : public vtkObject {
+public:
+	static ContourTree *New();
+	vtkTypeMacro(ContourTree, vtkObject);
+
+	/* Number of worker threads of Build and Simplify, 0 uses all hardware threads. */
+	vtkSetClampMacro(NumberOfThreads, int, 0, 256);
+	vtkGetMacro(NumberOfThreads, int);
+
+	/* Computes the contour tree, false for volumes without one scalar component. The volume is kept for FindSeed
+	   and must not change afterwards. A failed Build leaves the tree of the last one unchanged. */
+	bool Build(vtkImageData *volume);
+
+	/* Prunes leaf arcs until at most numberOfFeatures leaves (at least 2) remain. */
+	void Simplify(int numberOfFeatures);
+
+	/* Ascending values of the nodes of the simplified tree. */
+	const std::vector<double>& GetSignificantValues() const { return significantValues; }
+
+	/* Arcs of the simplified tree that contain the value, upper end >= value > lower end, longest first. */
+	std::vector<int> GetArcsAt(double value) const;
+	void GetArcRange(int arc, double range[2]) const;
+
+	/* A point of the iso surface component of the arc at the value, false if the arc does not contain it or no
+	   seed is found. The point is where a monotone path of points from an end of the arc crosses the value,
+	   interpolated on a lattice edge like the vertices of marching cubes, so it is a vertex of the surface. */
+	bool FindSeed(int arc, double value, double point[3]) const;
+
+	vtkIdType GetNumberOfNodes() const { return static_cast<vtkIdType>(nodeVertex.size()); }
+	vtkIdType GetNumberOfArcs() const { return static_cast<vtkIdType>(arcs.size()); }
+	vtkIdType GetNumberOfSimplifiedArcs() const;
+	vtkGetMacro(LastBuildTime, double);
+
+	/* Nodes, arcs, leaves and the times of sweeps, merges and contour tree of the last Build. */
+	void PrintStatistics(std::ostream& os) const;
+
+protected:
+	ContourTree();
+	~ContourTree() override {}
+
+private:
+	ContourTree(const ContourTree&) = delete;
+	void operator=(const ContourTree&) = delete;
+
+	// node ids of the ends of an arc, nodes are numbered ascending in the total order
+	struct Arc {
+		int64_t upper;
+		int64_t lower;
+	};
+	// arc of the simplified tree, the chain of contour tree arcs from first to last through nextArc
+	struct Chain {
+		int64_t upper;
+		int64_t lower;
+		int64_t first;
+		int64_t last;
+	};
+
+	int64_t findNode(uint64_t vertex) const;
+
+	int NumberOfThreads;
+	vtkSmartPointer<vtkImageData> volume;
+	std::vector<uint64_t> nodeVertex;           // point id of every node
+	std::vector<double> nodeValue;
+	std::vector<int64_t> joinParent;            // next lower node in the join tree, -1 at the root
+	std::vector<int64_t> splitParent;           // next higher node in the split tree, -1 at the root
+	std::vector<std::pair<uint64_t, int64_t>> vertexNode;     // (point id, node) sorted by point id
+	std::vector<Arc> arcs;
+	std::vector<Chain> chains;
+	std::vector<char> chainAlive;
+	std::vector<int64_t> nextArc;
+	std::vector<double> significantValues;
+
+	vtkIdType joinNodes;
+	vtkIdType splitNodes;
+	int numberOfSlabs;
+	int lastNumberOfThreads;
+	double sweepTime;
+	double mergeTime;
+	double contourTime;
+	double LastBuildTime;
+};
+
+/* Significant iso values as tick marks under the iso value slider, with keys to move the slider to the previous or
+   next one, and a key to cycle through the arcs of the simplified contour tree at the slider value: the component
+   filter of the surface then keeps only the component seeded on the arc, until the key comes back to the whole
+   surface. The seed follows the slider as long as the arc contains the value. */
+class ContourTreeNavigator : public vtkCommand {
+private:
+	ContourTreeNavigator();
+	~ContourTreeNavigator() override;
+
+public:
+	static ContourTreeNavigator *New() { return new ContourTreeNavigator; }
+
+	char PreviousKey;
+	char NextKey;
+	char ArcKey;
+	vtkSmartPointer<ContourTree> tree;
+	vtkSmartPointer<SurfaceComponentFilter> components;     // of the surface of the slider, gets the seed
+	vtkSmartPointer<InteractionScheduler> scheduler;
+	int NumberOfThreads;        // of the trees built by Rebuild, 0 uses all hardware threads
+
+	/* Draws the tick marks of the 2D slider representation and follows the keys and the slider. */
+	void Attach(vtkRenderer *renderer, vtkRenderWindowInteractor *interactor, vtkSliderWidget *slider);
+
+	/* After the tree was built again: draws the tick marks of its values, and shows the whole surface again because
+	   the arcs of the old tree are gone. Without a tree the tick marks are hidden. The caller renders. */
+	void TreeChanged();
+
+	/* Drops the tree of the volume before and builds and simplifies the tree of a copy of the volume on a worker
+	   thread. The navigator takes the new tree once the worker is done, polled through the scheduler, and stays
+	   without one if the Build fails. A rebuild requested while one runs starts after it with the last volume.
+	   Without a scheduler the tree is built right away. */
+	void Rebuild(vtkImageData *volume, int numberOfFeatures);
+
+	virtual void Execute(vtkObject *caller, unsigned long eventId, void *callData);
+
+private:
+	void drawTicks();
+	void setValue(double value);
+	void updateSeed(double value);
+	void startBuild();
+	void postBuildCheck();
+
+	vtkRenderer *renderer;
+	vtkRenderWindowInteractor *interactor;
+	vtkSliderWidget *slider;
+	vtkSmartPointer<vtkActor2D> ticks;
+	int arc;        // selected arc of the simplified tree, -1 for the whole surface
+
+	// the worker building the next tree. The volume of the next rebuild and its number of features are only used
+	// on the render thread, the result of the worker is guarded by buildMutex
+	std::thread builder;
+	vtkSmartPointer<vtkImageData> nextVolume;
+	int numberOfFeatures;
+	std::mutex buildMutex;
+	vtkSmartPointer<ContourTree> builtTree;
+	bool buildDone;
+	bool buildSucceeded;
+};
@@ -0,0 +1,154 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+
+#include "cropbox.h"
+
+#include <vtkProperty.h>
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+
+CropBox::CropBox()
+	: ToggleKey('b'), interactor(nullptr)
+{
+	representation = vtkSmartPointer<vtkBoxRepresentation>::New();
+	representation->SetPlaceFactor(1.0);
+	representation->GetOutlineProperty()->SetColor(1.0, 0.8, 0.2);
+
+	// an axis aligned box, the extent has no rotation; 'i' stays free for other bindings
+	widget = vtkSmartPointer<vtkBoxWidget2>::New();
+	widget->SetRepresentation(representation);
+	widget->RotationEnabledOff();
+	widget->KeyPressActivationOff();
+
+	for (int a = 0; a < 3; ++a) {
+		wholeExtent[2 * a] = wholeExtent[2 * a + 1] = 0;
+		origin[a] = 0.0;
+		spacing[a] = 1.0;
+	}
+}
+
+void CropBox::Attach(vtkRenderWindowInteractor *interactor, vtkImageData *volume)
+{
+	this->interactor = interactor;
+	volume->GetExtent(wholeExtent);
+	volume->GetOrigin(origin);
+	volume->GetSpacing(spacing);
+
+	double bounds[6];
+	volume->GetBounds(bounds);
+	representation->PlaceWidget(bounds);
+	widget->SetInteractor(interactor);
+	widget->AddObserver(vtkCommand::InteractionEvent, this);
+	widget->AddObserver(vtkCommand::EndInteractionEvent, this);
+	interactor->AddObserver(vtkCommand::KeyPressEvent, this);
+}
+
+void CropBox::SetEnabled(bool enabled)
+{
+	widget->SetEnabled(enabled);
+	apply();
+}
+
+bool CropBox::GetEnabled() const
+{
+	return widget->GetEnabled() != 0;
+}
+
+void CropBox::GetExtent(int extent[6]) const
+{
+	// the voxels the box touches, at least one cell per axis
+	const double *bounds = representation->GetBounds();
+	for (int a = 0; a < 3; ++a) {
+		int lower = static_cast<int>(std::floor((bounds[2 * a] - origin[a]) / spacing[a] + 1e-6));
+		int upper = static_cast<int>(std::ceil((bounds[2 * a + 1] - origin[a]) / spacing[a] - 1e-6));
+		lower = std::max(wholeExtent[2 * a], std::min(lower, wholeExtent[2 * a + 1] - 1));
+		upper = std::min(wholeExtent[2 * a + 1], std::max(upper, lower + 1));
+		extent[2 * a] = lower;
+		extent[2 * a + 1] = upper;
+	}
+}
+
+void CropBox::apply()
+{
+	int extent[6];
+	if (GetEnabled())
+		GetExtent(extent);
+	else
+		std::copy(wholeExtent, wholeExtent + 6, extent);
+
+	WeldedMarchingCubes *surface = extractor;
+	vtkVolumeMapper *mapper = volumeMapper;
+	const bool crop = GetEnabled();
+	double planes[6];
+	for (int i = 0; i < 6; ++i)
+		planes[i] = origin[i / 2] + extent[i] * spacing[i / 2];
+
+	InteractionScheduler::Update update = [surface, mapper, crop, extent, planes]() mutable {
+		if (mapper) {
+			mapper->SetCropping(crop);
+			mapper->SetCroppingRegionPlanes(planes);
+			mapper->SetCroppingRegionFlagsToSubVolume();
+		}
+		if (surface) {
+			int current[6];
+			surface->GetVolumeOfInterest(current);
+			if (std::equal(extent, extent + 6, current))
+				return mapper != nullptr;
+			surface->SetVolumeOfInterest(extent);
+			surface->Update();
+		}
+		return true;
+	};
+	if (scheduler)
+		scheduler->Post(this, update);
+	else {
+		update();
+		if (interactor)
+			interactor->Render();
+	}
+}
+
+void CropBox::printRegion(std::ostream& os) const
+{
+	int extent[6];
+	GetExtent(extent);
+	double cells = 1.0, wholeCells = 1.0;
+	for (int a = 0; a < 3; ++a) {
+		cells *= extent[2 * a + 1] - extent[2 * a];
+		wholeCells *= std::max(1, wholeExtent[2 * a + 1] - wholeExtent[2 * a]);
+	}
+	os << "crop box: extent " << extent[0] << "-" << extent[1] << ", " << extent[2] << "-" << extent[3] << ", "
+		<< extent[4] << "-" << extent[5] << ", " << std::fixed << std::setprecision(1) << 100.0 * cells / wholeCells
+		<< "% of the cells";
+	if (extractor)
+		os << ", extraction " << std::setprecision(2) << 1000.0 * (extractor->GetLastCountTime()
+			+ extractor->GetLastPrefixSumTime() + extractor->GetLastGenerateTime()) << " ms";
+	os << std::endl;
+}
+
+void CropBox::Execute(vtkObject *caller, unsigned long eventId, void *callData)
+{
+	if (eventId == vtkCommand::KeyPressEvent) {
+		vtkRenderWindowInteractor *keyInteractor = static_cast<vtkRenderWindowInteractor*>(caller);
+		if (keyInteractor->GetKeyCode() == ToggleKey) {
+			SetEnabled(!GetEnabled());
+			if (scheduler)
+				scheduler->RequestRender();
+		}
+		return;
+	}
+
+	if (eventId == vtkCommand::InteractionEvent)
+		apply();
+	else if (eventId == vtkCommand::EndInteractionEvent) {
+		// queued behind the extraction of the last box, so the time is the one of that box
+		if (scheduler)
+			scheduler->Post(&representation, [this]() { printRegion(std::cout); return false; });
+		else
+			printRegion(std::cout);
+	}
+}
@@ -0,0 +1,64 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+// Interactive crop box that limits iso surface extraction and volume ray casting to a region of the volume.
+//
+
+#pragma once
+
+#include "weldedcubes.h"
+#include "interactionscheduler.h"
+
+#include <vtkSmartPointer.h>
+#include <vtkImageData.h>
+#include <vtkVolumeMapper.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkBoxWidget2.h>
+#include <vtkBoxRepresentation.h>
+#include <vtkCommand.h>
+
+#include <ostream>
+
+/* Box widget on the volume, shown and hidden with the toggle key. While shown, the iso surfaces are extracted
+   and the volume is ray cast only inside the box, snapped to whole voxels:
+   - the extractor gets the box as volume of interest and reads that sub-extent in place, no vtkExtractVOI copy,
+   - the volume mapper crops its rays to the box (vtkVolumeMapper cropping, sub-volume region), the uploaded
+     volume stays as it is.
+   So dragging the box only changes an extent and six planes. The extraction runs through the interaction
+   scheduler, at most once per frame for the last box. When a drag ends, the region and its extraction time are
+   printed. Hiding the box restores the whole volume. */
+class CropBox : public vtkCommand {
+private:
+	CropBox();
+
+public:
+	static CropBox *New() { return new CropBox; }
+
+	char ToggleKey;
+	vtkSmartPointer<WeldedMarchingCubes> extractor;
+	vtkSmartPointer<vtkVolumeMapper> volumeMapper;
+	vtkSmartPointer<InteractionScheduler> scheduler;
+
+	/* Places the box on the bounds of the volume and observes the key presses of the interactor. */
+	void Attach(vtkRenderWindowInteractor *interactor, vtkImageData *volume);
+
+	/* Shows or hides the box, hidden the whole volume is extracted and rendered. */
+	void SetEnabled(bool enabled);
+	bool GetEnabled() const;
+
+	/* Extent of the box in the structured coordinates of the volume. */
+	void GetExtent(int extent[6]) const;
+
+	virtual void Execute(vtkObject *caller, unsigned long eventId, void *callData);
+
+private:
+	void apply();
+	void printRegion(std::ostream& os) const;
+
+	vtkSmartPointer<vtkBoxWidget2> widget;
+	vtkSmartPointer<vtkBoxRepresentation> representation;
+	vtkRenderWindowInteractor *interactor;
+	int wholeExtent[6];
+	double origin[3];
+	double spacing[3];
+};
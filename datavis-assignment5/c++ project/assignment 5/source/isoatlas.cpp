@@ -0,0 +1,789 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+
+#include "isoatlas.h"
+#include "weldedcubes.h"
+#include "volumekernels.h"
+
+#include <vtkObjectFactory.h>
+#include <vtkSmartPointer.h>
+#include <vtkPointData.h>
+#include <vtkDataArray.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkPoints.h>
+#include <vtkCellArray.h>
+#include <vtkMarchingCubesTriangleCases.h>
+#include <vtkTimerLog.h>
+
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <bitset>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <iomanip>
+
+namespace {
+	const char atlasMagic[8] = { 'I', 'S', 'O', 'A', 'T', 'L', 'A', 'S' };
+	const uint32_t atlasVersion = 1;
+	const uint32_t blockCells = 4096;
+	const size_t headerSize = 8 + 4 + 5 * 4 + 2 * 8 + 5 * 8;
+
+	// 64 bit hash of the bytes: a multiply-xor hash per MB, the hashes of the MBs combined in order
+	uint64_t hashBytes(const unsigned char *bytes, size_t size, int numberOfThreads)
+	{
+		const size_t chunkSize = size_t(1) << 20;
+		const int numberOfChunks = static_cast<int>((size + chunkSize - 1) / chunkSize);
+		std::vector<uint64_t> hashes(numberOfChunks);
+		parallelFor(numberOfChunks, numberOfThreads, [&](int chunk, int) {
+			const size_t begin = chunk * chunkSize, end = std::min(size, begin + chunkSize);
+			uint64_t hash = 0xcbf29ce484222325ULL;
+			size_t b = begin;
+			for (; b + 8 <= end; b += 8) {
+				uint64_t word;
+				std::memcpy(&word, bytes + b, 8);
+				hash = (hash ^ word) * 0x100000001b3ULL;
+				hash ^= hash >> 29;
+			}
+			for (; b < end; ++b)
+				hash = (hash ^ bytes[b]) * 0x100000001b3ULL;
+			hashes[chunk] = hash;
+		});
+		uint64_t hash = size;
+		for (int chunk = 0; chunk < numberOfChunks; ++chunk)
+			hash = (hash ^ hashes[chunk]) * 0x9e3779b97f4a7c15ULL;
+		return hash;
+	}
+
+	uint64_t hashVoxels(vtkDataArray *scalars, int numberOfThreads)
+	{
+		return hashBytes(static_cast<const unsigned char*>(scalars->GetVoidPointer(0)),
+			static_cast<size_t>(scalars->GetNumberOfTuples()) * scalars->GetDataTypeSize(), numberOfThreads);
+	}
+
+	// the span space bin of a value, monotone in the value
+	struct Binning {
+		double low;
+		double scale;
+		int bins;
+
+		int operator()(double value) const
+		{
+			const double bin = std::floor((value - low) * scale);
+			return bin < 0.0 ? 0 : bin >= bins ? bins - 1 : static_cast<int>(bin);
+		}
+	};
+
+	Binning makeBinning(const double range[2], int bins)
+	{
+		Binning binning = { range[0], range[1] > range[0] ? bins / (range[1] - range[0]) : 0.0, bins };
+		return binning;
+	}
+
+	void writeVarint(uint64_t value, std::vector<unsigned char>& bytes)
+	{
+		while (value >= 0x80) {
+			bytes.push_back(static_cast<unsigned char>(value | 0x80));
+			value >>= 7;
+		}
+		bytes.push_back(static_cast<unsigned char>(value));
+	}
+
+	uint64_t readVarint(const unsigned char *&bytes)
+	{
+		uint64_t value = 0;
+		for (int shift = 0;; shift += 7) {
+			const unsigned char byte = *bytes++;
+			value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+			if (!(byte & 0x80))
+				return value;
+		}
+	}
+
+	// the whole volume with one scalar component
+	template <class T> struct Lattice {
+		const T *scalars;
+		int dims[3];
+		vtkIdType rowSize;
+		vtkIdType sliceSize;
+
+		double Value(int i, int j, int k) const
+		{
+			return static_cast<double>(scalars[i + j * rowSize + k * sliceSize]);
+		}
+
+		void Corners(const int cell[3], double s[8]) const
+		{
+			for (int corner = 0; corner < 8; ++corner)
+				s[corner] = Value(cell[0] + cellVertex[corner][0], cell[1] + cellVertex[corner][1], cell[2] + cellVertex[corner][2]);
+		}
+
+		// negative central differences, one sided at the border, like vtkMarchingCubes
+		void Gradient(const int point[3], const double spacing[3], double g[3]) const
+		{
+			for (int axis = 0; axis < 3; ++axis) {
+				int lower[3] = { point[0], point[1], point[2] }, upper[3] = { point[0], point[1], point[2] };
+				if (lower[axis] > 0)
+					--lower[axis];
+				if (upper[axis] < dims[axis] - 1)
+					++upper[axis];
+				const int steps = upper[axis] - lower[axis];
+				g[axis] = steps ? (Value(lower[0], lower[1], lower[2]) - Value(upper[0], upper[1], upper[2])) / (steps * spacing[axis]) : 0.0;
+			}
+		}
+	};
+
+	template <class T> Lattice<T> makeLattice(const T *scalars, const int dims[3])
+	{
+		Lattice<T> lattice = { scalars, { dims[0], dims[1], dims[2] }, dims[0], static_cast<vtkIdType>(dims[0]) * dims[1] };
+		return lattice;
+	}
+
+	// visit(id, key) for the cells of slab out of numberOfSlabs, key is the span space bin of the cell or -1 for a
+	// constant cell
+	template <class T, class Visit> void visitSlab(const Lattice<T>& lattice, const Binning& binning, int slab,
+		int numberOfSlabs, Visit visit)
+	{
+		const int cells[3] = { lattice.dims[0] - 1, lattice.dims[1] - 1, lattice.dims[2] - 1 };
+		const int kBegin = static_cast<int>(static_cast<int64_t>(slab) * cells[2] / numberOfSlabs);
+		const int kEnd = static_cast<int>(static_cast<int64_t>(slab + 1) * cells[2] / numberOfSlabs);
+		for (int k = kBegin; k < kEnd; ++k)
+			for (int j = 0; j < cells[1]; ++j)
+				for (int i = 0; i < cells[0]; ++i) {
+					const int cell[3] = { i, j, k };
+					double s[8];
+					lattice.Corners(cell, s);
+					const double low = *std::min_element(s, s + 8), high = *std::max_element(s, s + 8);
+					const uint32_t id = static_cast<uint32_t>(i + static_cast<uint64_t>(cells[0]) * (j + static_cast<uint64_t>(cells[1]) * k));
+					visit(id, low < high ? binning(low) * binning.bins + binning(high) : -1);
+				}
+	}
+
+	// Sorts the ids of the non-constant cells by the span space bin of (min, max), ascending inside a bin, with a
+	// counting sort over slabs of cells: a histogram of the bins per slab, their prefix sums in bin and slab order,
+	// and a second pass that scatters the ids. binStart gets the first position of every bin and one past the end.
+	template <class T> void sortCells(const T *scalars, const int dims[3], const Binning& binning, int numberOfThreads,
+		std::vector<uint32_t>& ids, std::vector<uint64_t>& binStart)
+	{
+		const Lattice<T> lattice = makeLattice(scalars, dims);
+		const int numberOfKeys = binning.bins * binning.bins;
+		const int numberOfSlabs = std::min(dims[2] - 1, 64);
+
+		std::vector<uint64_t> position(static_cast<size_t>(numberOfSlabs) * numberOfKeys, 0);
+		parallelFor(numberOfSlabs, numberOfThreads, [&](int slab, int) {
+			uint64_t *counts = &position[static_cast<size_t>(slab) * numberOfKeys];
+			visitSlab(lattice, binning, slab, numberOfSlabs, [&](uint32_t, int key) {
+				if (key >= 0)
+					++counts[key];
+			});
+		});
+
+		binStart.assign(numberOfKeys + 1, 0);
+		uint64_t total = 0;
+		for (int key = 0; key < numberOfKeys; ++key) {
+			binStart[key] = total;
+			for (int slab = 0; slab < numberOfSlabs; ++slab) {
+				uint64_t& slot = position[static_cast<size_t>(slab) * numberOfKeys + key];
+				const uint64_t count = slot;
+				slot = total;
+				total += count;
+			}
+		}
+		binStart[numberOfKeys] = total;
+
+		ids.resize(total);
+		parallelFor(numberOfSlabs, numberOfThreads, [&](int slab, int) {
+			uint64_t *next = &position[static_cast<size_t>(slab) * numberOfKeys];
+			visitSlab(lattice, binning, slab, numberOfSlabs, [&](uint32_t id, int key) {
+				if (key >= 0)
+					ids[next[key]++] = id;
+			});
+		});
+	}
+
+	// a block of the atlas to stream
+	struct Candidate {
+		uint64_t offset;
+		uint32_t numberOfCells;
+	};
+
+	// Streams the candidate blocks and returns the active cells as cell id << 8 | case, sorted by cell id: every
+	// worker collects and sorts its cells, then the sorted runs are merged pairwise in parallel.
+	template <class T> void retrieveCells(const Lattice<T>& lattice, double value, const unsigned char *bytes,
+		const std::vector<Candidate>& candidates, int numberOfThreads, std::vector<uint64_t>& active)
+	{
+		const int cells[2] = { lattice.dims[0] - 1, lattice.dims[1] - 1 };
+		std::vector<std::vector<uint64_t>> runs(numberOfThreads);
+		parallelFor(static_cast<int>(candidates.size()), numberOfThreads, [&](int b, int worker) {
+			const unsigned char *next = bytes + candidates[b].offset;
+			uint64_t id = 0;
+			for (uint32_t c = 0; c < candidates[b].numberOfCells; ++c) {
+				id += readVarint(next);
+				const int cell[3] = { static_cast<int>(id % cells[0]), static_cast<int>(id / cells[0] % cells[1]),
+					static_cast<int>(id / cells[0] / cells[1]) };
+				double s[8];
+				lattice.Corners(cell, s);
+				int index = 0;
+				for (int corner = 0; corner < 8; ++corner)
+					if (s[corner] >= value)
+						index |= 1 << corner;
+				if (index != 0 && index != 255)
+					runs[worker].push_back(id << 8 | index);
+			}
+		});
+
+		parallelFor(numberOfThreads, numberOfThreads, [&](int run, int) { std::sort(runs[run].begin(), runs[run].end()); });
+		for (size_t width = 1; width < runs.size(); width *= 2) {
+			const int pairs = static_cast<int>((runs.size() + 2 * width - 1) / (2 * width));
+			parallelFor(pairs, numberOfThreads, [&](int pair, int) {
+				const size_t a = 2 * width * pair, b = a + width;
+				if (b >= runs.size())
+					return;
+				std::vector<uint64_t> merged(runs[a].size() + runs[b].size());
+				std::merge(runs[a].begin(), runs[a].end(), runs[b].begin(), runs[b].end(), merged.begin());
+				runs[a].swap(merged);
+				std::vector<uint64_t>().swap(runs[b]);
+			});
+		}
+		active.swap(runs[0]);
+	}
+
+	// Generates the surface of the sorted active cells. The cell with the smallest id around an intersected edge
+	// numbers it: along the axis of the edge it is the cell that contains the edge, across the axis the lower of
+	// the two cells where there is one. A cell away from the lower border numbers its edges 5, 6 and 11.
+	template <class T> void generateSurface(const Lattice<T>& lattice, const double origin[3], const double spacing[3],
+		double value, bool computeNormals, int numberOfThreads, const std::vector<uint64_t>& active, vtkPolyData *output,
+		double times[2])
+	{
+		vtkMarchingCubesTriangleCases *cases = vtkMarchingCubesTriangleCases::GetCases();
+		const int cells[3] = { lattice.dims[0] - 1, lattice.dims[1] - 1, lattice.dims[2] - 1 };
+
+		// per case the intersected edges and the triangles, per edge its number in the cell at an offset
+		int intersected[256], triangles[256];
+		for (int index = 0; index < 256; ++index) {
+			intersected[index] = 0;
+			for (int e = 0; e < 12; ++e)
+				if (((index >> cellEdge[e][0]) & 1) != ((index >> cellEdge[e][1]) & 1))
+					intersected[index] |= 1 << e;
+			triangles[index] = 0;
+			for (const EDGE_LIST *edges = cases[index].edges; *edges > -1; edges += 3)
+				++triangles[index];
+		}
+		int edgeAt[3][2][2][2];
+		for (int e = 0; e < 12; ++e) {
+			const int *offset = cellVertex[cellEdge[e][0]];
+			edgeAt[edgeAxis[e]][offset[0]][offset[1]][offset[2]] = e;
+		}
+		// the edges a cell numbers, indexed by its coordinates at the lower border
+		int owned[8];
+		for (int border = 0; border < 8; ++border) {
+			owned[border] = 0;
+			for (int e = 0; e < 12; ++e) {
+				const int *offset = cellVertex[cellEdge[e][0]];
+				bool own = true;
+				for (int b = 0; b < 3; ++b)
+					if (b != edgeAxis[e] && !offset[b] && !((border >> b) & 1))
+						own = false;
+				if (own)
+					owned[border] |= 1 << e;
+			}
+		}
+
+		auto cellOf = [&](uint64_t key, int cell[3]) {
+			const uint64_t id = key >> 8;
+			cell[0] = static_cast<int>(id % cells[0]);
+			cell[1] = static_cast<int>(id / cells[0] % cells[1]);
+			cell[2] = static_cast<int>(id / cells[0] / cells[1]);
+		};
+		auto numberedEdges = [&](uint64_t key, const int cell[3]) {
+			const int border = (cell[0] == 0 ? 1 : 0) | (cell[1] == 0 ? 2 : 0) | (cell[2] == 0 ? 4 : 0);
+			return owned[border] & intersected[key & 255];
+		};
+
+		vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+		timer->StartTimer();
+
+		// the vertices numbered by every cell, prefix sums per chunk of cells and over the chunks
+		const vtkIdType numberOfCells = static_cast<vtkIdType>(active.size());
+		const vtkIdType chunkSize = 4096;
+		const int numberOfChunks = static_cast<int>((numberOfCells + chunkSize - 1) / chunkSize);
+		std::vector<vtkIdType> firstVertex(active.size());
+		std::vector<vtkIdType> chunkVertex(numberOfChunks + 1, 0), chunkTriangle(numberOfChunks + 1, 0);
+		parallelFor(numberOfChunks, numberOfThreads, [&](int chunk, int) {
+			vtkIdType vertices = 0, chunkTriangles = 0;
+			for (vtkIdType c = chunk * chunkSize; c < std::min(numberOfCells, (chunk + 1) * chunkSize); ++c) {
+				int cell[3];
+				cellOf(active[c], cell);
+				firstVertex[c] = vertices;
+				vertices += static_cast<vtkIdType>(std::bitset<12>(numberedEdges(active[c], cell)).count());
+				chunkTriangles += triangles[active[c] & 255];
+			}
+			chunkVertex[chunk + 1] = vertices;
+			chunkTriangle[chunk + 1] = chunkTriangles;
+		});
+		for (int chunk = 0; chunk < numberOfChunks; ++chunk) {
+			chunkVertex[chunk + 1] += chunkVertex[chunk];
+			chunkTriangle[chunk + 1] += chunkTriangle[chunk];
+		}
+		parallelFor(numberOfChunks, numberOfThreads, [&](int chunk, int) {
+			for (vtkIdType c = chunk * chunkSize; c < std::min(numberOfCells, (chunk + 1) * chunkSize); ++c)
+				firstVertex[c] += chunkVertex[chunk];
+		});
+		timer->StopTimer();
+		times[0] = timer->GetElapsedTime();
+
+		timer->StartTimer();
+		const vtkIdType numberOfPoints = chunkVertex[numberOfChunks], numberOfTriangles = chunkTriangle[numberOfChunks];
+		vtkSmartPointer<vtkFloatArray> coordinates = vtkSmartPointer<vtkFloatArray>::New();
+		coordinates->SetNumberOfComponents(3);
+		coordinates->SetNumberOfTuples(numberOfPoints);
+		vtkSmartPointer<vtkFloatArray> normals = vtkSmartPointer<vtkFloatArray>::New();
+		normals->SetName("Normals");
+		normals->SetNumberOfComponents(3);
+		normals->SetNumberOfTuples(computeNormals ? numberOfPoints : 0);
+		vtkSmartPointer<vtkIdTypeArray> connectivity = vtkSmartPointer<vtkIdTypeArray>::New();
+		connectivity->SetNumberOfValues(4 * numberOfTriangles);
+		float *points = coordinates->GetPointer(0);
+		float *pointNormals = computeNormals ? normals->GetPointer(0) : nullptr;
+		vtkIdType *polys = connectivity->GetPointer(0);
+
+		parallelFor(numberOfChunks, numberOfThreads, [&](int chunk, int) {
+			vtkIdType triangle = chunkTriangle[chunk];
+			for (vtkIdType c = chunk * chunkSize; c < std::min(numberOfCells, (chunk + 1) * chunkSize); ++c) {
+				int cell[3];
+				cellOf(active[c], cell);
+
+				// the numbered edges in edge order, interpolated like WeldedMarchingCubes
+				const int numbered = numberedEdges(active[c], cell);
+				vtkIdType vertex = firstVertex[c];
+				for (int e = 0; e < 12; ++e) {
+					if (!((numbered >> e) & 1))
+						continue;
+					const int axis = edgeAxis[e];
+					const int *offset = cellVertex[cellEdge[e][0]];
+					const int point[3] = { cell[0] + offset[0], cell[1] + offset[1], cell[2] + offset[2] };
+					int other[3] = { point[0], point[1], point[2] };
+					++other[axis];
+					const double s0 = lattice.Value(point[0], point[1], point[2]);
+					const double t = (value - s0) / (lattice.Value(other[0], other[1], other[2]) - s0);
+					for (int a = 0; a < 3; ++a)
+						points[3 * vertex + a] = static_cast<float>(origin[a] + (point[a] + (a == axis ? t : 0.0)) * spacing[a]);
+					if (pointNormals) {
+						double g0[3], g1[3], n[3];
+						lattice.Gradient(point, spacing, g0);
+						lattice.Gradient(other, spacing, g1);
+						for (int a = 0; a < 3; ++a)
+							n[a] = g0[a] + t * (g1[a] - g0[a]);
+						const double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+						for (int a = 0; a < 3; ++a)
+							pointNormals[3 * vertex + a] = static_cast<float>(length > 0.0 ? n[a] / length : 0.0);
+					}
+					++vertex;
+				}
+
+				// the vertex of an edge, from the cell that numbers it
+				auto vertexOf = [&](int e) {
+					const int axis = edgeAxis[e];
+					const int *offset = cellVertex[cellEdge[e][0]];
+					int owner[3], local[3];
+					for (int a = 0; a < 3; ++a) {
+						const int point = cell[a] + offset[a];
+						owner[a] = a == axis ? point : std::max(point - 1, 0);
+						local[a] = point - owner[a];
+					}
+					vtkIdType index = c;
+					if (owner[0] != cell[0] || owner[1] != cell[1] || owner[2] != cell[2]) {
+						const uint64_t id = owner[0] + static_cast<uint64_t>(cells[0]) * (owner[1] + static_cast<uint64_t>(cells[1]) * owner[2]);
+						index = std::lower_bound(active.begin(), active.begin() + c, id << 8) - active.begin();
+					}
+					const int ownerEdge = edgeAt[axis][local[0]][local[1]][local[2]];
+					const int before = numberedEdges(active[index], owner) & ((1 << ownerEdge) - 1);
+					return firstVertex[index] + static_cast<vtkIdType>(std::bitset<12>(before).count());
+				};
+
+				for (const EDGE_LIST *edges = cases[active[c] & 255].edges; *edges > -1; edges += 3) {
+					vtkIdType *polygon = polys + 4 * triangle++;
+					polygon[0] = 3;
+					for (int corner = 0; corner < 3; ++corner)
+						polygon[1 + corner] = vertexOf(edges[corner]);
+				}
+			}
+		});
+
+		vtkSmartPointer<vtkPoints> surfacePoints = vtkSmartPointer<vtkPoints>::New();
+		surfacePoints->SetData(coordinates);
+		vtkSmartPointer<vtkCellArray> surfacePolys = vtkSmartPointer<vtkCellArray>::New();
+		surfacePolys->SetCells(numberOfTriangles, connectivity);
+		output->Initialize();
+		output->SetPoints(surfacePoints);
+		output->SetPolys(surfacePolys);
+		if (computeNormals)
+			output->GetPointData()->SetNormals(normals);
+		timer->StopTimer();
+		times[1] = timer->GetElapsedTime();
+	}
+
+	template <class T> void extractFromAtlas(const T *scalars, const int dims[3], const double origin[3],
+		const double spacing[3], double value, bool computeNormals, int numberOfThreads, const unsigned char *bytes,
+		const std::vector<Candidate>& candidates, vtkPolyData *output, double times[3], vtkIdType& activeCells)
+	{
+		const Lattice<T> lattice = makeLattice(scalars, dims);
+		vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+		timer->StartTimer();
+		std::vector<uint64_t> active;
+		retrieveCells(lattice, value, bytes, candidates, numberOfThreads, active);
+		timer->StopTimer();
+		times[0] = timer->GetElapsedTime();
+		activeCells = static_cast<vtkIdType>(active.size());
+		generateSurface(lattice, origin, spacing, value, computeNormals, numberOfThreads, active, output, times + 1);
+	}
+
+	template <class V> bool writeValues(FILE *file, const V *values, size_t count)
+	{
+		return count == 0 || std::fwrite(values, sizeof(V), count, file) == count;
+	}
+
+	template <class V> bool readValues(FILE *file, V *values, size_t count)
+	{
+		return count == 0 || std::fread(values, sizeof(V), count, file) == count;
+	}
+
+	// bytes of an open file, 0 if unknown
+	uint64_t fileSize(FILE *file)
+	{
+#ifdef _WIN32
+		const __int64 position = _ftelli64(file);
+		const __int64 size = _fseeki64(file, 0, SEEK_END) == 0 ? _ftelli64(file) : -1;
+		_fseeki64(file, position, SEEK_SET);
+#else
+		const off_t position = ftello(file);
+		const off_t size = fseeko(file, 0, SEEK_END) == 0 ? ftello(file) : -1;
+		fseeko(file, position, SEEK_SET);
+#endif
+		return size > 0 ? static_cast<uint64_t>(size) : 0;
+	}
+
+	// readVarint that stops at the end of the bytes, false on a truncated or overlong value
+	bool readVarint(const unsigned char *&bytes, const unsigned char *end, uint64_t& value)
+	{
+		value = 0;
+		for (int shift = 0; shift < 64 && bytes < end; shift += 7) {
+			const unsigned char byte = *bytes++;
+			value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+			if (!(byte & 0x80))
+				return true;
+		}
+		return false;
+	}
+}
+
+vtkStandardNewMacro(IsoSurfaceAtlas);
+
+IsoSurfaceAtlas::IsoSurfaceAtlas()
+	: NumberOfBins(256), NumberOfThreads(0), ScalarType(0), Fingerprint(0), NumberOfCells(0), LastBuildTime(0.0),
+	LastStreamedCells(0), LastActiveCells(0)
+{
+	for (int a = 0; a < 3; ++a)
+		Dimensions[a] = 0;
+	Range[0] = Range[1] = 0.0;
+}
+
+bool IsoSurfaceAtlas::Build(vtkImageData *volume)
+{
+	vtkDataArray *scalars = volume ? volume->GetPointData()->GetScalars() : nullptr;
+	if (!scalars || scalars->GetNumberOfComponents() != 1) {
+		vtkErrorMacro("No volume with one scalar component to index.");
+		return false;
+	}
+	int dims[3];
+	volume->GetDimensions(dims);
+	if (dims[0] < 2 || dims[1] < 2 || dims[2] < 2) {
+		vtkErrorMacro("An atlas needs a volume of at least 2 x 2 x 2 points.");
+		return false;
+	}
+	if (static_cast<double>(dims[0] - 1) * (dims[1] - 1) * (dims[2] - 1) >= 4294967296.0) {
+		vtkErrorMacro("An atlas indexes less than 2^32 cells.");
+		return false;
+	}
+
+	vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+	timer->StartTimer();
+	const int numberOfThreads = threadCount(this->NumberOfThreads);
+	for (int a = 0; a < 3; ++a)
+		this->Dimensions[a] = dims[a];
+	this->ScalarType = scalars->GetDataType();
+	scalars->GetRange(this->Range);
+	this->Fingerprint = hashVoxels(scalars, numberOfThreads);
+
+	const Binning binning = makeBinning(this->Range, this->NumberOfBins);
+	std::vector<uint32_t> ids;
+	std::vector<uint64_t> binStart;
+	switch (this->ScalarType) {
+		vtkTemplateMacro(sortCells(static_cast<const VTK_TT*>(scalars->GetVoidPointer(0)), dims, binning, numberOfThreads,
+			ids, binStart));
+	default:
+		vtkErrorMacro("Unsupported scalar type " << scalars->GetDataTypeAsString());
+		return false;
+	}
+	this->NumberOfCells = ids.size();
+
+	// the non-empty bins cut into blocks, the blocks encoded in parallel
+	this->Bins.clear();
+	this->Blocks.clear();
+	std::vector<uint64_t> blockStart;
+	for (int key = 0; key + 1 < static_cast<int>(binStart.size()); ++key) {
+		if (binStart[key + 1] == binStart[key])
+			continue;
+		Bin bin = { static_cast<uint16_t>(key / this->NumberOfBins), static_cast<uint16_t>(key % this->NumberOfBins),
+			static_cast<uint32_t>(this->Blocks.size()), 0 };
+		for (uint64_t first = binStart[key]; first < binStart[key + 1]; first += blockCells) {
+			Block block = { 0, static_cast<uint32_t>(std::min<uint64_t>(blockCells, binStart[key + 1] - first)), 0 };
+			this->Blocks.push_back(block);
+			blockStart.push_back(first);
+			++bin.numberOfBlocks;
+		}
+		this->Bins.push_back(bin);
+	}
+	std::vector<std::vector<unsigned char>> encoded(this->Blocks.size());
+	parallelFor(static_cast<int>(this->Blocks.size()), numberOfThreads, [&](int b, int) {
+		uint64_t previous = 0;
+		for (uint32_t c = 0; c < this->Blocks[b].numberOfCells; ++c) {
+			const uint64_t id = ids[blockStart[b] + c];
+			writeVarint(id - previous, encoded[b]);
+			previous = id;
+		}
+	});
+	this->CellIds.clear();
+	for (size_t b = 0; b < encoded.size(); ++b) {
+		this->Blocks[b].offset = this->CellIds.size();
+		this->CellIds.insert(this->CellIds.end(), encoded[b].begin(), encoded[b].end());
+	}
+	timer->StopTimer();
+	this->LastBuildTime = timer->GetElapsedTime();
+	this->Modified();
+	return true;
+}
+
+size_t IsoSurfaceAtlas::GetSize() const
+{
+	return headerSize + this->Bins.size() * sizeof(Bin) + this->Blocks.size() * sizeof(Block) + this->CellIds.size();
+}
+
+bool IsoSurfaceAtlas::Write(const std::string& fileName) const
+{
+	FILE *file = std::fopen(fileName.c_str(), "wb");
+	if (!file) {
+		vtkErrorMacro("Could not open " << fileName << " for writing.");
+		return false;
+	}
+	const int32_t fields[5] = { this->Dimensions[0], this->Dimensions[1], this->Dimensions[2], this->ScalarType, this->NumberOfBins };
+	const uint64_t counts[5] = { this->Fingerprint, this->NumberOfCells, this->Bins.size(), this->Blocks.size(), this->CellIds.size() };
+	bool written = writeValues(file, atlasMagic, 8) && writeValues(file, &atlasVersion, 1) && writeValues(file, fields, 5)
+		&& writeValues(file, this->Range, 2) && writeValues(file, counts, 5) && writeValues(file, this->Bins.data(), this->Bins.size())
+		&& writeValues(file, this->Blocks.data(), this->Blocks.size()) && writeValues(file, this->CellIds.data(), this->CellIds.size());
+	written = std::fclose(file) == 0 && written;
+	if (!written)
+		vtkErrorMacro("Could not write " << fileName << ".");
+	return written;
+}
+
+bool IsoSurfaceAtlas::Read(const std::string& fileName)
+{
+	FILE *file = std::fopen(fileName.c_str(), "rb");
+	if (!file)
+		return false;
+	char magic[8];
+	uint32_t version = 0;
+	int32_t fields[5];
+	double range[2];
+	uint64_t counts[5];
+	bool read = readValues(file, magic, 8) && std::memcmp(magic, atlasMagic, 8) == 0 && readValues(file, &version, 1)
+		&& version == atlasVersion && readValues(file, fields, 5) && readValues(file, range, 2) && readValues(file, counts, 5)
+		&& fields[4] >= 2 && fields[4] <= 256;
+	// the tables must fill the rest of the file exactly, checked before anything is allocated
+	const uint64_t size = fileSize(file), tableBytes = size - std::min<uint64_t>(size, headerSize);
+	read = read && counts[2] <= tableBytes / sizeof(Bin) && counts[3] <= tableBytes / sizeof(Block) && counts[4] <= tableBytes
+		&& counts[2] * sizeof(Bin) + counts[3] * sizeof(Block) + counts[4] == tableBytes;
+	if (read) {
+		this->Bins.resize(counts[2]);
+		this->Blocks.resize(counts[3]);
+		this->CellIds.resize(counts[4]);
+		read = readValues(file, this->Bins.data(), this->Bins.size()) && readValues(file, this->Blocks.data(), this->Blocks.size())
+			&& readValues(file, this->CellIds.data(), this->CellIds.size()) && validTables(fields, fields[4], counts[1]);
+	}
+	std::fclose(file);
+	if (!read) {
+		vtkErrorMacro("No valid iso surface atlas in " << fileName << ".");
+		this->Bins.clear();
+		this->Blocks.clear();
+		this->CellIds.clear();
+		this->NumberOfCells = 0;
+		return false;
+	}
+	for (int a = 0; a < 3; ++a)
+		this->Dimensions[a] = fields[a];
+	this->ScalarType = fields[3];
+	this->NumberOfBins = fields[4];
+	this->Range[0] = range[0];
+	this->Range[1] = range[1];
+	this->Fingerprint = counts[0];
+	this->NumberOfCells = counts[1];
+	this->Modified();
+	return true;
+}
+
+bool IsoSurfaceAtlas::validTables(const int dims[3], int numberOfBins, uint64_t numberOfCells) const
+{
+	if (dims[0] < 2 || dims[1] < 2 || dims[2] < 2
+		|| static_cast<double>(dims[0] - 1) * (dims[1] - 1) * (dims[2] - 1) >= 4294967296.0)
+		return false;
+	const uint64_t latticeCells = static_cast<uint64_t>(dims[0] - 1) * (dims[1] - 1) * (dims[2] - 1);
+	for (size_t b = 0; b < this->Bins.size(); ++b) {
+		const Bin& bin = this->Bins[b];
+		if (bin.minBin > bin.maxBin || bin.maxBin >= numberOfBins
+			|| static_cast<uint64_t>(bin.firstBlock) + bin.numberOfBlocks > this->Blocks.size())
+			return false;
+	}
+
+	// every block decodes inside the cell ids to cells of the lattice, the blocks decoded in parallel
+	const unsigned char *bytes = this->CellIds.data(), *end = bytes + this->CellIds.size();
+	std::atomic<bool> valid(true);
+	std::atomic<uint64_t> cells(0);
+	parallelFor(static_cast<int>(this->Blocks.size()), threadCount(this->NumberOfThreads), [&](int b, int) {
+		const Block& block = this->Blocks[b];
+		if (block.offset > this->CellIds.size() || block.numberOfCells > blockCells) {
+			valid = false;
+			return;
+		}
+		const unsigned char *next = bytes + block.offset;
+		uint64_t id = 0, delta;
+		for (uint32_t c = 0; c < block.numberOfCells; ++c) {
+			if (!readVarint(next, end, delta) || delta >= latticeCells - id || (c > 0 && delta == 0)) {
+				valid = false;
+				return;
+			}
+			id += delta;
+		}
+		cells += block.numberOfCells;
+	});
+	return valid && cells == numberOfCells;
+}
+
+bool IsoSurfaceAtlas::Matches(vtkImageData *volume) const
+{
+	vtkDataArray *scalars = volume ? volume->GetPointData()->GetScalars() : nullptr;
+	if (!scalars || scalars->GetNumberOfComponents() != 1 || scalars->GetDataType() != this->ScalarType)
+		return false;
+	int dims[3];
+	volume->GetDimensions(dims);
+	return dims[0] == this->Dimensions[0] && dims[1] == this->Dimensions[1] && dims[2] == this->Dimensions[2]
+		&& hashVoxels(scalars, threadCount(this->NumberOfThreads)) == this->Fingerprint;
+}
+
+bool IsoSurfaceAtlas::Extract(vtkImageData *volume, double value, bool computeNormals, vtkPolyData *output, double times[3])
+{
+	vtkDataArray *scalars = volume ? volume->GetPointData()->GetScalars() : nullptr;
+	int dims[3] = { 0, 0, 0 };
+	if (volume)
+		volume->GetDimensions(dims);
+	if (!scalars || scalars->GetNumberOfComponents() != 1 || scalars->GetDataType() != this->ScalarType
+		|| dims[0] != this->Dimensions[0] || dims[1] != this->Dimensions[1] || dims[2] != this->Dimensions[2])
+		return false;
+
+	// the bins whose interval can contain the value, (min, max] of every active cell spans its bin
+	const Binning binning = makeBinning(this->Range, this->NumberOfBins);
+	const int valueBin = binning(value);
+	std::vector<Candidate> candidates;
+	this->LastStreamedCells = 0;
+	for (size_t b = 0; b < this->Bins.size(); ++b) {
+		if (this->Bins[b].minBin > valueBin || this->Bins[b].maxBin < valueBin)
+			continue;
+		for (uint32_t block = 0; block < this->Bins[b].numberOfBlocks; ++block) {
+			const Block& streamed = this->Blocks[this->Bins[b].firstBlock + block];
+			Candidate candidate = { streamed.offset, streamed.numberOfCells };
+			candidates.push_back(candidate);
+			this->LastStreamedCells += streamed.numberOfCells;
+		}
+	}
+
+	double origin[3], spacing[3];
+	volume->GetOrigin(origin);
+	volume->GetSpacing(spacing);
+	const int numberOfThreads = threadCount(this->NumberOfThreads);
+	switch (this->ScalarType) {
+		vtkTemplateMacro(extractFromAtlas(static_cast<const VTK_TT*>(scalars->GetVoidPointer(0)), dims, origin, spacing, value,
+			computeNormals, numberOfThreads, this->CellIds.data(), candidates, output, times, this->LastActiveCells));
+	default:
+		return false;
+	}
+	return true;
+}
+
+std::string IsoSurfaceAtlas::GetFileName(const std::string& volumeFileName)
+{
+	const size_t dot = volumeFileName.rfind('.');
+	const size_t slash = volumeFileName.find_last_of("/\\");
+	const bool extension = dot != std::string::npos && (slash == std::string::npos || dot > slash);
+	return (extension ? volumeFileName.substr(0, dot) : volumeFileName) + ".isoatlas";
+}
+
+// ----- benchmark -----
+
+void runAtlasBenchmark(vtkImageData *volume, IsoSurfaceAtlas *atlas, const std::string& name,
+	const std::vector<double>& values, int numberOfThreads, std::ostream& os)
+{
+	const int repetitions = 3;
+	int dims[3];
+	volume->GetDimensions(dims);
+	vtkDataArray *scalars = volume->GetPointData()->GetScalars();
+	const double volumeBytes = static_cast<double>(scalars->GetNumberOfTuples()) * scalars->GetDataTypeSize();
+	const double cells = static_cast<double>(dims[0] - 1) * (dims[1] - 1) * (dims[2] - 1);
+
+	os << "# iso surface atlas: " << name << " (" << dims[0] << " x " << dims[1] << " x " << dims[2] << " points)" << std::endl;
+	os << std::fixed << std::setprecision(2);
+	os << "voxels " << volumeBytes / 1048576.0 << " MB, atlas " << atlas->GetSize() / 1048576.0 << " MB ("
+		<< 100.0 * atlas->GetSize() / volumeBytes << " % of the voxels), " << atlas->GetNumberOfCells() << " of "
+		<< std::setprecision(0) << cells << " cells indexed, " << std::setprecision(2)
+		<< (atlas->GetNumberOfCells() ? static_cast<double>(atlas->GetSize()) / atlas->GetNumberOfCells() : 0.0)
+		<< " bytes per indexed cell" << std::endl;
+
+	vtkSmartPointer<WeldedMarchingCubes> onTheFly = vtkSmartPointer<WeldedMarchingCubes>::New();
+	onTheFly->SetInputData(volume);
+	onTheFly->SetNumberOfThreads(numberOfThreads);
+	vtkSmartPointer<WeldedMarchingCubes> fromAtlas = vtkSmartPointer<WeldedMarchingCubes>::New();
+	fromAtlas->SetInputData(volume);
+	fromAtlas->SetNumberOfThreads(numberOfThreads);
+	fromAtlas->SetAtlas(atlas);
+
+	os << "| iso value | streamed cells | active cells | triangles | atlas [ms] | on the fly [ms] | speedup | same size |" << std::endl;
+	os << "|----------:|---------------:|-------------:|----------:|-----------:|----------------:|--------:|:---------:|" << std::endl;
+	for (size_t v = 0; v < values.size(); ++v) {
+		double best[2] = { 0.0, 0.0 };
+		WeldedMarchingCubes *filters[2] = { fromAtlas, onTheFly };
+		for (int f = 0; f < 2; ++f) {
+			filters[f]->SetValue(0, values[v]);
+			for (int r = 0; r < repetitions; ++r) {
+				filters[f]->Modified();
+				filters[f]->Update();
+				const double total = filters[f]->GetLastCountTime() + filters[f]->GetLastPrefixSumTime() + filters[f]->GetLastGenerateTime();
+				best[f] = r ? std::min(best[f], total) : total;
+			}
+		}
+		vtkPolyData *atlasSurface = fromAtlas->GetOutput(), *surface = onTheFly->GetOutput();
+		const bool sameSize = atlasSurface->GetNumberOfPoints() == surface->GetNumberOfPoints()
+			&& atlasSurface->GetNumberOfPolys() == surface->GetNumberOfPolys();
+		os << "| " << std::setw(9) << std::setprecision(1) << values[v]
+			<< " | " << std::setw(14) << atlas->GetLastStreamedCells()
+			<< " | " << std::setw(12) << atlas->GetLastActiveCells()
+			<< " | " << std::setw(9) << surface->GetNumberOfPolys()
+			<< " | " << std::setw(10) << std::setprecision(2) << best[0] * 1000.0
+			<< " | " << std::setw(15) << best[1] * 1000.0
+			<< " | " << std::setw(6) << (best[0] > 0.0 ? best[1] / best[0] : 0.0) << "x"
+			<< " | " << std::setw(9) << (sameSize ? "yes" : "NO") << " |" << std::endl;
+	}
+	os << std::endl;
+}
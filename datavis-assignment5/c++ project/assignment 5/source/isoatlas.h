@@ -0,0 +1,116 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+// Precomputed index of the cells that are active for every iso value of a volume, stored next to the .vti file.
+//
+
+#pragma once
+
+#include <vtkObject.h>
+#include <vtkImageData.h>
+#include <vtkPolyData.h>
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/* Iso surface atlas of a volume with one scalar component, built once offline and read by the viewer.
+   A cell is active for the iso values in (min, max] of its eight corners, and its marching cubes case changes only
+   at its corner values, which are in the volume anyway. So the atlas records the active interval of every cell that
+   is not constant, in the span space of (min, max) quantized to NumberOfBins^2 bins:
+   - the cells are sorted by bin, ascending by cell id inside a bin, constant cells are left out,
+   - every bin is cut into blocks of 4096 cells, stored as variable length differences of the cell ids (mostly one
+     or two bytes per cell),
+   - a table of the non-empty bins and their blocks locates them in the file.
+   For an iso value only the bins whose interval contains it are streamed, the blocks in parallel. The eight corners
+   of a streamed cell give its case, the cells of trivial cases are dropped and the others are sorted by id.
+   The surface is then generated from the active cells alone: every intersected lattice edge belongs to the active
+   cell with the smallest id among the cells around it, which numbers it, the other cells find that cell by binary
+   search in the sorted active cells. Vertices, normals and triangles are those of WeldedMarchingCubes in another
+   order, so the surface is watertight as well. The file assumes a little endian host, as on x86 and ARM. */
+class IsoSurfaceAtlas : public vtkObject {
+public:
+	static IsoSurfaceAtlas *New();
+	vtkTypeMacro(IsoSurfaceAtlas, vtkObject);
+
+	/* Bins per axis of the span space, default 256. Set before Build. */
+	vtkSetClampMacro(NumberOfBins, int, 2, 256);
+	vtkGetMacro(NumberOfBins, int);
+
+	/* Number of worker threads of Build and Extract, 0 uses all hardware threads. */
+	vtkSetClampMacro(NumberOfThreads, int, 0, 256);
+	vtkGetMacro(NumberOfThreads, int);
+
+	/* Indexes the cells of the volume, false for volumes without one scalar component or with 2^32 cells or more. */
+	bool Build(vtkImageData *volume);
+
+	bool Write(const std::string& fileName) const;
+	bool Read(const std::string& fileName);
+
+	/* Whether the atlas was built from a volume with these dimensions, this scalar type and the same voxels (a
+	   hash of all voxels, computed in parallel). */
+	bool Matches(vtkImageData *volume) const;
+
+	/* Extracts the iso surface of the whole volume into the output, false if the dimensions or the scalar type of the
+	   volume differ from the ones of the atlas. The times are retrieval of the active cells (streaming, case test
+	   and sort), numbering of the vertices and generation of the surface in seconds. */
+	bool Extract(vtkImageData *volume, double value, bool computeNormals, vtkPolyData *output, double times[3]);
+
+	/* Bytes of the atlas file, indexed (non-constant) cells, seconds of the last Build. */
+	size_t GetSize() const;
+	vtkIdType GetNumberOfCells() const { return static_cast<vtkIdType>(this->NumberOfCells); }
+	vtkGetMacro(LastBuildTime, double);
+
+	/* Cells streamed from the atlas and active cells of the last extraction. */
+	vtkGetMacro(LastStreamedCells, vtkIdType);
+	vtkGetMacro(LastActiveCells, vtkIdType);
+
+	/* The atlas of a volume file, its name with the extension .isoatlas instead of .vti. */
+	static std::string GetFileName(const std::string& volumeFileName);
+
+protected:
+	IsoSurfaceAtlas();
+	~IsoSurfaceAtlas() override {}
+
+private:
+	IsoSurfaceAtlas(const IsoSurfaceAtlas&) = delete;
+	void operator=(const IsoSurfaceAtlas&) = delete;
+
+	// whether the bins, blocks and cell ids read from a file index inside each other and the cells of the dimensions
+	bool validTables(const int dims[3], int numberOfBins, uint64_t numberOfCells) const;
+
+	// a non-empty bin of the span space and its blocks
+	struct Bin {
+		uint16_t minBin;
+		uint16_t maxBin;
+		uint32_t firstBlock;
+		uint32_t numberOfBlocks;
+	};
+	// cells of a block, at a byte offset into the cell ids
+	struct Block {
+		uint64_t offset;
+		uint32_t numberOfCells;
+		uint32_t reserved;
+	};
+
+	int NumberOfBins;
+	int NumberOfThreads;
+	int Dimensions[3];
+	int ScalarType;
+	double Range[2];
+	uint64_t Fingerprint;
+	uint64_t NumberOfCells;
+	std::vector<Bin> Bins;
+	std::vector<Block> Blocks;
+	std::vector<unsigned char> CellIds;
+	double LastBuildTime;
+	vtkIdType LastStreamedCells;
+	vtkIdType LastActiveCells;
+};
+
+/* Prints the size of the atlas against the size of the voxels, and for every iso value the streamed and active
+   cells and the extraction time from the atlas against WeldedMarchingCubes on the whole volume, the fastest of
+   three runs each, with whether both surfaces have the same number of points and triangles. */
+void runAtlasBenchmark(vtkImageData *volume, IsoSurfaceAtlas *atlas, const std::string& name,
+	const std::vector<double>& values, int numberOfThreads, std::ostream& os);
@@ -0,0 +1,359 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+
+#include "meshexport.h"
+
+#include <vtkPointData.h>
+#include <vtkDataArray.h>
+#include <vtkFloatArray.h>
+#include <vtkPoints.h>
+#include <vtkCellArray.h>
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <chrono>
+#include <vector>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+
+namespace {
+	// bytes of one chunk, large enough for sequential writes, small enough to keep all threads busy
+	const size_t chunkBytes = 8 << 20;
+
+	// elements of the same size, encoded into a buffer per range
+	struct Section {
+		vtkIdType count;
+		size_t elementSize;
+		std::function<void(vtkIdType begin, vtkIdType end, char *out)> encode;
+	};
+
+	struct StreamTimes {
+		double encode;      // summed over the threads
+		double write;
+		double wait;        // the writer waiting for the next chunk
+	};
+
+	double secondsSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	// encodes the chunks of the sections on the threads and writes them in order after the header
+	bool writeStream(std::FILE *file, const std::string& header, const std::vector<Section>& sections, int numberOfThreads,
+		StreamTimes& times)
+	{
+		struct Chunk {
+			size_t section;
+			vtkIdType begin, end;
+		};
+		std::vector<Chunk> chunks;
+		for (size_t s = 0; s < sections.size(); ++s) {
+			const vtkIdType elements = std::max<vtkIdType>(1, static_cast<vtkIdType>(chunkBytes / sections[s].elementSize));
+			for (vtkIdType begin = 0; begin < sections[s].count; begin += elements) {
+				Chunk chunk = { s, begin, std::min(sections[s].count, begin + elements) };
+				chunks.push_back(chunk);
+			}
+		}
+
+		times.encode = times.write = times.wait = 0.0;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		bool ok = std::fwrite(header.data(), 1, header.size(), file) == header.size();
+		times.write += secondsSince(start);
+
+		// chunk c is encoded into buffer c % window once chunk c - window is written
+		const size_t window = 2 * static_cast<size_t>(numberOfThreads);
+		std::vector<std::vector<char>> buffers(window);
+		std::vector<long long> ready(window, -1);
+		std::mutex mutex;
+		std::condition_variable encoded, written;
+		size_t numberWritten = 0;
+		std::atomic<size_t> nextChunk(0);
+		bool cancelled = false;
+
+		auto worker = [&]() {
+			for (size_t c = nextChunk++; c < chunks.size(); c = nextChunk++) {
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					written.wait(lock, [&]() { return c < numberWritten + window || cancelled; });
+					if (cancelled)
+						return;
+				}
+				std::chrono::steady_clock::time_point encodeStart = std::chrono::steady_clock::now();
+				const Chunk& chunk = chunks[c];
+				const Section& section = sections[chunk.section];
+				std::vector<char>& buffer = buffers[c % window];
+				buffer.resize((chunk.end - chunk.begin) * section.elementSize);
+				section.encode(chunk.begin, chunk.end, buffer.data());
+				const double seconds = secondsSince(encodeStart);
+
+				std::lock_guard<std::mutex> lock(mutex);
+				times.encode += seconds;
+				ready[c % window] = static_cast<long long>(c);
+				encoded.notify_all();
+			}
+		};
+		std::vector<std::thread> threads;
+		for (int t = 0; t < numberOfThreads; ++t)
+			threads.push_back(std::thread(worker));
+
+		for (size_t c = 0; c < chunks.size() && ok; ++c) {
+			std::chrono::steady_clock::time_point waitStart = std::chrono::steady_clock::now();
+			std::unique_lock<std::mutex> lock(mutex);
+			encoded.wait(lock, [&]() { return ready[c % window] == static_cast<long long>(c); });
+			lock.unlock();
+			times.wait += secondsSince(waitStart);
+
+			std::chrono::steady_clock::time_point writeStart = std::chrono::steady_clock::now();
+			const std::vector<char>& buffer = buffers[c % window];
+			ok = std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+			times.write += secondsSince(writeStart);
+
+			lock.lock();
+			++numberWritten;
+			cancelled = !ok;
+			written.notify_all();
+		}
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			cancelled = true;
+			written.notify_all();
+		}
+		for (size_t t = 0; t < threads.size(); ++t)
+			threads[t].join();
+		return ok;
+	}
+
+	// float triples of a data array, read in place if it stores floats
+	struct Float3Reader {
+		vtkDataArray *array;
+		const float *values;
+
+		explicit Float3Reader(vtkDataArray *array)
+			: array(array), values(array && array->GetDataType() == VTK_FLOAT ? static_cast<vtkFloatArray*>(array)->GetPointer(0) : nullptr) {}
+
+		void Read(vtkIdType id, float out[3]) const
+		{
+			if (values) {
+				std::memcpy(out, values + 3 * id, 3 * sizeof(float));
+				return;
+			}
+			double tuple[3];
+			array->GetTuple(id, tuple);
+			for (int a = 0; a < 3; ++a)
+				out[a] = static_cast<float>(tuple[a]);
+		}
+	};
+
+	bool hasExtension(const std::string& fileName, const std::string& extension)
+	{
+		return fileName.size() >= extension.size()
+			&& fileName.compare(fileName.size() - extension.size(), extension.size(), extension) == 0;
+	}
+
+	template <class T> void put(char *&out, T value)
+	{
+		std::memcpy(out, &value, sizeof(T));
+		out += sizeof(T);
+	}
+}
+
+bool exportSurface(vtkPolyData *surface, const std::string& fileName, int numberOfThreads, std::ostream& os)
+{
+	numberOfThreads = std::max(1, numberOfThreads > 0 ? numberOfThreads : static_cast<int>(std::thread::hardware_concurrency()));
+	vtkCellArray *polys = surface->GetPolys();
+	const vtkIdType numberOfPoints = surface->GetNumberOfPoints();
+	const vtkIdType numberOfTriangles = polys->GetNumberOfCells();
+	if (surface->GetNumberOfVerts() + surface->GetNumberOfLines() + surface->GetNumberOfStrips() > 0
+		|| polys->GetNumberOfConnectivityEntries() != 4 * numberOfTriangles) {
+		os << fileName << ": only surfaces of triangles can be exported" << std::endl;
+		return false;
+	}
+	if (numberOfPoints > static_cast<vtkIdType>(UINT32_MAX) || numberOfTriangles > static_cast<vtkIdType>(UINT32_MAX)) {
+		os << fileName << ": too many points or triangles for 32 bit indices" << std::endl;
+		return false;
+	}
+
+	// the sections read the arrays of the surface in place
+	const vtkIdType *connectivity = polys->GetPointer();
+	const Float3Reader points(numberOfPoints > 0 ? surface->GetPoints()->GetData() : nullptr);
+	const Float3Reader normals(surface->GetPointData()->GetNormals());
+	Section positionSection = { numberOfPoints, 3 * sizeof(float), [&](vtkIdType begin, vtkIdType end, char *out) {
+		for (vtkIdType i = begin; i < end; ++i, out += 3 * sizeof(float))
+			points.Read(i, reinterpret_cast<float*>(out));
+	} };
+	Section normalSection = { numberOfPoints, 3 * sizeof(float), [&](vtkIdType begin, vtkIdType end, char *out) {
+		for (vtkIdType i = begin; i < end; ++i, out += 3 * sizeof(float))
+			normals.Read(i, reinterpret_cast<float*>(out));
+	} };
+	Section indexSection = { numberOfTriangles, 3 * sizeof(uint32_t), [&](vtkIdType begin, vtkIdType end, char *out) {
+		for (vtkIdType t = begin; t < end; ++t)
+			for (int corner = 1; corner <= 3; ++corner)
+				put(out, static_cast<uint32_t>(connectivity[4 * t + corner]));
+	} };
+
+	std::string header;
+	std::vector<Section> sections;
+	if (hasExtension(fileName, ".ply")) {
+		// vertices with interleaved normals, faces as (3, int, int, int)
+		std::ostringstream text;
+		text << "ply\nformat binary_little_endian 1.0\ncomment iso surface of assignment 5\nelement vertex " << numberOfPoints
+			<< "\nproperty float x\nproperty float y\nproperty float z\n";
+		if (normals.array)
+			text << "property float nx\nproperty float ny\nproperty float nz\n";
+		text << "element face " << numberOfTriangles << "\nproperty list uchar int vertex_indices\nend_header\n";
+		header = text.str();
+
+		const bool withNormals = normals.array != nullptr;
+		Section vertexSection = { numberOfPoints, (withNormals ? 6 : 3) * sizeof(float), [&](vtkIdType begin, vtkIdType end, char *out) {
+			for (vtkIdType i = begin; i < end; ++i) {
+				points.Read(i, reinterpret_cast<float*>(out));
+				out += 3 * sizeof(float);
+				if (withNormals) {
+					normals.Read(i, reinterpret_cast<float*>(out));
+					out += 3 * sizeof(float);
+				}
+			}
+		} };
+		Section faceSection = { numberOfTriangles, 1 + 3 * sizeof(int32_t), [&](vtkIdType begin, vtkIdType end, char *out) {
+			for (vtkIdType t = begin; t < end; ++t) {
+				put(out, static_cast<unsigned char>(3));
+				for (int corner = 1; corner <= 3; ++corner)
+					put(out, static_cast<int32_t>(connectivity[4 * t + corner]));
+			}
+		} };
+		sections.push_back(vertexSection);
+		sections.push_back(faceSection);
+	}
+	else if (hasExtension(fileName, ".stl")) {
+		// 80 byte header, the number of triangles, then normal, three corners and an attribute word per triangle
+		const std::string title = "iso surface of assignment 5";
+		header = title + std::string(80 - title.size(), ' ');
+		const uint32_t count = static_cast<uint32_t>(numberOfTriangles);
+		header.append(reinterpret_cast<const char*>(&count), sizeof(count));
+		Section facetSection = { numberOfTriangles, 12 * sizeof(float) + sizeof(uint16_t), [&](vtkIdType begin, vtkIdType end, char *out) {
+			float corners[3][3];
+			for (vtkIdType t = begin; t < end; ++t) {
+				for (int corner = 0; corner < 3; ++corner)
+					points.Read(connectivity[4 * t + 1 + corner], corners[corner]);
+				float u[3], v[3], n[3];
+				for (int a = 0; a < 3; ++a) {
+					u[a] = corners[1][a] - corners[0][a];
+					v[a] = corners[2][a] - corners[0][a];
+				}
+				n[0] = u[1] * v[2] - u[2] * v[1];
+				n[1] = u[2] * v[0] - u[0] * v[2];
+				n[2] = u[0] * v[1] - u[1] * v[0];
+				const float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+				for (int a = 0; a < 3; ++a)
+					put(out, length > 0.0f ? n[a] / length : 0.0f);
+				std::memcpy(out, corners, sizeof(corners));
+				out += sizeof(corners);
+				put(out, static_cast<uint16_t>(0));
+			}
+		} };
+		sections.push_back(facetSection);
+	}
+	else if (hasExtension(fileName, ".glb")) {
+		// one buffer with the positions, the normals and the indices, each a multiple of four bytes long
+		const uint64_t positionBytes = 12 * static_cast<uint64_t>(numberOfPoints);
+		const uint64_t normalBytes = normals.array ? positionBytes : 0;
+		const uint64_t indexBytes = 12 * static_cast<uint64_t>(numberOfTriangles);
+		const uint64_t binaryBytes = positionBytes + normalBytes + indexBytes;
+		double bounds[6];
+		surface->GetBounds(bounds);
+
+		std::ostringstream json;
+		json << std::setprecision(9)
+			<< "{\"asset\":{\"version\":\"2.0\",\"generator\":\"assignment 5\"},\"scene\":0,\"scenes\":[{\"nodes\":[0]}],"
+			<< "\"nodes\":[{\"mesh\":0}],\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0"
+			<< (normals.array ? ",\"NORMAL\":1" : "") << "},\"indices\":" << (normals.array ? 2 : 1) << ",\"mode\":4}]}],"
+			<< "\"buffers\":[{\"byteLength\":" << binaryBytes << "}],\"bufferViews\":["
+			<< "{\"buffer\":0,\"byteOffset\":0,\"byteLength\":" << positionBytes << ",\"target\":34962},";
+		if (normals.array)
+			json << "{\"buffer\":0,\"byteOffset\":" << positionBytes << ",\"byteLength\":" << normalBytes << ",\"target\":34962},";
+		json << "{\"buffer\":0,\"byteOffset\":" << positionBytes + normalBytes << ",\"byteLength\":" << indexBytes
+			<< ",\"target\":34963}],\"accessors\":["
+			<< "{\"bufferView\":0,\"componentType\":5126,\"count\":" << numberOfPoints << ",\"type\":\"VEC3\","
+			<< "\"min\":[" << bounds[0] << "," << bounds[2] << "," << bounds[4] << "],"
+			<< "\"max\":[" << bounds[1] << "," << bounds[3] << "," << bounds[5] << "]},";
+		if (normals.array)
+			json << "{\"bufferView\":1,\"componentType\":5126,\"count\":" << numberOfPoints << ",\"type\":\"VEC3\"},";
+		json << "{\"bufferView\":" << (normals.array ? 2 : 1) << ",\"componentType\":5125,\"count\":"
+			<< 3 * numberOfTriangles << ",\"type\":\"SCALAR\"}]}";
+		std::string jsonChunk = json.str();
+		jsonChunk.append((4 - jsonChunk.size() % 4) % 4, ' ');
+
+		const uint64_t totalBytes = 12 + 8 + jsonChunk.size() + 8 + binaryBytes;
+		if (totalBytes > UINT32_MAX) {
+			os << fileName << ": larger than the 4 GB of a glb file" << std::endl;
+			return false;
+		}
+		const uint32_t words[] = { 0x46546C67u, 2u, static_cast<uint32_t>(totalBytes),
+			static_cast<uint32_t>(jsonChunk.size()), 0x4E4F534Au };
+		header.assign(reinterpret_cast<const char*>(words), sizeof(words));
+		header += jsonChunk;
+		const uint32_t binaryHeader[] = { static_cast<uint32_t>(binaryBytes), 0x004E4942u };
+		header.append(reinterpret_cast<const char*>(binaryHeader), sizeof(binaryHeader));
+
+		sections.push_back(positionSection);
+		if (normals.array)
+			sections.push_back(normalSection);
+		sections.push_back(indexSection);
+	}
+	else {
+		os << fileName << ": unknown format, the extension must be .ply, .stl or .glb" << std::endl;
+		return false;
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::FILE *file = std::fopen(fileName.c_str(), "wb");
+	if (!file) {
+		os << fileName << ": cannot be opened for writing" << std::endl;
+		return false;
+	}
+	// the chunks are written with one call each, no copy into the stdio buffer
+	std::setvbuf(file, nullptr, _IONBF, 0);
+	StreamTimes times;
+	bool ok = writeStream(file, header, sections, numberOfThreads, times);
+	ok = std::fclose(file) == 0 && ok;
+	const double seconds = secondsSince(start);
+	if (!ok) {
+		os << fileName << ": write failed" << std::endl;
+		return false;
+	}
+
+	double bytes = static_cast<double>(header.size());
+	for (size_t s = 0; s < sections.size(); ++s)
+		bytes += static_cast<double>(sections[s].count) * sections[s].elementSize;
+	os << fileName << ": " << numberOfTriangles << " triangles, " << std::fixed << std::setprecision(1) << bytes / (1 << 20)
+		<< " MB in " << std::setprecision(3) << seconds << " s, " << std::setprecision(1) << bytes / (1 << 20) / seconds
+		<< " MB/s (encode " << std::setprecision(3) << times.encode << " s on " << numberOfThreads << " threads, write "
+		<< times.write << " s, waited " << times.wait << " s for chunks)" << std::endl;
+	return true;
+}
+
+void SurfaceExportCallback::Execute(vtkObject *caller, unsigned long eventId, void *callData)
+{
+	vtkRenderWindowInteractor *interactor = static_cast<vtkRenderWindowInteractor*>(caller);
+	if (interactor->GetKeyCode() != ExportKey || !extractor)
+		return;
+
+	const char *extensions[] = { ".ply", ".stl", ".glb" };
+	const int ports = extractor->GetNumberOfOutputPorts();
+	for (int port = 0; port < ports; ++port) {
+		vtkPolyData *surface = vtkPolyData::SafeDownCast(extractor->GetOutputDataObject(port));
+		if (!surface)
+			continue;
+		const std::string name = ports > 1 ? Prefix + "-" + std::to_string(port + 1) : Prefix;
+		for (const char *extension : extensions)
+			exportSurface(surface, name + extension, NumberOfThreads, std::cout);
+	}
+}
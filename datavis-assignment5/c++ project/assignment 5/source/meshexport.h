@@ -0,0 +1,46 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+// Streaming export of iso surfaces to binary PLY, STL and glTF for 3D printing and CAD tools.
+//
+
+#pragma once
+
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+#include <vtkAlgorithm.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkCommand.h>
+
+#include <ostream>
+#include <string>
+
+/* Writes a triangle surface to a file, the format follows the extension:
+   - .ply binary little endian PLY with float positions, float normals if the surface has any, and int triangles
+   - .stl binary STL with the facet normals computed from the corners
+   - .glb binary glTF 2.0 with one mesh, float positions, normals and unsigned int indices in one buffer.
+   The file is a header followed by sections (vertices, normals, faces) that are encoded straight from the arrays
+   of the surface, without an intermediate copy of the mesh: the sections are cut into chunks of a few MB, the
+   threads encode the next chunks into a window of buffers and the calling thread writes the finished chunks in
+   order with one fwrite each, so encoding overlaps with the write and the file is written sequentially. The
+   byte order of the host is assumed to be little endian, as on x86 and ARM.
+   Prints the size, the time, the throughput and where the time went (encoding, writing, waiting for chunks) and
+   returns false if the surface has other cells than triangles or the file cannot be written. */
+bool exportSurface(vtkPolyData *surface, const std::string& fileName, int numberOfThreads, std::ostream& os);
+
+/* Exports the current surface of every output port of the extractor to <prefix>.ply, .stl and .glb (with the
+   number of the iso value in the name if there are several) when the export key is pressed. */
+class SurfaceExportCallback : public vtkCommand {
+private:
+	SurfaceExportCallback() : ExportKey('x'), NumberOfThreads(0), Prefix("assignment5-surface") {}
+
+public:
+	static SurfaceExportCallback *New() { return new SurfaceExportCallback; }
+
+	char ExportKey;
+	int NumberOfThreads;
+	std::string Prefix;
+	vtkSmartPointer<vtkAlgorithm> extractor;
+
+	virtual void Execute(vtkObject *caller, unsigned long eventId, void *callData);
+};
@@ -0,0 +1,276 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+
+#include "surfacecomponents.h"
+#include "volumekernels.h"
+
+#include <vtkObjectFactory.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkPointData.h>
+#include <vtkDataArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkPoints.h>
+#include <vtkCellArray.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+#include <vtkMath.h>
+
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <functional>
+#include <vector>
+#include <algorithm>
+#include <iomanip>
+
+namespace {
+	// root of a point with path halving, the links only ever point to smaller ids
+	vtkIdType findRoot(std::vector<std::atomic<vtkIdType>>& parent, vtkIdType x)
+	{
+		for (;;) {
+			vtkIdType p = parent[x].load();
+			if (p == x)
+				return x;
+			vtkIdType grandparent = parent[p].load();
+			if (grandparent != p)
+				parent[x].compare_exchange_weak(p, grandparent);
+			x = grandparent;
+		}
+	}
+
+	// links the larger of the two roots to the smaller one, retried if another thread linked it first
+	void unite(std::vector<std::atomic<vtkIdType>>& parent, vtkIdType a, vtkIdType b)
+	{
+		for (;;) {
+			a = findRoot(parent, a);
+			b = findRoot(parent, b);
+			if (a == b)
+				return;
+			if (a < b)
+				std::swap(a, b);
+			vtkIdType expected = a;
+			if (parent[a].compare_exchange_strong(expected, b))
+				return;
+		}
+	}
+}
+
+vtkStandardNewMacro(SurfaceComponentFilter);
+
+SurfaceComponentFilter::SurfaceComponentFilter()
+	: LargestComponents(0), MinimumCells(1), UseSeedPoint(false), NumberOfThreads(0), LastNumberOfComponents(0),
+	LastNumberOfKeptComponents(0), LastNumberOfRemovedCells(0), LastLabelTime(0.0), LastSelectTime(0.0),
+	LastCompactTime(0.0), LastNumberOfThreads(0)
+{
+	SeedPoint[0] = SeedPoint[1] = SeedPoint[2] = 0.0;
+}
+
+int SurfaceComponentFilter::RequestData(vtkInformation *, vtkInformationVector **inputVector, vtkInformationVector *outputVector)
+{
+	vtkPolyData *input = vtkPolyData::GetData(inputVector[0]);
+	vtkPolyData *output = vtkPolyData::GetData(outputVector);
+	LastNumberOfComponents = LastNumberOfKeptComponents = LastNumberOfRemovedCells = 0;
+	LastLabelTime = LastSelectTime = LastCompactTime = 0.0;
+	if (!input || !output)
+		return 0;
+	if (input->GetNumberOfVerts() + input->GetNumberOfLines() + input->GetNumberOfStrips() > 0) {
+		vtkErrorMacro("Only surfaces of polygons are supported.");
+		return 0;
+	}
+
+	const vtkIdType numberOfPoints = input->GetNumberOfPoints();
+	const vtkIdType numberOfCells = input->GetNumberOfPolys();
+	if (numberOfPoints == 0 || numberOfCells == 0) {
+		output->ShallowCopy(input);
+		return 1;
+	}
+
+	const int numberOfThreads = threadCount(this->NumberOfThreads);
+	LastNumberOfThreads = numberOfThreads;
+	vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+
+	// labelling, cells are (n, id, ..., id) in the connectivity array, the start of every cell is found first
+	timer->StartTimer();
+	const vtkIdType *connectivity = input->GetPolys()->GetPointer();
+	std::vector<vtkIdType> cellStart(numberOfCells + 1);
+	cellStart[0] = 0;
+	for (vtkIdType c = 0; c < numberOfCells; ++c)
+		cellStart[c + 1] = cellStart[c] + connectivity[cellStart[c]] + 1;
+
+	std::vector<std::atomic<vtkIdType>> parent(numberOfPoints);
+	parallelRanges(numberOfPoints, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+		for (vtkIdType i = begin; i < end; ++i)
+			parent[i].store(i);
+	});
+	parallelRanges(numberOfCells, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+		for (vtkIdType c = begin; c < end; ++c) {
+			const vtkIdType *cell = connectivity + cellStart[c];
+			for (vtkIdType k = 2; k <= cell[0]; ++k)
+				unite(parent, cell[1], cell[k]);
+		}
+	});
+	std::vector<vtkIdType> root(numberOfPoints);
+	parallelRanges(numberOfPoints, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+		for (vtkIdType i = begin; i < end; ++i)
+			root[i] = findRoot(parent, i);
+	});
+	timer->StopTimer();
+	LastLabelTime = timer->GetElapsedTime();
+
+	// selection, the size of a component is its number of cells
+	timer->StartTimer();
+	std::vector<std::atomic<vtkIdType>> cellCount(numberOfPoints);
+	parallelRanges(numberOfPoints, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+		for (vtkIdType i = begin; i < end; ++i)
+			cellCount[i].store(0);
+	});
+	parallelRanges(numberOfCells, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+		for (vtkIdType c = begin; c < end; ++c)
+			cellCount[root[connectivity[cellStart[c] + 1]]].fetch_add(1, std::memory_order_relaxed);
+	});
+	std::vector<vtkIdType> components;
+	for (vtkIdType i = 0; i < numberOfPoints; ++i)
+		if (cellCount[i].load(std::memory_order_relaxed) > 0)
+			components.push_back(i);
+	LastNumberOfComponents = static_cast<vtkIdType>(components.size());
+	std::sort(components.begin(), components.end(), [&](vtkIdType a, vtkIdType b) {
+		const vtkIdType ca = cellCount[a].load(std::memory_order_relaxed), cb = cellCount[b].load(std::memory_order_relaxed);
+		return ca != cb ? ca > cb : a < b;
+	});
+	std::vector<char> keep(numberOfPoints, 0);
+	if (this->UseSeedPoint) {
+		// the point nearest to the seed, the nearest of every range first, ties to the smaller id
+		std::pair<double, vtkIdType> best(VTK_DOUBLE_MAX, -1);
+		std::mutex bestMutex;
+		parallelRanges(numberOfPoints, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+			std::pair<double, vtkIdType> nearest(VTK_DOUBLE_MAX, -1);
+			for (vtkIdType i = begin; i < end; ++i) {
+				double x[3];
+				input->GetPoint(i, x);
+				const double distance = vtkMath::Distance2BetweenPoints(x, this->SeedPoint);
+				if (distance < nearest.first)
+					nearest = std::make_pair(distance, i);
+			}
+			std::lock_guard<std::mutex> lock(bestMutex);
+			if (nearest.second >= 0 && (best.second < 0 || nearest < best))
+				best = nearest;
+		});
+		if (best.second >= 0 && cellCount[root[best.second]].load(std::memory_order_relaxed) > 0) {
+			keep[root[best.second]] = 1;
+			LastNumberOfKeptComponents = 1;
+		}
+	}
+	for (size_t rank = 0; rank < components.size() && !this->UseSeedPoint; ++rank) {
+		if (this->LargestComponents > 0 && rank >= static_cast<size_t>(this->LargestComponents))
+			break;
+		if (cellCount[components[rank]].load(std::memory_order_relaxed) < this->MinimumCells)
+			break;
+		keep[components[rank]] = 1;
+		++LastNumberOfKeptComponents;
+	}
+	timer->StopTimer();
+	LastSelectTime = timer->GetElapsedTime();
+
+	if (LastNumberOfKeptComponents == LastNumberOfComponents) {
+		output->ShallowCopy(input);
+		return 1;
+	}
+
+	// compaction, a count and a write pass over the same fixed ranges with a prefix sum in between
+	timer->StartTimer();
+	const vtkIdType numberOfRanges = std::min<vtkIdType>(std::max(numberOfPoints, numberOfCells), 64 * numberOfThreads);
+	auto rangeBegin = [numberOfRanges](vtkIdType count, vtkIdType range) { return range * count / numberOfRanges; };
+	std::vector<vtkIdType> firstPoint(numberOfRanges + 1, 0), firstCell(numberOfRanges + 1, 0), firstEntry(numberOfRanges + 1, 0);
+	parallelRanges(numberOfRanges, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+		for (vtkIdType range = begin; range < end; ++range) {
+			for (vtkIdType i = rangeBegin(numberOfPoints, range); i < rangeBegin(numberOfPoints, range + 1); ++i)
+				firstPoint[range + 1] += keep[root[i]];
+			for (vtkIdType c = rangeBegin(numberOfCells, range); c < rangeBegin(numberOfCells, range + 1); ++c)
+				if (keep[root[connectivity[cellStart[c] + 1]]]) {
+					++firstCell[range + 1];
+					firstEntry[range + 1] += cellStart[c + 1] - cellStart[c];
+				}
+		}
+	});
+	for (vtkIdType range = 0; range < numberOfRanges; ++range) {
+		firstPoint[range + 1] += firstPoint[range];
+		firstCell[range + 1] += firstCell[range];
+		firstEntry[range + 1] += firstEntry[range];
+	}
+	LastNumberOfRemovedCells = numberOfCells - firstCell[numberOfRanges];
+
+	vtkPointData *inPD = input->GetPointData();
+	vtkPointData *outPD = output->GetPointData();
+	std::vector<vtkDataArray*> sourceArrays, targetArrays;
+	for (int a = 0; a < inPD->GetNumberOfArrays(); ++a) {
+		vtkDataArray *source = inPD->GetArray(a);
+		if (!source)
+			continue;
+		vtkSmartPointer<vtkDataArray> target = vtkSmartPointer<vtkDataArray>::Take(source->NewInstance());
+		target->SetName(source->GetName());
+		target->SetNumberOfComponents(source->GetNumberOfComponents());
+		target->SetNumberOfTuples(firstPoint[numberOfRanges]);
+		outPD->AddArray(target);
+		if (source == inPD->GetNormals())
+			outPD->SetNormals(target);
+		if (source == inPD->GetScalars())
+			outPD->SetScalars(target);
+		sourceArrays.push_back(source);
+		targetArrays.push_back(target);
+	}
+	vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+	points->SetDataType(input->GetPoints()->GetDataType());
+	points->SetNumberOfPoints(firstPoint[numberOfRanges]);
+	vtkSmartPointer<vtkIdTypeArray> cells = vtkSmartPointer<vtkIdTypeArray>::New();
+	cells->SetNumberOfValues(firstEntry[numberOfRanges]);
+
+	std::vector<vtkIdType> pointId(numberOfPoints, -1);
+	vtkDataArray *inPoints = input->GetPoints()->GetData();
+	vtkDataArray *outPoints = points->GetData();
+	parallelRanges(numberOfRanges, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+		for (vtkIdType range = begin; range < end; ++range) {
+			vtkIdType next = firstPoint[range];
+			for (vtkIdType i = rangeBegin(numberOfPoints, range); i < rangeBegin(numberOfPoints, range + 1); ++i) {
+				if (!keep[root[i]])
+					continue;
+				pointId[i] = next;
+				outPoints->SetTuple(next, i, inPoints);
+				for (size_t a = 0; a < sourceArrays.size(); ++a)
+					targetArrays[a]->SetTuple(next, i, sourceArrays[a]);
+				++next;
+			}
+		}
+	});
+	vtkIdType *entries = cells->GetPointer(0);
+	parallelRanges(numberOfRanges, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+		for (vtkIdType range = begin; range < end; ++range) {
+			vtkIdType *entry = entries + firstEntry[range];
+			for (vtkIdType c = rangeBegin(numberOfCells, range); c < rangeBegin(numberOfCells, range + 1); ++c) {
+				const vtkIdType *cell = connectivity + cellStart[c];
+				if (!keep[root[cell[1]]])
+					continue;
+				*entry++ = cell[0];
+				for (vtkIdType k = 1; k <= cell[0]; ++k)
+					*entry++ = pointId[cell[k]];
+			}
+		}
+	});
+	vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+	polys->SetCells(firstCell[numberOfRanges], cells);
+	output->SetPoints(points);
+	output->SetPolys(polys);
+	timer->StopTimer();
+	LastCompactTime = timer->GetElapsedTime();
+	return 1;
+}
+
+void SurfaceComponentFilter::PrintStatistics(std::ostream& os) const
+{
+	os << "components: " << LastNumberOfKeptComponents << " of " << LastNumberOfComponents << " kept, "
+		<< LastNumberOfRemovedCells << " cells removed, label " << std::fixed << std::setprecision(2)
+		<< 1000.0 * LastLabelTime << " ms, select " << 1000.0 * LastSelectTime << " ms, compact "
+		<< 1000.0 * LastCompactTime << " ms on " << LastNumberOfThreads << " threads" << std::endl;
+}
@@ -0,0 +1,85 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+// Multithreaded connected component filter that removes the small fragments of an extracted iso surface.
+//
+
+#pragma once
+
+#include <vtkPolyDataAlgorithm.h>
+
+#include <ostream>
+
+/* Keeps the largest connected components of a surface, for the noise fragments that marching cubes extracts
+   around the skin of a CT volume. Like vtkPolyDataConnectivityFilter with the largest regions, but on all cores:
+   - labelling: a lock-free union-find over the points, every thread unites the points of its range of cells with
+     compare-and-swap links from the larger to the smaller root, then every point finds its root in parallel. The
+     root of a component is its smallest point id, so the labels do not depend on the number of threads,
+   - selection: the triangles per component are counted with atomic increments, the components are ranked by
+     size and the largest LargestComponents (0: all) with at least MinimumCells cells are kept,
+   - compaction: a prefix sum over ranges of points and cells gives every range its first output id, then the
+     kept points with their point data and the cells with renumbered points are written in parallel.
+   The output keeps the order of the input, so it is the same for any number of threads. If nothing is removed,
+   the input is passed through without a copy.
+   With a seed point, only the component of the surface point nearest to it is kept instead, e.g. the contour of
+   one arc of the contour tree (see contourtree.h). */
+class SurfaceComponentFilter : public vtkPolyDataAlgorithm {
+public:
+	static SurfaceComponentFilter *New();
+	vtkTypeMacro(SurfaceComponentFilter, vtkPolyDataAlgorithm);
+
+	/* Number of components to keep, the largest ones, 0 keeps all that are large enough. Default 0. */
+	vtkSetClampMacro(LargestComponents, int, 0, VTK_INT_MAX);
+	vtkGetMacro(LargestComponents, int);
+
+	/* Components with fewer cells are removed. Default 1, nothing is removed. */
+	vtkSetClampMacro(MinimumCells, vtkIdType, 1, VTK_ID_MAX);
+	vtkGetMacro(MinimumCells, vtkIdType);
+
+	/* Keeps only the component of the point nearest to the seed point, whatever the size criteria. Off by default. */
+	vtkSetVector3Macro(SeedPoint, double);
+	vtkGetVector3Macro(SeedPoint, double);
+	vtkSetMacro(UseSeedPoint, bool);
+	vtkGetMacro(UseSeedPoint, bool);
+	vtkBooleanMacro(UseSeedPoint, bool);
+
+	/* Number of worker threads, 0 uses all hardware threads. */
+	vtkSetClampMacro(NumberOfThreads, int, 0, 256);
+	vtkGetMacro(NumberOfThreads, int);
+
+	/* Statistics of the last execution: components found and kept, removed cells, and the seconds of the
+	   labelling, the selection and the compaction. */
+	vtkGetMacro(LastNumberOfComponents, vtkIdType);
+	vtkGetMacro(LastNumberOfKeptComponents, vtkIdType);
+	vtkGetMacro(LastNumberOfRemovedCells, vtkIdType);
+	vtkGetMacro(LastLabelTime, double);
+	vtkGetMacro(LastSelectTime, double);
+	vtkGetMacro(LastCompactTime, double);
+	vtkGetMacro(LastNumberOfThreads, int);
+
+	/* One line with the statistics of the last execution. */
+	void PrintStatistics(std::ostream& os) const;
+
+protected:
+	SurfaceComponentFilter();
+	~SurfaceComponentFilter() override {}
+
+	int RequestData(vtkInformation *request, vtkInformationVector **inputVector, vtkInformationVector *outputVector) override;
+
+private:
+	SurfaceComponentFilter(const SurfaceComponentFilter&) = delete;
+	void operator=(const SurfaceComponentFilter&) = delete;
+
+	int LargestComponents;
+	vtkIdType MinimumCells;
+	double SeedPoint[3];
+	bool UseSeedPoint;
+	int NumberOfThreads;
+	vtkIdType LastNumberOfComponents;
+	vtkIdType LastNumberOfKeptComponents;
+	vtkIdType LastNumberOfRemovedCells;
+	double LastLabelTime;
+	double LastSelectTime;
+	double LastCompactTime;
+	int LastNumberOfThreads;
+};
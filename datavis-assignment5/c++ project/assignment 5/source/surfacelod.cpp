@@ -0,0 +1,405 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+
+#include "surfacelod.h"
+#include "volumekernels.h"
+
+#include <vtkObjectFactory.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkPointData.h>
+#include <vtkDataArray.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkPoints.h>
+#include <vtkCellArray.h>
+#include <vtkPolyData.h>
+#include <vtkTimerLog.h>
+#include <vtkMath.h>
+
+#include <thread>
+#include <functional>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+	// grows the array of atomic counters if needed, the counters are not initialized
+	void reserveCounters(std::unique_ptr<std::atomic<vtkIdType>[]>& counters, size_t& capacity, size_t size)
+	{
+		if (size > capacity) {
+			counters.reset(new std::atomic<vtkIdType>[size]);
+			capacity = size;
+		}
+	}
+
+	void clearCounters(std::atomic<vtkIdType> *counters, vtkIdType size, int numberOfThreads)
+	{
+		parallelRanges(size, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+			for (vtkIdType i = begin; i < end; ++i)
+				counters[i].store(0, std::memory_order_relaxed);
+		});
+	}
+
+	// the connectivity (3, a, b, c, 3, ...) of a surface of triangles only, otherwise null
+	const vtkIdType *triangleConnectivity(vtkPolyData *input)
+	{
+		vtkCellArray *polys = input->GetPolys();
+		if (input->GetNumberOfVerts() + input->GetNumberOfLines() + input->GetNumberOfStrips() > 0
+			|| polys->GetNumberOfConnectivityEntries() != 4 * polys->GetNumberOfCells())
+			return nullptr;
+		return polys->GetPointer();
+	}
+}
+
+// ----- windowed sinc smoothing -----
+
+vtkStandardNewMacro(ParallelWindowedSinc);
+
+ParallelWindowedSinc::ParallelWindowedSinc()
+	: NumberOfIterations(15), PassBand(0.1), NumberOfThreads(0), LastIndexTime(0.0), LastSmoothTime(0.0),
+	degreeCapacity(0)
+{
+}
+
+int ParallelWindowedSinc::RequestData(vtkInformation *, vtkInformationVector **inputVector, vtkInformationVector *outputVector)
+{
+	vtkPolyData *input = vtkPolyData::GetData(inputVector[0]);
+	vtkPolyData *output = vtkPolyData::GetData(outputVector);
+	if (!input || !output)
+		return 0;
+	const vtkIdType numberOfPoints = input->GetNumberOfPoints();
+	const vtkIdType numberOfTriangles = input->GetNumberOfPolys();
+	if (numberOfPoints == 0 || numberOfTriangles == 0) {
+		output->ShallowCopy(input);
+		return 1;
+	}
+	const vtkIdType *connectivity = triangleConnectivity(input);
+	if (!connectivity) {
+		vtkErrorMacro("Only surfaces of triangles are supported.");
+		return 0;
+	}
+
+	const int numberOfThreads = threadCount(this->NumberOfThreads);
+	vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+
+	// neighbour index: two entries per incident triangle, counted, numbered, filled and sorted
+	timer->StartTimer();
+	reserveCounters(degree, degreeCapacity, numberOfPoints);
+	clearCounters(degree.get(), numberOfPoints, numberOfThreads);
+	parallelRanges(numberOfTriangles, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+		for (vtkIdType t = begin; t < end; ++t)
+			for (int corner = 1; corner <= 3; ++corner)
+				degree[connectivity[4 * t + corner]].fetch_add(2, std::memory_order_relaxed);
+	});
+	neighbourStart.resize(numberOfPoints + 1);
+	neighbourStart[0] = 0;
+	for (vtkIdType i = 0; i < numberOfPoints; ++i)
+		neighbourStart[i + 1] = neighbourStart[i] + degree[i].load(std::memory_order_relaxed);
+	neighbours.resize(neighbourStart[numberOfPoints]);
+	clearCounters(degree.get(), numberOfPoints, numberOfThreads);
+	parallelRanges(numberOfTriangles, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+		for (vtkIdType t = begin; t < end; ++t) {
+			const vtkIdType *triangle = connectivity + 4 * t + 1;
+			for (int corner = 0; corner < 3; ++corner) {
+				const vtkIdType point = triangle[corner];
+				const vtkIdType slot = neighbourStart[point] + degree[point].fetch_add(2, std::memory_order_relaxed);
+				neighbours[slot] = triangle[(corner + 1) % 3];
+				neighbours[slot + 1] = triangle[(corner + 2) % 3];
+			}
+		}
+	});
+	parallelRanges(numberOfPoints, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+		for (vtkIdType i = begin; i < end; ++i)
+			std::sort(neighbours.begin() + neighbourStart[i], neighbours.begin() + neighbourStart[i + 1]);
+	});
+	timer->StopTimer();
+	LastIndexTime = timer->GetElapsedTime();
+
+	// Hann windowed Chebyshev coefficients of the ideal low pass, scaled to keep the mean (f(0) = 1)
+	timer->StartTimer();
+	const int n = this->NumberOfIterations;
+	const double theta = std::acos(1.0 - 0.5 * this->PassBand);
+	std::vector<double> coefficients(n + 1);
+	double total = 0.0;
+	for (int i = 0; i <= n; ++i) {
+		const double ideal = i == 0 ? theta / vtkMath::Pi() : 2.0 * std::sin(i * theta) / (i * vtkMath::Pi());
+		coefficients[i] = ideal * (0.5 + 0.5 * std::cos(i * vtkMath::Pi() / (n + 1)));
+		total += coefficients[i];
+	}
+	for (int i = 0; i <= n; ++i)
+		coefficients[i] /= total;
+
+	previous.resize(3 * numberOfPoints);
+	current.resize(3 * numberOfPoints);
+	next.resize(3 * numberOfPoints);
+	sum.resize(3 * numberOfPoints);
+	vtkPoints *inputPoints = input->GetPoints();
+	parallelRanges(numberOfPoints, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+		for (vtkIdType i = begin; i < end; ++i) {
+			inputPoints->GetPoint(i, &previous[3 * i]);
+			for (int a = 0; a < 3; ++a)
+				sum[3 * i + a] = coefficients[0] * previous[3 * i + a];
+		}
+	});
+
+	// T(1) = (T(0) + mean T(0)) / 2, T(i+1) = T(i) + mean T(i) - T(i-1)
+	for (int i = 0; i < n; ++i) {
+		const double coefficient = coefficients[i + 1];
+		const std::vector<double>& from = i == 0 ? previous : current;
+		parallelRanges(numberOfPoints, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+			for (vtkIdType p = begin; p < end; ++p) {
+				const vtkIdType first = neighbourStart[p], last = neighbourStart[p + 1];
+				for (int a = 0; a < 3; ++a) {
+					double mean = from[3 * p + a];
+					if (last > first) {
+						mean = 0.0;
+						for (vtkIdType k = first; k < last; ++k)
+							mean += from[3 * neighbours[k] + a];
+						mean /= static_cast<double>(last - first);
+					}
+					const double value = i == 0 ? 0.5 * (from[3 * p + a] + mean) : from[3 * p + a] + mean - previous[3 * p + a];
+					next[3 * p + a] = value;
+					sum[3 * p + a] += coefficient * value;
+				}
+			}
+		});
+		if (i > 0)
+			previous.swap(current);
+		current.swap(next);
+	}
+
+	vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+	points->SetDataTypeToFloat();
+	points->SetNumberOfPoints(numberOfPoints);
+	float *coordinates = static_cast<vtkFloatArray*>(points->GetData())->GetPointer(0);
+	parallelRanges(3 * numberOfPoints, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+		for (vtkIdType k = begin; k < end; ++k)
+			coordinates[k] = static_cast<float>(sum[k]);
+	});
+	output->CopyStructure(input);
+	output->SetPoints(points);
+	output->GetPointData()->PassData(input->GetPointData());
+	timer->StopTimer();
+	LastSmoothTime = timer->GetElapsedTime();
+	return 1;
+}
+
+// ----- vertex clustering -----
+
+vtkStandardNewMacro(ParallelVertexClustering);
+
+ParallelVertexClustering::ParallelVertexClustering()
+	: NumberOfDivisions(64), NumberOfThreads(0), LastExecuteTime(0.0), counterCapacity(0)
+{
+}
+
+int ParallelVertexClustering::RequestData(vtkInformation *, vtkInformationVector **inputVector, vtkInformationVector *outputVector)
+{
+	vtkPolyData *input = vtkPolyData::GetData(inputVector[0]);
+	vtkPolyData *output = vtkPolyData::GetData(outputVector);
+	if (!input || !output)
+		return 0;
+	const vtkIdType numberOfPoints = input->GetNumberOfPoints();
+	const vtkIdType numberOfTriangles = input->GetNumberOfPolys();
+	double bounds[6];
+	input->GetBounds(bounds);
+	const double longest = std::max(bounds[1] - bounds[0], std::max(bounds[3] - bounds[2], bounds[5] - bounds[4]));
+	if (numberOfPoints == 0 || numberOfTriangles == 0 || longest <= 0.0) {
+		output->ShallowCopy(input);
+		return 1;
+	}
+	const vtkIdType *connectivity = triangleConnectivity(input);
+	if (!connectivity) {
+		vtkErrorMacro("Only surfaces of triangles are supported.");
+		return 0;
+	}
+
+	const int numberOfThreads = threadCount(this->NumberOfThreads);
+	vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+	timer->StartTimer();
+
+	// cubic grid cells, a point on the upper bound goes to the last cell
+	const double cellSize = longest / this->NumberOfDivisions;
+	vtkIdType dims[3];
+	for (int a = 0; a < 3; ++a)
+		dims[a] = std::max<vtkIdType>(1, std::min<vtkIdType>(this->NumberOfDivisions,
+			static_cast<vtkIdType>(std::ceil((bounds[2 * a + 1] - bounds[2 * a]) / cellSize))));
+	const vtkIdType numberOfBins = dims[0] * dims[1] * dims[2];
+	reserveCounters(counters, counterCapacity, numberOfBins);
+	std::atomic<vtkIdType> *count = counters.get();
+
+	// bin every point and count the points per bin
+	vtkPoints *inputPoints = input->GetPoints();
+	binOfPoint.resize(numberOfPoints);
+	clearCounters(count, numberOfBins, numberOfThreads);
+	parallelRanges(numberOfPoints, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+		double x[3];
+		for (vtkIdType i = begin; i < end; ++i) {
+			inputPoints->GetPoint(i, x);
+			vtkIdType index[3];
+			for (int a = 0; a < 3; ++a)
+				index[a] = std::min(dims[a] - 1, static_cast<vtkIdType>((x[a] - bounds[2 * a]) / cellSize));
+			binOfPoint[i] = index[0] + dims[0] * (index[1] + dims[1] * index[2]);
+			count[binOfPoint[i]].fetch_add(1, std::memory_order_relaxed);
+		}
+	});
+
+	// the occupied bins are the output points, numbered in bin order
+	binStart.resize(numberOfBins + 1);
+	clusterOfBin.resize(numberOfBins);
+	binStart[0] = 0;
+	vtkIdType numberOfClusters = 0;
+	for (vtkIdType b = 0; b < numberOfBins; ++b) {
+		const vtkIdType points = count[b].load(std::memory_order_relaxed);
+		binStart[b + 1] = binStart[b] + points;
+		clusterOfBin[b] = points > 0 ? numberOfClusters++ : -1;
+	}
+
+	// point lists per bin, sorted so that the means do not depend on the order of the threads
+	pointsByBin.resize(numberOfPoints);
+	clearCounters(count, numberOfBins, numberOfThreads);
+	parallelRanges(numberOfPoints, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+		for (vtkIdType i = begin; i < end; ++i) {
+			const vtkIdType b = binOfPoint[i];
+			pointsByBin[binStart[b] + count[b].fetch_add(1, std::memory_order_relaxed)] = i;
+		}
+	});
+
+	vtkDataArray *inputNormals = input->GetPointData()->GetNormals();
+	vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+	points->SetDataTypeToFloat();
+	points->SetNumberOfPoints(numberOfClusters);
+	float *coordinates = static_cast<vtkFloatArray*>(points->GetData())->GetPointer(0);
+	vtkSmartPointer<vtkFloatArray> normals;
+	if (inputNormals) {
+		normals = vtkSmartPointer<vtkFloatArray>::New();
+		normals->SetName(inputNormals->GetName() ? inputNormals->GetName() : "Normals");
+		normals->SetNumberOfComponents(3);
+		normals->SetNumberOfTuples(numberOfClusters);
+	}
+	float *normal = normals ? normals->GetPointer(0) : nullptr;
+	parallelRanges(numberOfBins, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+		double x[3], n[3];
+		for (vtkIdType b = begin; b < end; ++b) {
+			const vtkIdType cluster = clusterOfBin[b];
+			if (cluster < 0)
+				continue;
+			std::sort(pointsByBin.begin() + binStart[b], pointsByBin.begin() + binStart[b + 1]);
+			double position[3] = { 0.0, 0.0, 0.0 }, direction[3] = { 0.0, 0.0, 0.0 };
+			for (vtkIdType k = binStart[b]; k < binStart[b + 1]; ++k) {
+				inputPoints->GetPoint(pointsByBin[k], x);
+				vtkMath::Add(position, x, position);
+				if (normal) {
+					inputNormals->GetTuple(pointsByBin[k], n);
+					vtkMath::Add(direction, n, direction);
+				}
+			}
+			const double members = static_cast<double>(binStart[b + 1] - binStart[b]);
+			for (int a = 0; a < 3; ++a)
+				coordinates[3 * cluster + a] = static_cast<float>(position[a] / members);
+			if (normal) {
+				vtkMath::Normalize(direction);
+				for (int a = 0; a < 3; ++a)
+					normal[3 * cluster + a] = static_cast<float>(direction[a]);
+			}
+		}
+	});
+
+	// triangles between three different clusters, rotated to start at their smallest cluster and bucketed by it
+	auto clusterTriangle = [&](vtkIdType t, vtkIdType corners[3]) {
+		for (int c = 0; c < 3; ++c)
+			corners[c] = clusterOfBin[binOfPoint[connectivity[4 * t + 1 + c]]];
+		if (corners[0] == corners[1] || corners[1] == corners[2] || corners[0] == corners[2])
+			return false;
+		while (corners[0] > corners[1] || corners[0] > corners[2])
+			std::rotate(corners, corners + 1, corners + 3);
+		return true;
+	};
+	clearCounters(count, numberOfClusters, numberOfThreads);
+	parallelRanges(numberOfTriangles, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+		vtkIdType corners[3];
+		for (vtkIdType t = begin; t < end; ++t)
+			if (clusterTriangle(t, corners))
+				count[corners[0]].fetch_add(1, std::memory_order_relaxed);
+	});
+	triangleStart.resize(numberOfClusters + 1);
+	triangleStart[0] = 0;
+	for (vtkIdType c = 0; c < numberOfClusters; ++c)
+		triangleStart[c + 1] = triangleStart[c] + count[c].load(std::memory_order_relaxed);
+	trianglePairs.resize(triangleStart[numberOfClusters]);
+	clearCounters(count, numberOfClusters, numberOfThreads);
+	parallelRanges(numberOfTriangles, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+		vtkIdType corners[3];
+		for (vtkIdType t = begin; t < end; ++t)
+			if (clusterTriangle(t, corners))
+				trianglePairs[triangleStart[corners[0]] + count[corners[0]].fetch_add(1, std::memory_order_relaxed)] =
+					std::make_pair(corners[1], corners[2]);
+	});
+
+	// one triangle per distinct pair of every bucket, written in bucket order
+	uniqueStart.resize(numberOfClusters + 1);
+	uniqueStart[0] = 0;
+	parallelRanges(numberOfClusters, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+		for (vtkIdType c = begin; c < end; ++c) {
+			auto first = trianglePairs.begin() + triangleStart[c], last = trianglePairs.begin() + triangleStart[c + 1];
+			std::sort(first, last);
+			uniqueStart[c + 1] = std::unique(first, last) - first;
+		}
+	});
+	for (vtkIdType c = 0; c < numberOfClusters; ++c)
+		uniqueStart[c + 1] += uniqueStart[c];
+	vtkSmartPointer<vtkIdTypeArray> cells = vtkSmartPointer<vtkIdTypeArray>::New();
+	cells->SetNumberOfValues(4 * uniqueStart[numberOfClusters]);
+	vtkIdType *entries = cells->GetPointer(0);
+	parallelRanges(numberOfClusters, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+		for (vtkIdType c = begin; c < end; ++c) {
+			vtkIdType *entry = entries + 4 * uniqueStart[c];
+			for (vtkIdType k = 0; k < uniqueStart[c + 1] - uniqueStart[c]; ++k) {
+				*entry++ = 3;
+				*entry++ = c;
+				*entry++ = trianglePairs[triangleStart[c] + k].first;
+				*entry++ = trianglePairs[triangleStart[c] + k].second;
+			}
+		}
+	});
+
+	vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+	polys->SetCells(uniqueStart[numberOfClusters], cells);
+	output->SetPoints(points);
+	output->SetPolys(polys);
+	if (normals)
+		output->GetPointData()->SetNormals(normals);
+	timer->StopTimer();
+	LastExecuteTime = timer->GetElapsedTime();
+	return 1;
+}
+
+// ----- level of detail switch -----
+
+void LevelOfDetailSwitch::AddActor(vtkActor *actor, vtkMapper *fullMapper, vtkMapper *lodMapper)
+{
+	Entry entry;
+	entry.actor = actor;
+	entry.fullMapper = fullMapper;
+	entry.lodMapper = lodMapper;
+	entries.push_back(entry);
+	actor->SetMapper(interacting ? lodMapper : fullMapper);
+}
+
+void LevelOfDetailSwitch::Attach(vtkRenderWindow *window, vtkRenderWindowInteractor *interactor)
+{
+	this->interactor = interactor;
+	window->AddObserver(vtkCommand::StartEvent, this);
+}
+
+void LevelOfDetailSwitch::Execute(vtkObject *caller, unsigned long eventId, void *callData)
+{
+	vtkRenderWindow *window = static_cast<vtkRenderWindow*>(caller);
+	const bool moving = interactor && window->GetDesiredUpdateRate() > interactor->GetStillUpdateRate();
+	if (moving == interacting)
+		return;
+	interacting = moving;
+	for (size_t e = 0; e < entries.size(); ++e)
+		entries[e].actor->SetMapper(interacting ? entries[e].lodMapper : entries[e].fullMapper);
+}
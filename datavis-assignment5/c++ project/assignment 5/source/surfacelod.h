@@ -0,0 +1,155 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+// Multithreaded smoothing and vertex clustering decimation of iso surfaces, and the switch to the decimated level of
+// detail while the camera moves.
+//
+
+#pragma once
+
+#include <vtkPolyDataAlgorithm.h>
+#include <vtkSmartPointer.h>
+#include <vtkMapper.h>
+#include <vtkActor.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkCommand.h>
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/* Low pass filter of the point positions of a triangle mesh with a windowed sinc transfer function, like
+   vtkWindowedSincPolyDataFilter (Taubin): the Chebyshev polynomials of the umbrella operator are evaluated with
+   NumberOfIterations steps of the recursion T(i+1) = 2 T(i) + L T(i) - T(i-1), where L moves every point to the mean
+   of its neighbours, and summed with the Hann windowed coefficients of the ideal low pass up to PassBand. Unlike
+   Laplacian smoothing the surface does not shrink.
+   Every step is one parallel pass over the points. The neighbours of a point are the other corners of its
+   incident triangles, an index built in parallel from the triangles (counting, prefix sum, filling, and sorting
+   every list, so the sums and the output do not depend on the number of threads). The index and the recursion
+   buffers are members and keep their memory from one execution to the next, so a slider update allocates only
+   the output points. Point data, e.g. the gradient normals, is passed on unchanged like in the VTK filter. */
+class ParallelWindowedSinc : public vtkPolyDataAlgorithm {
+public:
+	static ParallelWindowedSinc *New();
+	vtkTypeMacro(ParallelWindowedSinc, vtkPolyDataAlgorithm);
+
+	/* Degree of the filter polynomial, default 15. */
+	vtkSetClampMacro(NumberOfIterations, int, 1, 200);
+	vtkGetMacro(NumberOfIterations, int);
+
+	/* Upper end of the pass band in 0..2 like in vtkWindowedSincPolyDataFilter, smaller smooths more, default 0.1. */
+	vtkSetClampMacro(PassBand, double, 0.001, 2.0);
+	vtkGetMacro(PassBand, double);
+
+	/* Number of worker threads, 0 uses all hardware threads. */
+	vtkSetClampMacro(NumberOfThreads, int, 0, 256);
+	vtkGetMacro(NumberOfThreads, int);
+
+	/* Seconds of the last execution for the neighbour index and for the filter steps. */
+	vtkGetMacro(LastIndexTime, double);
+	vtkGetMacro(LastSmoothTime, double);
+
+protected:
+	ParallelWindowedSinc();
+	~ParallelWindowedSinc() override {}
+
+	int RequestData(vtkInformation *request, vtkInformationVector **inputVector, vtkInformationVector *outputVector) override;
+
+private:
+	ParallelWindowedSinc(const ParallelWindowedSinc&) = delete;
+	void operator=(const ParallelWindowedSinc&) = delete;
+
+	int NumberOfIterations;
+	double PassBand;
+	int NumberOfThreads;
+	double LastIndexTime;
+	double LastSmoothTime;
+
+	// reused between executions
+	std::unique_ptr<std::atomic<vtkIdType>[]> degree;
+	size_t degreeCapacity;
+	std::vector<vtkIdType> neighbourStart;
+	std::vector<vtkIdType> neighbours;
+	std::vector<double> previous, current, next, sum;
+};
+
+/* Decimation by vertex clustering like vtkQuadricClustering with mean positions, on all cores: the points are
+   binned into a grid of cubic cells with NumberOfDivisions cells along the longest side of the bounds, every
+   occupied cell becomes one point at the mean of its points (with the mean of their normals), and every triangle
+   whose corners fall into three different cells becomes a triangle between them. Triangles that collapse to the
+   same three cells are kept once.
+   All steps are parallel passes: binning, counting the points per cell with atomic increments, numbering the
+   occupied cells with a prefix sum, averaging per cell over sorted point lists, and removing the duplicate
+   triangles per first corner over sorted lists. The output does not depend on the number of threads. The
+   buffers are members and keep their memory between executions. */
+class ParallelVertexClustering : public vtkPolyDataAlgorithm {
+public:
+	static ParallelVertexClustering *New();
+	vtkTypeMacro(ParallelVertexClustering, vtkPolyDataAlgorithm);
+
+	/* Grid cells along the longest side of the bounds, default 64. */
+	vtkSetClampMacro(NumberOfDivisions, int, 2, 256);
+	vtkGetMacro(NumberOfDivisions, int);
+
+	/* Number of worker threads, 0 uses all hardware threads. */
+	vtkSetClampMacro(NumberOfThreads, int, 0, 256);
+	vtkGetMacro(NumberOfThreads, int);
+
+	/* Seconds of the last execution. */
+	vtkGetMacro(LastExecuteTime, double);
+
+protected:
+	ParallelVertexClustering();
+	~ParallelVertexClustering() override {}
+
+	int RequestData(vtkInformation *request, vtkInformationVector **inputVector, vtkInformationVector *outputVector) override;
+
+private:
+	ParallelVertexClustering(const ParallelVertexClustering&) = delete;
+	void operator=(const ParallelVertexClustering&) = delete;
+
+	int NumberOfDivisions;
+	int NumberOfThreads;
+	double LastExecuteTime;
+
+	// reused between executions
+	std::unique_ptr<std::atomic<vtkIdType>[]> counters;
+	size_t counterCapacity;
+	std::vector<vtkIdType> binOfPoint, binStart, pointsByBin, clusterOfBin;
+	std::vector<vtkIdType> triangleStart, uniqueStart;
+	std::vector<std::pair<vtkIdType, vtkIdType>> trianglePairs;
+};
+
+/* Shows the decimated surfaces while the camera moves and the full ones otherwise. The interactor styles raise
+   the desired update rate of the render window for the duration of an interaction (vtkInteractorStyle::StartState)
+   and set it back to the still update rate at its end, which renders once more. Before every render the switch
+   compares the two and gives every actor its full or its level of detail mapper, so it works with any interactor
+   style and with the render requests of the interaction scheduler. */
+class LevelOfDetailSwitch : public vtkCommand {
+private:
+	LevelOfDetailSwitch() : interactor(nullptr), interacting(false) {}
+
+public:
+	static LevelOfDetailSwitch *New() { return new LevelOfDetailSwitch; }
+
+	/* The actor shows the full mapper now and the level of detail mapper while interacting. */
+	void AddActor(vtkActor *actor, vtkMapper *fullMapper, vtkMapper *lodMapper);
+
+	/* Observes the start of every render of the window. */
+	void Attach(vtkRenderWindow *window, vtkRenderWindowInteractor *interactor);
+
+	virtual void Execute(vtkObject *caller, unsigned long eventId, void *callData);
+
+private:
+	struct Entry {
+		vtkSmartPointer<vtkActor> actor;
+		vtkSmartPointer<vtkMapper> fullMapper;
+		vtkSmartPointer<vtkMapper> lodMapper;
+	};
+
+	std::vector<Entry> entries;
+	vtkRenderWindowInteractor *interactor;
+	bool interacting;
+};
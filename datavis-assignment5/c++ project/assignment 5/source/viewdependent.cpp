@@ -0,0 +1,308 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+
+#include "viewdependent.h"
+
+#include <vtkCamera.h>
+#include <vtkProperty.h>
+#include <vtkTimerLog.h>
+#include <vtkMath.h>
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+
+// whether the box is on the inner side of all six planes (a, b, c, d) of vtkCamera::GetFrustumPlanes, tested with
+// the corner farthest along the inward normal
+static bool intersectsFrustum(const double bounds[6], const double planes[24])
+{
+	for (int p = 0; p < 6; ++p) {
+		const double *plane = planes + 4 * p;
+		double distance = plane[3];
+		for (int a = 0; a < 3; ++a)
+			distance += plane[a] * (plane[a] >= 0.0 ? bounds[2 * a + 1] : bounds[2 * a]);
+		if (distance < 0.0)
+			return false;
+	}
+	return true;
+}
+
+// distance of the point to the box, zero inside
+static double distanceToBox(const double point[3], const double bounds[6])
+{
+	double squared = 0.0;
+	for (int a = 0; a < 3; ++a) {
+		double d = std::max(bounds[2 * a] - point[a], std::max(0.0, point[a] - bounds[2 * a + 1]));
+		squared += d * d;
+	}
+	return std::sqrt(squared);
+}
+
+ViewDependentSurface::ViewDependentSurface()
+	: ToggleKey('v'), BrickSize(32), MaxLevel(3), CellPixels(2.0), TimeBudget(0.01), NumberOfThreads(0),
+	enabled(false), isoValue(500.0), spacing(1.0), renderer(nullptr), pending(0), extractedBricks(0),
+	extractionTime(0.0), reported(true)
+{
+	extractor = vtkSmartPointer<WeldedMarchingCubes>::New();
+	output = vtkSmartPointer<vtkMultiBlockDataSet>::New();
+	mapper = vtkSmartPointer<vtkCompositePolyDataMapper2>::New();
+	mapper->SetInputDataObject(output);
+	mapper->ScalarVisibilityOff();
+	actor = vtkSmartPointer<vtkActor>::New();
+	actor->SetMapper(mapper);
+	actor->VisibilityOff();
+}
+
+void ViewDependentSurface::Attach(vtkRenderer *renderer, vtkRenderWindowInteractor *interactor, vtkImageData *volume)
+{
+	this->renderer = renderer;
+	if (wholeSurface)
+		isoValue = wholeSurface->GetValue(0);
+	if (wholeActor)
+		actor->SetProperty(wholeActor->GetProperty());
+
+	extractor->SetValue(0, isoValue);
+	extractor->SetNumberOfThreads(NumberOfThreads);
+	SetVolume(volume);
+
+	renderer->AddActor(actor);
+	renderer->GetActiveCamera()->AddObserver(vtkCommand::ModifiedEvent, this);
+	interactor->AddObserver(vtkCommand::KeyPressEvent, this);
+}
+
+void ViewDependentSurface::SetVolume(vtkImageData *volume)
+{
+	extractor->SetInputData(volume);
+
+	// bricks share their boundary points, so the surfaces of neighbouring bricks of the same level meet
+	int extent[6];
+	volume->GetExtent(extent);
+	double origin[3], volumeSpacing[3];
+	volume->GetOrigin(origin);
+	volume->GetSpacing(volumeSpacing);
+	spacing = std::min(volumeSpacing[0], std::min(volumeSpacing[1], volumeSpacing[2]));
+	std::vector<Brick> split;
+	for (int k = extent[4]; k < extent[5]; k += BrickSize)
+		for (int j = extent[2]; j < extent[3]; j += BrickSize)
+			for (int i = extent[0]; i < extent[1]; i += BrickSize) {
+				Brick brick;
+				const int lower[3] = { i, j, k };
+				for (int a = 0; a < 3; ++a) {
+					brick.extent[2 * a] = lower[a];
+					brick.extent[2 * a + 1] = std::min(lower[a] + BrickSize, extent[2 * a + 1]);
+					brick.bounds[2 * a] = origin[a] + brick.extent[2 * a] * volumeSpacing[a];
+					brick.bounds[2 * a + 1] = origin[a] + brick.extent[2 * a + 1] * volumeSpacing[a];
+				}
+				brick.visible = false;
+				brick.level = 0;
+				brick.surfaceLevel = -1;
+				brick.surfaceValue = 0.0;
+				split.push_back(brick);
+			}
+
+	bool sameBricks = split.size() == bricks.size();
+	for (size_t b = 0; b < split.size() && sameBricks; ++b)
+		sameBricks = std::equal(split[b].extent, split[b].extent + 6, bricks[b].extent)
+			&& std::equal(split[b].bounds, split[b].bounds + 6, bricks[b].bounds);
+	if (sameBricks) {
+		for (Brick& brick : bricks)
+			brick.surfaceLevel = -1;
+	}
+	else {
+		bricks.swap(split);
+		output->SetNumberOfBlocks(0);
+		output->SetNumberOfBlocks(static_cast<unsigned int>(bricks.size()));
+		output->Modified();
+	}
+	if (enabled)
+		schedule();
+}
+
+void ViewDependentSurface::SetEnabled(bool enabled)
+{
+	this->enabled = enabled;
+	actor->SetVisibility(enabled);
+	if (wholeActor)
+		wholeActor->SetVisibility(!enabled);
+	if (enabled)
+		schedule();
+	else if (wholeSurface && wholeSurface->GetValue(0) != isoValue) {
+		// the slider moved the bricks only, the whole surface catches up
+		WeldedMarchingCubes *surface = wholeSurface;
+		const double value = isoValue;
+		InteractionScheduler::Update update = [surface, value]() {
+			surface->SetValue(0, value);
+			surface->Update();
+			return true;
+		};
+		if (scheduler)
+			scheduler->Post(&wholeSurface, update);
+		else
+			update();
+	}
+}
+
+void ViewDependentSurface::SetIsoValue(double value)
+{
+	if (value == isoValue)
+		return;
+	isoValue = value;
+	extractor->SetValue(0, value);
+	if (enabled)
+		schedule();
+}
+
+int ViewDependentSurface::chooseLevel(const Brick& brick) const
+{
+	vtkCamera *camera = renderer->GetActiveCamera();
+	const int *size = renderer->GetSize();
+	double pixelsPerUnit;
+	if (camera->GetParallelProjection())
+		pixelsPerUnit = size[1] / (2.0 * camera->GetParallelScale());
+	else {
+		const double distance = std::max(distanceToBox(camera->GetPosition(), brick.bounds), spacing);
+		pixelsPerUnit = size[1] / (2.0 * distance * std::tan(vtkMath::RadiansFromDegrees(camera->GetViewAngle()) / 2.0));
+	}
+
+	// coarser while even the cells of the next level stay below the wanted size on the screen
+	const double cellPixels = spacing * pixelsPerUnit;
+	int level = 0;
+	while (level < MaxLevel && cellPixels * (2 << level) <= CellPixels && (2 << level) <= BrickSize)
+		++level;
+	return level;
+}
+
+void ViewDependentSurface::extract(Brick& brick)
+{
+	extractor->SetVolumeOfInterest(brick.extent);
+	extractor->SetSampleRate(1 << brick.level);
+	extractor->Update();
+	brick.surface = vtkSmartPointer<vtkPolyData>::New();
+	brick.surface->ShallowCopy(extractor->GetOutput());
+	brick.surfaceLevel = brick.level;
+	brick.surfaceValue = isoValue;
+}
+
+bool ViewDependentSurface::Update()
+{
+	if (!enabled || !renderer || bricks.empty())
+		return false;
+
+	vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+	timer->StartTimer();
+
+	double planes[24];
+	vtkCamera *camera = renderer->GetActiveCamera();
+	camera->GetFrustumPlanes(renderer->GetTiledAspectRatio(), planes);
+	const double *position = camera->GetPosition();
+
+	// cull and choose the levels, collect the visible bricks without a surface for the current value and level
+	bool changed = false;
+	std::vector<size_t> work;
+	for (size_t b = 0; b < bricks.size(); ++b) {
+		Brick& brick = bricks[b];
+		const bool visible = intersectsFrustum(brick.bounds, planes);
+		changed |= visible != brick.visible;
+		brick.visible = visible;
+		if (!visible)
+			continue;
+		brick.level = chooseLevel(brick);
+		if (!brick.surface || brick.surfaceLevel != brick.level || brick.surfaceValue != isoValue)
+			work.push_back(b);
+	}
+
+	// holes first, then stale iso values or voxels, then stale levels, the nearest bricks first in each group
+	auto priority = [this](size_t b) {
+		const Brick& brick = bricks[b];
+		return !brick.surface ? 0 : brick.surfaceValue != isoValue || brick.surfaceLevel < 0 ? 1 : 2;
+	};
+	std::vector<double> distances(bricks.size(), 0.0);
+	for (size_t b : work)
+		distances[b] = distanceToBox(position, bricks[b].bounds);
+	std::sort(work.begin(), work.end(), [&](size_t a, size_t b) {
+		const int pa = priority(a), pb = priority(b);
+		return pa != pb ? pa < pb : distances[a] < distances[b];
+	});
+
+	// without a scheduler there are no later frames, everything is extracted at once
+	size_t done = 0;
+	while (done < work.size()) {
+		timer->StopTimer();
+		if (done > 0 && scheduler && timer->GetElapsedTime() >= TimeBudget)
+			break;
+		extract(bricks[work[done++]]);
+	}
+	timer->StopTimer();
+	if (done > 0) {
+		changed = true;
+		extractedBricks += done;
+		extractionTime += timer->GetElapsedTime();
+		reported = false;
+	}
+	pending = work.size() - done;
+
+	if (changed) {
+		for (size_t b = 0; b < bricks.size(); ++b)
+			output->SetBlock(static_cast<unsigned int>(b), bricks[b].visible ? bricks[b].surface.GetPointer() : nullptr);
+		output->Modified();
+	}
+
+	if (pending > 0)
+		schedule();
+	else if (!reported) {
+		PrintStatistics(std::cout);
+		extractedBricks = 0;
+		extractionTime = 0.0;
+		reported = true;
+	}
+	return changed;
+}
+
+void ViewDependentSurface::schedule()
+{
+	if (scheduler)
+		scheduler->Post(this, [this]() { return Update(); });
+	else
+		Update();
+}
+
+void ViewDependentSurface::PrintStatistics(std::ostream& os) const
+{
+	size_t visible = 0;
+	vtkIdType triangles = 0;
+	std::vector<size_t> levels(MaxLevel + 1, 0);
+	for (const Brick& brick : bricks) {
+		if (!brick.visible)
+			continue;
+		++visible;
+		++levels[brick.level];
+		if (brick.surface)
+			triangles += brick.surface->GetNumberOfPolys();
+	}
+	os << "view dependent surface: " << visible << " of " << bricks.size() << " bricks visible, levels";
+	for (int level = 0; level <= MaxLevel; ++level)
+		os << " " << level << ":" << levels[level];
+	os << ", " << pending << " pending, " << triangles << " triangles, " << extractedBricks << " bricks extracted in "
+		<< std::fixed << std::setprecision(2) << 1000.0 * extractionTime << " ms" << std::endl;
+}
+
+void ViewDependentSurface::Execute(vtkObject *caller, unsigned long eventId, void *callData)
+{
+	if (eventId == vtkCommand::KeyPressEvent) {
+		vtkRenderWindowInteractor *keyInteractor = static_cast<vtkRenderWindowInteractor*>(caller);
+		if (keyInteractor->GetKeyCode() == ToggleKey) {
+			SetEnabled(!enabled);
+			if (scheduler)
+				scheduler->RequestRender();
+			else
+				keyInteractor->Render();
+		}
+		return;
+	}
+
+	// the renderer also modifies the camera when it resets the clipping range, that update finds nothing to do
+	if (eventId == vtkCommand::ModifiedEvent && enabled)
+		schedule();
+}
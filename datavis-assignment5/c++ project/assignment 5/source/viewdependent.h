@@ -0,0 +1,113 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+// View-dependent iso surface extraction: only the bricks of the volume inside the view frustum are extracted, at a
+// resolution that follows their projected size.
+//
+
+#pragma once
+
+#include "weldedcubes.h"
+#include "interactionscheduler.h"
+
+#include <vtkSmartPointer.h>
+#include <vtkImageData.h>
+#include <vtkPolyData.h>
+#include <vtkMultiBlockDataSet.h>
+#include <vtkCompositePolyDataMapper2.h>
+#include <vtkActor.h>
+#include <vtkRenderer.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkCommand.h>
+
+#include <ostream>
+#include <vector>
+
+/* Replaces the surface of the first iso value by one extracted per brick of BrickSize cells, switched on and off
+   with the toggle key. On every camera change
+   - bricks outside the view frustum are culled, their surfaces stay cached but are not rendered,
+   - every visible brick gets a level from the size of its cells on the screen: a brick whose cells cover less
+     than CellPixels pixels is extracted from every 2nd, 4th, ... point (WeldedMarchingCubes sample rate), so
+     distant bricks are coarse,
+   - visible bricks without a surface for the current iso value and level are extracted, those without any
+     surface first, then the nearest ones, until the time budget of the frame is spent. The rest is posted to
+     the interaction scheduler for the next frames, so panning pulls in the newly visible bricks a few at a time
+     and a stale surface is shown until its brick is extracted again.
+   Every brick is one block of a vtkMultiBlockDataSet, so a new brick changes one block and the other ones are
+   not uploaded again. Bricks of different levels are not stitched, there can be cracks between them. */
+class ViewDependentSurface : public vtkCommand {
+private:
+	ViewDependentSurface();
+
+public:
+	static ViewDependentSurface *New() { return new ViewDependentSurface; }
+
+	char ToggleKey;
+	int BrickSize;          // cells along a brick edge, default 32
+	int MaxLevel;           // coarsest level, sample rate 2^MaxLevel, default 3
+	double CellPixels;      // smallest size of a cell on the screen before a coarser level is used, default 2
+	double TimeBudget;      // seconds of extraction per frame, default 0.01
+	int NumberOfThreads;    // threads of the extraction of a brick, 0: all cores
+
+	/* The whole volume surface and its actor, hidden while the view-dependent surface is shown. */
+	vtkSmartPointer<WeldedMarchingCubes> wholeSurface;
+	vtkSmartPointer<vtkActor> wholeActor;
+	vtkSmartPointer<InteractionScheduler> scheduler;
+
+	/* Splits the volume into bricks, adds the actor of the bricks to the renderer and observes its camera and the
+	   key presses of the interactor. The iso value is the first one of the whole volume surface. */
+	void Attach(vtkRenderer *renderer, vtkRenderWindowInteractor *interactor, vtkImageData *volume);
+
+	/* New voxels of the volume, e.g. republished by a loader: with the same extent the cached brick surfaces are
+	   stale and shown until their bricks are extracted again, with another extent the volume is split again. */
+	void SetVolume(vtkImageData *volume);
+
+	/* Shows the bricks instead of the whole volume surface or the other way round. */
+	void SetEnabled(bool enabled);
+	bool GetEnabled() const { return enabled; }
+
+	/* Iso value of the bricks, cached brick surfaces of another value are extracted again when visible. */
+	void SetIsoValue(double value);
+	double GetIsoValue() const { return isoValue; }
+
+	/* Culls the bricks, chooses their levels and extracts within the time budget. Returns whether the rendered
+	   surface changed. Called through the scheduler on camera changes. */
+	bool Update();
+
+	/* Bricks in total, visible, per level and still to extract, the rendered triangles and the extraction time
+	   since the view was last settled. */
+	void PrintStatistics(std::ostream& os) const;
+
+	virtual void Execute(vtkObject *caller, unsigned long eventId, void *callData);
+
+private:
+	struct Brick {
+		int extent[6];
+		double bounds[6];
+		bool visible;
+		int level;                           // wanted level for the current view
+		int surfaceLevel;                    // level and iso value of the cached surface
+		double surfaceValue;
+		vtkSmartPointer<vtkPolyData> surface;
+	};
+
+	void schedule();
+	void extract(Brick& brick);
+	int chooseLevel(const Brick& brick) const;
+
+	bool enabled;
+	double isoValue;
+	std::vector<Brick> bricks;
+	double spacing;                          // smallest spacing of the volume
+	vtkSmartPointer<WeldedMarchingCubes> extractor;
+	vtkSmartPointer<vtkMultiBlockDataSet> output;
+	vtkSmartPointer<vtkCompositePolyDataMapper2> mapper;
+	vtkSmartPointer<vtkActor> actor;
+	vtkRenderer *renderer;
+
+	// statistics of the current view
+	size_t pending;
+	size_t extractedBricks;
+	double extractionTime;
+	bool reported;
+};
@@ -0,0 +1,93 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+// Internal helpers of the parallel volume and surface filters: the marching cubes cell tables, the thread pools and
+// a parallel sort.
+//
+
+#pragma once
+
+#include <vtkType.h>
+
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <vector>
+#include <algorithm>
+
+// cell vertices in the order of the vtkMarchingCubes case table, as (i, j, k) offsets
+const int cellVertex[8][3] = { { 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 }, { 0, 1, 0 },
+	{ 0, 0, 1 }, { 1, 0, 1 }, { 1, 1, 1 }, { 0, 1, 1 } };
+// the cell edges of the case table, the first vertex is the lattice point that owns the edge
+const int cellEdge[12][2] = { { 0, 1 }, { 1, 2 }, { 3, 2 }, { 0, 3 }, { 4, 5 }, { 5, 6 }, { 7, 6 }, { 4, 7 },
+	{ 0, 4 }, { 1, 5 }, { 3, 7 }, { 2, 6 } };
+const int edgeAxis[12] = { 0, 1, 0, 1, 0, 1, 0, 1, 2, 2, 2, 2 };
+
+/* Worker threads for a NumberOfThreads setting, 0 uses all hardware threads. */
+inline int threadCount(int numberOfThreads)
+{
+	return std::max(1, numberOfThreads > 0 ? numberOfThreads : static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+/* Runs body(unit, worker) for all units, the threads take the next unit from a shared counter. */
+inline void parallelFor(int numberOfUnits, int numberOfThreads, const std::function<void(int, int)>& body)
+{
+	std::atomic<int> nextUnit(0);
+	auto worker = [&](int workerId) {
+		for (int unit = nextUnit++; unit < numberOfUnits; unit = nextUnit++)
+			body(unit, workerId);
+	};
+	std::vector<std::thread> threads;
+	for (int t = 1; t < numberOfThreads; ++t)
+		threads.push_back(std::thread(worker, t));
+	worker(0);
+	for (size_t t = 0; t < threads.size(); ++t)
+		threads[t].join();
+}
+
+/* Runs body(begin, end) on ranges of about equal size, taken by the threads from a shared counter. */
+inline void parallelRanges(vtkIdType count, int numberOfThreads, const std::function<void(vtkIdType, vtkIdType)>& body)
+{
+	const vtkIdType numberOfRanges = std::min<vtkIdType>(count, 16 * numberOfThreads);
+	if (numberOfRanges == 0)
+		return;
+	std::atomic<vtkIdType> nextRange(0);
+	auto worker = [&]() {
+		for (vtkIdType range = nextRange++; range < numberOfRanges; range = nextRange++)
+			body(range * count / numberOfRanges, (range + 1) * count / numberOfRanges);
+	};
+	std::vector<std::thread> threads;
+	for (int t = 1; t < numberOfThreads; ++t)
+		threads.push_back(std::thread(worker));
+	worker();
+	for (size_t t = 0; t < threads.size(); ++t)
+		threads[t].join();
+}
+
+/* Sorts the values on the threads: ranges of the values are sorted in parallel, then merged pairwise level by level,
+   the merges of a level in parallel. */
+template <class T, class Compare> void parallelSort(std::vector<T>& values, int numberOfThreads, Compare compare)
+{
+	const int numberOfRuns = static_cast<int>(std::min<size_t>(numberOfThreads, values.size() / 4096 + 1));
+	if (numberOfRuns <= 1) {
+		std::sort(values.begin(), values.end(), compare);
+		return;
+	}
+	std::vector<size_t> runStart(numberOfRuns + 1);
+	for (int run = 0; run <= numberOfRuns; ++run)
+		runStart[run] = values.size() * run / numberOfRuns;
+	parallelFor(numberOfRuns, numberOfThreads, [&](int run, int) {
+		std::sort(values.begin() + runStart[run], values.begin() + runStart[run + 1], compare);
+	});
+	std::vector<T> merged(values.size());
+	for (int width = 1; width < numberOfRuns; width *= 2) {
+		const int pairs = (numberOfRuns + 2 * width - 1) / (2 * width);
+		parallelFor(pairs, numberOfThreads, [&](int pair, int) {
+			const size_t first = runStart[2 * pair * width], middle = runStart[std::min(numberOfRuns, (2 * pair + 1) * width)],
+				last = runStart[std::min(numberOfRuns, (2 * pair + 2) * width)];
+			std::merge(values.begin() + first, values.begin() + middle, values.begin() + middle, values.begin() + last,
+				merged.begin() + first, compare);
+		});
+		values.swap(merged);
+	}
+}
@@ -0,0 +1,397 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+
+#include "voxelprobe.h"
+
+#include <vtkPointData.h>
+#include <vtkDataArray.h>
+#include <vtkTextProperty.h>
+#include <vtkCoordinate.h>
+
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+namespace {
+	const double infinity = std::numeric_limits<double>::infinity();
+
+	// Amanatides-Woo traversal of a grid of cubic cells of cellSize points in index space along o + t d for t in
+	// [t0, t1]. visit(cell, tIn, tOut) returns true to stop, so does traverse.
+	template <class Visit> bool traverse(const double o[3], const double d[3], double t0, double t1, int cellSize,
+		const int cells[3], Visit visit)
+	{
+		int cell[3], step[3];
+		double tMax[3], tDelta[3];
+		// the cell just after t0, so that a start on a cell face goes to the cell in the direction of the ray
+		const double tStart = t0 + 1e-9 * (t1 - t0);
+		for (int a = 0; a < 3; ++a) {
+			const double position = o[a] + tStart * d[a];
+			cell[a] = std::max(0, std::min(cells[a] - 1, static_cast<int>(std::floor(position / cellSize))));
+			if (d[a] > 0.0) {
+				step[a] = 1;
+				tMax[a] = ((cell[a] + 1) * cellSize - o[a]) / d[a];
+				tDelta[a] = cellSize / d[a];
+			}
+			else if (d[a] < 0.0) {
+				step[a] = -1;
+				tMax[a] = (cell[a] * cellSize - o[a]) / d[a];
+				tDelta[a] = -cellSize / d[a];
+			}
+			else {
+				step[a] = 0;
+				tMax[a] = tDelta[a] = infinity;
+			}
+		}
+
+		double t = t0;
+		while (t < t1) {
+			const int axis = tMax[0] < tMax[1] ? (tMax[0] < tMax[2] ? 0 : 2) : (tMax[1] < tMax[2] ? 1 : 2);
+			const double tNext = std::min(tMax[axis], t1);
+			if (visit(cell, t, tNext))
+				return true;
+			t = tNext;
+			cell[axis] += step[axis];
+			if (cell[axis] < 0 || cell[axis] >= cells[axis])
+				break;
+			tMax[axis] += tDelta[axis];
+		}
+		return false;
+	}
+
+	template <class T> struct Grid {
+		const T *scalars;
+		int dims[3];
+
+		double Value(int i, int j, int k) const
+		{
+			return static_cast<double>(scalars[i + static_cast<vtkIdType>(dims[0]) * (j + static_cast<vtkIdType>(dims[1]) * k)]);
+		}
+
+		// trilinear interpolation inside the cell at the index space position, clamped to the cell
+		double Sample(const int cell[3], const double position[3]) const
+		{
+			double f[3];
+			for (int a = 0; a < 3; ++a)
+				f[a] = std::max(0.0, std::min(1.0, position[a] - cell[a]));
+			const int i = cell[0], j = cell[1], k = cell[2];
+			const double c00 = Value(i, j, k) * (1 - f[0]) + Value(i + 1, j, k) * f[0];
+			const double c10 = Value(i, j + 1, k) * (1 - f[0]) + Value(i + 1, j + 1, k) * f[0];
+			const double c01 = Value(i, j, k + 1) * (1 - f[0]) + Value(i + 1, j, k + 1) * f[0];
+			const double c11 = Value(i, j + 1, k + 1) * (1 - f[0]) + Value(i + 1, j + 1, k + 1) * f[0];
+			return (c00 * (1 - f[1]) + c10 * f[1]) * (1 - f[2]) + (c01 * (1 - f[1]) + c11 * f[1]) * f[2];
+		}
+	};
+
+	// minimum and maximum of the points of every brick, including the points it shares with the next bricks
+	template <class T> void computeBrickRanges(const T *scalars, const int dims[3], int brickSize, const int brickDims[3],
+		int numberOfThreads, std::vector<double>& ranges)
+	{
+		Grid<T> grid = { scalars, { dims[0], dims[1], dims[2] } };
+		std::atomic<int> nextLayer(0);
+		auto worker = [&]() {
+			for (int bk = nextLayer++; bk < brickDims[2]; bk = nextLayer++)
+				for (int bj = 0; bj < brickDims[1]; ++bj)
+					for (int bi = 0; bi < brickDims[0]; ++bi) {
+						double low = infinity, high = -infinity;
+						for (int k = bk * brickSize; k <= std::min((bk + 1) * brickSize, dims[2] - 1); ++k)
+							for (int j = bj * brickSize; j <= std::min((bj + 1) * brickSize, dims[1] - 1); ++j)
+								for (int i = bi * brickSize; i <= std::min((bi + 1) * brickSize, dims[0] - 1); ++i) {
+									const double value = grid.Value(i, j, k);
+									low = std::min(low, value);
+									high = std::max(high, value);
+								}
+						const size_t brick = bi + static_cast<size_t>(brickDims[0]) * (bj + static_cast<size_t>(brickDims[1]) * bk);
+						ranges[2 * brick] = low;
+						ranges[2 * brick + 1] = high;
+					}
+		};
+		std::vector<std::thread> threads;
+		for (int t = 1; t < numberOfThreads; ++t)
+			threads.push_back(std::thread(worker));
+		worker();
+		for (size_t t = 0; t < threads.size(); ++t)
+			threads[t].join();
+	}
+
+	// first crossing of an iso value along the ray inside the cell, searched on two halves of the segment
+	template <class T> bool crossCell(const Grid<T>& grid, const int cell[3], const double o[3], const double d[3],
+		double tIn, double tOut, const std::vector<double>& values, double& tHit, double& valueHit)
+	{
+		auto sample = [&](double t, double value) {
+			const double position[3] = { o[0] + t * d[0], o[1] + t * d[1], o[2] + t * d[2] };
+			return grid.Sample(cell, position) - value;
+		};
+		bool found = false;
+		const double tMid = 0.5 * (tIn + tOut);
+		for (double value : values) {
+			const double segments[2][2] = { { tIn, tMid }, { tMid, tOut } };
+			for (int s = 0; s < 2; ++s) {
+				double a = segments[s][0], b = segments[s][1];
+				double fa = sample(a, value), fb = sample(b, value);
+				if (fa != 0.0 && (fa < 0.0) == (fb < 0.0))
+					continue;
+				for (int iteration = 0; iteration < 20 && fa != 0.0; ++iteration) {
+					const double m = 0.5 * (a + b), fm = sample(m, value);
+					if ((fm < 0.0) == (fa < 0.0)) {
+						a = m;
+						fa = fm;
+					}
+					else
+						b = m;
+				}
+				if (!found || a < tHit) {
+					tHit = a;
+					valueHit = value;
+					found = true;
+				}
+				break;
+			}
+		}
+		return found;
+	}
+
+	template <class T> bool traceRay(const T *scalars, const int dims[3], int brickSize, const int brickDims[3],
+		const std::vector<double>& ranges, const std::vector<double>& values, const double o[3], const double d[3],
+		double t0, double t1, double& tHit, double& valueHit)
+	{
+		Grid<T> grid = { scalars, { dims[0], dims[1], dims[2] } };
+		const int cells[3] = { dims[0] - 1, dims[1] - 1, dims[2] - 1 };
+		return traverse(o, d, t0, t1, brickSize, brickDims, [&](const int brick[3], double bIn, double bOut) {
+			const double *range = &ranges[2 * (brick[0] + static_cast<size_t>(brickDims[0]) * (brick[1] + static_cast<size_t>(brickDims[1]) * brick[2]))];
+			bool active = false;
+			for (double value : values)
+				active |= value >= range[0] && value <= range[1];
+			if (!active)
+				return false;
+			return traverse(o, d, bIn, bOut, 1, cells, [&](const int cell[3], double cIn, double cOut) {
+				return crossCell(grid, cell, o, d, cIn, cOut, values, tHit, valueHit);
+			});
+		});
+	}
+}
+
+VoxelProbe::VoxelProbe()
+	: ToggleKey('m'), BrickSize(8), NumberOfThreads(0), enabled(false), renderer(nullptr), interactor(nullptr),
+	brickTime(0.0), picks(0), totalPickTime(0.0), maxPickTime(0.0)
+{
+	for (int a = 0; a < 3; ++a)
+		pointDims[a] = brickDims[a] = 0;
+
+	text = vtkSmartPointer<vtkTextActor>::New();
+	text->GetTextProperty()->SetFontFamilyToCourier();
+	text->GetTextProperty()->SetFontSize(14);
+	text->GetTextProperty()->SetColor(0.6, 1, 1);
+	text->GetTextProperty()->SetJustificationToRight();
+	text->GetTextProperty()->SetVerticalJustificationToBottom();
+	text->GetPositionCoordinate()->SetCoordinateSystemToNormalizedViewport();
+	text->GetPositionCoordinate()->SetValue(0.99, 0.01);
+	text->VisibilityOff();
+}
+
+void VoxelProbe::SetVolume(vtkImageData *volume)
+{
+	this->volume = volume;
+	brickRange.clear();
+	vtkDataArray *scalars = volume ? volume->GetPointData()->GetScalars() : nullptr;
+	if (!scalars || scalars->GetNumberOfComponents() != 1)
+		return;
+	volume->GetDimensions(pointDims);
+	if (pointDims[0] < 2 || pointDims[1] < 2 || pointDims[2] < 2)
+		return;
+	for (int a = 0; a < 3; ++a)
+		brickDims[a] = (pointDims[a] - 2) / BrickSize + 1;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	int numberOfThreads = NumberOfThreads > 0 ? NumberOfThreads : static_cast<int>(std::thread::hardware_concurrency());
+	numberOfThreads = std::max(1, std::min(numberOfThreads, brickDims[2]));
+	brickRange.resize(2 * static_cast<size_t>(brickDims[0]) * brickDims[1] * brickDims[2]);
+	switch (scalars->GetDataType()) {
+		vtkTemplateMacro(computeBrickRanges(static_cast<const VTK_TT*>(scalars->GetVoidPointer(0)), pointDims, BrickSize,
+			brickDims, numberOfThreads, brickRange));
+	default:
+		brickRange.clear();
+		break;
+	}
+	brickTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void VoxelProbe::Attach(vtkRenderer *renderer, vtkRenderWindowInteractor *interactor)
+{
+	this->renderer = renderer;
+	this->interactor = interactor;
+	renderer->AddActor2D(text);
+	interactor->AddObserver(vtkCommand::MouseMoveEvent, this);
+	interactor->AddObserver(vtkCommand::KeyPressEvent, this);
+}
+
+void VoxelProbe::SetEnabled(bool enabled)
+{
+	this->enabled = enabled;
+	if (!enabled) {
+		text->VisibilityOff();
+		readout.clear();
+	}
+}
+
+bool VoxelProbe::Pick(int x, int y, Hit& hit)
+{
+	if (!renderer || !volume || brickRange.empty())
+		return false;
+
+	// the ray from the near to the far plane through the pixel, in the structured coordinates of the volume, which
+	// count from the start of its extent
+	double origin[3], spacing[3], ends[2][3];
+	int extent[6];
+	volume->GetOrigin(origin);
+	volume->GetSpacing(spacing);
+	volume->GetExtent(extent);
+	for (int e = 0; e < 2; ++e) {
+		double world[4];
+		renderer->SetDisplayPoint(x, y, e);
+		renderer->DisplayToWorld();
+		renderer->GetWorldPoint(world);
+		if (world[3] == 0.0)
+			return false;
+		for (int a = 0; a < 3; ++a)
+			ends[e][a] = (world[a] / world[3] - origin[a]) / spacing[a] - extent[2 * a];
+	}
+	double o[3], d[3];
+	for (int a = 0; a < 3; ++a) {
+		o[a] = ends[0][a];
+		d[a] = ends[1][a] - ends[0][a];
+	}
+
+	// clipped to the box of the points, or to the crop box while it is shown since nothing is extracted outside it
+	double low[3] = { 0.0, 0.0, 0.0 };
+	double high[3] = { pointDims[0] - 1.0, pointDims[1] - 1.0, pointDims[2] - 1.0 };
+	if (cropBox && cropBox->GetEnabled()) {
+		int box[6];
+		cropBox->GetExtent(box);
+		for (int a = 0; a < 3; ++a) {
+			low[a] = std::max(low[a], static_cast<double>(box[2 * a] - extent[2 * a]));
+			high[a] = std::min(high[a], static_cast<double>(box[2 * a + 1] - extent[2 * a]));
+		}
+	}
+	double t0 = 0.0, t1 = 1.0;
+	for (int a = 0; a < 3; ++a) {
+		if (d[a] == 0.0) {
+			if (o[a] < low[a] || o[a] > high[a])
+				return false;
+			continue;
+		}
+		double enter = (low[a] - o[a]) / d[a], exit = (high[a] - o[a]) / d[a];
+		if (enter > exit)
+			std::swap(enter, exit);
+		t0 = std::max(t0, enter);
+		t1 = std::min(t1, exit);
+	}
+	if (t0 >= t1)
+		return false;
+
+	// the values the sliders drive, the first slider moves the view-dependent surface instead of the extractor
+	// while that is shown, and the extractor keeps its last value
+	std::vector<double> values;
+	if (extractor)
+		for (int v = 0; v < extractor->GetNumberOfContours(); ++v)
+			values.push_back(extractor->GetValue(v));
+	if (viewDependent && viewDependent->GetEnabled()) {
+		if (values.empty())
+			values.push_back(viewDependent->GetIsoValue());
+		else
+			values[0] = viewDependent->GetIsoValue();
+	}
+
+	vtkDataArray *scalars = volume->GetPointData()->GetScalars();
+	double tHit = t0, valueHit = 0.0;
+	bool surface = false;
+	switch (scalars->GetDataType()) {
+		vtkTemplateMacro(surface = traceRay(static_cast<const VTK_TT*>(scalars->GetVoidPointer(0)), pointDims, BrickSize,
+			brickDims, brickRange, values, o, d, t0, t1, tHit, valueHit));
+	}
+
+	// without a surface, the voxel where the ray enters the volume or the crop box
+	hit.surface = surface;
+	hit.isoValue = valueHit;
+	for (int a = 0; a < 3; ++a) {
+		const double index = o[a] + tHit * d[a];
+		hit.position[a] = origin[a] + (index + extent[2 * a]) * spacing[a];
+		hit.voxel[a] = std::max(0, std::min(pointDims[a] - 1, static_cast<int>(std::floor(index + 0.5))));
+	}
+	hit.voxelValue = scalars->GetComponent(hit.voxel[0] + static_cast<vtkIdType>(pointDims[0]) * (hit.voxel[1]
+		+ static_cast<vtkIdType>(pointDims[1]) * hit.voxel[2]), 0);
+	return true;
+}
+
+bool VoxelProbe::probe(int x, int y)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	Hit hit;
+	const bool inside = Pick(x, y, hit);
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	++picks;
+	totalPickTime += seconds;
+	maxPickTime = std::max(maxPickTime, seconds);
+
+	if (!inside) {
+		const bool changed = text->GetVisibility() != 0;
+		text->VisibilityOff();
+		readout.clear();
+		return changed;
+	}
+	std::ostringstream lines;
+	lines << "voxel (" << hit.voxel[0] << ", " << hit.voxel[1] << ", " << hit.voxel[2] << ") = " << hit.voxelValue << "\n"
+		<< std::fixed << std::setprecision(1) << "position (" << hit.position[0] << ", " << hit.position[1] << ", "
+		<< hit.position[2] << ")\n";
+	if (hit.surface)
+		lines << "surface " << hit.isoValue << "\n";
+	else
+		lines << "no surface\n";
+
+	// the same readout, e.g. for a mouse move within a pixel of the surface, needs no frame
+	if (lines.str() == readout && text->GetVisibility())
+		return false;
+	readout = lines.str();
+	lines << "pick " << std::setprecision(3) << 1000.0 * seconds << " ms";
+	text->SetInput(lines.str().c_str());
+	text->VisibilityOn();
+	return true;
+}
+
+void VoxelProbe::PrintStatistics(std::ostream& os) const
+{
+	os << "voxel probe: " << picks << " picks, mean " << std::fixed << std::setprecision(3)
+		<< (picks ? 1000.0 * totalPickTime / picks : 0.0) << " ms, max " << 1000.0 * maxPickTime << " ms, "
+		<< brickDims[0] * brickDims[1] * brickDims[2] << " bricks of " << BrickSize << "^3 cells in "
+		<< 1000.0 * brickTime << " ms" << std::endl;
+}
+
+void VoxelProbe::Execute(vtkObject *caller, unsigned long eventId, void *callData)
+{
+	if (eventId == vtkCommand::KeyPressEvent) {
+		if (interactor->GetKeyCode() == ToggleKey) {
+			SetEnabled(!enabled);
+			if (scheduler)
+				scheduler->RequestRender();
+			else
+				interactor->Render();
+		}
+		return;
+	}
+
+	// one pick per frame for the last mouse position
+	if (eventId != vtkCommand::MouseMoveEvent || !enabled)
+		return;
+	const int *position = interactor->GetEventPosition();
+	const int x = position[0], y = position[1];
+	if (scheduler)
+		scheduler->Post(this, [this, x, y]() { return probe(x, y); });
+	else if (probe(x, y))
+		interactor->Render();
+}
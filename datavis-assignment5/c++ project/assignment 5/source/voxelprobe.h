@@ -0,0 +1,98 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+// Voxel value and iso surface probe under the mouse cursor, traced through the volume instead of picking triangles.
+//
+
+#pragma once
+
+#include "weldedcubes.h"
+#include "viewdependent.h"
+#include "cropbox.h"
+#include "interactionscheduler.h"
+
+#include <vtkSmartPointer.h>
+#include <vtkImageData.h>
+#include <vtkRenderer.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkTextActor.h>
+#include <vtkCommand.h>
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+/* Readout in the lower right corner with the voxel under the mouse cursor, its world position and the iso surface
+   it lies on, toggled with the toggle key. A vtkCellPicker would intersect the ray with every triangle of the
+   surfaces in its bounding box. The probe traces the ray through the volume itself, in two levels of a 3D DDA
+   (Amanatides and Woo):
+   - the outer level steps through bricks of BrickSize^3 cells and skips every brick whose precomputed value range
+     does not contain one of the iso values the sliders drive (the first one is the value of the view-dependent
+     surface while that is shown),
+   - the inner level steps through the cells of the remaining bricks and looks for a sign change of the trilinear
+     interpolant minus the iso value along the ray, refined by bisection.
+   The ray is clipped to the crop box while it is shown. The first crossing is the surface hit, the voxel nearest
+   to it is reported. The cost depends on the cells along
+   the ray near the surface, not on the number of triangles, so a pick stays well below a millisecond also on large
+   volumes. The probe starts disabled. Mouse moves are coalesced by the interaction scheduler to one pick per
+   frame, a frame is only requested when the readout changes, which then shows the latency of its pick. */
+class VoxelProbe : public vtkCommand {
+private:
+	VoxelProbe();
+
+public:
+	static VoxelProbe *New() { return new VoxelProbe; }
+
+	char ToggleKey;
+	int BrickSize;          // cells along a brick edge, default 8, set before SetVolume
+	int NumberOfThreads;    // threads of the brick range computation, 0: all cores
+	vtkSmartPointer<WeldedMarchingCubes> extractor;     // source of the iso values
+	vtkSmartPointer<ViewDependentSurface> viewDependent; // source of the first iso value while enabled, may be null
+	vtkSmartPointer<CropBox> cropBox;                   // limits the rays while enabled, may be null
+	vtkSmartPointer<InteractionScheduler> scheduler;
+
+	struct Hit {
+		bool surface;           // the ray crosses an iso surface inside the volume
+		double isoValue;
+		double position[3];     // world position of the crossing
+		int voxel[3];           // structured coordinates of the voxel nearest to it, from the start of the extent
+		double voxelValue;
+	};
+
+	/* Computes the value ranges of the bricks, again whenever the voxels change. */
+	void SetVolume(vtkImageData *volume);
+
+	/* Shows the readout in the renderer and follows the mouse of the interactor. */
+	void Attach(vtkRenderer *renderer, vtkRenderWindowInteractor *interactor);
+
+	void SetEnabled(bool enabled);
+	bool GetEnabled() const { return enabled; }
+
+	/* Traces the ray through the display position, returns whether the ray meets the volume at all. */
+	bool Pick(int x, int y, Hit& hit);
+
+	/* Number of picks, mean and maximum latency, and the time of the brick ranges. */
+	void PrintStatistics(std::ostream& os) const;
+
+	virtual void Execute(vtkObject *caller, unsigned long eventId, void *callData);
+
+private:
+	// picks and updates the readout, returns whether the readout changed
+	bool probe(int x, int y);
+
+	bool enabled;
+	vtkSmartPointer<vtkImageData> volume;
+	vtkSmartPointer<vtkTextActor> text;
+	vtkRenderer *renderer;
+	vtkRenderWindowInteractor *interactor;
+	std::string readout;                // readout of the last pick without its latency
+
+	int pointDims[3];
+	int brickDims[3];
+	std::vector<double> brickRange;     // minimum and maximum per brick, x fastest
+	double brickTime;
+
+	unsigned long picks;
+	double totalPickTime;
+	double maxPickTime;
+};
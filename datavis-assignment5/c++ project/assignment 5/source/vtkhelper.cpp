@@ -17,8 +17,9 @@ void doRenderingAndInteraction(vtkSmartPointer<vtkRenderWindowInteractor> intera
 {
 	vtkRenderWindow *window = interactor->GetRenderWindow();
 
-	// set trackball interactor
-	interactor->SetInteractorStyle(vtkInteractorStyleTrackballCamera::New());
+	// set trackball interactor, the interactor holds the only reference
+	vtkSmartPointer<vtkInteractorStyleTrackballCamera> style = vtkSmartPointer<vtkInteractorStyleTrackballCamera>::New();
+	interactor->SetInteractorStyle(style);
 
 	// execute render/interaction loop
 	interactor->Initialize();
@@ -36,9 +37,10 @@ then closes the window. */
 void doRenderingAndInteraction(vtkSmartPointer<vtkRenderWindow> window)
 {
 	// create interactor (with 'trackball' interactor style)
-	vtkSmartPointer<vtkRenderWindowInteractor> interactor = vtkRenderWindowInteractor::New();
+	vtkSmartPointer<vtkRenderWindowInteractor> interactor = vtkSmartPointer<vtkRenderWindowInteractor>::New();
 	interactor->SetRenderWindow(window);
-	interactor->SetInteractorStyle(vtkInteractorStyleTrackballCamera::New());
+	vtkSmartPointer<vtkInteractorStyleTrackballCamera> style = vtkSmartPointer<vtkInteractorStyleTrackballCamera>::New();
+	interactor->SetInteractorStyle(style);
 
 	// execute render/interaction loop
 	interactor->Initialize();
@@ -58,16 +60,16 @@ vtkSmartPointer<vtkRenderWindow> createRenderWindowFromMapper(vtkSmartPointer<vt
 	vtkSmartPointer<vtkRenderer>& renderer)
 {
 	// Create an actor with disabled lighting
-	actor = vtkActor::New();
+	actor = vtkSmartPointer<vtkActor>::New();
 	actor->SetMapper(mapper);
 	actor->GetProperty()->LightingOff();
 
 	// Create a renderer
-	renderer = vtkRenderer::New();
+	renderer = vtkSmartPointer<vtkRenderer>::New();
 	renderer->AddActor(actor);
 
 	// Create a window, set viewport size and add the renderer
-	vtkSmartPointer<vtkRenderWindow> window = vtkRenderWindow::New();
+	vtkSmartPointer<vtkRenderWindow> window = vtkSmartPointer<vtkRenderWindow>::New();
 	window->SetSize(640, 480);
 	window->AddRenderer(renderer);
 	return window;
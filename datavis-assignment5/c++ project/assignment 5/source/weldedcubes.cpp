@@ -0,0 +1,507 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+
+#include "weldedcubes.h"
+#include "volumekernels.h"
+
+#include <vtkObjectFactory.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkPointData.h>
+#include <vtkDataArray.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkPoints.h>
+#include <vtkCellArray.h>
+#include <vtkPolyData.h>
+#include <vtkMarchingCubes.h>
+#include <vtkMarchingCubesTriangleCases.h>
+#include <vtkTimerLog.h>
+
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+
+namespace {
+	// Region of a volume with one scalar component, read in place with the strides of the whole volume, every
+	// sampleRate-th point per axis. Indices are relative to the first point of the region, which is also the origin.
+	template <class T> struct Volume {
+		const T *scalars;       // first point of the region
+		int dims[3];            // sampled points of the region
+		int offset[3];          // first point of the region in the whole volume
+		int wholeDims[3];
+		int sampleRate;
+		vtkIdType rowSize;
+		vtkIdType sliceSize;
+		double origin[3];
+		double spacing[3];      // between sampled points
+
+		double Value(int i, int j, int k) const
+		{
+			return static_cast<double>(scalars[(i + j * rowSize + k * sliceSize) * sampleRate]);
+		}
+
+		// negative central differences, one sided at the border of the whole volume, like vtkMarchingCubes
+		void Gradient(int i, int j, int k, double g[3]) const
+		{
+			for (int axis = 0; axis < 3; ++axis) {
+				int lower[3] = { i, j, k }, upper[3] = { i, j, k };
+				if (offset[axis] + lower[axis] * sampleRate >= sampleRate)
+					--lower[axis];
+				if (offset[axis] + (upper[axis] + 1) * sampleRate <= wholeDims[axis] - 1)
+					++upper[axis];
+				const int steps = upper[axis] - lower[axis];
+				g[axis] = steps ? (Value(lower[0], lower[1], lower[2]) - Value(upper[0], upper[1], upper[2])) / (steps * spacing[axis]) : 0.0;
+			}
+		}
+	};
+
+	// output arrays of one surface, nullptr while counting
+	struct SurfaceArrays {
+		float *points;
+		float *normals;
+		vtkIdType *cells;
+	};
+
+	// Numbers the intersected edges owned by the points of slice k for every iso value, point by point and x, y, z per
+	// point. With ids, ids[v] gets the vertex id of every edge of the slice relative to the first vertex of the slice,
+	// or -1. counts[v] gets the number of vertices. With surfaces, the vertices are written too, from firstIds[v] on.
+	// Every sample is read once for all values.
+	template <class T> void numberSlice(const Volume<T>& volume, const std::vector<double>& values, int k,
+		const vtkIdType *firstIds, std::vector<int> *ids, const SurfaceArrays *surfaces, vtkIdType *counts)
+	{
+		const int nx = volume.dims[0], ny = volume.dims[1];
+		const size_t numberOfValues = values.size();
+		for (size_t v = 0; v < numberOfValues; ++v)
+			counts[v] = 0;
+
+		for (int j = 0; j < ny; ++j) {
+			for (int i = 0; i < nx; ++i) {
+				const int point[3] = { i, j, k };
+				const size_t edgeIndex = 3 * (static_cast<size_t>(j) * nx + i);
+				const double s0 = volume.Value(i, j, k);
+				double s1[3];
+				bool hasEdge[3];
+				for (int axis = 0; axis < 3; ++axis) {
+					int other[3] = { i, j, k };
+					++other[axis];
+					hasEdge[axis] = other[axis] < volume.dims[axis];
+					s1[axis] = hasEdge[axis] ? volume.Value(other[0], other[1], other[2]) : 0.0;
+				}
+
+				for (size_t v = 0; v < numberOfValues; ++v) {
+					const double value = values[v];
+					const bool inside = s0 >= value;
+					int *edges = ids ? &ids[v][edgeIndex] : nullptr;
+					for (int axis = 0; axis < 3; ++axis) {
+						if (edges)
+							edges[axis] = -1;
+						if (!hasEdge[axis] || (s1[axis] >= value) == inside)
+							continue;
+						const vtkIdType local = counts[v]++;
+						if (edges)
+							edges[axis] = static_cast<int>(local);
+						if (!surfaces)
+							continue;
+
+						const vtkIdType id = firstIds[v] + local;
+
+						const double t = (value - s0) / (s1[axis] - s0);
+						float *x = surfaces[v].points + 3 * id;
+						for (int c = 0; c < 3; ++c)
+							x[c] = static_cast<float>(volume.origin[c] + (point[c] + (c == axis ? t : 0.0)) * volume.spacing[c]);
+						if (surfaces[v].normals) {
+							int other[3] = { i, j, k };
+							++other[axis];
+							double g0[3], g1[3], n[3];
+							volume.Gradient(i, j, k, g0);
+							volume.Gradient(other[0], other[1], other[2], g1);
+							for (int c = 0; c < 3; ++c)
+								n[c] = g0[c] + t * (g1[c] - g0[c]);
+							double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+							for (int c = 0; c < 3; ++c)
+								surfaces[v].normals[3 * id + c] = static_cast<float>(length > 0.0 ? n[c] / length : 0.0);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	// Counts the triangles of every iso value in the cells between slice k and k + 1. With surfaces, they are written
+	// from firstTriangles[v] on as (3, a, b, c) with the vertex ids of the edges, i.e. the first vertex of the lower or
+	// the upper slice plus the id in its numbering. The eight samples of a cell are read once for all values.
+	template <class T> void triangulateSlab(const Volume<T>& volume, const std::vector<double>& values, int k,
+		const std::vector<int> *lower, const vtkIdType *lowerFirst, const std::vector<int> *upper, const vtkIdType *upperFirst,
+		const vtkIdType *firstTriangles, const SurfaceArrays *surfaces, vtkIdType *counts)
+	{
+		vtkMarchingCubesTriangleCases *cases = vtkMarchingCubesTriangleCases::GetCases();
+		const int nx = volume.dims[0], ny = volume.dims[1];
+		const size_t numberOfValues = values.size();
+		for (size_t v = 0; v < numberOfValues; ++v)
+			counts[v] = 0;
+
+		for (int j = 0; j < ny - 1; ++j) {
+			for (int i = 0; i < nx - 1; ++i) {
+				double s[8];
+				for (int corner = 0; corner < 8; ++corner)
+					s[corner] = volume.Value(i + cellVertex[corner][0], j + cellVertex[corner][1], k + cellVertex[corner][2]);
+
+				for (size_t v = 0; v < numberOfValues; ++v) {
+					int index = 0;
+					for (int corner = 0; corner < 8; ++corner)
+						if (s[corner] >= values[v])
+							index |= 1 << corner;
+
+					const EDGE_LIST *edges = cases[index].edges;
+					for (int e = 0; edges[e] > -1; e += 3) {
+						if (surfaces) {
+							vtkIdType *cell = surfaces[v].cells + 4 * (firstTriangles[v] + counts[v]);
+							cell[0] = 3;
+							for (int c = 0; c < 3; ++c) {
+								const int *owner = cellVertex[cellEdge[edges[e + c]][0]];
+								const std::vector<int>& ids = owner[2] ? upper[v] : lower[v];
+								const vtkIdType first = owner[2] ? upperFirst[v] : lowerFirst[v];
+								cell[1 + c] = first + ids[3 * (static_cast<size_t>(j + owner[1]) * nx + i + owner[0]) + edgeAxis[edges[e + c]]];
+							}
+						}
+						++counts[v];
+					}
+				}
+			}
+		}
+	}
+
+	// extracts the surfaces of the region (an extent inside the whole extent) of the scalars
+	template <class T> void extractSurfaces(const T *scalars, const int wholeExtent[6], const int region[6], int sampleRate,
+		const double origin[3], const double spacing[3], const std::vector<double>& values, bool computeNormals,
+		int numberOfThreads, std::vector<vtkPolyData*>& outputs, double times[3])
+	{
+		Volume<T> volume;
+		volume.sampleRate = sampleRate;
+		for (int a = 0; a < 3; ++a) {
+			volume.dims[a] = (region[2 * a + 1] - region[2 * a]) / sampleRate + 1;
+			volume.offset[a] = region[2 * a] - wholeExtent[2 * a];
+			volume.wholeDims[a] = wholeExtent[2 * a + 1] - wholeExtent[2 * a] + 1;
+			volume.origin[a] = origin[a] + region[2 * a] * spacing[a];
+			volume.spacing[a] = spacing[a] * sampleRate;
+		}
+		volume.rowSize = volume.wholeDims[0];
+		volume.sliceSize = static_cast<vtkIdType>(volume.wholeDims[0]) * volume.wholeDims[1];
+		volume.scalars = scalars + volume.offset[0] + volume.offset[1] * volume.rowSize + volume.offset[2] * volume.sliceSize;
+
+		vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+		const int nz = volume.dims[2];
+		const size_t numberOfValues = values.size();
+		// the edges of a slice of the region (not of the whole volume), numbered per slice so 32 bits are enough
+		const size_t sliceEdges = 3 * static_cast<size_t>(volume.dims[0]) * volume.dims[1];
+
+		// pass 1: one unit per point slice, counting the vertices of the slice and the triangles of the slab above it
+		// for all iso values in one traversal, indexed [slice * values + value]. Counting needs no edge numbering
+		timer->StartTimer();
+		std::vector<vtkIdType> vertexCount(nz * numberOfValues), triangleCount(nz * numberOfValues, 0);
+		parallelFor(nz, numberOfThreads, [&](int k, int) {
+			numberSlice(volume, values, k, nullptr, nullptr, nullptr, &vertexCount[k * numberOfValues]);
+			if (k < nz - 1)
+				triangulateSlab(volume, values, k, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, &triangleCount[k * numberOfValues]);
+		});
+		timer->StopTimer();
+		times[0] = timer->GetElapsedTime();
+
+		// exclusive prefix sums per iso value over the slices: first vertex and first triangle of every unit
+		timer->StartTimer();
+		std::vector<vtkIdType> firstVertex((nz + 1) * numberOfValues, 0), firstTriangle((nz + 1) * numberOfValues, 0);
+		for (int k = 0; k < nz; ++k) {
+			for (size_t v = 0; v < numberOfValues; ++v) {
+				firstVertex[(k + 1) * numberOfValues + v] = firstVertex[k * numberOfValues + v] + vertexCount[k * numberOfValues + v];
+				firstTriangle[(k + 1) * numberOfValues + v] = firstTriangle[k * numberOfValues + v] + triangleCount[k * numberOfValues + v];
+			}
+		}
+		timer->StopTimer();
+		times[1] = timer->GetElapsedTime();
+
+		// pass 2: every unit writes its own range of the arrays of every surface
+		timer->StartTimer();
+		std::vector<SurfaceArrays> surfaces(numberOfValues);
+		for (size_t v = 0; v < numberOfValues; ++v) {
+			const vtkIdType numberOfPoints = firstVertex[nz * numberOfValues + v];
+			const vtkIdType numberOfTriangles = firstTriangle[nz * numberOfValues + v];
+
+			vtkSmartPointer<vtkFloatArray> coordinates = vtkSmartPointer<vtkFloatArray>::New();
+			coordinates->SetNumberOfComponents(3);
+			coordinates->SetNumberOfTuples(numberOfPoints);
+			vtkSmartPointer<vtkFloatArray> normals = vtkSmartPointer<vtkFloatArray>::New();
+			normals->SetName("Normals");
+			normals->SetNumberOfComponents(3);
+			normals->SetNumberOfTuples(computeNormals ? numberOfPoints : 0);
+			vtkSmartPointer<vtkIdTypeArray> connectivity = vtkSmartPointer<vtkIdTypeArray>::New();
+			connectivity->SetNumberOfValues(4 * numberOfTriangles);
+
+			surfaces[v].points = coordinates->GetPointer(0);
+			surfaces[v].normals = computeNormals ? normals->GetPointer(0) : nullptr;
+			surfaces[v].cells = connectivity->GetPointer(0);
+
+			// the output owns the arrays before they are filled
+			vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+			points->SetData(coordinates);
+			vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+			polys->SetCells(numberOfTriangles, connectivity);
+			outputs[v]->SetPoints(points);
+			outputs[v]->SetPolys(polys);
+			if (computeNormals)
+				outputs[v]->GetPointData()->SetNormals(normals);
+		}
+
+		// the edge numbering of two slices per worker and iso value, only needed by this pass
+		std::vector<std::vector<std::vector<int>>> lower(numberOfThreads,
+			std::vector<std::vector<int>>(numberOfValues, std::vector<int>(sliceEdges)));
+		std::vector<std::vector<std::vector<int>>> upper(lower);
+
+		parallelFor(nz, numberOfThreads, [&](int k, int worker) {
+			std::vector<vtkIdType> counts(numberOfValues);
+			const vtkIdType *first = &firstVertex[k * numberOfValues];
+			numberSlice(volume, values, k, first, lower[worker].data(), surfaces.data(), counts.data());
+			if (k < nz - 1) {
+				numberSlice(volume, values, k + 1, nullptr, upper[worker].data(), nullptr, counts.data());
+				triangulateSlab(volume, values, k, lower[worker].data(), first, upper[worker].data(), first + numberOfValues,
+					&firstTriangle[k * numberOfValues], surfaces.data(), counts.data());
+			}
+		});
+		timer->StopTimer();
+		times[2] = timer->GetElapsedTime();
+	}
+}
+
+vtkStandardNewMacro(WeldedMarchingCubes);
+
+WeldedMarchingCubes::WeldedMarchingCubes()
+	: ContourValues(vtkSmartPointer<vtkContourValues>::New()), ComputeNormals(true), SampleRate(1), NumberOfThreads(0),
+	LastCountTime(0.0), LastPrefixSumTime(0.0), LastGenerateTime(0.0), LastNumberOfThreads(0), LastNumberOfCells(0.0)
+{
+	// the whole extent
+	for (int a = 0; a < 3; ++a) {
+		VolumeOfInterest[2 * a] = VTK_INT_MIN;
+		VolumeOfInterest[2 * a + 1] = VTK_INT_MAX;
+	}
+}
+
+vtkMTimeType WeldedMarchingCubes::GetMTime()
+{
+	vtkMTimeType mtime = std::max(this->Superclass::GetMTime(), this->ContourValues->GetMTime());
+	return this->Atlas ? std::max(mtime, this->Atlas->GetMTime()) : mtime;
+}
+
+int WeldedMarchingCubes::FillInputPortInformation(int, vtkInformation *info)
+{
+	info->Set(vtkAlgorithm::INPUT_REQUIRED_DATA_TYPE(), "vtkImageData");
+	return 1;
+}
+
+int WeldedMarchingCubes::RequestData(vtkInformation *, vtkInformationVector **inputVector, vtkInformationVector *outputVector)
+{
+	vtkImageData *input = vtkImageData::GetData(inputVector[0]);
+	vtkDataArray *scalars = input ? input->GetPointData()->GetScalars() : nullptr;
+	if (!scalars || scalars->GetNumberOfComponents() != 1) {
+		vtkErrorMacro("No volume with one scalar component to contour.");
+		return 0;
+	}
+
+	int dims[3], extent[6];
+	double origin[3], spacing[3];
+	input->GetDimensions(dims);
+	input->GetExtent(extent);
+	input->GetOrigin(origin);
+	input->GetSpacing(spacing);
+	if (dims[0] < 2 || dims[1] < 2 || dims[2] < 2) {
+		vtkErrorMacro("Marching cubes needs a volume of at least 2 x 2 x 2 points.");
+		return 0;
+	}
+
+	std::vector<double> values(this->ContourValues->GetNumberOfContours());
+	for (size_t v = 0; v < values.size(); ++v)
+		values[v] = this->ContourValues->GetValue(static_cast<int>(v));
+
+	// one surface per output port
+	std::vector<vtkPolyData*> outputs(values.size());
+	for (size_t v = 0; v < values.size(); ++v) {
+		outputs[v] = vtkPolyData::GetData(outputVector, static_cast<int>(v));
+		if (!outputs[v]) {
+			vtkErrorMacro("No output port for iso value " << v << ".");
+			return 0;
+		}
+	}
+
+	// the volume of interest clamped to the extent, the surfaces stay empty if less than one cell remains
+	int region[6];
+	for (int a = 0; a < 3; ++a) {
+		region[2 * a] = std::max(this->VolumeOfInterest[2 * a], extent[2 * a]);
+		region[2 * a + 1] = std::min(this->VolumeOfInterest[2 * a + 1], extent[2 * a + 1]);
+	}
+	LastNumberOfCells = 1.0;
+	for (int a = 0; a < 3; ++a)
+		LastNumberOfCells *= std::max(0, region[2 * a + 1] - region[2 * a]) / this->SampleRate;
+	LastCountTime = LastPrefixSumTime = LastGenerateTime = 0.0;
+	if (LastNumberOfCells == 0.0)
+		return 1;
+
+	// the whole volume at full resolution from the active cells of an atlas that fits the input
+	bool wholeExtent = this->SampleRate == 1;
+	for (int a = 0; a < 6; ++a)
+		wholeExtent &= region[a] == extent[a];
+	if (this->Atlas && wholeExtent) {
+		double times[3] = { 0.0, 0.0, 0.0 };
+		bool extracted = true;
+		for (size_t v = 0; v < values.size() && extracted; ++v) {
+			double valueTimes[3];
+			extracted = this->Atlas->Extract(input, values[v], this->ComputeNormals, outputs[v], valueTimes);
+			for (int pass = 0; pass < 3 && extracted; ++pass)
+				times[pass] += valueTimes[pass];
+		}
+		if (extracted) {
+			LastCountTime = times[0];
+			LastPrefixSumTime = times[1];
+			LastGenerateTime = times[2];
+			LastNumberOfThreads = threadCount(this->Atlas->GetNumberOfThreads());
+			return 1;
+		}
+		vtkWarningMacro("The iso surface atlas does not fit the input, extracting without it.");
+	}
+
+	const int numberOfThreads = std::max(1, std::min(threadCount(this->NumberOfThreads), (region[5] - region[4]) / this->SampleRate + 1));
+
+	double times[3] = { 0.0, 0.0, 0.0 };
+	switch (scalars->GetDataType()) {
+		vtkTemplateMacro(extractSurfaces(static_cast<const VTK_TT*>(scalars->GetVoidPointer(0)), extent, region,
+			this->SampleRate, origin, spacing, values, this->ComputeNormals, numberOfThreads, outputs, times));
+	default:
+		vtkErrorMacro("Unsupported scalar type " << scalars->GetDataTypeAsString());
+		return 0;
+	}
+
+	LastCountTime = times[0];
+	LastPrefixSumTime = times[1];
+	LastGenerateTime = times[2];
+	LastNumberOfThreads = numberOfThreads;
+	return 1;
+}
+
+// ----- benchmark -----
+
+// edges used by exactly one triangle, zero for a closed surface that does not touch the volume border
+static vtkIdType countOpenEdges(vtkPolyData *surface)
+{
+	std::unordered_map<unsigned long long, int> edgeUses;
+	vtkCellArray *polys = surface->GetPolys();
+	vtkIdType npts;
+	vtkIdType *pts;
+	for (polys->InitTraversal(); polys->GetNextCell(npts, pts);) {
+		for (vtkIdType k = 0; k < npts; ++k) {
+			unsigned long long a = static_cast<unsigned long long>(pts[k]), b = static_cast<unsigned long long>(pts[(k + 1) % npts]);
+			++edgeUses[std::min(a, b) << 32 | std::max(a, b)];
+		}
+	}
+	vtkIdType open = 0;
+	for (std::unordered_map<unsigned long long, int>::const_iterator it = edgeUses.begin(); it != edgeUses.end(); ++it)
+		if (it->second == 1)
+			++open;
+	return open;
+}
+
+static bool sameArrays(vtkDataArray *a, vtkDataArray *b)
+{
+	if (a->GetDataType() != b->GetDataType() || a->GetNumberOfTuples() != b->GetNumberOfTuples()
+		|| a->GetNumberOfComponents() != b->GetNumberOfComponents())
+		return false;
+	size_t bytes = static_cast<size_t>(a->GetNumberOfTuples()) * a->GetNumberOfComponents() * a->GetDataTypeSize();
+	return bytes == 0 || std::memcmp(a->GetVoidPointer(0), b->GetVoidPointer(0), bytes) == 0;
+}
+
+void runWeldingBenchmark(vtkImageData *volume, const std::string& name, double isoValue, int maxThreads, std::ostream& os)
+{
+	const int repetitions = 3;
+	int dims[3];
+	volume->GetDimensions(dims);
+	maxThreads = threadCount(maxThreads);
+
+	// reference: serial marching cubes that welds through a vtkMergePoints locator
+	vtkSmartPointer<vtkMarchingCubes> reference = vtkSmartPointer<vtkMarchingCubes>::New();
+	reference->SetInputData(volume);
+	reference->SetValue(0, isoValue);
+	vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+	double referenceTime = 0.0;
+	for (int r = 0; r < repetitions; ++r) {
+		reference->Modified();
+		timer->StartTimer();
+		reference->Update();
+		timer->StopTimer();
+		referenceTime = r ? std::min(referenceTime, timer->GetElapsedTime()) : timer->GetElapsedTime();
+	}
+
+	os << "# welding benchmark: " << name << " (" << dims[0] << " x " << dims[1] << " x " << dims[2]
+		<< " points), iso value " << isoValue << std::endl;
+	os << std::fixed << std::setprecision(1);
+	os << "vtkMarchingCubes with point locator: " << referenceTime * 1000.0 << " ms, "
+		<< reference->GetOutput()->GetNumberOfPoints() << " points, " << reference->GetOutput()->GetNumberOfPolys()
+		<< " triangles" << std::endl;
+
+	std::vector<int> threadCounts;
+	for (int t = 1; t < maxThreads; t *= 2)
+		threadCounts.push_back(t);
+	threadCounts.push_back(maxThreads);
+
+	vtkSmartPointer<vtkPolyData> serial;
+	double serialTime = 0.0;
+	os << "| threads | count [ms] | prefix sum [ms] | number + generate [ms] | total [ms] | speedup | vs locator | identical |" << std::endl;
+	os << "|--------:|-----------:|----------------:|-----------------------:|-----------:|--------:|-----------:|:---------:|" << std::endl;
+	for (size_t c = 0; c < threadCounts.size(); ++c) {
+		vtkSmartPointer<WeldedMarchingCubes> welded = vtkSmartPointer<WeldedMarchingCubes>::New();
+		welded->SetInputData(volume);
+		welded->SetValue(0, isoValue);
+		welded->SetNumberOfThreads(threadCounts[c]);
+
+		// the fastest of the repetitions, with the pass times of that run
+		double best[3] = { 0.0, 0.0, 0.0 }, bestTotal = 0.0;
+		for (int r = 0; r < repetitions; ++r) {
+			welded->Modified();
+			welded->Update();
+			double total = welded->GetLastCountTime() + welded->GetLastPrefixSumTime() + welded->GetLastGenerateTime();
+			if (r == 0 || total < bestTotal) {
+				bestTotal = total;
+				best[0] = welded->GetLastCountTime();
+				best[1] = welded->GetLastPrefixSumTime();
+				best[2] = welded->GetLastGenerateTime();
+			}
+		}
+
+		bool identical = true;
+		if (!serial) {
+			serial = welded->GetOutput();
+			serialTime = bestTotal;
+		}
+		else {
+			vtkPolyData *output = welded->GetOutput();
+			identical = sameArrays(serial->GetPoints()->GetData(), output->GetPoints()->GetData())
+				&& sameArrays(serial->GetPolys()->GetData(), output->GetPolys()->GetData())
+				&& sameArrays(serial->GetPointData()->GetNormals(), output->GetPointData()->GetNormals());
+		}
+
+		os << "| " << std::setw(7) << threadCounts[c]
+			<< " | " << std::setw(10) << std::setprecision(2) << best[0] * 1000.0
+			<< " | " << std::setw(15) << best[1] * 1000.0
+			<< " | " << std::setw(22) << best[2] * 1000.0
+			<< " | " << std::setw(10) << bestTotal * 1000.0
+			<< " | " << std::setw(6) << (bestTotal > 0.0 ? serialTime / bestTotal : 0.0) << "x"
+			<< " | " << std::setw(9) << (bestTotal > 0.0 ? referenceTime / bestTotal : 0.0) << "x"
+			<< " | " << std::setw(9) << (identical ? "yes" : "NO") << " |" << std::endl;
+	}
+
+	os << std::setprecision(0) << "welded mesh: " << serial->GetNumberOfPoints() << " points, " << serial->GetNumberOfPolys()
+		<< " triangles, " << countOpenEdges(serial) << " open edges (at the volume border only)" << std::endl << std::endl;
+}
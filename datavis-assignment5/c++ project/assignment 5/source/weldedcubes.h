@@ -0,0 +1,126 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+// Multithreaded marching cubes that welds the surface vertices by their lattice edge instead of a point locator.
+//
+
+#pragma once
+
+#include "isoatlas.h"
+
+#include <vtkPolyDataAlgorithm.h>
+#include <vtkSmartPointer.h>
+#include <vtkContourValues.h>
+#include <vtkImageData.h>
+
+#include <algorithm>
+#include <ostream>
+#include <string>
+
+/* Drop-in replacement of vtkMarchingCubes for images with one scalar component.
+   Every surface vertex lies on exactly one edge of the voxel lattice, so the edge id (3 * point id + axis) identifies
+   it and no vtkMergePoints locator is needed. The extraction runs in two passes over slices of the volume:
+   - the first pass counts the intersected edges of every point slice and the triangles of every cell slab,
+   - a prefix sum over these counts gives every slice its first vertex id and every slab its first triangle,
+   - the second pass numbers the intersected edges of a slice in a fixed order, writes their vertices and the
+     triangles of the slab, looking up the vertices of its cells by edge id in the numbering of the two slices.
+   No thread writes to memory of another one and no locks are taken. The vertex and triangle order only depends on
+   the volume, so the output is the same for any number of threads, and a vertex shared by neighbouring cells is one
+   point, so the surface is watertight like the one of vtkMarchingCubes. Normals are the interpolated negative
+   gradients of the volume, as in vtkMarchingCubes.
+   Several iso values are extracted in the same traversal: every sample is read once and compared with all values,
+   and every value gets its own surface on its own output port, so each can have its own actor.
+   A volume of interest restricts the extraction to a sub-extent, which is read in place from the whole volume, so
+   changing it copies no voxels and the cost follows the number of cells inside.
+   With an iso surface atlas of the input, the surfaces of the whole volume at full resolution come from the active
+   cells of the atlas instead of a traversal of all cells. */
+class WeldedMarchingCubes : public vtkPolyDataAlgorithm {
+public:
+	static WeldedMarchingCubes *New();
+	vtkTypeMacro(WeldedMarchingCubes, vtkPolyDataAlgorithm);
+
+	/* Iso values, the same interface as vtkMarchingCubes, except that the surface of value i is on output port i. */
+	void SetValue(int i, double value) { this->ContourValues->SetValue(i, value); this->UpdateOutputPorts(); }
+	double GetValue(int i) { return this->ContourValues->GetValue(i); }
+	void SetNumberOfContours(int number) { this->ContourValues->SetNumberOfContours(number); this->UpdateOutputPorts(); }
+	int GetNumberOfContours() { return this->ContourValues->GetNumberOfContours(); }
+	void GenerateValues(int numberOfContours, double range[2])
+	{
+		this->ContourValues->GenerateValues(numberOfContours, range);
+		this->UpdateOutputPorts();
+	}
+
+	/* Interpolated gradient normals, on by default. */
+	vtkSetMacro(ComputeNormals, bool);
+	vtkGetMacro(ComputeNormals, bool);
+	vtkBooleanMacro(ComputeNormals, bool);
+
+	/* Sub-extent to extract, in the structured coordinates of the input like vtkExtractVOI. It is clamped to the
+	   extent of the input, the default is the whole extent. */
+	vtkSetVector6Macro(VolumeOfInterest, int);
+	vtkGetVector6Macro(VolumeOfInterest, int);
+
+	/* Extracts from every n-th point per axis of the volume of interest, a coarse surface for level of detail.
+	   Cells that do not fit completely at the end of an axis are left out. Default 1. */
+	vtkSetClampMacro(SampleRate, int, 1, 64);
+	vtkGetMacro(SampleRate, int);
+
+	/* Precomputed atlas of the active cells of the input (see isoatlas.h), none by default. It is used while the
+	   volume of interest is the whole extent and the sample rate is 1, the extraction of each iso value then runs
+	   on the threads of the atlas. The voxels are not compared with the atlas here, see IsoSurfaceAtlas::Matches. */
+	void SetAtlas(IsoSurfaceAtlas *atlas)
+	{
+		if (this->Atlas != atlas) {
+			this->Atlas = atlas;
+			this->Modified();
+		}
+	}
+	IsoSurfaceAtlas *GetAtlas() { return this->Atlas; }
+
+	/* Number of worker threads, 0 uses all hardware threads. */
+	vtkSetClampMacro(NumberOfThreads, int, 0, 256);
+	vtkGetMacro(NumberOfThreads, int);
+
+	/* Statistics of the last execution in seconds, for all iso values together: counting pass, prefix sum, and the
+	   pass that numbers the edges, writes the welded vertices and the triangles; and the cells of the volume of
+	   interest. With an atlas the passes are the retrieval of the active cells, the numbering of the vertices and the
+	   generation of the surfaces. */
+	vtkGetMacro(LastCountTime, double);
+	vtkGetMacro(LastPrefixSumTime, double);
+	vtkGetMacro(LastGenerateTime, double);
+	vtkGetMacro(LastNumberOfThreads, int);
+	vtkGetMacro(LastNumberOfCells, double);
+
+	/* The iso values are delegated to vtkContourValues, a rebuilt or reread atlas modifies the filter as well. */
+	vtkMTimeType GetMTime() override;
+
+protected:
+	WeldedMarchingCubes();
+	~WeldedMarchingCubes() override {}
+
+	int FillInputPortInformation(int port, vtkInformation *info) override;
+	int RequestData(vtkInformation *request, vtkInformationVector **inputVector, vtkInformationVector *outputVector) override;
+
+private:
+	WeldedMarchingCubes(const WeldedMarchingCubes&) = delete;
+	void operator=(const WeldedMarchingCubes&) = delete;
+
+	void UpdateOutputPorts() { this->SetNumberOfOutputPorts(std::max(1, this->ContourValues->GetNumberOfContours())); }
+
+	vtkSmartPointer<vtkContourValues> ContourValues;
+	vtkSmartPointer<IsoSurfaceAtlas> Atlas;
+	bool ComputeNormals;
+	int VolumeOfInterest[6];
+	int SampleRate;
+	int NumberOfThreads;
+	double LastCountTime;
+	double LastPrefixSumTime;
+	double LastGenerateTime;
+	int LastNumberOfThreads;
+	double LastNumberOfCells;
+};
+
+/* Extracts the iso surface with vtkMarchingCubes as reference and with WeldedMarchingCubes on 1, 2, 4, ... up to
+   the given number of threads (0: all cores), and prints a table with the times of the passes, the speedup over
+   one thread, the number of open edges of the mesh and whether the output is identical to the one of one thread. */
+void runWeldingBenchmark(vtkImageData *volume, const std::string& name, double isoValue, int maxThreads, std::ostream& os);
@@ -0,0 +1,128 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+
+#include "batchrender.h"
+
+#include <vtkRenderer.h>
+#include <vtkRendererCollection.h>
+#include <vtkCamera.h>
+#include <vtkWindowToImageFilter.h>
+#include <vtkPNGWriter.h>
+#include <vtkTimerLog.h>
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+bool readCameraPath(const std::string& fileName, std::vector<CameraKeyframe>& path)
+{
+	std::ifstream file(fileName.c_str());
+	if (!file)
+		return false;
+
+	path.clear();
+	std::string line;
+	while (std::getline(file, line)) {
+		size_t first = line.find_first_not_of(" \t\r");
+		if (first == std::string::npos || line[first] == '#')
+			continue;
+
+		std::istringstream values(line);
+		CameraKeyframe keyframe;
+		for (int k = 0; k < 3; ++k)
+			values >> keyframe.position[k];
+		for (int k = 0; k < 3; ++k)
+			values >> keyframe.focalPoint[k];
+		for (int k = 0; k < 3; ++k)
+			values >> keyframe.viewUp[k];
+		values >> keyframe.isoValue >> keyframe.warpFactor;
+		if (!values)
+			return false;
+		path.push_back(keyframe);
+	}
+	return true;
+}
+
+int renderCameraPath(vtkSmartPointer<vtkRenderWindow> window, const std::vector<CameraKeyframe>& path,
+	const std::string& outputPrefix, SceneUpdate updateScene, std::ostream& os)
+{
+	vtkRenderer *renderer = window->GetRenderers()->GetFirstRenderer();
+	if (!renderer || path.empty())
+		return 0;
+
+	// render into an offscreen buffer, no window is mapped and no interactor is needed
+	window->SetOffScreenRendering(1);
+
+	// grabbing the back buffer right after our own render, the grabber must not render again
+	vtkSmartPointer<vtkWindowToImageFilter> grabber = vtkSmartPointer<vtkWindowToImageFilter>::New();
+	grabber->SetInput(window);
+	grabber->SetInputBufferTypeToRGB();
+	grabber->ReadFrontBufferOff();
+	grabber->ShouldRerenderOff();
+
+	vtkSmartPointer<vtkPNGWriter> writer = vtkSmartPointer<vtkPNGWriter>::New();
+	writer->SetInputConnection(grabber->GetOutputPort());
+
+	vtkSmartPointer<vtkTimerLog> timer = vtkSmartPointer<vtkTimerLog>::New();
+	std::vector<double> renderTimes, frameTimes;
+	renderTimes.reserve(path.size());
+	frameTimes.reserve(path.size());
+
+	os << "| frame | render [ms] | frame with PNG [ms] |" << std::endl;
+	os << "|------:|------------:|--------------------:|" << std::endl;
+	os << std::fixed << std::setprecision(2);
+
+	vtkCamera *camera = renderer->GetActiveCamera();
+	int frames = 0;
+	for (size_t i = 0; i < path.size(); ++i) {
+		const CameraKeyframe& keyframe = path[i];
+		timer->StartTimer();
+
+		// scene parameters first, they may change the bounds used for the clipping range
+		if (updateScene)
+			updateScene(keyframe);
+		camera->SetPosition(keyframe.position[0], keyframe.position[1], keyframe.position[2]);
+		camera->SetFocalPoint(keyframe.focalPoint[0], keyframe.focalPoint[1], keyframe.focalPoint[2]);
+		camera->SetViewUp(keyframe.viewUp[0], keyframe.viewUp[1], keyframe.viewUp[2]);
+		camera->OrthogonalizeViewUp();
+		renderer->ResetCameraClippingRange();
+
+		// rendering also executes the parts of the pipeline that changed
+		window->Render();
+		timer->StopTimer();
+		double renderTime = timer->GetElapsedTime();
+
+		std::ostringstream fileName;
+		fileName << outputPrefix << std::setw(4) << std::setfill('0') << i << ".png";
+		grabber->Modified();
+		writer->SetFileName(fileName.str().c_str());
+		writer->Write();
+		timer->StopTimer();
+		double frameTime = timer->GetElapsedTime();
+
+		renderTimes.push_back(renderTime);
+		frameTimes.push_back(frameTime);
+		os << "| " << std::setw(5) << i << " | " << std::setw(11) << 1000.0 * renderTime
+			<< " | " << std::setw(19) << 1000.0 * frameTime << " |" << std::endl;
+		++frames;
+	}
+
+	double totalRender = 0.0, totalFrame = 0.0;
+	for (size_t i = 0; i < frameTimes.size(); ++i) {
+		totalRender += renderTimes[i];
+		totalFrame += frameTimes[i];
+	}
+
+	// the first frame includes the initial pipeline execution and is reported separately
+	std::sort(renderTimes.begin() + 1, renderTimes.end());
+	os << frames << " frames in " << totalFrame << " s: " << frames / totalFrame << " frames/s with PNG output, "
+		<< frames / totalRender << " frames/s render only" << std::endl;
+	os << "first frame " << 1000.0 * frameTimes[0] << " ms";
+	if (frames > 1)
+		os << ", following frames render median " << 1000.0 * renderTimes[1 + (frames - 1) / 2]
+			<< " ms, maximum " << 1000.0 * renderTimes.back() << " ms";
+	os << std::endl;
+	return frames;
+}
@@ -0,0 +1,40 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+// Headless batch rendering: renders a scene offscreen along a camera path and writes every frame as PNG.
+// The same file is used by assignment 4 and assignment 5.
+//
+
+#pragma once
+
+#include <vtkSmartPointer.h>
+#include <vtkRenderWindow.h>
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <functional>
+
+/* One keyframe of a camera path. */
+struct CameraKeyframe {
+	double position[3];
+	double focalPoint[3];
+	double viewUp[3];
+	double isoValue;      // used by the volume scene (assignment 5)
+	double warpFactor;    // used by the terrain scene (assignment 4)
+};
+
+/* Reads a camera path file. Every keyframe is one line of 11 numbers:
+       px py pz  fx fy fz  ux uy uz  iso  warp
+   Empty lines and lines starting with '#' are skipped. Returns false if the file cannot be read or a line is incomplete. */
+bool readCameraPath(const std::string& fileName, std::vector<CameraKeyframe>& path);
+
+/* Called before a frame is rendered to apply the scene parameters of the keyframe (iso value, warp factor). */
+typedef std::function<void(const CameraKeyframe&)> SceneUpdate;
+
+/* Renders the first renderer of the window offscreen once per keyframe, without an interactor, and writes the frames
+   to <outputPrefix>0000.png, <outputPrefix>0001.png, ... The pipeline is built once by the caller and only updated
+   through updateScene, so data is loaded once for the whole path.
+   Prints the time of every frame and the frames per second to os. Returns the number of written frames. */
+int renderCameraPath(vtkSmartPointer<vtkRenderWindow> window, const std::vector<CameraKeyframe>& path,
+	const std::string& outputPrefix, SceneUpdate updateScene, std::ostream& os);
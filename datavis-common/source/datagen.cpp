@@ -0,0 +1,142 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+// Command line tool to generate DEMs and volumes of arbitrary size for scaling studies, procedurally or by
+// upsampling the bundled data sets. The output format follows the extension, .dem or .vti.
+// The same file is used by assignment 4 and assignment 5.
+//
+// usage: datagen terrain <size> <output.dem|output.vti> [--seed n]
+//        datagen phantom <width> <height> <depth> <output.vti> [--seed n]
+//        datagen upsample <input.dem|input.vti> <factor> <output.dem|output.vti> [--fractal] [--seed n]
+//
+
+#include "syntheticdata.h"
+
+#include <vtkSmartPointer.h>
+#include <vtkDEMReader.h>
+#include <vtkXMLImageDataReader.h>
+#include <vtkXMLImageDataWriter.h>
+#include <vtkImageData.h>
+
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <vector>
+
+static bool hasExtension(const std::string& fileName, const std::string& extension)
+{
+	return fileName.size() >= extension.size()
+		&& fileName.compare(fileName.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+static vtkSmartPointer<vtkImageData> readImage(const std::string& fileName)
+{
+	vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+	if (hasExtension(fileName, ".dem")) {
+		vtkSmartPointer<vtkDEMReader> reader = vtkSmartPointer<vtkDEMReader>::New();
+		reader->SetFileName(fileName.c_str());
+		reader->Update();
+		image->ShallowCopy(reader->GetOutput());
+	}
+	else if (hasExtension(fileName, ".vti")) {
+		vtkSmartPointer<vtkXMLImageDataReader> reader = vtkSmartPointer<vtkXMLImageDataReader>::New();
+		reader->SetFileName(fileName.c_str());
+		reader->Update();
+		image->ShallowCopy(reader->GetOutput());
+	}
+	return image;
+}
+
+static bool writeImage(const std::string& fileName, vtkImageData *image)
+{
+	if (hasExtension(fileName, ".dem"))
+		return writeDem(fileName, image, fileName);
+	if (!hasExtension(fileName, ".vti"))
+		return false;
+	vtkSmartPointer<vtkXMLImageDataWriter> writer = vtkSmartPointer<vtkXMLImageDataWriter>::New();
+	writer->SetFileName(fileName.c_str());
+	writer->SetInputData(image);
+	writer->SetDataModeToAppended();
+	writer->SetCompressorTypeToZLib();
+	return writer->Write() == 1;
+}
+
+static void usage(const char *program)
+{
+	std::cerr << "usage: " << program << " terrain <size> <output.dem|output.vti> [--seed n]" << std::endl
+		<< "       " << program << " phantom <width> <height> <depth> <output.vti> [--seed n]" << std::endl
+		<< "       " << program << " upsample <input.dem|input.vti> <factor> <output.dem|output.vti> [--fractal] [--seed n]"
+		<< std::endl;
+}
+
+int main(int argc, char * argv[])
+{
+	// positional arguments first, options anywhere after the mode
+	std::vector<std::string> arguments;
+	bool fractal = false;
+	unsigned int seed = 1;
+	for (int i = 2; i < argc; ++i) {
+		if (!std::strcmp(argv[i], "--fractal"))
+			fractal = true;
+		else if (!std::strcmp(argv[i], "--seed") && i + 1 < argc)
+			seed = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+		else if (!std::strncmp(argv[i], "--", 2)) {
+			std::cerr << "unknown option " << argv[i] << std::endl;
+			return 1;
+		}
+		else
+			arguments.push_back(argv[i]);
+	}
+
+	const std::string mode = argc > 1 ? argv[1] : "";
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	vtkSmartPointer<vtkImageData> image;
+	std::string output;
+	if (mode == "terrain" && arguments.size() == 2) {
+		image = createSyntheticTerrain(std::atoi(arguments[0].c_str()), seed);
+		output = arguments[1];
+	}
+	else if (mode == "phantom" && arguments.size() == 4) {
+		image = createHeadPhantom(std::atoi(arguments[0].c_str()), std::atoi(arguments[1].c_str()),
+			std::atoi(arguments[2].c_str()), seed);
+		output = arguments[3];
+	}
+	else if (mode == "upsample" && arguments.size() == 3) {
+		vtkSmartPointer<vtkImageData> input = readImage(arguments[0]);
+		if (input->GetNumberOfPoints() == 0) {
+			std::cerr << "could not read " << arguments[0] << std::endl;
+			return 1;
+		}
+		image = upsampleImage(input, std::atof(arguments[1].c_str()), fractal, seed);
+		output = arguments[2];
+	}
+	else {
+		usage(argv[0]);
+		return 1;
+	}
+
+	if (!image || image->GetNumberOfPoints() == 0) {
+		std::cerr << "could not generate the data set" << std::endl;
+		return 1;
+	}
+	double generated = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	if (!writeImage(output, image)) {
+		std::cerr << "could not write " << output << " (DEMs need a 2D grid, the extension must be .dem or .vti)" << std::endl;
+		return 1;
+	}
+	double written = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() - generated;
+
+	int dims[3];
+	image->GetDimensions(dims);
+	double range[2];
+	image->GetScalarRange(range);
+	std::cout << output << ": " << dims[0] << " x " << dims[1] << " x " << dims[2] << " samples, values "
+		<< range[0] << " to " << range[1] << ", " << std::fixed << std::setprecision(1)
+		<< image->GetActualMemorySize() / 1024.0 << " MB in memory" << std::endl
+		<< "generated in " << std::setprecision(3) << generated << " s, written in " << written << " s" << std::endl;
+	return 0;
+}
@@ -0,0 +1,108 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+
+#include "interactionscheduler.h"
+
+#include <iostream>
+#include <cmath>
+
+InteractionScheduler::InteractionScheduler()
+	: Interval(1.0 / 60.0), timerId(-1), renderRequested(false),
+	events(0), coalesced(0), dropped(0), frames(0), idleTicks(0)
+{
+}
+
+void InteractionScheduler::Attach(vtkRenderWindowInteractor *interactor, vtkRenderWindow *window)
+{
+	this->interactor = interactor;
+	this->window = window;
+
+	// every Render() of the interactor only invokes its RenderEvent from now on
+	interactor->EnableRenderOff();
+	interactor->AddObserver(vtkCommand::RenderEvent, this);
+	// ahead of the interactor style, which would otherwise animate on every timer event
+	interactor->AddObserver(vtkCommand::TimerEvent, this, 1.0);
+
+	if (interactor->GetInitialized())
+		startTimer();
+}
+
+void InteractionScheduler::startTimer()
+{
+	if (timerId >= 0 || !interactor)
+		return;
+	unsigned long milliseconds = static_cast<unsigned long>(std::ceil(1000.0 * Interval));
+	timerId = interactor->CreateRepeatingTimer(milliseconds > 0 ? milliseconds : 1);
+}
+
+void InteractionScheduler::Post(const void *key, Update update)
+{
+	if (!interactor) {
+		update();
+		return;
+	}
+
+	++events;
+	for (size_t i = 0; i < pending.size(); ++i)
+		if (pending[i].key == key) {
+			// the queued update was not applied yet and is stale now
+			pending[i].update = update;
+			++dropped;
+			return;
+		}
+
+	Pending entry;
+	entry.key = key;
+	entry.update = update;
+	pending.push_back(entry);
+}
+
+void InteractionScheduler::RequestRender()
+{
+	++events;
+	if (renderRequested)
+		++coalesced;
+	renderRequested = true;
+}
+
+void InteractionScheduler::tick()
+{
+	// updates queued by the updates themselves wait for the next tick
+	std::vector<Pending> updates;
+	updates.swap(pending);
+
+	bool changed = false;
+	for (size_t i = 0; i < updates.size(); ++i)
+		if (updates[i].update())
+			changed = true;
+
+	if (!changed && !renderRequested) {
+		++idleTicks;
+		return;
+	}
+
+	renderRequested = false;
+	++frames;
+	if (window)
+		window->Render();
+}
+
+void InteractionScheduler::Execute(vtkObject *caller, unsigned long eventId, void *callData)
+{
+	if (eventId == vtkCommand::RenderEvent) {
+		// the first render of the interactor comes from Initialize(), the timer can be created from then on
+		startTimer();
+		RequestRender();
+	}
+	else if (eventId == vtkCommand::TimerEvent && callData && *static_cast<int*>(callData) == timerId) {
+		SetAbortFlag(1);
+		tick();
+	}
+}
+
+void InteractionScheduler::PrintStatistics(std::ostream& os) const
+{
+	os << "interaction: " << events << " events, " << frames << " frames, " << coalesced << " coalesced render requests, "
+		<< dropped << " dropped updates, " << idleTicks << " idle ticks" << std::endl;
+}
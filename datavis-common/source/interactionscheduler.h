@@ -0,0 +1,83 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+// Render on demand for slider and camera interaction: pipeline updates and renders are coalesced to at most one
+// per display interval. The same file is used by assignment 4 and assignment 5.
+//
+
+#pragma once
+
+#include <vtkSmartPointer.h>
+#include <vtkWeakPointer.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkCommand.h>
+
+#include <functional>
+#include <vector>
+#include <ostream>
+
+/* Widgets and interactor styles execute the pipeline and render for every mouse event, also when the events
+   arrive faster than frames (an animated slider sends all its animation steps at once). Attached to an
+   interactor, the scheduler
+   - turns the renders of the interactor into requests (vtkRenderWindowInteractor::EnableRenderOff), so widgets,
+     styles and callbacks only mark the window as dirty
+   - takes pipeline updates through Post(). A newer update with the same key replaces a queued one, so e.g. only
+     the last position of a dragged slider is extracted
+   - applies the queued updates and renders once on a repeating timer with the display interval. Ticks without
+     a request or a change render nothing.
+   Its own timer events are not passed on to the interactor style. */
+class InteractionScheduler : public vtkCommand {
+private:
+	InteractionScheduler();
+
+public:
+	typedef std::function<bool()> Update;
+
+	static InteractionScheduler *New() { return new InteractionScheduler; }
+
+	/* Seconds between two frames, default 1/60. Set before Attach. */
+	double Interval;
+
+	/* Takes over the rendering of the interactor. The timer starts once the interactor is initialized. */
+	void Attach(vtkRenderWindowInteractor *interactor, vtkRenderWindow *window);
+
+	/* Queues an update for the next frame, replacing a queued update with the same key. The update returns
+	   whether it changed the scene. Without an attached interactor the update runs immediately. */
+	void Post(const void *key, Update update);
+
+	/* Asks for a frame, all requests until the next tick give one frame. */
+	void RequestRender();
+
+	/* Counters since Attach. */
+	unsigned long GetNumberOfEvents() const { return events; }
+	unsigned long GetNumberOfCoalescedEvents() const { return coalesced; }
+	unsigned long GetNumberOfDroppedUpdates() const { return dropped; }
+	unsigned long GetNumberOfFrames() const { return frames; }
+	unsigned long GetNumberOfIdleTicks() const { return idleTicks; }
+
+	void PrintStatistics(std::ostream& os) const;
+
+	virtual void Execute(vtkObject *caller, unsigned long eventId, void *callData);
+
+private:
+	struct Pending {
+		const void *key;
+		Update update;
+	};
+
+	void startTimer();
+	void tick();
+
+	vtkWeakPointer<vtkRenderWindowInteractor> interactor;
+	vtkWeakPointer<vtkRenderWindow> window;
+	int timerId;
+	bool renderRequested;
+	std::vector<Pending> pending;
+
+	unsigned long events;
+	unsigned long coalesced;
+	unsigned long dropped;
+	unsigned long frames;
+	unsigned long idleTicks;
+};
@@ -0,0 +1,226 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+
+#include "microbench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+bool parseBenchmarkOptions(int argc, char *argv[], BenchmarkOptions& options)
+{
+	for (int i = 1; i < argc; ++i) {
+		if (!std::strcmp(argv[i], "--repetitions") && i + 1 < argc)
+			options.repetitions = std::max(1, std::atoi(argv[++i]));
+		else if (!std::strcmp(argv[i], "--warmup") && i + 1 < argc)
+			options.warmUp = std::max(0, std::atoi(argv[++i]));
+		else if (!std::strcmp(argv[i], "--scales") && i + 1 < argc) {
+			options.scales.clear();
+			std::istringstream list(argv[++i]);
+			std::string item;
+			while (std::getline(list, item, ','))
+				if (std::atof(item.c_str()) > 0.0)
+					options.scales.push_back(std::atof(item.c_str()));
+		}
+		else if (!std::strcmp(argv[i], "--output") && i + 1 < argc)
+			options.output = argv[++i];
+		else if (!std::strcmp(argv[i], "--baseline") && i + 1 < argc)
+			options.baseline = argv[++i];
+		else if (!std::strcmp(argv[i], "--threshold") && i + 1 < argc)
+			options.threshold = std::atof(argv[++i]);
+		else {
+			std::cerr << "unknown option " << argv[i] << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+// ----- runner -----
+MicroBenchmark::MicroBenchmark(const BenchmarkOptions& options)
+	: options(options)
+{
+}
+
+const BenchmarkResult& MicroBenchmark::Run(const std::string& stage, const std::string& input, double elements,
+	std::function<void()> body, std::function<void()> prepare)
+{
+	for (int i = 0; i < options.warmUp; ++i) {
+		if (prepare)
+			prepare();
+		body();
+	}
+
+	std::vector<double> times;
+	for (int i = 0; i < options.repetitions; ++i) {
+		if (prepare)
+			prepare();
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		body();
+		times.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+	}
+	std::sort(times.begin(), times.end());
+
+	BenchmarkResult result;
+	result.stage = stage;
+	result.input = input;
+	result.elements = elements;
+	result.repetitions = static_cast<int>(times.size());
+	result.minimum = times.front();
+	result.median = times.size() % 2 ? times[times.size() / 2] : 0.5 * (times[times.size() / 2 - 1] + times[times.size() / 2]);
+	result.p90 = times[std::min(times.size() - 1, static_cast<size_t>(std::ceil(0.9 * times.size())) - 1)];
+	double sum = 0.0;
+	for (size_t i = 0; i < times.size(); ++i)
+		sum += times[i];
+	result.mean = sum / times.size();
+	double squares = 0.0;
+	for (size_t i = 0; i < times.size(); ++i)
+		squares += (times[i] - result.mean) * (times[i] - result.mean);
+	result.deviation = times.size() > 1 ? std::sqrt(squares / (times.size() - 1)) : 0.0;
+
+	// progress on the console, the table follows at the end
+	std::cout << stage << " on " << input << ": " << std::fixed << std::setprecision(3) << 1000.0 * result.median
+		<< " ms" << std::endl;
+	results.push_back(result);
+	return results.back();
+}
+
+void MicroBenchmark::PrintTable(std::ostream& os) const
+{
+	os << "| stage | input | elements | median [ms] | min [ms] | p90 [ms] | stddev [ms] | M elements/s |" << std::endl;
+	os << "|-------|-------|---------:|------------:|---------:|---------:|------------:|-------------:|" << std::endl;
+	os << std::fixed;
+	for (size_t i = 0; i < results.size(); ++i) {
+		const BenchmarkResult& r = results[i];
+		os << "| " << r.stage << " | " << r.input << " | " << std::setprecision(0) << r.elements
+			<< " | " << std::setprecision(3) << 1000.0 * r.median << " | " << 1000.0 * r.minimum
+			<< " | " << 1000.0 * r.p90 << " | " << 1000.0 * r.deviation
+			<< " | " << std::setprecision(1) << (r.median > 0.0 ? r.elements / r.median / 1e6 : 0.0) << " |" << std::endl;
+	}
+	os << std::endl;
+}
+
+int MicroBenchmark::Finish(std::ostream& os) const
+{
+	PrintTable(os);
+
+	int exitCode = 0;
+	if (!options.output.empty()) {
+		if (writeBenchmarkCsv(options.output, results))
+			os << "results written to " << options.output << std::endl;
+		else {
+			std::cerr << "could not write " << options.output << std::endl;
+			exitCode = 1;
+		}
+	}
+
+	if (!options.baseline.empty()) {
+		std::vector<BenchmarkResult> baseline;
+		if (!readBenchmarkCsv(options.baseline, baseline)) {
+			std::cerr << "could not read the baseline " << options.baseline << std::endl;
+			return 1;
+		}
+		if (compareWithBaseline(results, baseline, options.threshold, os) > 0)
+			exitCode = 1;
+	}
+	return exitCode;
+}
+
+// ----- CSV -----
+// one header line, then one line per result, times in milliseconds
+static const char *csvHeader = "stage,input,elements,repetitions,median_ms,min_ms,mean_ms,p90_ms,stddev_ms";
+
+static std::string csvField(const std::string& text)
+{
+	std::string field = text;
+	std::replace(field.begin(), field.end(), ',', ';');
+	return field;
+}
+
+bool writeBenchmarkCsv(const std::string& fileName, const std::vector<BenchmarkResult>& results)
+{
+	std::ofstream file(fileName.c_str());
+	if (!file)
+		return false;
+	file << csvHeader << "\n" << std::setprecision(9);
+	for (size_t i = 0; i < results.size(); ++i) {
+		const BenchmarkResult& r = results[i];
+		file << csvField(r.stage) << "," << csvField(r.input) << "," << r.elements << "," << r.repetitions << ","
+			<< 1000.0 * r.median << "," << 1000.0 * r.minimum << "," << 1000.0 * r.mean << ","
+			<< 1000.0 * r.p90 << "," << 1000.0 * r.deviation << "\n";
+	}
+	return static_cast<bool>(file);
+}
+
+bool readBenchmarkCsv(const std::string& fileName, std::vector<BenchmarkResult>& results)
+{
+	std::ifstream file(fileName.c_str());
+	std::string line;
+	if (!file || !std::getline(file, line))
+		return false;
+
+	results.clear();
+	while (std::getline(file, line)) {
+		if (line.empty())
+			continue;
+		std::vector<std::string> fields;
+		std::istringstream row(line);
+		std::string field;
+		while (std::getline(row, field, ','))
+			fields.push_back(field);
+		if (fields.size() < 9)
+			return false;
+
+		BenchmarkResult r;
+		r.stage = fields[0];
+		r.input = fields[1];
+		r.elements = std::atof(fields[2].c_str());
+		r.repetitions = std::atoi(fields[3].c_str());
+		r.median = std::atof(fields[4].c_str()) / 1000.0;
+		r.minimum = std::atof(fields[5].c_str()) / 1000.0;
+		r.mean = std::atof(fields[6].c_str()) / 1000.0;
+		r.p90 = std::atof(fields[7].c_str()) / 1000.0;
+		r.deviation = std::atof(fields[8].c_str()) / 1000.0;
+		results.push_back(r);
+	}
+	return true;
+}
+
+int compareWithBaseline(const std::vector<BenchmarkResult>& results, const std::vector<BenchmarkResult>& baseline,
+	double threshold, std::ostream& os)
+{
+	int regressions = 0;
+	os << "| stage | input | baseline [ms] | now [ms] | change | |" << std::endl;
+	os << "|-------|-------|--------------:|---------:|-------:|-|" << std::endl;
+	os << std::fixed;
+	for (size_t i = 0; i < results.size(); ++i) {
+		const BenchmarkResult& r = results[i];
+		const BenchmarkResult *reference = nullptr;
+		for (size_t j = 0; j < baseline.size() && !reference; ++j)
+			if (baseline[j].stage == csvField(r.stage) && baseline[j].input == csvField(r.input))
+				reference = &baseline[j];
+
+		os << "| " << r.stage << " | " << r.input << " | ";
+		if (!reference || reference->median <= 0.0) {
+			os << "- | " << std::setprecision(3) << 1000.0 * r.median << " | - | new |" << std::endl;
+			continue;
+		}
+		double change = r.median / reference->median - 1.0;
+		bool regression = change > threshold;
+		if (regression)
+			++regressions;
+		os << std::setprecision(3) << 1000.0 * reference->median << " | " << 1000.0 * r.median << " | "
+			<< std::showpos << std::setprecision(1) << 100.0 * change << std::noshowpos << "% | "
+			<< (regression ? "REGRESSION" : "") << " |" << std::endl;
+	}
+	os << std::endl << regressions << " regression(s) beyond " << std::setprecision(0) << 100.0 * threshold << "%"
+		<< std::endl;
+	return regressions;
+}
@@ -0,0 +1,79 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+// Repeatable micro-benchmarks of single pipeline stages, with CSV output and regression checks against a baseline.
+// The same file is used by assignment 4 and assignment 5.
+//
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <ostream>
+
+/* Statistics of one stage on one input, times in seconds. */
+struct BenchmarkResult {
+	std::string stage;
+	std::string input;
+	double elements;        // samples, voxels or triangles of the input, for throughput
+	int repetitions;
+	double minimum;
+	double median;
+	double mean;
+	double p90;
+	double deviation;       // standard deviation
+};
+
+/* Command line of the bench programs:
+     --repetitions <n>      timed repetitions per stage (default 10)
+     --warmup <n>           untimed runs before (default 2)
+     --scales <a,b,...>     scale factors of the synthetic inputs
+     --output <file.csv>    writes all results
+     --baseline <file.csv>  compares the medians with a saved run
+     --threshold <fraction> slowdown reported as regression (default 0.1, i.e. 10 %) */
+struct BenchmarkOptions {
+	int repetitions;
+	int warmUp;
+	std::vector<double> scales;
+	std::string output;
+	std::string baseline;
+	double threshold;
+
+	BenchmarkOptions() : repetitions(10), warmUp(2), threshold(0.1) {}
+};
+
+/* Parses the options above, the scales keep their defaults if not given. Returns false on an unknown option. */
+bool parseBenchmarkOptions(int argc, char *argv[], BenchmarkOptions& options);
+
+/* Runs stages and collects their statistics. Every stage is executed WarmUp times untimed and Repetitions
+   times timed. The prepare function runs untimed before every execution, e.g. to mark a filter modified so
+   that its pipeline executes again. */
+class MicroBenchmark {
+public:
+	MicroBenchmark(const BenchmarkOptions& options);
+
+	const BenchmarkResult& Run(const std::string& stage, const std::string& input, double elements,
+		std::function<void()> body, std::function<void()> prepare = std::function<void()>());
+
+	const std::vector<BenchmarkResult>& GetResults() const { return results; }
+
+	/* Markdown table of all results so far. */
+	void PrintTable(std::ostream& os) const;
+
+	/* Writes the options output file, compares with the options baseline and prints the comparison.
+	   Returns the exit code of the bench program: 1 for regressions or unreadable files, else 0. */
+	int Finish(std::ostream& os) const;
+
+private:
+	BenchmarkOptions options;
+	std::vector<BenchmarkResult> results;
+};
+
+bool writeBenchmarkCsv(const std::string& fileName, const std::vector<BenchmarkResult>& results);
+bool readBenchmarkCsv(const std::string& fileName, std::vector<BenchmarkResult>& results);
+
+/* Prints the median of every result next to the baseline with the same stage and input and returns the number
+   of results that are slower than the baseline by more than the threshold. */
+int compareWithBaseline(const std::vector<BenchmarkResult>& results, const std::vector<BenchmarkResult>& baseline,
+	double threshold, std::ostream& os);
@@ -0,0 +1,162 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+
+#include "objecttracker.h"
+
+#include <vtkRenderer.h>
+#include <vtkRendererCollection.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkInteractorObserver.h>
+#include <vtkCamera.h>
+#include <vtkLight.h>
+#include <vtkLightCollection.h>
+#include <vtkPropCollection.h>
+#include <vtkActor.h>
+#include <vtkActor2D.h>
+#include <vtkVolume.h>
+#include <vtkProperty.h>
+#include <vtkVolumeProperty.h>
+#include <vtkTexture.h>
+#include <vtkLinearTransform.h>
+#include <vtkMapper.h>
+#include <vtkMapper2D.h>
+#include <vtkAbstractVolumeMapper.h>
+#include <vtkDataObject.h>
+#include <vtkAbstractArray.h>
+
+#include <iostream>
+#include <iomanip>
+
+ObjectTracker::ObjectTracker()
+	: enabled(false)
+{
+}
+
+ObjectTracker::~ObjectTracker()
+{
+	if (!enabled)
+		return;
+	// everything that was released properly is gone by now
+	std::cerr << "VTK objects still alive at shutdown:" << std::endl;
+	Report(std::cerr);
+}
+
+void ObjectTracker::Track(vtkObjectBase *object, const std::string& name)
+{
+	if (!enabled || !object)
+		return;
+
+	// an address may be reused by a new object once the tracked one is deleted
+	std::map<vtkObjectBase*, size_t>::iterator known = index.find(object);
+	if (known != index.end() && entries[known->second].object) {
+		if (!name.empty())
+			entries[known->second].name = name;
+		return;
+	}
+
+	Entry entry;
+	entry.object = object;
+	entry.className = object->GetClassName();
+	entry.name = name;
+	if (known != index.end())
+		entries[known->second] = entry;
+	else {
+		index[object] = entries.size();
+		entries.push_back(entry);
+	}
+}
+
+void ObjectTracker::trackAlgorithm(vtkAlgorithm *algorithm)
+{
+	// stop at algorithms that are tracked already, this also ends cycles
+	std::map<vtkObjectBase*, size_t>::iterator known = index.find(algorithm);
+	if (!algorithm || (known != index.end() && entries[known->second].object))
+		return;
+	Track(algorithm);
+
+	for (int port = 0; port < algorithm->GetNumberOfOutputPorts(); ++port)
+		Track(algorithm->GetOutputDataObject(port));
+	for (int port = 0; port < algorithm->GetNumberOfInputPorts(); ++port)
+		for (int connection = 0; connection < algorithm->GetNumberOfInputConnections(port); ++connection)
+			trackAlgorithm(algorithm->GetInputAlgorithm(port, connection));
+}
+
+void ObjectTracker::TrackScene(vtkRenderWindow *window)
+{
+	if (!enabled || !window)
+		return;
+
+	Track(window, "render window");
+	if (vtkRenderWindowInteractor *interactor = window->GetInteractor()) {
+		Track(interactor, "interactor");
+		Track(interactor->GetInteractorStyle(), "interactor style");
+	}
+
+	vtkRendererCollection *renderers = window->GetRenderers();
+	renderers->InitTraversal();
+	while (vtkRenderer *renderer = renderers->GetNextItem()) {
+		Track(renderer);
+		Track(renderer->GetActiveCamera());
+
+		vtkLightCollection *lights = renderer->GetLights();
+		lights->InitTraversal();
+		while (vtkLight *light = lights->GetNextItem())
+			Track(light);
+
+		vtkPropCollection *props = renderer->GetViewProps();
+		props->InitTraversal();
+		while (vtkProp *prop = props->GetNextProp()) {
+			Track(prop);
+			if (vtkProp3D *prop3D = vtkProp3D::SafeDownCast(prop))
+				Track(prop3D->GetUserTransform());
+			if (vtkActor *actor = vtkActor::SafeDownCast(prop)) {
+				Track(actor->GetProperty());
+				Track(actor->GetTexture());
+				trackAlgorithm(actor->GetMapper());
+			}
+			else if (vtkVolume *volume = vtkVolume::SafeDownCast(prop)) {
+				Track(volume->GetProperty());
+				trackAlgorithm(volume->GetMapper());
+			}
+			else if (vtkActor2D *actor2D = vtkActor2D::SafeDownCast(prop))
+				trackAlgorithm(actor2D->GetMapper());
+		}
+	}
+}
+
+size_t ObjectTracker::Report(std::ostream& os) const
+{
+	size_t live = 0;
+	double totalMemory = 0.0;
+	for (size_t i = 0; i < entries.size(); ++i) {
+		vtkObjectBase *object = entries[i].object;
+		if (!object)
+			continue;
+
+		// GetActualMemorySize reports kibibytes, shared arrays are counted by every data object that holds them
+		double memory = 0.0;
+		if (vtkDataObject *data = vtkDataObject::SafeDownCast(object))
+			memory = data->GetActualMemorySize();
+		else if (vtkAbstractArray *array = vtkAbstractArray::SafeDownCast(object))
+			memory = array->GetActualMemorySize();
+		totalMemory += memory;
+
+		os << std::left << std::setw(36) << entries[i].className << std::setw(20) << entries[i].name << std::right
+			<< " refs " << std::setw(3) << object->GetReferenceCount()
+			<< std::fixed << std::setprecision(1) << std::setw(12) << memory << " KiB" << std::endl;
+		++live;
+	}
+	os << live << " of " << entries.size() << " tracked objects alive, " << std::fixed << std::setprecision(2)
+		<< totalMemory / 1024.0 << " MiB in data objects" << std::endl;
+	return live;
+}
+
+void ObjectReportCallback::Execute(vtkObject *caller, unsigned long eventId, void *callData)
+{
+	vtkRenderWindowInteractor *interactor = static_cast<vtkRenderWindowInteractor*>(caller);
+	if (!tracker || !tracker->GetEnabled() || interactor->GetKeyCode() != key)
+		return;
+	tracker->TrackScene(window);
+	tracker->Report(std::cout);
+}
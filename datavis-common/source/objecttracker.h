@@ -0,0 +1,77 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+// Debug accounting of the VTK objects of a scene: which objects are alive, how often they are referenced
+// and how much memory they hold. Objects still alive when the tracker is destroyed are reported as leaks.
+// The same file is used by assignment 4 and assignment 5.
+//
+
+#pragma once
+
+#include <vtkSmartPointer.h>
+#include <vtkWeakPointer.h>
+#include <vtkObjectBase.h>
+#include <vtkAlgorithm.h>
+#include <vtkRenderWindow.h>
+#include <vtkCommand.h>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <ostream>
+
+/* Keeps weak references to the tracked objects, so tracking never changes their lifetime.
+   Declare the tracker before all smart pointers of a scope: it is destroyed after them, and every tracked object
+   that is still alive at that point is leaked (a reference that was never released) and is reported on std::cerr.
+   A disabled tracker records nothing. */
+class ObjectTracker {
+public:
+	ObjectTracker();
+	~ObjectTracker();
+
+	void SetEnabled(bool enabled) { this->enabled = enabled; }
+	bool GetEnabled() const { return enabled; }
+
+	/* Tracks a single object. */
+	void Track(vtkObjectBase *object, const std::string& name = std::string());
+
+	/* Tracks everything reachable from the window: interactor and interactor style, renderers, cameras, lights,
+	   props with their mappers, properties and transforms, and the complete upstream pipeline of every mapper
+	   including the output data objects. Calling it again adds objects created since the last call. */
+	void TrackScene(vtkRenderWindow *window);
+
+	/* Prints class, name, reference count and memory of every tracked object that is still alive.
+	   Returns the number of live objects. */
+	size_t Report(std::ostream& os) const;
+
+private:
+	ObjectTracker(const ObjectTracker&) = delete;
+	void operator=(const ObjectTracker&) = delete;
+
+	void trackAlgorithm(vtkAlgorithm *algorithm);
+
+	struct Entry {
+		vtkWeakPointer<vtkObjectBase> object;
+		std::string className;
+		std::string name;
+	};
+
+	bool enabled;
+	std::vector<Entry> entries;
+	std::map<vtkObjectBase*, size_t> index;
+};
+
+/* Prints the report of a tracker when a key is pressed, after looking for new objects in the scene. */
+class ObjectReportCallback : public vtkCommand {
+private:
+	ObjectReportCallback() : tracker(nullptr), key('o') {}
+
+public:
+	ObjectTracker *tracker;
+	vtkWeakPointer<vtkRenderWindow> window;
+	char key;
+
+	static ObjectReportCallback *New() { return new ObjectReportCallback; }
+
+	virtual void Execute(vtkObject *caller, unsigned long eventId, void *callData);
+};
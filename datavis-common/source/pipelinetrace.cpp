@@ -0,0 +1,284 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+
+#include "pipelinetrace.h"
+
+#include <vtkObjectFactory.h>
+#include <vtkExecutionTimer.h>
+#include <vtkTimerLog.h>
+#include <vtkRenderTimerLog.h>
+#include <vtkRenderer.h>
+#include <vtkRendererCollection.h>
+#include <vtkRenderWindowInteractor.h>
+
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <deque>
+
+// GPU render passes get their own track in the trace viewer
+static const int gpuTrack = 1000;
+
+// ----- filter spans -----
+class TraceExecutionTimer : public vtkExecutionTimer {
+public:
+	static TraceExecutionTimer *New();
+	vtkTypeMacro(TraceExecutionTimer, vtkExecutionTimer);
+
+	PipelineTrace *trace;
+	std::string name;
+
+protected:
+	TraceExecutionTimer() : trace(nullptr) {}
+	~TraceExecutionTimer() override {}
+
+	// called by vtkExecutionTimer on the EndEvent of the filter
+	void TimerFinished() override {
+		if (trace)
+			trace->AddSpan(name, "pipeline", WallClockStartTime, WallClockEndTime);
+	}
+
+private:
+	TraceExecutionTimer(const TraceExecutionTimer&) = delete;
+	void operator=(const TraceExecutionTimer&) = delete;
+};
+
+vtkStandardNewMacro(TraceExecutionTimer);
+
+// ----- render spans -----
+class PipelineTrace::RenderObserver : public vtkCommand {
+private:
+	RenderObserver() : trace(nullptr), window(nullptr) {}
+
+public:
+	PipelineTrace *trace;
+	vtkRenderWindow *window;
+
+	static RenderObserver *New() { return new RenderObserver; }
+
+	virtual void Execute(vtkObject *caller, unsigned long eventId, void *callData) {
+		double now = vtkTimerLog::GetUniversalTime();
+		if (eventId == vtkCommand::StartEvent) {
+			starts[caller] = now;
+			return;
+		}
+
+		std::map<vtkObject*, double>::iterator start = starts.find(caller);
+		if (start == starts.end())
+			return;
+		if (caller != window) {
+			trace->AddSpan(caller->GetClassName(), "render", start->second, now);
+			return;
+		}
+		trace->AddSpan("vtkRenderWindow::Render", "render", start->second, now);
+
+		// GPU timings arrive a few frames late, each frame is anchored at the start of the Render() that issued it
+		vtkRenderTimerLog *gpuLog = window->GetRenderTimer();
+		if (!gpuLog->IsSupported())
+			return;
+		gpuLog->MarkFrame();
+		frameStarts.push_back(start->second);
+		while (gpuLog->FrameReady() && !frameStarts.empty()) {
+			vtkRenderTimerLog::Frame frame = gpuLog->PopFirstReadyFrame();
+			double anchor = frameStarts.front();
+			frameStarts.pop_front();
+			if (!frame.Events.empty())
+				addGpuEvents(frame.Events, frame.Events.front().StartTime, anchor);
+		}
+		// frames without any GPU event are never reported, do not let the anchors pile up
+		while (frameStarts.size() > 2 * gpuLog->GetFrameLimit() + 2)
+			frameStarts.pop_front();
+	}
+
+	void Reset() {
+		starts.clear();
+		frameStarts.clear();
+	}
+
+private:
+	void addGpuEvents(const std::vector<vtkRenderTimerLog::Event>& events, vtkTypeUInt64 origin, double anchor) {
+		for (size_t i = 0; i < events.size(); ++i) {
+			double start = anchor + 1e-9 * static_cast<double>(events[i].StartTime - origin);
+			trace->AddSpan(events[i].Name, "gpu", start, start + events[i].ElapsedTimeSeconds(), gpuTrack);
+			addGpuEvents(events[i].Events, origin, anchor);
+		}
+	}
+
+	std::map<vtkObject*, double> starts;
+	std::deque<double> frameStarts;
+};
+
+// ----- trace -----
+PipelineTrace::PipelineTrace()
+	: enabled(true), sessionStart(vtkTimerLog::GetUniversalTime())
+{
+}
+
+PipelineTrace::~PipelineTrace()
+{
+	SetEnabled(false);
+}
+
+void PipelineTrace::AddFilter(vtkAlgorithm *filter, const std::string& name)
+{
+	TracedFilter traced;
+	traced.filter = filter;
+	traced.timer = vtkSmartPointer<TraceExecutionTimer>::New();
+	traced.timer->trace = this;
+	traced.timer->name = name.empty() ? std::string(filter->GetClassName()) : name;
+	if (enabled)
+		traced.timer->SetFilter(filter);
+	filters.push_back(traced);
+}
+
+void PipelineTrace::AddRenderWindow(vtkRenderWindow *window)
+{
+	TracedWindow traced;
+	traced.window = window;
+	traced.observer = vtkSmartPointer<RenderObserver>::New();
+	traced.observer->trace = this;
+	traced.observer->window = window;
+	windows.push_back(traced);
+	if (enabled)
+		attach(windows.back());
+}
+
+void PipelineTrace::attach(TracedWindow& traced)
+{
+	vtkRenderWindow *window = traced.window;
+	if (!window)
+		return;
+	traced.observer->Reset();
+	std::vector<vtkObject*> observed(1, window);
+	vtkRendererCollection *renderers = window->GetRenderers();
+	renderers->InitTraversal();
+	while (vtkRenderer *renderer = renderers->GetNextItem())
+		observed.push_back(renderer);
+
+	for (size_t i = 0; i < observed.size(); ++i) {
+		traced.tags.push_back(std::make_pair(vtkWeakPointer<vtkObject>(observed[i]), observed[i]->AddObserver(vtkCommand::StartEvent, traced.observer)));
+		traced.tags.push_back(std::make_pair(vtkWeakPointer<vtkObject>(observed[i]), observed[i]->AddObserver(vtkCommand::EndEvent, traced.observer)));
+	}
+	window->GetRenderTimer()->LoggingEnabledOn();
+}
+
+void PipelineTrace::detach(TracedWindow& traced)
+{
+	for (size_t i = 0; i < traced.tags.size(); ++i)
+		if (vtkObject *observed = traced.tags[i].first)
+			observed->RemoveObserver(traced.tags[i].second);
+	traced.tags.clear();
+
+	vtkRenderWindow *window = traced.window;
+	if (window)
+		window->GetRenderTimer()->LoggingEnabledOff();
+}
+
+void PipelineTrace::SetEnabled(bool enabled)
+{
+	if (this->enabled == enabled)
+		return;
+	this->enabled = enabled;
+
+	for (size_t i = 0; i < filters.size(); ++i)
+		filters[i].timer->SetFilter(enabled ? filters[i].filter.GetPointer() : nullptr);
+	for (size_t i = 0; i < windows.size(); ++i) {
+		if (enabled)
+			attach(windows[i]);
+		else
+			detach(windows[i]);
+	}
+}
+
+int PipelineTrace::threadTrack()
+{
+	// called with spansMutex held, the first thread that records a span is track 1
+	std::map<std::thread::id, int>::iterator track = threadTracks.find(std::this_thread::get_id());
+	if (track != threadTracks.end())
+		return track->second;
+	int next = static_cast<int>(threadTracks.size()) + 1;
+	threadTracks[std::this_thread::get_id()] = next;
+	return next;
+}
+
+void PipelineTrace::AddSpan(const std::string& name, const char *category, double start, double end, int track)
+{
+	std::lock_guard<std::mutex> lock(spansMutex);
+	Span span;
+	span.name = name;
+	span.category = category;
+	span.start = start - sessionStart;
+	span.duration = end - start;
+	span.track = track < 0 ? threadTrack() : track;
+	spans.push_back(span);
+}
+
+size_t PipelineTrace::GetNumberOfSpans() const
+{
+	std::lock_guard<std::mutex> lock(spansMutex);
+	return spans.size();
+}
+
+static void writeJsonString(std::ostream& os, const std::string& text)
+{
+	os << '"';
+	for (size_t i = 0; i < text.size(); ++i) {
+		char c = text[i];
+		if (c == '"' || c == '\\')
+			os << '\\' << c;
+		else if (static_cast<unsigned char>(c) < 0x20)
+			os << ' ';
+		else
+			os << c;
+	}
+	os << '"';
+}
+
+bool PipelineTrace::Write(const std::string& fileName) const
+{
+	std::ofstream file(fileName.c_str());
+	if (!file)
+		return false;
+
+	std::lock_guard<std::mutex> lock(spansMutex);
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << std::endl;
+
+	// track names
+	file << "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"visualization pipeline\"}}";
+	for (std::map<std::thread::id, int>::const_iterator track = threadTracks.begin(); track != threadTracks.end(); ++track)
+		file << ",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << track->second
+			<< ",\"args\":{\"name\":\"CPU thread " << track->second << "\"}}";
+	file << ",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << gpuTrack << ",\"args\":{\"name\":\"GPU\"}}";
+
+	// complete events, times in microseconds
+	file << std::fixed << std::setprecision(3);
+	for (size_t i = 0; i < spans.size(); ++i) {
+		file << ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":" << spans[i].track << ",\"cat\":\"" << spans[i].category << "\",\"name\":";
+		writeJsonString(file, spans[i].name);
+		file << ",\"ts\":" << 1e6 * spans[i].start << ",\"dur\":" << 1e6 * spans[i].duration << "}";
+	}
+	file << "\n]}" << std::endl;
+	return static_cast<bool>(file);
+}
+
+void writeTrace(const PipelineTrace& trace, const std::string& fileName)
+{
+	if (trace.GetNumberOfSpans() == 0)
+		return;
+	if (trace.Write(fileName))
+		std::cout << trace.GetNumberOfSpans() << " trace spans written to " << fileName << std::endl;
+	else
+		std::cerr << "could not write the trace " << fileName << std::endl;
+}
+
+// ----- key toggle -----
+void TraceToggleCallback::Execute(vtkObject *caller, unsigned long eventId, void *callData)
+{
+	vtkRenderWindowInteractor *interactor = static_cast<vtkRenderWindowInteractor*>(caller);
+	if (!trace || interactor->GetKeyCode() != key)
+		return;
+	trace->SetEnabled(!trace->GetEnabled());
+	std::cout << "pipeline trace " << (trace->GetEnabled() ? "on" : "off") << " ("
+		<< trace->GetNumberOfSpans() << " spans recorded)" << std::endl;
+}
@@ -0,0 +1,111 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+// Execution tracing of the visualization pipeline, written in the Chrome trace event format
+// (load the file in chrome://tracing or https://ui.perfetto.dev).
+// The same file is used by assignment 4 and assignment 5.
+//
+
+#pragma once
+
+#include <vtkSmartPointer.h>
+#include <vtkWeakPointer.h>
+#include <vtkAlgorithm.h>
+#include <vtkRenderWindow.h>
+#include <vtkCommand.h>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+class TraceExecutionTimer;
+
+/* Records where the time of a session goes:
+   - one span per RequestData of every added filter, measured by a vtkExecutionTimer on its Start/EndEvent
+   - one span per Render() of every added window and of each of its renderers
+   - the render passes of every frame as measured on the GPU by the vtkRenderTimerLog of the window, if supported.
+     GPU timestamps have their own clock, every GPU frame is placed at the start of the Render() that issued it.
+   Tracing can be switched on and off at any time. While off, all observers are detached, so the pipeline runs
+   exactly as without tracing. */
+class PipelineTrace {
+public:
+	PipelineTrace();
+	~PipelineTrace();
+
+	/* Traces every execution of the filter. The name defaults to the class name. */
+	void AddFilter(vtkAlgorithm *filter, const std::string& name = std::string());
+
+	/* Traces every render of the window and of its renderers, including the GPU render passes. */
+	void AddRenderWindow(vtkRenderWindow *window);
+
+	void SetEnabled(bool enabled);
+	bool GetEnabled() const { return enabled; }
+
+	/* Number of recorded spans. */
+	size_t GetNumberOfSpans() const;
+
+	/* Writes all spans recorded so far as Chrome trace JSON. */
+	bool Write(const std::string& fileName) const;
+
+	/* Adds a span, times are vtkTimerLog::GetUniversalTime() seconds. Thread-safe. */
+	void AddSpan(const std::string& name, const char *category, double start, double end, int track = -1);
+
+private:
+	PipelineTrace(const PipelineTrace&) = delete;
+	void operator=(const PipelineTrace&) = delete;
+
+	class RenderObserver;
+	friend class RenderObserver;
+
+	struct Span {
+		std::string name;
+		const char *category;
+		double start;
+		double duration;
+		int track;
+	};
+
+	struct TracedFilter {
+		vtkWeakPointer<vtkAlgorithm> filter;
+		vtkSmartPointer<TraceExecutionTimer> timer;
+	};
+
+	struct TracedWindow {
+		vtkWeakPointer<vtkRenderWindow> window;
+		vtkSmartPointer<RenderObserver> observer;
+		std::vector<std::pair<vtkWeakPointer<vtkObject>, unsigned long>> tags;
+	};
+
+	int threadTrack();
+	void attach(TracedWindow& traced);
+	void detach(TracedWindow& traced);
+
+	bool enabled;
+	double sessionStart;
+	std::vector<TracedFilter> filters;
+	std::vector<TracedWindow> windows;
+
+	mutable std::mutex spansMutex;
+	std::vector<Span> spans;
+	std::map<std::thread::id, int> threadTracks;
+};
+
+/* Writes the trace to the file if anything was recorded and reports the result on the console. */
+void writeTrace(const PipelineTrace& trace, const std::string& fileName);
+
+/* Switches a trace on and off with a key of the interactor. */
+class TraceToggleCallback : public vtkCommand {
+private:
+	TraceToggleCallback() : trace(nullptr), key('l') {}
+
+public:
+	PipelineTrace *trace;
+	char key;
+
+	static TraceToggleCallback *New() { return new TraceToggleCallback; }
+
+	virtual void Execute(vtkObject *caller, unsigned long eventId, void *callData);
+};
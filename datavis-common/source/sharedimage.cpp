@@ -0,0 +1,451 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+
+#include "sharedimage.h"
+
+#include <vtkPointData.h>
+#include <vtkDataArray.h>
+
+#include <atomic>
+#include <new>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// ----- segment layout -----
+namespace {
+	const char sharedImageMagic[8] = { 'V', 'T', 'K', 'I', 'M', 'G', '0', '1' };
+	const char sharedDirectoryMagic[8] = { 'V', 'T', 'K', 'I', 'D', 'I', 'R', '1' };
+
+	// the segment under the published name, the generation of the current image segment
+	struct SharedImageDirectory {
+		char magic[8];
+		std::atomic<unsigned long long> generation;
+	};
+
+	// the scalars start at the first page after the header
+	const size_t dataOffset = 4096;
+
+	struct SharedImageHeader {
+		char magic[8];
+		// odd (or 0) while the publisher writes the segment, even once header and scalars are complete
+		std::atomic<unsigned long long> generation;
+		// set when the name refers to a newer, complete segment
+		std::atomic<unsigned int> superseded;
+		int scalarType;
+		int components;
+		int dimensions[3];
+		double spacing[3];
+		double origin[3];
+		unsigned long long dataBytes;
+		char arrayName[64];
+	};
+
+	std::string segmentName(const std::string& name, unsigned long long generation)
+	{
+		return name + "." + std::to_string(generation);
+	}
+
+	// maps the current image segment of a name, nullptr while there is none
+	SharedSegment *openCurrentSegment(const std::string& name)
+	{
+		SharedSegment directory;
+		if (!directory.Open(name) || directory.GetSize() < sizeof(SharedImageDirectory))
+			return nullptr;
+		const SharedImageDirectory *header = static_cast<const SharedImageDirectory*>(directory.GetData());
+		const unsigned long long generation = header->generation.load();
+		if (generation == 0 || std::memcmp(header->magic, sharedDirectoryMagic, sizeof(sharedDirectoryMagic)) != 0)
+			return nullptr;
+		SharedSegment *segment = new SharedSegment;
+		if (!segment->Open(segmentName(name, generation))) {
+			delete segment;
+			return nullptr;
+		}
+		return segment;
+	}
+
+	bool sameLayout(const SharedImageHeader *header, vtkImageData *image, vtkDataArray *scalars)
+	{
+		int *dimensions = image->GetDimensions();
+		return header->scalarType == scalars->GetDataType() && header->components == scalars->GetNumberOfComponents()
+			&& header->dimensions[0] == dimensions[0] && header->dimensions[1] == dimensions[1]
+			&& header->dimensions[2] == dimensions[2];
+	}
+}
+
+// ----- shared segment -----
+SharedSegment::SharedSegment()
+	: data(nullptr), size(0), handle(nullptr)
+{
+}
+
+SharedSegment::~SharedSegment()
+{
+	Close();
+}
+
+#ifdef _WIN32
+bool SharedSegment::Create(const std::string& name, size_t bytes)
+{
+	Close();
+	this->name = "Local\\" + name;
+	unsigned long long size64 = bytes;
+	HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+		static_cast<DWORD>(size64 >> 32), static_cast<DWORD>(size64 & 0xffffffffu), this->name.c_str());
+	if (!mapping)
+		return false;
+	// a mapping lives as long as anybody holds it, a name still in use by viewers cannot get a new size
+	if (GetLastError() == ERROR_ALREADY_EXISTS) {
+		CloseHandle(mapping);
+		return false;
+	}
+	data = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes);
+	if (!data) {
+		CloseHandle(mapping);
+		return false;
+	}
+	handle = mapping;
+	size = bytes;
+	return true;
+}
+
+bool SharedSegment::Open(const std::string& name)
+{
+	Close();
+	this->name = "Local\\" + name;
+	HANDLE mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, this->name.c_str());
+	if (!mapping)
+		return false;
+	data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	MEMORY_BASIC_INFORMATION region;
+	if (!data || !VirtualQuery(data, &region, sizeof(region))) {
+		if (data)
+			UnmapViewOfFile(data);
+		data = nullptr;
+		CloseHandle(mapping);
+		return false;
+	}
+	handle = mapping;
+	size = region.RegionSize;
+	return true;
+}
+
+void SharedSegment::Unlink()
+{
+	// named mappings disappear with their last handle
+}
+
+void SharedSegment::Close()
+{
+	if (data)
+		UnmapViewOfFile(data);
+	if (handle)
+		CloseHandle(static_cast<HANDLE>(handle));
+	data = nullptr;
+	handle = nullptr;
+	size = 0;
+}
+#else
+bool SharedSegment::Create(const std::string& name, size_t bytes)
+{
+	Close();
+	this->name = "/" + name;
+	shm_unlink(this->name.c_str());
+	int descriptor = shm_open(this->name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+	if (descriptor < 0)
+		return false;
+	if (ftruncate(descriptor, static_cast<off_t>(bytes)) != 0) {
+		close(descriptor);
+		shm_unlink(this->name.c_str());
+		return false;
+	}
+	void *mapped = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+	close(descriptor);
+	if (mapped == MAP_FAILED) {
+		shm_unlink(this->name.c_str());
+		return false;
+	}
+	data = mapped;
+	size = bytes;
+	return true;
+}
+
+bool SharedSegment::Open(const std::string& name)
+{
+	Close();
+	this->name = "/" + name;
+	int descriptor = shm_open(this->name.c_str(), O_RDONLY, 0);
+	if (descriptor < 0)
+		return false;
+	struct stat status;
+	if (fstat(descriptor, &status) != 0 || status.st_size <= 0) {
+		close(descriptor);
+		return false;
+	}
+	void *mapped = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_SHARED, descriptor, 0);
+	close(descriptor);
+	if (mapped == MAP_FAILED)
+		return false;
+	data = mapped;
+	size = static_cast<size_t>(status.st_size);
+	return true;
+}
+
+void SharedSegment::Unlink()
+{
+	if (!name.empty())
+		shm_unlink(name.c_str());
+}
+
+void SharedSegment::Close()
+{
+	if (data)
+		munmap(data, size);
+	data = nullptr;
+	size = 0;
+}
+#endif
+
+// ----- publisher -----
+SharedImagePublisher::SharedImagePublisher()
+	: directory(nullptr), segment(nullptr), previous(nullptr)
+{
+}
+
+SharedImagePublisher::~SharedImagePublisher()
+{
+	if (directory)
+		directory->Unlink();
+	if (segment)
+		segment->Unlink();
+	delete directory;
+	delete segment;
+	delete previous;
+}
+
+unsigned long long SharedImagePublisher::GetGeneration() const
+{
+	return segment ? static_cast<SharedImageHeader*>(segment->GetData())->generation.load() : 0;
+}
+
+bool SharedImagePublisher::Publish(const std::string& name, vtkImageData *image)
+{
+	vtkDataArray *scalars = image ? image->GetPointData()->GetScalars() : nullptr;
+	if (!scalars)
+		return false;
+	unsigned long long bytes = static_cast<unsigned long long>(scalars->GetNumberOfTuples())
+		* scalars->GetNumberOfComponents() * scalars->GetDataTypeSize();
+
+	// the directory under the name, created with the first image
+	if (!directory || name != this->name) {
+		SharedSegment *created = new SharedSegment;
+		if (!created->Create(name, sizeof(SharedImageDirectory))) {
+			delete created;
+			return false;
+		}
+		if (directory)
+			directory->Unlink();
+		delete directory;
+		directory = created;
+		SharedImageDirectory *entry = new (directory->GetData()) SharedImageDirectory();
+		std::memcpy(entry->magic, sharedDirectoryMagic, sizeof(sharedDirectoryMagic));
+		entry->generation.store(0);
+		this->name = name;
+	}
+	SharedImageDirectory *entry = static_cast<SharedImageDirectory*>(directory->GetData());
+
+	// viewers may still read the current segment, the image goes to a new one
+	const unsigned long long generation = segment ? static_cast<SharedImageHeader*>(segment->GetData())->generation.load() + 2 : 2;
+	SharedSegment *created = new SharedSegment;
+	if (!created->Create(segmentName(name, generation), dataOffset + static_cast<size_t>(bytes))) {
+		delete created;
+		return false;
+	}
+
+	// the viewers refuse odd generations, the even one is stored after everything else is written
+	SharedImageHeader *header = new (created->GetData()) SharedImageHeader();
+	header->generation.store(generation - 1);
+	header->superseded.store(0);
+	std::memcpy(header->magic, sharedImageMagic, sizeof(sharedImageMagic));
+	header->scalarType = scalars->GetDataType();
+	header->components = scalars->GetNumberOfComponents();
+	image->GetDimensions(header->dimensions);
+	image->GetSpacing(header->spacing);
+	image->GetOrigin(header->origin);
+	header->dataBytes = bytes;
+	std::strncpy(header->arrayName, scalars->GetName() ? scalars->GetName() : "scalars", sizeof(header->arrayName) - 1);
+	char *data = static_cast<char*>(created->GetData()) + dataOffset;
+	std::memcpy(data, scalars->GetVoidPointer(0), static_cast<size_t>(bytes));
+	header->generation.store(generation);
+
+	// only now the name leads to the new segment and the viewers of the old one look it up. The old name is removed,
+	// mappings of it stay valid
+	entry->generation.store(generation);
+	if (segment) {
+		static_cast<SharedImageHeader*>(segment->GetData())->superseded.store(1);
+		segment->Unlink();
+	}
+	delete previous;
+	previous = segment;
+	segment = created;
+
+	// from now on the loader uses the published scalars, its own copy is released
+	scalars->SetVoidArray(data, scalars->GetNumberOfTuples() * scalars->GetNumberOfComponents(), 1);
+	return true;
+}
+
+// ----- view -----
+SharedImageView::SharedImageView()
+	: segment(nullptr), previous(nullptr), generation(0)
+{
+}
+
+SharedImageView::~SharedImageView()
+{
+	delete segment;
+	delete previous;
+}
+
+bool SharedImageView::Attach(const std::string& name)
+{
+	SharedSegment *opened = openCurrentSegment(name);
+	if (!opened || !wrap(opened)) {
+		delete opened;
+		return false;
+	}
+	delete previous;
+	previous = segment;
+	segment = opened;
+	this->name = name;
+	return true;
+}
+
+bool SharedImageView::wrap(const SharedSegment *source)
+{
+	// the generation is read first: once it is even, the publisher has written everything before it
+	const SharedImageHeader *header = static_cast<const SharedImageHeader*>(source->GetData());
+	if (source->GetSize() < dataOffset)
+		return false;
+	const unsigned long long current = header->generation.load();
+	if (current == 0 || (current & 1) || std::memcmp(header->magic, sharedImageMagic, sizeof(sharedImageMagic)) != 0
+		|| dataOffset + header->dataBytes > source->GetSize())
+		return false;
+
+	vtkSmartPointer<vtkDataArray> scalars;
+	scalars.TakeReference(vtkDataArray::CreateDataArray(header->scalarType));
+	if (!scalars || header->components < 1)
+		return false;
+	scalars->SetNumberOfComponents(header->components);
+	scalars->SetName(std::string(header->arrayName, strnlen(header->arrayName, sizeof(header->arrayName))).c_str());
+	// the mapping is read-only, the filters only read their input scalars. save = 1: VTK never frees the memory
+	scalars->SetVoidArray(static_cast<char*>(source->GetData()) + dataOffset,
+		static_cast<vtkIdType>(header->dataBytes / scalars->GetDataTypeSize()), 1);
+
+	// the same image object is reused, pipelines that hold it stay connected
+	if (!image)
+		image = vtkSmartPointer<vtkImageData>::New();
+	image->SetDimensions(header->dimensions[0], header->dimensions[1], header->dimensions[2]);
+	image->SetSpacing(header->spacing[0], header->spacing[1], header->spacing[2]);
+	image->SetOrigin(header->origin[0], header->origin[1], header->origin[2]);
+	image->GetPointData()->SetScalars(scalars);
+	generation = current;
+	return true;
+}
+
+SharedImageView::Change SharedImageView::Refresh()
+{
+	if (!segment)
+		return Unchanged;
+	const SharedImageHeader *header = static_cast<const SharedImageHeader*>(segment->GetData());
+	if (!header->superseded.load())
+		return Unchanged;
+
+	// the new segment replaces the current one only once it is wrapped, until then the next poll tries again
+	SharedSegment *opened = openCurrentSegment(name);
+	if (!opened || !wrap(opened)) {
+		// the publisher is gone or in the middle of writing a newer segment
+		delete opened;
+		return Unchanged;
+	}
+	const bool reshaped = !sameLayout(header, image, image->GetPointData()->GetScalars());
+	delete previous;
+	previous = segment;
+	segment = opened;
+	return reshaped ? Reshaped : Modified;
+}
+
+void SharedImageView::PrintInformation(std::ostream& os) const
+{
+	if (!image)
+		return;
+	int *dimensions = image->GetDimensions();
+	vtkDataArray *scalars = image->GetPointData()->GetScalars();
+	os << "shared image " << name << ": " << dimensions[0] << " x " << dimensions[1] << " x " << dimensions[2] << " "
+		<< scalars->GetDataTypeAsString() << ", " << std::fixed << std::setprecision(1)
+		<< scalars->GetNumberOfTuples() * scalars->GetNumberOfComponents() * scalars->GetDataTypeSize() / (1024.0 * 1024.0)
+		<< " MiB mapped, generation " << generation << std::endl;
+}
+
+// ----- watcher -----
+void SharedImageWatcher::Attach(vtkRenderWindowInteractor *interactor)
+{
+	this->interactor = interactor;
+	interactor->AddObserver(vtkCommand::RenderEvent, this);
+	interactor->AddObserver(vtkCommand::TimerEvent, this);
+}
+
+void SharedImageWatcher::Execute(vtkObject *caller, unsigned long eventId, void *callData)
+{
+	if (eventId == vtkCommand::RenderEvent) {
+		if (timerId < 0 && interactor && interactor->GetInitialized())
+			timerId = interactor->CreateRepeatingTimer(Interval);
+		return;
+	}
+	if (eventId != vtkCommand::TimerEvent || !callData || *static_cast<int*>(callData) != timerId || !view)
+		return;
+
+	SharedImageView::Change change = view->Refresh();
+	if (change != SharedImageView::Unchanged && update)
+		update(change);
+}
+
+// ----- loader mode -----
+int runImagePublisher(vtkAlgorithm *source, const std::string& name, std::ostream& os)
+{
+	SharedImagePublisher publisher;
+	std::string line;
+	do {
+		// the scalars of the last read are the published segment now. The next read gets a fresh array, a reader that
+		// reuses the memory of its output would otherwise decode into the segment the viewers are mapping
+		if (vtkImageData *last = vtkImageData::SafeDownCast(source->GetOutputDataObject(0)))
+			if (vtkDataArray *published = last->GetPointData()->GetScalars()) {
+				vtkSmartPointer<vtkDataArray> fresh;
+				fresh.TakeReference(published->NewInstance());
+				fresh->SetNumberOfComponents(published->GetNumberOfComponents());
+				fresh->SetName(published->GetName());
+				last->GetPointData()->SetScalars(fresh);
+			}
+		source->Modified();
+		source->Update();
+		vtkImageData *image = vtkImageData::SafeDownCast(source->GetOutputDataObject(0));
+		if (!publisher.Publish(name, image)) {
+			std::cerr << "could not publish the image as " << name << std::endl;
+			return 1;
+		}
+		int *dimensions = image->GetDimensions();
+		os << "published " << name << ": " << dimensions[0] << " x " << dimensions[1] << " x " << dimensions[2]
+			<< ", generation " << publisher.GetGeneration() << ". Enter publishes a fresh read, end of input quits."
+			<< std::endl;
+	} while (std::getline(std::cin, line));
+	return 0;
+}
@@ -0,0 +1,139 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+// Hands a decoded vtkImageData from a loader process to viewer processes through shared memory, without copies.
+// The same file is used by assignment 4 and assignment 5.
+//
+
+#pragma once
+
+#include <vtkSmartPointer.h>
+#include <vtkWeakPointer.h>
+#include <vtkImageData.h>
+#include <vtkAlgorithm.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkCommand.h>
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <ostream>
+
+/* A named shared memory segment (POSIX shm_open and mmap, a named file mapping on Windows), unmapped on
+   destruction. The name stays until the creator calls Unlink(). */
+class SharedSegment {
+public:
+	SharedSegment();
+	~SharedSegment();
+
+	/* Creates and maps a new segment of the given size, replacing a segment of the same name. */
+	bool Create(const std::string& name, size_t bytes);
+
+	/* Maps an existing segment read-only. */
+	bool Open(const std::string& name);
+
+	/* Removes the name, mappings stay valid until they are closed. */
+	void Unlink();
+
+	void Close();
+
+	void *GetData() const { return data; }
+	size_t GetSize() const { return size; }
+
+private:
+	SharedSegment(const SharedSegment&) = delete;
+	void operator=(const SharedSegment&) = delete;
+
+	std::string name;
+	void *data;
+	size_t size;
+	void *handle;       // file mapping handle on Windows
+};
+
+/* Publishes the point scalars of images under a name. Every image goes to a new segment, named after the name
+   and its generation, a segment is never rewritten while viewers may read it. The segment starts with a small
+   header (magic, layout, generation), the scalars follow at the next page. The name itself holds a small
+   directory segment with the generation of the current image. A new image is written completely, with an even
+   generation, then the directory points to it and only then the old segment is marked superseded, so viewers
+   that look up the name always find a complete image. */
+class SharedImagePublisher {
+public:
+	SharedImagePublisher();
+	~SharedImagePublisher();
+
+	/* Copies the scalars into the segment once. The scalars of the image then point into the segment as well,
+	   so the loader does not keep a second copy. Returns false if the segment could not be created. */
+	bool Publish(const std::string& name, vtkImageData *image);
+
+	unsigned long long GetGeneration() const;
+
+private:
+	std::string name;
+	SharedSegment *directory;
+	SharedSegment *segment;
+	// the segment before stays mapped, the image published before may still use its scalars
+	SharedSegment *previous;
+};
+
+/* A read-only image on the scalars of a published segment. The scalar array wraps the mapped memory
+   (SetVoidArray), no voxel is copied: every additional viewer costs no data memory. Keep the view alive as long
+   as the image or anything that shares its scalars is used. */
+class SharedImageView {
+public:
+	enum Change { Unchanged, Modified, Reshaped };
+
+	SharedImageView();
+	~SharedImageView();
+
+	/* Maps the named segment and sets up the image. Returns false if there is no valid segment of that name. */
+	bool Attach(const std::string& name);
+
+	/* Looks for a newer segment: Modified if the image got new scalars with the same layout, Reshaped if it got a
+	   new layout. The image object stays the same, its scalar array is a new one on the new segment, so the
+	   pipeline executes again. The current segment is only replaced once the new one is valid. */
+	Change Refresh();
+
+	vtkImageData *GetImage() const { return image; }
+	unsigned long long GetGeneration() const { return generation; }
+
+	void PrintInformation(std::ostream& os) const;
+
+private:
+	// sets up the image on a complete segment, false (and the image unchanged) for an invalid or unfinished one
+	bool wrap(const SharedSegment *source);
+
+	std::string name;
+	SharedSegment *segment;
+	// the segment before stays mapped until the next refresh, filter outputs may still reference its scalars
+	SharedSegment *previous;
+	vtkSmartPointer<vtkImageData> image;
+	unsigned long long generation;
+};
+
+/* Polls a shared image on a repeating interactor timer and calls the update function on every change. */
+class SharedImageWatcher : public vtkCommand {
+private:
+	SharedImageWatcher() : view(nullptr), Interval(100), timerId(-1) {}
+
+public:
+	static SharedImageWatcher *New() { return new SharedImageWatcher; }
+
+	SharedImageView *view;
+	std::function<void(SharedImageView::Change)> update;
+
+	/* Milliseconds between two polls, default 100. */
+	unsigned long Interval;
+
+	/* Polls while the interactor runs. The timer starts with the first render of the initialized interactor. */
+	void Attach(vtkRenderWindowInteractor *interactor);
+
+	virtual void Execute(vtkObject *caller, unsigned long eventId, void *callData);
+
+private:
+	vtkWeakPointer<vtkRenderWindowInteractor> interactor;
+	int timerId;
+};
+
+/* Loader mode: updates the source, publishes its image under the name and republishes a fresh read of the
+   source for every line on standard input. Unpublishes at the end of the input. Returns the exit code. */
+int runImagePublisher(vtkAlgorithm *source, const std::string& name, std::ostream& os);
@@ -0,0 +1,185 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+
+#include "statshud.h"
+
+#include <vtkTextProperty.h>
+#include <vtkCoordinate.h>
+#include <vtkTimerLog.h>
+#include <vtkActor.h>
+#include <vtkActorCollection.h>
+#include <vtkMapper.h>
+#include <vtkVolume.h>
+#include <vtkVolumeCollection.h>
+#include <vtkAbstractVolumeMapper.h>
+#include <vtkDataObject.h>
+#include <vtkDataSet.h>
+#include <vtkPolyData.h>
+#include <vtkCellArray.h>
+
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+// frame times used for mean and percentile
+static const size_t frameHistory = 120;
+
+StatisticsHud::StatisticsHud()
+	: UpdateInterval(0.25), ToggleKey('h'), nextFrame(0), frameStart(0.0), lastTextUpdate(0.0)
+{
+	text = vtkSmartPointer<vtkTextActor>::New();
+	text->GetTextProperty()->SetFontFamilyToCourier();
+	text->GetTextProperty()->SetFontSize(14);
+	text->GetTextProperty()->SetColor(1, 1, 0.6);
+	text->GetTextProperty()->SetVerticalJustificationToTop();
+	text->GetPositionCoordinate()->SetCoordinateSystemToNormalizedViewport();
+	text->GetPositionCoordinate()->SetValue(0.01, 0.99);
+	text->VisibilityOff();
+	frameTimes.reserve(frameHistory);
+}
+
+void StatisticsHud::Attach(vtkRenderWindow *window, vtkRenderer *renderer, vtkRenderWindowInteractor *interactor)
+{
+	this->window = window;
+	this->renderer = renderer;
+	renderer->AddActor2D(text);
+	window->AddObserver(vtkCommand::StartEvent, this);
+	window->AddObserver(vtkCommand::EndEvent, this);
+	if (interactor)
+		interactor->AddObserver(vtkCommand::KeyPressEvent, this);
+}
+
+void StatisticsHud::AddFilter(vtkAlgorithm *filter, const std::string& name)
+{
+	Filter entry;
+	entry.algorithm = filter;
+	entry.name = name;
+	entry.start = 0.0;
+	entry.lastUpdateTime = 0.0;
+	{
+		std::lock_guard<std::mutex> lock(filterMutex);
+		filters.push_back(entry);
+	}
+	filter->AddObserver(vtkCommand::StartEvent, this);
+	filter->AddObserver(vtkCommand::EndEvent, this);
+}
+
+void StatisticsHud::SetVisible(bool visible)
+{
+	text->SetVisibility(visible);
+	if (visible)
+		updateText();
+}
+
+bool StatisticsHud::GetVisible() const
+{
+	return text->GetVisibility() != 0;
+}
+
+void StatisticsHud::Execute(vtkObject *caller, unsigned long eventId, void *callData)
+{
+	if (eventId == vtkCommand::KeyPressEvent) {
+		vtkRenderWindowInteractor *interactor = static_cast<vtkRenderWindowInteractor*>(caller);
+		if (interactor->GetKeyCode() == ToggleKey) {
+			SetVisible(!GetVisible());
+			interactor->Render();
+		}
+		return;
+	}
+
+	double now = vtkTimerLog::GetUniversalTime();
+	if (caller == window.GetPointer()) {
+		if (eventId == vtkCommand::StartEvent) {
+			frameStart = now;
+			return;
+		}
+		if (frameTimes.size() < frameHistory)
+			frameTimes.push_back(now - frameStart);
+		else
+			frameTimes[nextFrame] = now - frameStart;
+		nextFrame = (nextFrame + 1) % frameHistory;
+
+		// the new text is drawn with the next frame
+		if (GetVisible() && now - lastTextUpdate >= UpdateInterval)
+			updateText();
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(filterMutex);
+	for (size_t i = 0; i < filters.size(); ++i)
+		if (caller == filters[i].algorithm.GetPointer()) {
+			if (eventId == vtkCommand::StartEvent)
+				filters[i].start = now;
+			else
+				filters[i].lastUpdateTime = now - filters[i].start;
+		}
+}
+
+static vtkIdType countTriangles(vtkPolyData *polyData)
+{
+	// a strip with n points has n - 2 triangles and n + 1 connectivity entries
+	vtkCellArray *strips = polyData->GetStrips();
+	vtkIdType stripTriangles = strips->GetNumberOfCells() > 0 ?
+		strips->GetNumberOfConnectivityEntries() - 3 * strips->GetNumberOfCells() : 0;
+	return polyData->GetNumberOfPolys() + stripTriangles;
+}
+
+void StatisticsHud::updateText()
+{
+	lastTextUpdate = vtkTimerLog::GetUniversalTime();
+	std::ostringstream os;
+	os << std::fixed << std::setprecision(1);
+
+	// frame time
+	if (!frameTimes.empty()) {
+		std::vector<double> sorted(frameTimes);
+		double mean = 0.0;
+		for (size_t i = 0; i < sorted.size(); ++i)
+			mean += sorted[i];
+		mean /= sorted.size();
+		size_t p99 = std::min(sorted.size() - 1, (sorted.size() * 99) / 100);
+		std::nth_element(sorted.begin(), sorted.begin() + p99, sorted.end());
+		os << "frame     " << std::setw(7) << 1000.0 * mean << " ms mean " << std::setw(7) << 1000.0 * sorted[p99]
+			<< " ms p99 (" << sorted.size() << " frames)\n";
+	}
+
+	// primitives of the visible props
+	vtkIdType triangles = 0, voxels = 0;
+	if (renderer) {
+		vtkActorCollection *actors = renderer->GetActors();
+		actors->InitTraversal();
+		while (vtkActor *actor = actors->GetNextActor()) {
+			vtkPolyData *polyData = actor->GetVisibility() && actor->GetMapper() ?
+				vtkPolyData::SafeDownCast(actor->GetMapper()->GetInput()) : nullptr;
+			if (polyData)
+				triangles += countTriangles(polyData);
+		}
+		vtkVolumeCollection *volumes = renderer->GetVolumes();
+		volumes->InitTraversal();
+		while (vtkVolume *volume = volumes->GetNextVolume()) {
+			vtkDataSet *data = volume->GetVisibility() && volume->GetMapper() ? volume->GetMapper()->GetDataSetInput() : nullptr;
+			if (data)
+				voxels += data->GetNumberOfPoints();
+		}
+	}
+	os << "triangles " << std::setw(10) << triangles << "   voxels " << std::setw(10) << voxels << "\n";
+
+	// update time and memory of the filters
+	for (size_t i = 0; i < filters.size(); ++i) {
+		vtkAlgorithm *algorithm = filters[i].algorithm;
+		if (!algorithm)
+			continue;
+		double updateTime;
+		{
+			std::lock_guard<std::mutex> lock(filterMutex);
+			updateTime = filters[i].lastUpdateTime;
+		}
+		vtkDataObject *output = algorithm->GetNumberOfOutputPorts() > 0 ? algorithm->GetOutputDataObject(0) : nullptr;
+		double memory = output ? output->GetActualMemorySize() / 1024.0 : 0.0;
+		os << std::left << std::setw(14) << filters[i].name << std::right << " update " << std::setw(8)
+			<< 1000.0 * updateTime << " ms   memory " << std::setw(7) << memory << " MiB\n";
+	}
+
+	text->SetInput(os.str().c_str());
+}
@@ -0,0 +1,75 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+// On-screen overlay with frame time, pipeline update time, primitive counts and memory of the scene.
+// The same file is used by assignment 4 and assignment 5.
+//
+
+#pragma once
+
+#include <vtkSmartPointer.h>
+#include <vtkWeakPointer.h>
+#include <vtkAlgorithm.h>
+#include <vtkRenderer.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkTextActor.h>
+#include <vtkCommand.h>
+
+#include <string>
+#include <vector>
+#include <mutex>
+
+/* Statistics overlay in the upper left corner of a renderer, toggled with a key (default 'h'). It shows
+   - mean and 99th percentile of the last 120 frame times
+   - the last update time and the output memory (GetActualMemorySize) of every added filter
+   - the number of triangles of all visible actors and the number of voxels of all visible volumes.
+   The text actor is created once and its text is rebuilt at most every UpdateInterval seconds while it is
+   shown, so the overlay costs next to nothing per frame. Frame times are collected while it is hidden, too.
+   Filters may be updated on worker threads (e.g. by a BranchExecutor), their times are guarded by a mutex. */
+class StatisticsHud : public vtkCommand {
+private:
+	StatisticsHud();
+
+public:
+	static StatisticsHud *New() { return new StatisticsHud; }
+
+	/* Seconds between two updates of the text, default 0.25. */
+	double UpdateInterval;
+
+	/* Key that shows and hides the overlay. */
+	char ToggleKey;
+
+	/* Shows the overlay in the renderer, listens to the window for frame times and to the interactor for the key. */
+	void Attach(vtkRenderWindow *window, vtkRenderer *renderer, vtkRenderWindowInteractor *interactor);
+
+	/* Reports the update time and the output memory of the filter under the given name. */
+	void AddFilter(vtkAlgorithm *filter, const std::string& name);
+
+	void SetVisible(bool visible);
+	bool GetVisible() const;
+
+	virtual void Execute(vtkObject *caller, unsigned long eventId, void *callData);
+
+private:
+	struct Filter {
+		vtkWeakPointer<vtkAlgorithm> algorithm;
+		std::string name;
+		double start;
+		double lastUpdateTime;
+	};
+
+	void updateText();
+
+	vtkSmartPointer<vtkTextActor> text;
+	vtkWeakPointer<vtkRenderer> renderer;
+	vtkWeakPointer<vtkRenderWindow> window;
+	std::vector<Filter> filters;
+	std::mutex filterMutex;     // start and update times, the filters may run on worker threads
+
+	// ring buffer of frame times
+	std::vector<double> frameTimes;
+	size_t nextFrame;
+	double frameStart;
+	double lastTextUpdate;
+};
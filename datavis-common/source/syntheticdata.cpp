@@ -0,0 +1,409 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+
+#include "syntheticdata.h"
+
+#include <vtkPointData.h>
+#include <vtkDataArray.h>
+#include <vtkFloatArray.h>
+#include <vtkUnsignedShortArray.h>
+#include <vtkTypeTraits.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <vector>
+
+// ----- noise -----
+
+static double latticeValue(int x, int y, int z, unsigned int seed)
+{
+	unsigned int h = static_cast<unsigned int>(x) * 374761393u + static_cast<unsigned int>(y) * 668265263u
+		+ static_cast<unsigned int>(z) * 1440662683u + seed * 2246822519u;
+	h = (h ^ (h >> 13)) * 1274126177u;
+	h ^= h >> 16;
+	return (h & 0xffffff) / static_cast<double>(0xffffff);
+}
+
+static double valueNoise(double x, double y, unsigned int seed)
+{
+	int ix = static_cast<int>(std::floor(x));
+	int iy = static_cast<int>(std::floor(y));
+	double fx = x - ix, fy = y - iy;
+	// smoothstep interpolation between the lattice values
+	fx = fx * fx * (3 - 2 * fx);
+	fy = fy * fy * (3 - 2 * fy);
+	double v00 = latticeValue(ix, iy, 0, seed), v10 = latticeValue(ix + 1, iy, 0, seed);
+	double v01 = latticeValue(ix, iy + 1, 0, seed), v11 = latticeValue(ix + 1, iy + 1, 0, seed);
+	return (v00 * (1 - fx) + v10 * fx) * (1 - fy) + (v01 * (1 - fx) + v11 * fx) * fy;
+}
+
+static double valueNoise(double x, double y, double z, unsigned int seed)
+{
+	int iz = static_cast<int>(std::floor(z));
+	double fz = z - iz;
+	fz = fz * fz * (3 - 2 * fz);
+	int ix = static_cast<int>(std::floor(x));
+	int iy = static_cast<int>(std::floor(y));
+	double fx = x - ix, fy = y - iy;
+	fx = fx * fx * (3 - 2 * fx);
+	fy = fy * fy * (3 - 2 * fy);
+
+	double layers[2];
+	for (int k = 0; k < 2; ++k) {
+		double v00 = latticeValue(ix, iy, iz + k, seed), v10 = latticeValue(ix + 1, iy, iz + k, seed);
+		double v01 = latticeValue(ix, iy + 1, iz + k, seed), v11 = latticeValue(ix + 1, iy + 1, iz + k, seed);
+		layers[k] = (v00 * (1 - fx) + v10 * fx) * (1 - fy) + (v01 * (1 - fx) + v11 * fx) * fy;
+	}
+	return layers[0] * (1 - fz) + layers[1] * fz;
+}
+
+// ----- synthetic terrain -----
+
+vtkSmartPointer<vtkImageData> createSyntheticTerrain(int size, unsigned int seed)
+{
+	vtkSmartPointer<vtkImageData> terrain = vtkSmartPointer<vtkImageData>::New();
+	terrain->SetExtent(0, size - 1, 0, size - 1, 0, 0);
+	terrain->SetSpacing(30, 30, 1);
+	terrain->SetOrigin(0, 0, 0);
+
+	vtkSmartPointer<vtkFloatArray> elevation = vtkSmartPointer<vtkFloatArray>::New();
+	elevation->SetName("Elevation");
+	elevation->SetNumberOfTuples(static_cast<vtkIdType>(size) * size);
+	float *values = elevation->GetPointer(0);
+
+	// 8 octaves of value noise, the largest features span a quarter of the terrain
+	const double baseFrequency = 4.0 / size;
+	for (int j = 0; j < size; ++j) {
+		for (int i = 0; i < size; ++i) {
+			double height = 0.0, amplitude = 1.0, frequency = baseFrequency;
+			for (int octave = 0; octave < 8; ++octave) {
+				height += amplitude * valueNoise(i * frequency, j * frequency, seed + octave);
+				amplitude *= 0.5;
+				frequency *= 2.0;
+			}
+			values[static_cast<size_t>(j) * size + i] = static_cast<float>(500.0 + 1000.0 * height);
+		}
+	}
+
+	terrain->GetPointData()->SetScalars(elevation);
+	return terrain;
+}
+
+// ----- head phantom -----
+
+// 0 outside, 1 inside an ellipsoid, with a linear ramp of the given width around the surface
+static double softInside(double radius, double width)
+{
+	return std::min(1.0, std::max(0.0, 0.5 + (1.0 - radius) / width));
+}
+
+static double ellipsoidRadius(double x, double y, double z, const double center[3], const double radii[3])
+{
+	double dx = (x - center[0]) / radii[0], dy = (y - center[1]) / radii[1], dz = (z - center[2]) / radii[2];
+	return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+vtkSmartPointer<vtkImageData> createHeadPhantom(int width, int height, int depth, unsigned int seed)
+{
+	vtkSmartPointer<vtkImageData> phantom = vtkSmartPointer<vtkImageData>::New();
+	phantom->SetExtent(0, width - 1, 0, height - 1, 0, depth - 1);
+	phantom->SetSpacing(1, 1, 1);
+	phantom->SetOrigin(0, 0, 0);
+
+	vtkSmartPointer<vtkUnsignedShortArray> values = vtkSmartPointer<vtkUnsignedShortArray>::New();
+	values->SetName("ImageFile");
+	values->SetNumberOfTuples(static_cast<vtkIdType>(width) * height * depth);
+	unsigned short *voxel = values->GetPointer(0);
+
+	// tissue values in the ranges of headsq: air, skin and soft tissue, bone, brain, cerebrospinal fluid
+	const double air = 30, skin = 900, bone = 1700, brain = 1050, fluid = 620;
+	const double center[3] = { 0, 0, 0 };
+	const double head[3] = { 0.80, 0.92, 0.90 };
+	const double skull[3] = { 0.74, 0.86, 0.84 };
+	const double inner[3] = { 0.68, 0.80, 0.78 };
+	const double ventricles[2][3] = { { -0.12, 0.05, 0.1 }, { 0.12, 0.05, 0.1 } };
+	const double ventricle[3] = { 0.07, 0.25, 0.15 };
+
+	// boundaries are blurred over about two voxels, like the partial volume effect of a scanner
+	const double ramp = 4.0 / std::max(width, std::max(height, depth));
+
+	for (int k = 0; k < depth; ++k) {
+		double z = depth > 1 ? 2.0 * k / (depth - 1) - 1.0 : 0.0;
+		for (int j = 0; j < height; ++j) {
+			double y = height > 1 ? 2.0 * j / (height - 1) - 1.0 : 0.0;
+			for (int i = 0; i < width; ++i) {
+				double x = width > 1 ? 2.0 * i / (width - 1) - 1.0 : 0.0;
+
+				double value = air;
+				value += (skin - air) * softInside(ellipsoidRadius(x, y, z, center, head), ramp / head[0]);
+				value += (bone - skin) * softInside(ellipsoidRadius(x, y, z, center, skull), ramp / skull[0]);
+				value += (brain - bone) * softInside(ellipsoidRadius(x, y, z, center, inner), ramp / inner[0]);
+				for (int v = 0; v < 2; ++v)
+					value += (fluid - brain) * softInside(ellipsoidRadius(x, y, z, ventricles[v], ventricle), ramp / ventricle[0]);
+
+				// smooth tissue variation and scanner noise
+				value += 60.0 * (valueNoise(i * 0.15, j * 0.15, k * 0.15, seed) - 0.5);
+				value += 30.0 * (latticeValue(i, j, k, seed + 1) - 0.5);
+
+				*voxel++ = static_cast<unsigned short>(std::min(65535.0, std::max(0.0, value + 0.5)));
+			}
+		}
+	}
+
+	phantom->GetPointData()->SetScalars(values);
+	return phantom;
+}
+
+// ----- upsampling -----
+
+namespace {
+	// one output axis: the input sample below every output sample and the fraction towards the next one
+	struct AxisSamples {
+		std::vector<int> lower;
+		std::vector<double> fraction;
+	};
+
+	AxisSamples axisSamples(int inputSamples, int outputSamples)
+	{
+		AxisSamples samples;
+		for (int o = 0; o < outputSamples; ++o) {
+			double u = outputSamples > 1 ? static_cast<double>(o) * (inputSamples - 1) / (outputSamples - 1) : 0.0;
+			int lower = std::min(static_cast<int>(std::floor(u)), std::max(0, inputSamples - 2));
+			samples.lower.push_back(lower);
+			samples.fraction.push_back(inputSamples > 1 ? u - lower : 0.0);
+		}
+		return samples;
+	}
+
+	template <class T> T storedValue(double value)
+	{
+		// integer types are rounded and clamped, floating point types are stored as they are
+		if (std::numeric_limits<T>::is_integer) {
+			value = std::floor(value + 0.5);
+			value = std::min(static_cast<double>(vtkTypeTraits<T>::Max()), std::max(static_cast<double>(vtkTypeTraits<T>::Min()), value));
+		}
+		return static_cast<T>(value);
+	}
+
+	template <class T> void resample(const std::vector<double>& input, const int inputDims[3], T *output,
+		const int outputDims[3], bool fractal, unsigned int seed)
+	{
+		AxisSamples axes[3];
+		for (int a = 0; a < 3; ++a)
+			axes[a] = axisSamples(inputDims[a], outputDims[a]);
+		const size_t rowStride = inputDims[0], sliceStride = static_cast<size_t>(inputDims[0]) * inputDims[1];
+		const int stepX = inputDims[0] > 1 ? 1 : 0, stepY = inputDims[1] > 1 ? 1 : 0, stepZ = inputDims[2] > 1 ? 1 : 0;
+
+		for (int k = 0; k < outputDims[2]; ++k) {
+			const int z0 = axes[2].lower[k];
+			const double tz = axes[2].fraction[k];
+			for (int j = 0; j < outputDims[1]; ++j) {
+				const int y0 = axes[1].lower[j];
+				const double ty = axes[1].fraction[j];
+				for (int i = 0; i < outputDims[0]; ++i) {
+					const int x0 = axes[0].lower[i];
+					const double tx = axes[0].fraction[i];
+
+					// the eight samples of the input cell, degenerated axes repeat their single sample
+					const double *base = &input[z0 * sliceStride + y0 * rowStride + x0];
+					double c[8];
+					for (int corner = 0; corner < 8; ++corner)
+						c[corner] = base[(corner & 4 ? stepZ * sliceStride : 0) + (corner & 2 ? stepY * rowStride : 0) + (corner & 1 ? stepX : 0)];
+
+					double bottom = (c[0] * (1 - tx) + c[1] * tx) * (1 - ty) + (c[2] * (1 - tx) + c[3] * tx) * ty;
+					double top = (c[4] * (1 - tx) + c[5] * tx) * (1 - ty) + (c[6] * (1 - tx) + c[7] * tx) * ty;
+					double value = bottom * (1 - tz) + top * tz;
+
+					if (fractal) {
+						// four octaves from the input sample frequency up, zero at the input samples themselves
+						double roughness = *std::max_element(c, c + 8) - *std::min_element(c, c + 8);
+						double weight = 1.0 - (1.0 - 4 * tx * (1 - tx)) * (1.0 - 4 * ty * (1 - ty)) * (1.0 - 4 * tz * (1 - tz));
+						double u = x0 + tx, v = y0 + ty, w = z0 + tz;
+						double detail = 0.0, amplitude = 0.5, frequency = 1.0;
+						for (int octave = 0; octave < 4; ++octave) {
+							detail += amplitude * (valueNoise(u * frequency, v * frequency, w * frequency, seed + octave) - 0.5);
+							amplitude *= 0.5;
+							frequency *= 2.0;
+						}
+						value += roughness * weight * detail;
+					}
+
+					*output++ = storedValue<T>(value);
+				}
+			}
+		}
+	}
+}
+
+vtkSmartPointer<vtkImageData> upsampleImage(vtkImageData *image, double factor, bool fractal, unsigned int seed)
+{
+	vtkDataArray *scalars = image->GetPointData()->GetScalars();
+	if (!scalars || factor <= 0.0)
+		return nullptr;
+
+	int inputDims[3], outputDims[3];
+	image->GetDimensions(inputDims);
+	double spacing[3];
+	image->GetSpacing(spacing);
+	for (int a = 0; a < 3; ++a) {
+		outputDims[a] = inputDims[a] > 1 ? static_cast<int>(std::floor((inputDims[a] - 1) * factor + 0.5)) + 1 : 1;
+		if (outputDims[a] > 1)
+			spacing[a] *= static_cast<double>(inputDims[a] - 1) / (outputDims[a] - 1);
+	}
+
+	// the input is small compared to the output, it is read once into doubles (first component)
+	std::vector<double> input(static_cast<size_t>(scalars->GetNumberOfTuples()));
+	for (vtkIdType p = 0; p < scalars->GetNumberOfTuples(); ++p)
+		input[p] = scalars->GetComponent(p, 0);
+
+	vtkSmartPointer<vtkDataArray> values;
+	values.TakeReference(scalars->NewInstance());
+	values->SetName(scalars->GetName());
+	values->SetNumberOfComponents(1);
+	values->SetNumberOfTuples(static_cast<vtkIdType>(outputDims[0]) * outputDims[1] * outputDims[2]);
+
+	switch (values->GetDataType()) {
+		vtkTemplateMacro(resample(input, inputDims, static_cast<VTK_TT*>(values->GetVoidPointer(0)), outputDims, fractal, seed));
+	default:
+		return nullptr;
+	}
+
+	vtkSmartPointer<vtkImageData> output = vtkSmartPointer<vtkImageData>::New();
+	int extent[6];
+	image->GetExtent(extent);
+	output->SetExtent(extent[0], extent[0] + outputDims[0] - 1, extent[2], extent[2] + outputDims[1] - 1,
+		extent[4], extent[4] + outputDims[2] - 1);
+	output->SetOrigin(image->GetOrigin());
+	output->SetSpacing(spacing);
+	output->GetPointData()->SetScalars(values);
+	return output;
+}
+
+// ----- DEM writer -----
+
+namespace {
+	// fixed-width Fortran fields, reals with D exponents like the USGS files
+	void integerField(std::string& record, int value, int width = 6)
+	{
+		char field[32];
+		std::snprintf(field, sizeof(field), "%*d", width, value);
+		record += field;
+	}
+
+	void realField(std::string& record, double value)
+	{
+		char field[40];
+		std::snprintf(field, sizeof(field), "%24.15E", value);
+		std::string text(field);
+		std::replace(text.begin(), text.end(), 'E', 'D');
+		record += text;
+	}
+
+	void resolutionField(std::string& record, double value)
+	{
+		char field[32];
+		std::snprintf(field, sizeof(field), "%12.6E", value);
+		record += field;
+	}
+
+	void padRecord(std::string& record)
+	{
+		record.resize((record.size() + 1023) / 1024 * 1024, ' ');
+	}
+}
+
+bool writeDem(const std::string& fileName, vtkImageData *terrain, const std::string& title)
+{
+	vtkDataArray *elevation = terrain->GetPointData()->GetScalars();
+	int dims[3];
+	terrain->GetDimensions(dims);
+	if (!elevation || dims[2] != 1 || dims[0] < 2 || dims[1] < 2)
+		return false;
+
+	double origin[3], spacing[3];
+	terrain->GetOrigin(origin);
+	terrain->GetSpacing(spacing);
+	int extent[6];
+	terrain->GetExtent(extent);
+	const double west = origin[0] + extent[0] * spacing[0], south = origin[1] + extent[2] * spacing[1];
+	const double east = west + (dims[0] - 1) * spacing[0], north = south + (dims[1] - 1) * spacing[1];
+
+	// elevations are stored as integer meters
+	std::vector<int> heights(static_cast<size_t>(dims[0]) * dims[1]);
+	int low = std::numeric_limits<int>::max(), high = std::numeric_limits<int>::min();
+	for (size_t p = 0; p < heights.size(); ++p) {
+		heights[p] = static_cast<int>(std::floor(elevation->GetComponent(static_cast<vtkIdType>(p), 0) + 0.5));
+		low = std::min(low, heights[p]);
+		high = std::max(high, heights[p]);
+	}
+
+	std::ofstream file(fileName.c_str(), std::ios::binary);
+	if (!file)
+		return false;
+
+	// A-record: title, level, pattern, UTM zone 10, projection parameters, units, corners, range, resolution
+	std::string record = title.substr(0, 144);
+	record.resize(144, ' ');
+	integerField(record, 1);
+	integerField(record, 1);
+	integerField(record, 1);
+	integerField(record, 10);
+	for (int parameter = 0; parameter < 15; ++parameter)
+		realField(record, 0.0);
+	integerField(record, 2);
+	integerField(record, 2);
+	integerField(record, 4);
+	const double corners[4][2] = { { west, south }, { west, north }, { east, north }, { east, south } };
+	for (int corner = 0; corner < 4; ++corner) {
+		realField(record, corners[corner][0]);
+		realField(record, corners[corner][1]);
+	}
+	realField(record, low);
+	realField(record, high);
+	realField(record, 0.0);
+	integerField(record, 0);
+	resolutionField(record, spacing[0]);
+	resolutionField(record, spacing[1]);
+	resolutionField(record, 1.0);
+	integerField(record, 1);
+	integerField(record, dims[0]);
+	padRecord(record);
+	file.write(record.data(), record.size());
+
+	// B-records: one south to north profile per column, 146 elevations in the first block and 170 in the others
+	for (int column = 0; column < dims[0]; ++column) {
+		int profileLow = std::numeric_limits<int>::max(), profileHigh = std::numeric_limits<int>::min();
+		for (int row = 0; row < dims[1]; ++row) {
+			int value = heights[static_cast<size_t>(row) * dims[0] + column];
+			profileLow = std::min(profileLow, value);
+			profileHigh = std::max(profileHigh, value);
+		}
+
+		record.clear();
+		integerField(record, 1);
+		integerField(record, column + 1);
+		integerField(record, dims[1]);
+		integerField(record, 1);
+		realField(record, west + column * spacing[0]);
+		realField(record, south);
+		realField(record, 0.0);
+		realField(record, profileLow);
+		realField(record, profileHigh);
+
+		size_t blockEnd = 1020;
+		for (int row = 0; row < dims[1]; ++row) {
+			if (record.size() + 6 > blockEnd) {
+				padRecord(record);
+				blockEnd = record.size() + 1020;
+			}
+			integerField(record, heights[static_cast<size_t>(row) * dims[0] + column]);
+		}
+		padRecord(record);
+		file.write(record.data(), record.size());
+	}
+	return static_cast<bool>(file);
+}
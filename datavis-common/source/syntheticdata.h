@@ -0,0 +1,33 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+// Synthetic elevation grids and volumes of arbitrary size for scaling studies, and a USGS DEM writer.
+// The same file is used by assignment 4 and assignment 5.
+//
+
+#pragma once
+
+#include <vtkSmartPointer.h>
+#include <vtkImageData.h>
+
+#include <string>
+
+/* Creates a procedural height field (fractal value noise) with the given number of samples per side,
+   30 m spacing like SainteHelens.dem and elevations roughly in its range. */
+vtkSmartPointer<vtkImageData> createSyntheticTerrain(int size, unsigned int seed);
+
+/* Creates a CT-like head phantom with unsigned short values in the ranges of headsq-half.vti: air, skin and soft
+   tissue, skull, brain and two ventricles as nested ellipsoids with boundaries blurred over two voxels and a little
+   noise, so iso surfaces at 500 (skin) and 1150 (bone) look like the ones of the bundled volume. */
+vtkSmartPointer<vtkImageData> createHeadPhantom(int width, int height, int depth, unsigned int seed);
+
+/* Upsamples an image by the factor along every axis of more than one sample, with bilinear or trilinear
+   interpolation; the spacing shrinks by the same factor, so the bounds stay. The scalar type is kept.
+   With fractal detail, value noise at the frequency of the original samples and above is added, scaled by the
+   local difference of the original samples, so flat regions stay flat and rough regions get new roughness
+   instead of smooth ramps between the original samples. */
+vtkSmartPointer<vtkImageData> upsampleImage(vtkImageData *image, double factor, bool fractal, unsigned int seed);
+
+/* Writes a 2D elevation grid as USGS DEM that vtkDEMReader and readDemHeader read: UTM ground coordinates in
+   meters starting at the image origin, one profile per column, integer elevations in meters. */
+bool writeDem(const std::string& fileName, vtkImageData *terrain, const std::string& title);
@@ -0,0 +1,172 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+
+#include "taskgraph.h"
+
+#include <vtkTimerLog.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <deque>
+
+// ----- task graph -----
+TaskGraph::TaskGraph()
+	: trace(nullptr), lastRunTime(0.0)
+{
+}
+
+int TaskGraph::AddTask(const std::string& name, Function function, const std::vector<int>& dependencies)
+{
+	int id = static_cast<int>(tasks.size());
+	Task task;
+	task.name = name;
+	task.function = function;
+	task.duration = 0.0;
+	// tasks only depend on earlier tasks, so the ids are a topological order and there are no cycles
+	for (size_t d = 0; d < dependencies.size(); ++d)
+		if (dependencies[d] >= 0 && dependencies[d] < id)
+			task.dependencies.push_back(dependencies[d]);
+	tasks.push_back(task);
+	for (size_t d = 0; d < tasks[id].dependencies.size(); ++d)
+		tasks[tasks[id].dependencies[d]].dependents.push_back(id);
+	return id;
+}
+
+double TaskGraph::Run(int maximumThreads)
+{
+	if (tasks.empty())
+		return 0.0;
+	if (maximumThreads <= 0)
+		maximumThreads = std::max(1u, std::thread::hardware_concurrency());
+	const int workerCount = std::min(maximumThreads, static_cast<int>(tasks.size()));
+
+	std::mutex mutex;
+	std::condition_variable changed;
+	std::deque<int> ready;
+	std::vector<size_t> waitingFor(tasks.size());
+	size_t finished = 0;
+	for (size_t t = 0; t < tasks.size(); ++t) {
+		waitingFor[t] = tasks[t].dependencies.size();
+		if (waitingFor[t] == 0)
+			ready.push_back(static_cast<int>(t));
+	}
+
+	PipelineTrace *trace = this->trace && this->trace->GetEnabled() ? this->trace : nullptr;
+	double start = vtkTimerLog::GetUniversalTime();
+
+	auto worker = [&]() {
+		std::unique_lock<std::mutex> lock(mutex);
+		while (finished < tasks.size()) {
+			if (ready.empty()) {
+				changed.wait(lock);
+				continue;
+			}
+			int id = ready.front();
+			ready.pop_front();
+
+			lock.unlock();
+			double taskStart = vtkTimerLog::GetUniversalTime();
+			if (tasks[id].function)
+				tasks[id].function();
+			double taskEnd = vtkTimerLog::GetUniversalTime();
+			if (trace)
+				trace->AddSpan(tasks[id].name, "task", taskStart, taskEnd);
+			lock.lock();
+
+			tasks[id].duration = taskEnd - taskStart;
+			++finished;
+			for (size_t d = 0; d < tasks[id].dependents.size(); ++d)
+				if (--waitingFor[tasks[id].dependents[d]] == 0)
+					ready.push_back(tasks[id].dependents[d]);
+			changed.notify_all();
+		}
+	};
+
+	// the calling thread is one of the workers
+	std::vector<std::thread> workers;
+	for (int w = 1; w < workerCount; ++w)
+		workers.push_back(std::thread(worker));
+	worker();
+	for (size_t w = 0; w < workers.size(); ++w)
+		workers[w].join();
+
+	lastRunTime = vtkTimerLog::GetUniversalTime() - start;
+	return lastRunTime;
+}
+
+double TaskGraph::GetSumOfTaskTimes() const
+{
+	double sum = 0.0;
+	for (size_t t = 0; t < tasks.size(); ++t)
+		sum += tasks[t].duration;
+	return sum;
+}
+
+double TaskGraph::GetCriticalPathTime() const
+{
+	// tasks are stored in topological order
+	std::vector<double> finish(tasks.size(), 0.0);
+	double longest = 0.0;
+	for (size_t t = 0; t < tasks.size(); ++t) {
+		double begin = 0.0;
+		for (size_t d = 0; d < tasks[t].dependencies.size(); ++d)
+			begin = std::max(begin, finish[tasks[t].dependencies[d]]);
+		finish[t] = begin + tasks[t].duration;
+		longest = std::max(longest, finish[t]);
+	}
+	return longest;
+}
+
+void TaskGraph::PrintSummary(std::ostream& os) const
+{
+	os << std::fixed << std::setprecision(1);
+	for (size_t t = 0; t < tasks.size(); ++t)
+		os << "  " << std::left << std::setw(20) << tasks[t].name << std::right << std::setw(10)
+			<< 1000.0 * tasks[t].duration << " ms" << std::endl;
+	os << "  wall clock " << 1000.0 * lastRunTime << " ms, longest path " << 1000.0 * GetCriticalPathTime()
+		<< " ms, sum of tasks " << 1000.0 * GetSumOfTaskTimes() << " ms" << std::endl;
+}
+
+// ----- pipeline branches -----
+BranchExecutor::BranchExecutor(vtkAlgorithm *upstream, const std::string& name)
+	: upstream(upstream), upstreamName(name)
+{
+}
+
+void BranchExecutor::AddBranch(vtkAlgorithm *branch, const std::string& name)
+{
+	Branch entry;
+	entry.algorithm = branch;
+	entry.name = name;
+	branches.push_back(entry);
+}
+
+double BranchExecutor::Update(PipelineTrace *trace, int maximumThreads)
+{
+	graph = TaskGraph();
+	graph.SetTrace(trace);
+
+	int source = graph.AddTask(upstreamName, [this]() {
+		upstream->Update();
+
+		// still on one thread: hand every branch its own data object before any of them runs
+		vtkDataObject *output = upstream->GetOutputDataObject(0);
+		for (size_t b = 0; b < branches.size(); ++b) {
+			if (!branches[b].input || !branches[b].input->IsA(output->GetClassName()))
+				branches[b].input.TakeReference(output->NewInstance());
+			branches[b].input->ShallowCopy(output);
+			branches[b].algorithm->SetInputDataObject(0, branches[b].input);
+		}
+	});
+
+	for (size_t b = 0; b < branches.size(); ++b) {
+		vtkAlgorithm *algorithm = branches[b].algorithm;
+		graph.AddTask(branches[b].name, [algorithm]() { algorithm->Update(); }, std::vector<int>(1, source));
+	}
+
+	return graph.Run(maximumThreads);
+}
@@ -0,0 +1,92 @@
+//
+// MAINTAINER MAHIUDDIN AL KAMAL <mahiuddinalkamal@gmail.com>
+//
+// Task graph executor and concurrent update of independent pipeline branches.
+// The same file is used by assignment 4 and assignment 5.
+//
+
+#pragma once
+
+#include "pipelinetrace.h"
+
+#include <vtkSmartPointer.h>
+#include <vtkAlgorithm.h>
+#include <vtkDataObject.h>
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <functional>
+
+/* A set of tasks with dependencies. Run() starts every task as soon as all tasks it depends on have finished,
+   on a pool of worker threads, so independent tasks overlap. */
+class TaskGraph {
+public:
+	typedef std::function<void()> Function;
+
+	TaskGraph();
+
+	/* Adds a task that runs after the given tasks. Returns the id of the task for later dependencies. */
+	int AddTask(const std::string& name, Function function, const std::vector<int>& dependencies = std::vector<int>());
+
+	/* Records a span for every task in the trace (may be null). */
+	void SetTrace(PipelineTrace *trace) { this->trace = trace; }
+
+	/* Runs all tasks with at most maximumThreads at a time (0: one per core) and returns the wall clock time in seconds. */
+	double Run(int maximumThreads = 0);
+
+	size_t GetNumberOfTasks() const { return tasks.size(); }
+	const std::string& GetTaskName(int task) const { return tasks[task].name; }
+	double GetTaskTime(int task) const { return tasks[task].duration; }
+
+	/* Sum of all task times and the time of the longest dependency chain of the last run. With enough threads the
+	   wall clock time approaches the critical path instead of the sum. */
+	double GetSumOfTaskTimes() const;
+	double GetCriticalPathTime() const;
+
+	/* Prints every task time, the wall clock time, the critical path and the sum of the last run. */
+	void PrintSummary(std::ostream& os) const;
+
+private:
+	struct Task {
+		std::string name;
+		Function function;
+		std::vector<int> dependencies;
+		std::vector<int> dependents;
+		double duration;
+	};
+
+	std::vector<Task> tasks;
+	PipelineTrace *trace;
+	double lastRunTime;
+};
+
+/* Updates a shared upstream algorithm once and then all pipeline branches that hang off its first output in
+   parallel. VTK updates the branches of a pipeline one after another and its executives must not be entered from
+   two threads at once, so every branch is connected to its own shallow copy of the upstream output (the arrays are
+   shared, nothing is copied) before the branches run. Later updates of a branch (e.g. from a slider) only execute
+   that branch. Call Update() again after the upstream changed. */
+class BranchExecutor {
+public:
+	BranchExecutor(vtkAlgorithm *upstream, const std::string& name);
+
+	/* Adds a branch. Its input port 0 is reconnected to the shallow copy by Update(). */
+	void AddBranch(vtkAlgorithm *branch, const std::string& name);
+
+	/* Updates upstream and branches, returns the wall clock time in seconds. */
+	double Update(PipelineTrace *trace = nullptr, int maximumThreads = 0);
+
+	const TaskGraph& GetTaskGraph() const { return graph; }
+
+private:
+	struct Branch {
+		vtkSmartPointer<vtkAlgorithm> algorithm;
+		std::string name;
+		vtkSmartPointer<vtkDataObject> input;
+	};
+
+	vtkSmartPointer<vtkAlgorithm> upstream;
+	std::string upstreamName;
+	std::vector<Branch> branches;
+	TaskGraph graph;
+};